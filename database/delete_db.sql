@@ -3,6 +3,7 @@
 -- =====================================
 
 DROP TABLE IF EXISTS call_logs CASCADE;
+DROP TABLE IF EXISTS offline_notifications CASCADE;
 DROP TABLE IF EXISTS chat_messages CASCADE;
 DROP TABLE IF EXISTS server_sessions CASCADE;
 DROP TABLE IF EXISTS game_items CASCADE;
@@ -66,6 +66,11 @@ CREATE TABLE IF NOT EXISTS results (
     status VARCHAR(20) CHECK (status IN ('pending', 'graded')) DEFAULT 'graded'
 );
 
+-- Teacher grading queue: pending results newest first, in the keyset order
+-- PENDING_SUBMISSIONS_REQUEST pages through; graded history is not indexed here
+CREATE INDEX IF NOT EXISTS idx_results_pending
+    ON results (submitted_at DESC, result_id DESC) WHERE status = 'pending';
+
 CREATE TABLE IF NOT EXISTS game_items (
     game_id SERIAL PRIMARY KEY,
     type VARCHAR(50) CHECK (type IN ('word_match', 'sentence_match', 'image_match')),
@@ -98,10 +103,32 @@ CREATE TABLE IF NOT EXISTS chat_messages (
     message_type VARCHAR(20) CHECK (message_type IN ('TEXT', 'AUDIO', 'SYSTEM')) DEFAULT 'TEXT',
     created_at TIMESTAMPTZ NOT NULL DEFAULT NOW(),
     is_read BOOLEAN NOT NULL DEFAULT FALSE,
+    is_delivered BOOLEAN NOT NULL DEFAULT FALSE,
     FOREIGN KEY (sender_id) REFERENCES users(user_id),
     FOREIGN KEY (receiver_id) REFERENCES users(user_id)
 );
 
+-- Upgrade path for databases created before delivery tracking:
+-- existing rows count as delivered, new rows start undelivered
+ALTER TABLE chat_messages ADD COLUMN IF NOT EXISTS is_delivered BOOLEAN NOT NULL DEFAULT TRUE;
+ALTER TABLE chat_messages ALTER COLUMN is_delivered SET DEFAULT FALSE;
+
+-- Offline outbox lookup on login
+CREATE INDEX IF NOT EXISTS idx_chat_messages_undelivered
+    ON chat_messages (receiver_id, created_at) WHERE is_delivered = FALSE;
+
+-- Notifications for users who were offline (missed calls, grades). Pushed in
+-- the next login's digest and deleted once the client acknowledges them.
+CREATE TABLE IF NOT EXISTS offline_notifications (
+    id SERIAL PRIMARY KEY,
+    user_id INTEGER NOT NULL REFERENCES users(user_id) ON DELETE CASCADE,
+    content TEXT NOT NULL,
+    created_at TIMESTAMPTZ NOT NULL DEFAULT NOW()
+);
+
+CREATE INDEX IF NOT EXISTS idx_offline_notifications_user
+    ON offline_notifications (user_id, id);
+
 CREATE TABLE IF NOT EXISTS call_logs (
     call_id SERIAL PRIMARY KEY,
     caller_id INTEGER NOT NULL REFERENCES users(user_id),
@@ -4,8 +4,14 @@
 #include "common/protocol.h"
 #include <string>
 #include <vector>
+#include <deque>
+#include <unordered_map>
 #include <chrono>
 
+namespace Payloads {
+struct PendingSubmissionsRequest;
+}
+
 namespace client {
 
 class NetworkClient {
@@ -17,6 +23,9 @@ private:
     std::string userRole;
     bool connected;
     bool loggedIn;
+    bool binaryPayloads; // Requests use the binary codec (HELLO / CODEC_SELECT negotiated)
+    bool compressPayloads; // Large frames are deflated both ways (HELLO / CODEC_SELECT negotiated)
+    protocol::Capabilities serverCapabilities; // From HELLO_ACK; defaults for servers without HELLO
     
     std::chrono::steady_clock::time_point lastHeartbeat;
     int heartbeatInterval; // seconds
@@ -31,6 +40,54 @@ private:
     // Buffer for incoming data
     std::vector<uint8_t> receiveBuffer;
 
+    // Frames read while waiting for a specific response; handed out first
+    // by receiveMessage()/pollMessages()
+    std::deque<protocol::Message> pendingMessages;
+    uint32_t nextCorrelationId;
+
+    // Block for the next frame off the socket
+    protocol::Message readFrame();
+
+    // Requests queued between beginBatch() and sendBatch()
+    bool batching;
+    std::vector<uint8_t> batchFrames;
+
+    // Chunked responses (STREAM_START/CHUNK/END) being reassembled, by stream id
+    struct PartialStream {
+        protocol::MsgCode code;
+        bool binary;
+        uint32_t correlationId;
+        std::vector<uint8_t> data;
+    };
+    std::unordered_map<uint32_t, PartialStream> streams;
+
+    // Fold a STREAM_* frame into its stream. Returns true if msg was consumed;
+    // on STREAM_END msg becomes the reassembled response and false is returned.
+    bool absorbStreamFrame(protocol::Message& msg);
+
+    // Append msg to out, or its sub-responses if it is a BATCH_RESPONSE
+    void appendUnpacked(std::vector<protocol::Message>& out, protocol::Message msg);
+
+    // Conditional fetch for catalog requests (lists and lesson/exercise/exam/
+    // game content): the last response per request is kept with its content
+    // version, and a NOT_MODIFIED reply is swapped for the cached copy, so
+    // callers always see the usual *_SUCCESS message.
+    struct CachedResponse {
+        uint64_t version;
+        protocol::Message response;
+    };
+    static constexpr size_t MAX_CATALOG_CACHE = 256;
+    std::unordered_map<std::string, CachedResponse> catalogCache; // Keyed by code + parameters
+    std::unordered_map<uint32_t, std::string> pendingCatalogRequests; // Correlation id -> cache key
+
+    bool sendCatalogRequest(protocol::Message msg, const std::string& cacheKey);
+
+    // HELLO handshake; returns false if the server predates it
+    bool sendHello(bool binary, bool deflate);
+    // CODEC_SELECT_REQUEST, for servers without HELLO
+    bool selectCodec(bool binary, bool deflate);
+    void applyCatalogCache(protocol::Message& msg);
+
 public:
     NetworkClient(const std::string& host = "127.0.0.1", int port = 8080);
     ~NetworkClient();
@@ -41,6 +98,21 @@ public:
     bool isConnected() const { return connected; }
     bool isLoggedIn() const { return loggedIn; }
 
+    // Ask the server for binary payloads (call before login). Falls back to
+    // text and returns false if the server does not support it. Responses to
+    // binary requests arrive binary; read them with Payloads::decode.
+    bool negotiateBinaryPayloads();
+    bool usesBinaryPayloads() const { return binaryPayloads; }
+
+    // Pick the codec and compression (replacing any earlier choice), with a
+    // HELLO that also advertises our other features and learns the server's
+    // limits; servers that predate HELLO get a CODEC_SELECT_REQUEST instead.
+    // Returns true if the server accepted both; each option the server does
+    // not support stays off.
+    bool negotiatePayloads(bool binary, bool deflate);
+    bool usesCompression() const { return compressPayloads; }
+    const protocol::Capabilities& getServerCapabilities() const { return serverCapabilities; }
+
     // Authentication
     bool login(const std::string& username, const std::string& password);
     bool registerUser(const std::string& username, const std::string& password);
@@ -53,6 +125,24 @@ public:
     // Message sending/receiving
     bool sendMessage(const protocol::Message& msg);
     protocol::Message receiveMessage();
+
+    // Pipelined requests: sendRequest tags msg with a fresh correlation id
+    // (v2 frame) and returns it, or 0 if sending failed. receiveResponse
+    // waits for the response carrying that id; anything that arrives first
+    // is kept for receiveMessage()/pollMessages().
+    uint32_t sendRequest(protocol::Message msg);
+    protocol::Message receiveResponse(uint32_t correlationId);
+
+    // Batching: after beginBatch(), sendMessage()/sendRequest() and the
+    // requestX() helpers queue their frames instead of writing them.
+    // sendBatch() sends the queue as one BATCH_REQUEST and returns its
+    // correlation id (0 if empty or sending failed). receiveMessage() and
+    // pollMessages() hand out the sub-responses one by one; receiveResponse()
+    // on the batch id returns the whole BATCH_RESPONSE
+    // (split it with protocol::unpackFrames).
+    void beginBatch();
+    uint32_t sendBatch();
+    bool isBatching() const { return batching; }
     
     // Non-blocking poll for messages
     std::vector<protocol::Message> pollMessages();
@@ -74,6 +164,8 @@ public:
     bool requestResultList();
     bool requestResultDetail(const std::string& targetType, const std::string& targetId);
     bool requestPendingSubmissions();
+    // One filtered page; filter.after = Payloads::submissionCursor(last row) for the next
+    bool requestPendingSubmissions(Payloads::PendingSubmissionsRequest filter);
     bool submitGrade(const std::string& resultId, const std::string& score, const std::string& feedback, const std::string& gradingDetails = "{}");
     // Exercise and exam requests
     bool requestExercises();
@@ -85,6 +177,16 @@ public:
     bool sendPrivateMessage(const std::string& recipient, const std::string& content, const std::string& type = "TEXT");
     bool requestChatHistory(const std::string& otherUser);
     bool requestRecentChats();
+    bool acknowledgeChatRead(const std::string& otherUser); // Fire-and-forget CHAT_READ_ACK
+    bool acknowledgeUnreadDigest(const std::vector<std::string>& messageIds); // Fire-and-forget UNREAD_DIGEST_ACK
+    bool acknowledgeChatMessage(const std::string& messageId); // Fire-and-forget CHAT_RECEIVE_ACK
+
+    // Blob transfer (chat audio). uploadBlob sends every chunk in order;
+    // requestBlobChunk pulls one BLOB_DOWNLOAD_CHUNK starting at offset;
+    // accept lists encodings the caller can decode (e.g. "adpcm").
+    static constexpr size_t BLOB_CHUNK_SIZE = 48 * 1024;
+    bool uploadBlob(const std::string& uploadId, const std::string& bytes);
+    bool requestBlobChunk(const std::string& hash, uint64_t offset = 0, const std::string& accept = "");
 
     // Voice Calls
     bool initiateCall(const std::string& targetUser);
@@ -0,0 +1,39 @@
+#ifndef COMMON_ADPCM_H
+#define COMMON_ADPCM_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Voice note compression shared by server (encode) and client (decode).
+// Container ("ADP1"): [4B magic][4B sampleRate LE][4B sampleCount LE] followed by
+// IMA-ADPCM blocks of up to ADPCM_BLOCK_SAMPLES samples. Each block starts with
+// [2B predictor LE][1B step index][1B reserved] and packs 4-bit codes low nibble first.
+namespace audio {
+
+constexpr uint32_t VOICE_SAMPLE_RATE = 16000;
+constexpr size_t ADPCM_BLOCK_SAMPLES = 1024;
+
+// Mono 16-bit PCM
+struct PcmAudio {
+    uint32_t sampleRate = 0;
+    std::vector<int16_t> samples;
+};
+
+// Parse a PCM WAV file (8/16-bit, any channel count; mixed down to mono)
+bool parseWav(const std::string& bytes, PcmAudio& out);
+
+// Build a mono 16-bit PCM WAV file
+std::string buildWav(const PcmAudio& pcm);
+
+// Downsample to targetRate with a box low-pass filter; never upsamples
+PcmAudio downsample(const PcmAudio& in, uint32_t targetRate);
+
+// Encode / decode the ADP1 container
+std::string encodeAdpcm(const PcmAudio& pcm);
+bool decodeAdpcm(const std::string& bytes, PcmAudio& out);
+bool isAdpcm(const std::string& bytes);
+
+} // namespace audio
+
+#endif // COMMON_ADPCM_H
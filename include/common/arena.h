@@ -0,0 +1,50 @@
+#ifndef COMMON_ARENA_H
+#define COMMON_ARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+
+// Per-request scratch memory. Parsing a request allocates only short-lived
+// temporaries (field views, token vectors); they come from a monotonic
+// buffer that is released in one step when the handler returns instead of
+// being freed piecemeal.
+namespace arena {
+
+class RequestArena {
+private:
+    static constexpr size_t INLINE_BYTES = 8192; // Covers typical request payloads without touching the heap
+
+    alignas(std::max_align_t) std::byte initial[INLINE_BYTES];
+    std::pmr::monotonic_buffer_resource resource;
+
+public:
+    RequestArena();
+    RequestArena(const RequestArena&) = delete;
+    RequestArena& operator=(const RequestArena&) = delete;
+
+    std::pmr::memory_resource* get() { return &resource; }
+
+    // Drop everything allocated since the last reset; overflow blocks are freed
+    void reset() { resource.release(); }
+};
+
+// Resource for temporaries on this thread: the installed request arena, or
+// the default heap resource when no request is being handled
+std::pmr::memory_resource* current();
+
+// Installs an arena for the lifetime of one request and resets it on exit
+class Scope {
+private:
+    RequestArena& arena;
+    std::pmr::memory_resource* previous;
+
+public:
+    explicit Scope(RequestArena& a);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+};
+
+} // namespace arena
+
+#endif // COMMON_ARENA_H
@@ -0,0 +1,176 @@
+#ifndef COMMON_BINARY_CODEC_H
+#define COMMON_BINARY_CODEC_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+// Length-prefixed binary encoding for Payloads, used instead of the ';' / '|'
+// text format on connections that negotiated it (CODEC_SELECT_REQUEST).
+//
+// A payload is a sequence of fields in declaration order. Each field is a
+// one-byte wire type followed by its value:
+//   INT    zigzag varint
+//   STRING varint length + raw bytes (any content, no escaping)
+//   LIST   varint count + elements; nested DTOs are STRING-framed
+// Decoders stop quietly when the payload runs out of fields, so a newer
+// reader accepts payloads from an older writer (missing fields keep their
+// defaults) and extra trailing fields are ignored.
+namespace codec {
+
+enum class WireType : uint8_t {
+    INT = 0,
+    STRING = 1,
+    LIST = 2
+};
+
+class BinaryWriter {
+private:
+    std::string buffer;
+
+public:
+    void writeVarint(uint64_t value) {
+        while (value >= 0x80) {
+            buffer.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        buffer.push_back(static_cast<char>(value));
+    }
+
+    void writeType(WireType type) { buffer.push_back(static_cast<char>(type)); }
+
+    void writeInt(int64_t value) {
+        writeType(WireType::INT);
+        writeVarint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    void writeString(const std::string& value) {
+        writeType(WireType::STRING);
+        writeVarint(value.size());
+        buffer.append(value);
+    }
+
+    void beginList(size_t count) {
+        writeType(WireType::LIST);
+        writeVarint(count);
+    }
+
+    const std::string& data() const { return buffer; }
+    std::string release() { return std::move(buffer); }
+};
+
+class BinaryReader {
+private:
+    const uint8_t* pos;
+    const uint8_t* end;
+
+    uint8_t next() {
+        if (pos >= end) throw std::runtime_error("Binary payload truncated");
+        return *pos++;
+    }
+
+    void expect(WireType type) {
+        WireType actual = static_cast<WireType>(next());
+        if (actual != type) throw std::runtime_error("Binary payload field type mismatch");
+    }
+
+public:
+    BinaryReader(const uint8_t* data, size_t size) : pos(data), end(data + size) {}
+    explicit BinaryReader(const std::string& data)
+        : BinaryReader(reinterpret_cast<const uint8_t*>(data.data()), data.size()) {}
+
+    bool atEnd() const { return pos >= end; }
+
+    uint64_t readVarint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte = next();
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) return value;
+        }
+        throw std::runtime_error("Binary payload varint too long");
+    }
+
+    int64_t readInt() {
+        expect(WireType::INT);
+        uint64_t raw = readVarint();
+        return static_cast<int64_t>((raw >> 1) ^ (~(raw & 1) + 1));
+    }
+
+    std::string readString() {
+        expect(WireType::STRING);
+        uint64_t length = readVarint();
+        if (length > static_cast<uint64_t>(end - pos)) throw std::runtime_error("Binary payload truncated");
+        std::string value(reinterpret_cast<const char*>(pos), static_cast<size_t>(length));
+        pos += length;
+        return value;
+    }
+
+    size_t beginList() {
+        expect(WireType::LIST);
+        uint64_t count = readVarint();
+        // Every element takes at least two bytes; reject absurd counts early
+        if (count > static_cast<uint64_t>(end - pos)) throw std::runtime_error("Binary payload list too long");
+        return static_cast<size_t>(count);
+    }
+};
+
+// Field helpers: DTOs list their members once in encode()/decode()
+// and these pick the wire representation from the C++ type.
+
+inline void writeField(BinaryWriter& w, const std::string& value) { w.writeString(value); }
+inline void writeField(BinaryWriter& w, int value) { w.writeInt(value); }
+inline void writeField(BinaryWriter& w, bool value) { w.writeInt(value ? 1 : 0); }
+
+template <typename T>
+void writeField(BinaryWriter& w, const T& dto) {
+    BinaryWriter nested;
+    dto.encode(nested);
+    w.writeString(nested.data());
+}
+
+template <typename T>
+void writeField(BinaryWriter& w, const std::vector<T>& items) {
+    w.beginList(items.size());
+    for (const auto& item : items) writeField(w, item);
+}
+
+inline void readField(BinaryReader& r, std::string& value) { value = r.readString(); }
+inline void readField(BinaryReader& r, int& value) { value = static_cast<int>(r.readInt()); }
+inline void readField(BinaryReader& r, bool& value) { value = r.readInt() != 0; }
+
+template <typename T>
+void readField(BinaryReader& r, T& dto) {
+    std::string bytes = r.readString();
+    BinaryReader nested(bytes);
+    dto.decode(nested);
+}
+
+template <typename T>
+void readField(BinaryReader& r, std::vector<T>& items) {
+    size_t count = r.beginList();
+    items.clear();
+    items.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        T item{};
+        readField(r, item);
+        items.push_back(std::move(item));
+    }
+}
+
+template <typename... Fields>
+void writeFields(BinaryWriter& w, const Fields&... fields) {
+    (writeField(w, fields), ...);
+}
+
+template <typename... Fields>
+void readFields(BinaryReader& r, Fields&... fields) {
+    // Fields absent from an older writer keep their current values
+    ((r.atEnd() ? void() : readField(r, fields)), ...);
+}
+
+} // namespace codec
+
+#endif // COMMON_BINARY_CODEC_H
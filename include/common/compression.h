@@ -0,0 +1,35 @@
+#ifndef COMMON_COMPRESSION_H
+#define COMMON_COMPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Payload compression for connections that negotiated it (CODEC_SELECT_REQUEST
+// with "deflate"). A compressed payload is
+//   [4B original length, big-endian][raw deflate stream]
+// where both ends prime the stream with the same preset dictionary of protocol
+// vocabulary (JSON keys, exercise types, levels), so even mid-sized frames
+// compress well.
+namespace compression {
+
+// Smaller payloads (heartbeats, acks, short replies) are sent as is
+constexpr size_t MIN_COMPRESS_SIZE = 256;
+
+// Largest payload inflatePayload() will produce, protocol::MAX_FRAME_SIZE:
+// a compressed frame carries no more than an uncompressed one could
+constexpr size_t MAX_INFLATED_SIZE = 16 * 1024 * 1024;
+
+// Deflate size bytes into out. Returns false, leaving out empty, if the
+// result would not be smaller than the input.
+bool deflatePayload(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+// Inverse of deflatePayload. Throws std::runtime_error on corrupt input, or
+// on a length prefix above MAX_INFLATED_SIZE or beyond what size bytes of
+// deflate stream can expand to. Memory grows with the output actually
+// produced, never ahead of it on the prefix's word.
+std::vector<uint8_t> inflatePayload(const uint8_t* data, size_t size);
+
+} // namespace compression
+
+#endif // COMMON_COMPRESSION_H
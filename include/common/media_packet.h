@@ -0,0 +1,47 @@
+#ifndef COMMON_MEDIA_PACKET_H
+#define COMMON_MEDIA_PACKET_H
+
+#include <cstdint>
+#include <cstddef>
+
+// UDP media datagram layout used by the voice call relay.
+// [4B sessionId][8B token][2B sequence][2B flags][payload...], all big-endian.
+// The token identifies which party of the session sent the packet.
+namespace media {
+
+constexpr size_t HEADER_SIZE = 16;
+constexpr size_t MAX_DATAGRAM_SIZE = 1400; // Stay under typical path MTU
+
+// Keepalive packets only register the sender's address (NAT binding); they are not forwarded
+constexpr uint16_t FLAG_KEEPALIVE = 0x0001;
+
+struct PacketHeader {
+    uint32_t sessionId = 0;
+    uint64_t token = 0;
+    uint16_t sequence = 0;
+    uint16_t flags = 0;
+};
+
+inline void writeHeader(uint8_t* buf, const PacketHeader& h) {
+    for (int i = 0; i < 4; ++i) buf[i] = static_cast<uint8_t>(h.sessionId >> (24 - 8 * i));
+    for (int i = 0; i < 8; ++i) buf[4 + i] = static_cast<uint8_t>(h.token >> (56 - 8 * i));
+    buf[12] = static_cast<uint8_t>(h.sequence >> 8);
+    buf[13] = static_cast<uint8_t>(h.sequence);
+    buf[14] = static_cast<uint8_t>(h.flags >> 8);
+    buf[15] = static_cast<uint8_t>(h.flags);
+}
+
+inline bool readHeader(const uint8_t* buf, size_t len, PacketHeader& h) {
+    if (len < HEADER_SIZE) return false;
+    h.sessionId = 0;
+    for (int i = 0; i < 4; ++i) h.sessionId = (h.sessionId << 8) | buf[i];
+    h.token = 0;
+    for (int i = 0; i < 8; ++i) h.token = (h.token << 8) | buf[4 + i];
+    h.sequence = static_cast<uint16_t>((buf[12] << 8) | buf[13]);
+    h.flags = static_cast<uint16_t>((buf[14] << 8) | buf[15]);
+    return true;
+}
+
+} // namespace media
+
+#endif // COMMON_MEDIA_PACKET_H
@@ -0,0 +1,167 @@
+#ifndef COMMON_PAYLOAD_FIELDS_H
+#define COMMON_PAYLOAD_FIELDS_H
+
+#include "common/binary_codec.h"
+#include "common/utils.h"
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Compile-time field descriptors for Payloads. A DTO lists its members once:
+//
+//   static constexpr auto fields() {
+//       return codec::fields<';'>(&LoginRequest::username, &LoginRequest::password);
+//   }
+//
+// and the text codec (fields joined by the separator) and the binary codec
+// (binary_codec.h) are generated from that list. Everything is resolved at
+// compile time; there are no virtual calls and the loops unroll per DTO.
+//
+// Text rules, matching the legacy hand-written format:
+//   - std::string as is, bool as "1"/"0", int in decimal
+//   - std::vector fields join their items with their own separator
+//     (codec::list); nested DTOs use their own text format per item
+//   - a DTO with a single field is that field verbatim (never split)
+//   - on decode, fields missing from the text keep their current values
+namespace codec {
+
+template <typename Owner, typename T>
+struct Field {
+    T Owner::*member;
+    char itemSeparator;  // Between items of a vector field
+    bool omitWhenEmpty;  // Trailing field dropped from the text (with its separator) when empty
+};
+
+// A vector member with its item separator
+template <typename Owner, typename T>
+constexpr Field<Owner, std::vector<T>> list(std::vector<T> Owner::*member, char itemSeparator,
+                                            bool omitWhenEmpty = false) {
+    return {member, itemSeparator, omitWhenEmpty};
+}
+
+// A string member added after the text format shipped: dropped from the
+// text when empty, so older readers and writers keep the format they know
+template <typename Owner>
+constexpr Field<Owner, std::string> trailing(std::string Owner::*member) { return {member, '\0', true}; }
+
+template <typename Owner, typename T>
+constexpr Field<Owner, T> asField(T Owner::*member) { return {member, '\0', false}; }
+
+template <typename Owner, typename T>
+constexpr Field<Owner, T> asField(Field<Owner, T> field) { return field; }
+
+template <char Separator, typename... Fs>
+struct FieldList {
+    static constexpr char separator = Separator;
+    static constexpr size_t size = sizeof...(Fs);
+    std::tuple<Fs...> fields;
+};
+
+template <char Separator, typename... Ms>
+constexpr auto fields(Ms... members) {
+    using List = FieldList<Separator, decltype(asField(members))...>;
+    return List{std::make_tuple(asField(members)...)};
+}
+
+// --- Text values ---
+
+inline void appendText(std::string& out, const std::string& value, char) { out += value; }
+inline void appendText(std::string& out, bool value, char) { out += value ? '1' : '0'; }
+inline void appendText(std::string& out, int value, char) { out += std::to_string(value); }
+
+template <typename T>
+void appendText(std::string& out, const T& dto, char) { out += dto.serialize(); }
+
+template <typename T>
+void appendText(std::string& out, const std::vector<T>& items, char itemSeparator) {
+    for (size_t i = 0; i < items.size(); ++i) {
+        if (i > 0) out += itemSeparator;
+        appendText(out, items[i], '\0');
+    }
+}
+
+inline void parseText(std::string_view token, std::string& value, char) { value = token; }
+inline void parseText(std::string_view token, bool& value, char) { value = (token == "1"); }
+inline void parseText(std::string_view token, int& value, char) {
+    // Keeps the current value on malformed input
+    std::from_chars(token.data(), token.data() + token.size(), value);
+}
+
+template <typename T>
+void parseText(std::string_view token, T& dto, char) { dto.deserialize(token); }
+
+template <typename T>
+void parseText(std::string_view token, std::vector<T>& items, char itemSeparator) {
+    items.clear();
+    for (std::string_view itemText : utils::splitView(token, itemSeparator)) {
+        T item{};
+        parseText(itemText, item, '\0');
+        items.push_back(std::move(item));
+    }
+}
+
+template <typename T>
+struct IsVector : std::false_type {};
+
+template <typename T>
+struct IsVector<std::vector<T>> : std::true_type {};
+
+template <typename Owner, typename T>
+bool isOmitted(const Owner& dto, const Field<Owner, T>& field) {
+    if constexpr (IsVector<T>::value || std::is_same_v<T, std::string>) {
+        return field.omitWhenEmpty && (dto.*field.member).empty();
+    } else {
+        return false;
+    }
+}
+
+// --- Generated codecs ---
+
+template <typename T>
+std::string toText(const T& dto) {
+    constexpr auto desc = T::fields();
+    std::string out;
+    bool first = true;
+    std::apply([&](const auto&... field) {
+        ((isOmitted(dto, field) ? void() : (
+            (first ? void() : void(out += desc.separator)),
+            first = false,
+            appendText(out, dto.*field.member, field.itemSeparator))), ...);
+    }, desc.fields);
+    return out;
+}
+
+template <typename T>
+void fromText(std::string_view raw, T& dto) {
+    constexpr auto desc = T::fields();
+    if constexpr (desc.size == 1) {
+        const auto& field = std::get<0>(desc.fields);
+        parseText(raw, dto.*field.member, field.itemSeparator);
+    } else {
+        auto parts = utils::splitView(raw, desc.separator);
+        size_t index = 0;
+        std::apply([&](const auto&... field) {
+            ((index < parts.size() ? parseText(parts[index], dto.*field.member, field.itemSeparator) : void(), ++index), ...);
+        }, desc.fields);
+    }
+}
+
+template <typename T>
+void encodeFields(BinaryWriter& w, const T& dto) {
+    constexpr auto desc = T::fields();
+    std::apply([&](const auto&... field) { writeFields(w, dto.*field.member...); }, desc.fields);
+}
+
+template <typename T>
+void decodeFields(BinaryReader& r, T& dto) {
+    constexpr auto desc = T::fields();
+    std::apply([&](const auto&... field) { readFields(r, dto.*field.member...); }, desc.fields);
+}
+
+} // namespace codec
+
+#endif // COMMON_PAYLOAD_FIELDS_H
@@ -1,302 +1,218 @@
 #ifndef COMMON_PAYLOADS_H
 #define COMMON_PAYLOADS_H
 
+#include "common/binary_codec.h"
+#include "common/payload_fields.h"
+#include "common/protocol.h"
 #include "common/utils.h"
 #include <string>
+#include <string_view>
 #include <vector>
 #include <stdexcept>
 
 namespace Payloads {
 
-    // Base Interface
-    struct ISerializable {
-        virtual std::string serialize() const = 0;
-        virtual void deserialize(const std::string& raw) = 0;
-        virtual ~ISerializable() = default;
+    // Base for DTOs: text and binary codecs generated from Derived::fields()
+    // (see common/payload_fields.h)
+    template <typename Derived>
+    struct Serializable {
+        std::string serialize() const {
+            return codec::toText(static_cast<const Derived&>(*this));
+        }
+
+        void deserialize(std::string_view raw) {
+            codec::fromText(raw, static_cast<Derived&>(*this));
+        }
+
+        void encode(codec::BinaryWriter& w) const {
+            codec::encodeFields(w, static_cast<const Derived&>(*this));
+        }
+
+        void decode(codec::BinaryReader& r) {
+            codec::decodeFields(r, static_cast<Derived&>(*this));
+        }
     };
 
     // LoginRequest
-    struct LoginRequest : public ISerializable {
+    struct LoginRequest : public Serializable<LoginRequest> {
         std::string username;
         std::string password;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {username, password};
-            return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) username = parts[0];
-            if (parts.size() >= 2) password = parts[1];
+        static constexpr auto fields() {
+            return codec::fields<';'>(&LoginRequest::username, &LoginRequest::password);
         }
     };
 
     // LessonListRequest
-    struct LessonListRequest : public ISerializable {
+    struct LessonListRequest : public Serializable<LessonListRequest> {
         std::string sessionToken;
         std::string topic;
         std::string level;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {sessionToken, topic, level};
-            return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) topic = parts[1];
-            if (parts.size() >= 3) level = parts[2];
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &LessonListRequest::sessionToken, &LessonListRequest::topic, &LessonListRequest::level);
         }
     };
 
     // SubmitAnswerRequest
-    struct SubmitAnswerRequest : public ISerializable {
+    struct SubmitAnswerRequest : public Serializable<SubmitAnswerRequest> {
         std::string sessionToken;
         std::string targetType;
         std::string targetId;
         std::string answer;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {sessionToken, targetType, targetId, answer};
-            return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) targetType = parts[1];
-            if (parts.size() >= 3) targetId = parts[2];
-            if (parts.size() >= 4) answer = parts[3];
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &SubmitAnswerRequest::sessionToken, &SubmitAnswerRequest::targetType,
+                &SubmitAnswerRequest::targetId, &SubmitAnswerRequest::answer);
         }
     };
 
     // StudyLessonRequest
-    struct StudyLessonRequest : public ISerializable {
+    struct StudyLessonRequest : public Serializable<StudyLessonRequest> {
         std::string sessionToken;
         std::string lessonId;
         std::string lessonType;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {sessionToken, lessonId, lessonType};
-            return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) lessonId = parts[1];
-            if (parts.size() >= 3) lessonType = parts[2];
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &StudyLessonRequest::sessionToken, &StudyLessonRequest::lessonId,
+                &StudyLessonRequest::lessonType);
         }
     };
 
     // PrivateMessageRequest
-    struct PrivateMessageRequest : public ISerializable {
+    struct PrivateMessageRequest : public Serializable<PrivateMessageRequest> {
         std::string sessionToken;
         std::string recipient;
         std::string messageType; // "TEXT" or "AUDIO"
         std::string content;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {sessionToken, recipient, messageType, content};
-            return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) recipient = parts[1];
-            if (parts.size() >= 3) messageType = parts[2];
-            if (parts.size() >= 4) content = parts[3];
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &PrivateMessageRequest::sessionToken, &PrivateMessageRequest::recipient,
+                &PrivateMessageRequest::messageType, &PrivateMessageRequest::content);
         }
     };
 
     // ChatHistoryRequest
-    struct ChatHistoryRequest : public ISerializable {
+    struct ChatHistoryRequest : public Serializable<ChatHistoryRequest> {
         std::string sessionToken;
         std::string otherUser;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {sessionToken, otherUser};
-            return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) otherUser = parts[1];
+        static constexpr auto fields() {
+            return codec::fields<';'>(&ChatHistoryRequest::sessionToken, &ChatHistoryRequest::otherUser);
         }
     };
 
     // ExerciseListRequest
-    struct ExerciseListRequest : public ISerializable {
+    struct ExerciseListRequest : public Serializable<ExerciseListRequest> {
         std::string sessionToken;
         std::string type;
         std::string level;
         std::string lessonId;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {sessionToken, type, level, lessonId};
-            return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) type = parts[1];
-            if (parts.size() >= 3) level = parts[2];
-            if (parts.size() >= 4) lessonId = parts[3];
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &ExerciseListRequest::sessionToken, &ExerciseListRequest::type, &ExerciseListRequest::level,
+                &ExerciseListRequest::lessonId);
         }
     };
 
     // StudyExerciseRequest
-    struct StudyExerciseRequest : public ISerializable {
+    struct StudyExerciseRequest : public Serializable<StudyExerciseRequest> {
         std::string sessionToken;
         std::string exerciseId;
         std::string exerciseType;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {sessionToken, exerciseId, exerciseType};
-            return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) exerciseId = parts[1];
-            if (parts.size() >= 3) exerciseType = parts[2];
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &StudyExerciseRequest::sessionToken, &StudyExerciseRequest::exerciseId,
+                &StudyExerciseRequest::exerciseType);
         }
     };
 
     // SpecificExerciseRequest
-    struct SpecificExerciseRequest : public ISerializable {
+    struct SpecificExerciseRequest : public Serializable<SpecificExerciseRequest> {
         std::string sessionToken;
         std::string exerciseId;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {sessionToken, exerciseId};
-            return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) exerciseId = parts[1];
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &SpecificExerciseRequest::sessionToken, &SpecificExerciseRequest::exerciseId);
         }
     };
 
     // ResultRequest
-    struct ResultRequest : public ISerializable {
+    struct ResultRequest : public Serializable<ResultRequest> {
         std::string sessionToken;
         std::string targetType;
         std::string targetId;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {sessionToken, targetType, targetId};
-            return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) targetType = parts[1];
-            if (parts.size() >= 3) targetId = parts[2];
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &ResultRequest::sessionToken, &ResultRequest::targetType, &ResultRequest::targetId);
         }
     };
 
     // ResultListRequest
-    struct ResultListRequest : public ISerializable {
+    struct ResultListRequest : public Serializable<ResultListRequest> {
         std::string sessionToken;
         std::string targetType;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {sessionToken, targetType};
-            return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) targetType = parts[1];
+        static constexpr auto fields() {
+            return codec::fields<';'>(&ResultListRequest::sessionToken, &ResultListRequest::targetType);
         }
     };
 
     // ExamListRequest
-    struct ExamListRequest : public ISerializable {
+    struct ExamListRequest : public Serializable<ExamListRequest> {
         std::string sessionToken;
         std::string type;
         std::string level;
         std::string lessonId;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {sessionToken, type, level, lessonId};
-            return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) type = parts[1];
-            if (parts.size() >= 3) level = parts[2];
-            if (parts.size() >= 4) lessonId = parts[3];
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &ExamListRequest::sessionToken, &ExamListRequest::type, &ExamListRequest::level,
+                &ExamListRequest::lessonId);
         }
     };
 
-    struct ExamRequest : public ISerializable {
+    struct ExamRequest : public Serializable<ExamRequest> {
         std::string sessionToken;
         std::string examId;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {sessionToken, examId};
-            return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) examId = parts[1];
+        static constexpr auto fields() {
+            return codec::fields<';'>(&ExamRequest::sessionToken, &ExamRequest::examId);
         }
     };
 
     // GenericResponse
-    struct GenericResponse : public ISerializable {
-        bool success;
+    struct GenericResponse : public Serializable<GenericResponse> {
+        bool success = false;
         std::string message;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {success ? "1" : "0", message};
-            return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) success = (parts[0] == "1");
-            if (parts.size() >= 2) message = parts[1];
+        static constexpr auto fields() {
+            return codec::fields<';'>(&GenericResponse::success, &GenericResponse::message);
         }
     };
 
-    struct LessonMetadataDTO : public ISerializable {
+    struct LessonMetadataDTO : public Serializable<LessonMetadataDTO> {
         std::string id;
         std::string title;
         std::string topic;
         std::string level;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {id, title, topic, level};
-            return utils::join(parts, '|');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, '|');
-            if (parts.size() >= 1) id = parts[0];
-            if (parts.size() >= 2) title = parts[1];
-            if (parts.size() >= 3) topic = parts[2];
-            if (parts.size() >= 4) level = parts[3];
+        static constexpr auto fields() {
+            return codec::fields<'|'>(
+                &LessonMetadataDTO::id, &LessonMetadataDTO::title, &LessonMetadataDTO::topic,
+                &LessonMetadataDTO::level);
         }
     };
 
-    struct LessonDTO : public ISerializable {
+    struct LessonDTO : public Serializable<LessonDTO> {
         std::string id;
         std::string title;
         std::string topic;
@@ -307,57 +223,29 @@ namespace Payloads {
         std::vector<std::string> vocabulary;
         std::vector<std::string> grammar;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts;
-            parts.push_back(id);
-            parts.push_back(title);
-            parts.push_back(topic);
-            parts.push_back(level);
-            parts.push_back(videoUrl);
-            parts.push_back(audioUrl);
-            parts.push_back(textContent);
-            parts.push_back(utils::join(vocabulary, ','));
-            parts.push_back(utils::join(grammar, ','));
-            return utils::join(parts, '|');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, '|');
-            if (parts.size() >= 1) id = parts[0];
-            if (parts.size() >= 2) title = parts[1];
-            if (parts.size() >= 3) topic = parts[2];
-            if (parts.size() >= 4) level = parts[3];
-            if (parts.size() >= 5) videoUrl = parts[4];
-            if (parts.size() >= 6) audioUrl = parts[5];
-            if (parts.size() >= 7) textContent = parts[6];
-            if (parts.size() >= 8) vocabulary = utils::split(parts[7], ',');
-            if (parts.size() >= 9) grammar = utils::split(parts[8], ',');
+        static constexpr auto fields() {
+            return codec::fields<'|'>(
+                &LessonDTO::id, &LessonDTO::title, &LessonDTO::topic, &LessonDTO::level, &LessonDTO::videoUrl,
+                &LessonDTO::audioUrl, &LessonDTO::textContent, codec::list(&LessonDTO::vocabulary, ','),
+                codec::list(&LessonDTO::grammar, ','));
         }
     };
 
-    struct ExerciseMetadataDTO : public ISerializable {
+    struct ExerciseMetadataDTO : public Serializable<ExerciseMetadataDTO> {
         std::string id;
         std::string lessonId;
         std::string title;
         std::string type;
         std::string level;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {id, lessonId, title, type, level};
-            return utils::join(parts, '|');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, '|');
-            if (parts.size() >= 1) id = parts[0];
-            if (parts.size() >= 2) lessonId = parts[1];
-            if (parts.size() >= 3) title = parts[2];
-            if (parts.size() >= 4) type = parts[3];
-            if (parts.size() >= 5) level = parts[4];
+        static constexpr auto fields() {
+            return codec::fields<'|'>(
+                &ExerciseMetadataDTO::id, &ExerciseMetadataDTO::lessonId, &ExerciseMetadataDTO::title,
+                &ExerciseMetadataDTO::type, &ExerciseMetadataDTO::level);
         }
     };
 
-    struct ExerciseDTO : public ISerializable {
+    struct ExerciseDTO : public Serializable<ExerciseDTO> {
         std::string id;
         std::string lessonId;
         std::string title;
@@ -365,51 +253,28 @@ namespace Payloads {
         std::string level;
         std::vector<std::string> questions;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts;
-            parts.push_back(id);
-            parts.push_back(lessonId);
-            parts.push_back(title);
-            parts.push_back(type);
-            parts.push_back(level);
-            parts.push_back(utils::join(questions, '^'));
-            return utils::join(parts, '|');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, '|');
-            if (parts.size() >= 1) id = parts[0];
-            if (parts.size() >= 2) lessonId = parts[1];
-            if (parts.size() >= 3) title = parts[2];
-            if (parts.size() >= 4) type = parts[3];
-            if (parts.size() >= 5) level = parts[4];
-            if (parts.size() >= 6) questions = utils::split(parts[5], '^');
+        static constexpr auto fields() {
+            return codec::fields<'|'>(
+                &ExerciseDTO::id, &ExerciseDTO::lessonId, &ExerciseDTO::title, &ExerciseDTO::type,
+                &ExerciseDTO::level, codec::list(&ExerciseDTO::questions, '^'));
         }
     };
 
-    struct ExamMetadataDTO : public ISerializable {
+    struct ExamMetadataDTO : public Serializable<ExamMetadataDTO> {
         std::string id;
         std::string lessonId;
         std::string title;
         std::string type;
         std::string level;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {id, lessonId, title, type, level};
-            return utils::join(parts, '|');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, '|');
-            if (parts.size() >= 1) id = parts[0];
-            if (parts.size() >= 2) lessonId = parts[1];
-            if (parts.size() >= 3) title = parts[2];
-            if (parts.size() >= 4) type = parts[3];
-            if (parts.size() >= 5) level = parts[4];
+        static constexpr auto fields() {
+            return codec::fields<'|'>(
+                &ExamMetadataDTO::id, &ExamMetadataDTO::lessonId, &ExamMetadataDTO::title,
+                &ExamMetadataDTO::type, &ExamMetadataDTO::level);
         }
     };
 
-    struct ExamDTO : public ISerializable {
+    struct ExamDTO : public Serializable<ExamDTO> {
         std::string id;
         std::string lessonId;
         std::string title;
@@ -417,45 +282,23 @@ namespace Payloads {
         std::string level;
         std::vector<std::string> questions;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts;
-            parts.push_back(id);
-            parts.push_back(lessonId);
-            parts.push_back(title);
-            parts.push_back(type);
-            parts.push_back(level);
-            parts.push_back(utils::join(questions, '^'));
-            return utils::join(parts, '|');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, '|');
-            if (parts.size() >= 1) id = parts[0];
-            if (parts.size() >= 2) lessonId = parts[1];
-            if (parts.size() >= 3) title = parts[2];
-            if (parts.size() >= 4) type = parts[3];
-            if (parts.size() >= 5) level = parts[4];
-            if (parts.size() >= 6) questions = utils::split(parts[5], '^');
+        static constexpr auto fields() {
+            return codec::fields<'|'>(
+                &ExamDTO::id, &ExamDTO::lessonId, &ExamDTO::title, &ExamDTO::type, &ExamDTO::level,
+                codec::list(&ExamDTO::questions, '^'));
         }
     };
 
-    struct ResultDTO : public ISerializable {
+    struct ResultDTO : public Serializable<ResultDTO> {
         std::string score;
         std::string feedback;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {score, feedback};
-            return utils::join(parts, '|');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, '|');
-            if (parts.size() >= 1) score = parts[0];
-            if (parts.size() >= 2) feedback = parts[1];
+        static constexpr auto fields() {
+            return codec::fields<'|'>(&ResultDTO::score, &ResultDTO::feedback);
         }
     };
 
-    struct ResultSummaryDTO : public ISerializable {
+    struct ResultSummaryDTO : public Serializable<ResultSummaryDTO> {
         std::string targetId;
         std::string score;
         std::string status;
@@ -463,86 +306,53 @@ namespace Payloads {
         std::string targetType; // Added targetType
         std::string title; // Added title
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {targetId, score, status, feedback, targetType, title};
-            return utils::join(parts, '|');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, '|');
-            if (parts.size() >= 1) targetId = parts[0];
-            if (parts.size() >= 2) score = parts[1];
-            if (parts.size() >= 3) status = parts[2];
-            if (parts.size() >= 4) feedback = parts[3];
-            if (parts.size() >= 5) targetType = parts[4];
-            if (parts.size() >= 6) title = parts[5];
-        }
-    };
-
-    struct PendingSubmissionDTO : public ISerializable {
-        std::string resultId;
-        std::string userName;
-        std::string targetType;
-        std::string targetTitle;
-        std::string submittedAt;
-        std::string userAnswer;
-        std::string targetId;
-        std::string status; // "pending" or "graded"
-
-        std::string serialize() const override {
-            std::vector<std::string> parts = {resultId, userName, targetType, targetTitle, submittedAt, userAnswer, targetId, status};
-            return utils::join(parts, '|');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, '|');
-            if (parts.size() >= 1) resultId = parts[0];
-            if (parts.size() >= 2) userName = parts[1];
-            if (parts.size() >= 3) targetType = parts[2];
-            if (parts.size() >= 4) targetTitle = parts[3];
-            if (parts.size() >= 5) submittedAt = parts[4];
-            if (parts.size() >= 6) userAnswer = parts[5];
-            if (parts.size() >= 7) targetId = parts[6];
-            if (parts.size() >= 8) status = parts[7];
+        static constexpr auto fields() {
+            return codec::fields<'|'>(
+                &ResultSummaryDTO::targetId, &ResultSummaryDTO::score, &ResultSummaryDTO::status,
+                &ResultSummaryDTO::feedback, &ResultSummaryDTO::targetType, &ResultSummaryDTO::title);
         }
     };
 
-    struct PendingSubmissionsRequest : public ISerializable {
+    // Teacher submission review, one page at a time: pending first, then
+    // newest first. Filters left empty match everything.
+    struct PendingSubmissionsRequest : public Serializable<PendingSubmissionsRequest> {
         std::string sessionToken;
+        std::string status;     // "pending" or "graded"
+        std::string targetType; // "exercise", "exam" or "game"
+        std::string targetId;
+        std::string student;    // Username
+        std::string from;       // Submitted at or after this date/time
+        std::string to;         // Submitted before this date/time
+        std::string after;      // submissionCursor() of the previous page's last row
+        std::string limit;      // Page size; the server's default when empty
 
-        std::string serialize() const override {
-            return sessionToken;
-        }
-
-        void deserialize(const std::string& raw) override {
-            sessionToken = raw;
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &PendingSubmissionsRequest::sessionToken, &PendingSubmissionsRequest::status,
+                &PendingSubmissionsRequest::targetType, &PendingSubmissionsRequest::targetId,
+                &PendingSubmissionsRequest::student, &PendingSubmissionsRequest::from,
+                &PendingSubmissionsRequest::to, &PendingSubmissionsRequest::after,
+                &PendingSubmissionsRequest::limit);
         }
     };
 
-    struct GradeSubmissionRequest : public ISerializable {
+    struct GradeSubmissionRequest : public Serializable<GradeSubmissionRequest> {
         std::string sessionToken;
         std::string resultId;
         std::string score;
         std::string feedback;
         std::string gradingDetails;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {sessionToken, resultId, score, feedback, gradingDetails};
-            return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) resultId = parts[1];
-            if (parts.size() >= 3) score = parts[2];
-            if (parts.size() >= 4) feedback = parts[3];
-            if (parts.size() >= 5) gradingDetails = parts[4];
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &GradeSubmissionRequest::sessionToken, &GradeSubmissionRequest::resultId,
+                &GradeSubmissionRequest::score, &GradeSubmissionRequest::feedback,
+                &GradeSubmissionRequest::gradingDetails);
         }
     };
 
     // SubmissionDTO - represents a student submission for teacher review
-    struct SubmissionDTO : public ISerializable {
+    struct SubmissionDTO : public Serializable<SubmissionDTO> {
         std::string resultId;
         std::string studentName;
         std::string targetType;     // "exercise" or "exam"
@@ -553,27 +363,22 @@ namespace Payloads {
         std::string score;
         std::string userAnswer;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {resultId, studentName, targetType, targetTitle, targetId, submittedAt, status, score, userAnswer};
-            return utils::join(parts, '|');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, '|');
-            if (parts.size() >= 1) resultId = parts[0];
-            if (parts.size() >= 2) studentName = parts[1];
-            if (parts.size() >= 3) targetType = parts[2];
-            if (parts.size() >= 4) targetTitle = parts[3];
-            if (parts.size() >= 5) targetId = parts[4];
-            if (parts.size() >= 6) submittedAt = parts[5];
-            if (parts.size() >= 7) status = parts[6];
-            if (parts.size() >= 8) score = parts[7];
-            if (parts.size() >= 9) userAnswer = parts[8];
+        static constexpr auto fields() {
+            return codec::fields<'|'>(
+                &SubmissionDTO::resultId, &SubmissionDTO::studentName, &SubmissionDTO::targetType,
+                &SubmissionDTO::targetTitle, &SubmissionDTO::targetId, &SubmissionDTO::submittedAt,
+                &SubmissionDTO::status, &SubmissionDTO::score, &SubmissionDTO::userAnswer);
         }
     };
 
+    // PendingSubmissionsRequest::after for the page following one that ended
+    // with last: its sort key (status, submission time, id)
+    inline std::string submissionCursor(const SubmissionDTO& last) {
+        return last.status + "," + last.submittedAt + "," + last.resultId;
+    }
+
     // FeedbackDTO - teacher feedback for a submission
-    struct FeedbackDTO : public ISerializable {
+    struct FeedbackDTO : public Serializable<FeedbackDTO> {
         std::string resultId;
         std::string feedbackText;
         std::string feedbackType;   // "text" or "audio"
@@ -581,64 +386,42 @@ namespace Payloads {
         std::string gradedBy;
         std::string gradedAt;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {resultId, feedbackText, feedbackType, audioData, gradedBy, gradedAt};
-            return utils::join(parts, '|');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, '|');
-            if (parts.size() >= 1) resultId = parts[0];
-            if (parts.size() >= 2) feedbackText = parts[1];
-            if (parts.size() >= 3) feedbackType = parts[2];
-            if (parts.size() >= 4) audioData = parts[3];
-            if (parts.size() >= 5) gradedBy = parts[4];
-            if (parts.size() >= 6) gradedAt = parts[5];
+        static constexpr auto fields() {
+            return codec::fields<'|'>(
+                &FeedbackDTO::resultId, &FeedbackDTO::feedbackText, &FeedbackDTO::feedbackType,
+                &FeedbackDTO::audioData, &FeedbackDTO::gradedBy, &FeedbackDTO::gradedAt);
         }
     };
 
     // AddFeedbackRequest - request to add feedback to a submission
-    struct AddFeedbackRequest : public ISerializable {
+    struct AddFeedbackRequest : public Serializable<AddFeedbackRequest> {
         std::string sessionToken;
         std::string resultId;
         std::string feedbackText;
         std::string feedbackType;   // "text" or "audio"
         std::string audioData;      // Base64 if audio
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {sessionToken, resultId, feedbackText, feedbackType, audioData};
-            return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) resultId = parts[1];
-            if (parts.size() >= 3) feedbackText = parts[2];
-            if (parts.size() >= 4) feedbackType = parts[3];
-            if (parts.size() >= 5) audioData = parts[4];
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &AddFeedbackRequest::sessionToken, &AddFeedbackRequest::resultId,
+                &AddFeedbackRequest::feedbackText, &AddFeedbackRequest::feedbackType,
+                &AddFeedbackRequest::audioData);
         }
     };
 
-    struct ResultDetailRequest : public ISerializable {
+    struct ResultDetailRequest : public Serializable<ResultDetailRequest> {
         std::string sessionToken;
         std::string targetType;
         std::string targetId;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {sessionToken, targetType, targetId};
-            return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) targetType = parts[1];
-            if (parts.size() >= 3) targetId = parts[2];
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &ResultDetailRequest::sessionToken, &ResultDetailRequest::targetType,
+                &ResultDetailRequest::targetId);
         }
     };
 
-    struct QuestionResultDTO : public ISerializable {
+    struct QuestionResultDTO : public Serializable<QuestionResultDTO> {
         std::string questionText;
         std::string userAnswer;
         std::string correctAnswer;
@@ -646,23 +429,15 @@ namespace Payloads {
         std::string score;
         std::string comment;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {questionText, userAnswer, correctAnswer, status, score, comment};
-            return utils::join(parts, '^');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, '^');
-            if (parts.size() >= 1) questionText = parts[0];
-            if (parts.size() >= 2) userAnswer = parts[1];
-            if (parts.size() >= 3) correctAnswer = parts[2];
-            if (parts.size() >= 4) status = parts[3];
-            if (parts.size() >= 5) score = parts[4];
-            if (parts.size() >= 6) comment = parts[5];
+        static constexpr auto fields() {
+            return codec::fields<'^'>(
+                &QuestionResultDTO::questionText, &QuestionResultDTO::userAnswer,
+                &QuestionResultDTO::correctAnswer, &QuestionResultDTO::status, &QuestionResultDTO::score,
+                &QuestionResultDTO::comment);
         }
     };
 
-    struct ResultDetailDTO : public ISerializable {
+    struct ResultDetailDTO : public Serializable<ResultDetailDTO> {
         std::string targetId;
         std::string targetType;
         std::string title;
@@ -670,355 +445,459 @@ namespace Payloads {
         std::string feedback;
         std::vector<QuestionResultDTO> questions;
 
-        std::string serialize() const override {
-            std::string base = utils::join({targetId, targetType, title, score, feedback}, '|');
-            std::vector<std::string> qParts;
-            for (const auto& q : questions) {
-                qParts.push_back(q.serialize());
-            }
-            if (!qParts.empty()) {
-                base += "|" + utils::join(qParts, '~');
-            }
-            return base;
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, '|');
-            if (parts.size() >= 1) targetId = parts[0];
-            if (parts.size() >= 2) targetType = parts[1];
-            if (parts.size() >= 3) title = parts[2];
-            if (parts.size() >= 4) score = parts[3];
-            if (parts.size() >= 5) feedback = parts[4];
-            
-            if (parts.size() >= 6) {
-                std::string qStr = parts[5];
-                auto qList = utils::split(qStr, '~');
-                for (const auto& qRaw : qList) {
-                    QuestionResultDTO q;
-                    q.deserialize(qRaw);
-                    questions.push_back(q);
-                }
-            }
+        static constexpr auto fields() {
+            return codec::fields<'|'>(
+                &ResultDetailDTO::targetId, &ResultDetailDTO::targetType, &ResultDetailDTO::title,
+                &ResultDetailDTO::score, &ResultDetailDTO::feedback,
+                codec::list(&ResultDetailDTO::questions, '~', true));
         }
     };
 
-    struct ChatMessageDTO : public ISerializable {
+    // sender;messageType;content;timestamp[;messageId]
+    // messageId is set on CHAT_PRIVATE_RECEIVE only, for the client's
+    // CHAT_RECEIVE_ACK; history entries leave it out.
+    struct ChatMessageDTO : public Serializable<ChatMessageDTO> {
         std::string sender;
         std::string messageType;
         std::string content;
         std::string timestamp;
+        std::string messageId;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {sender, messageType, content, timestamp};
-            return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sender = parts[0];
-            if (parts.size() >= 2) messageType = parts[1];
-            if (parts.size() >= 3) content = parts[2];
-            if (parts.size() >= 4) timestamp = parts[3];
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &ChatMessageDTO::sender, &ChatMessageDTO::messageType, &ChatMessageDTO::content,
+                &ChatMessageDTO::timestamp, codec::trailing(&ChatMessageDTO::messageId));
         }
     };
 
-    struct ChatHistoryDTO {
+    struct ChatHistoryDTO : public Serializable<ChatHistoryDTO> {
         std::vector<ChatMessageDTO> messages;
 
-        std::string serialize() const {
-            std::string result;
-            for (size_t i = 0; i < messages.size(); ++i) {
-                result += messages[i].serialize();
-                if (i < messages.size() - 1) result += "|";
-            }
-            return result;
-        }
-
-        void deserialize(const std::string& data) {
-            messages.clear();
-            std::stringstream ss(data);
-            std::string segment;
-            while (std::getline(ss, segment, '|')) {
-                ChatMessageDTO msg;
-                msg.deserialize(segment);
-                messages.push_back(msg);
-            }
+        static constexpr auto fields() {
+            return codec::fields<'|'>(codec::list(&ChatHistoryDTO::messages, '|'));
         }
     };
 
-    struct RecentChatsRequest {
+    struct RecentChatsRequest : public Serializable<RecentChatsRequest> {
         std::string sessionToken;
 
-        std::string serialize() const {
-            return sessionToken;
-        }
-
-        void deserialize(const std::string& data) {
-            sessionToken = data;
+        static constexpr auto fields() {
+            return codec::fields<';'>(&RecentChatsRequest::sessionToken);
         }
     };
 
-    struct RecentChatDTO {
-        int userId;
+    struct RecentChatDTO : public Serializable<RecentChatDTO> {
+        int userId = 0;
         std::string username;
         std::string lastMessage;
         std::string timestamp;
 
-        std::string serialize() const {
-            return std::to_string(userId) + ";" + username + ";" + lastMessage + ";" + timestamp;
-        }
-
-        void deserialize(const std::string& data) {
-            std::stringstream ss(data);
-            std::string segment;
-            std::getline(ss, segment, ';'); userId = std::stoi(segment);
-            std::getline(ss, username, ';');
-            std::getline(ss, lastMessage, ';');
-            std::getline(ss, timestamp, ';');
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &RecentChatDTO::userId, &RecentChatDTO::username, &RecentChatDTO::lastMessage,
+                &RecentChatDTO::timestamp);
         }
     };
 
-    struct RecentChatsDTO {
+    struct RecentChatsDTO : public Serializable<RecentChatsDTO> {
         std::vector<RecentChatDTO> chats;
 
-        std::string serialize() const {
-            std::string result;
-            for (size_t i = 0; i < chats.size(); ++i) {
-                result += chats[i].serialize();
-                if (i < chats.size() - 1) result += "|";
-            }
-            return result;
-        }
-
-        void deserialize(const std::string& data) {
-            chats.clear();
-            std::stringstream ss(data);
-            std::string segment;
-            while (std::getline(ss, segment, '|')) {
-                RecentChatDTO chat;
-                chat.deserialize(segment);
-                chats.push_back(chat);
-            }
+        static constexpr auto fields() {
+            return codec::fields<'|'>(codec::list(&RecentChatsDTO::chats, '|'));
         }
     };
 
     // --- Game Payloads ---
 
     // GameListRequest
-    struct GameListRequest : public ISerializable {
+    struct GameListRequest : public Serializable<GameListRequest> {
         std::string sessionToken;
 
-        std::string serialize() const override {
-            return sessionToken;
-        }
-
-        void deserialize(const std::string& raw) override {
-            sessionToken = raw;
+        static constexpr auto fields() {
+            return codec::fields<';'>(&GameListRequest::sessionToken);
         }
     };
 
-    struct GameMetadataDTO : public ISerializable {
+    struct GameMetadataDTO : public Serializable<GameMetadataDTO> {
         std::string type; // "sentence_match", "picture_match", etc
         std::string description;
 
-        std::string serialize() const override {
-             std::vector<std::string> parts = {type, description};
-             return utils::join(parts, '|');
-        }
-
-       void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, '|');
-            if (parts.size() >= 1) type = parts[0];
-            if (parts.size() >= 2) description = parts[1];
+        static constexpr auto fields() {
+            return codec::fields<'|'>(&GameMetadataDTO::type, &GameMetadataDTO::description);
         }
     };
 
     // GameLevelListRequest
-    struct GameLevelListRequest : public ISerializable {
+    struct GameLevelListRequest : public Serializable<GameLevelListRequest> {
         std::string sessionToken;
         std::string gameType; // e.g., "sentence_match"
 
-        std::string serialize() const override {
-             std::vector<std::string> parts = {sessionToken, gameType};
-             return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) gameType = parts[1];
+        static constexpr auto fields() {
+            return codec::fields<';'>(&GameLevelListRequest::sessionToken, &GameLevelListRequest::gameType);
         }
     };
 
-    struct GameLevelDTO : public ISerializable {
+    struct GameLevelDTO : public Serializable<GameLevelDTO> {
         std::string id;
         std::string level; // "beginner", etc.
         std::string status; // "locked", "unlocked", "completed"
 
-        std::string serialize() const override {
-             std::vector<std::string> parts = {id, level, status};
-             return utils::join(parts, '|');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, '|');
-            if (parts.size() >= 1) id = parts[0];
-            if (parts.size() >= 2) level = parts[1];
-            if (parts.size() >= 3) status = parts[2];
+        static constexpr auto fields() {
+            return codec::fields<'|'>(&GameLevelDTO::id, &GameLevelDTO::level, &GameLevelDTO::status);
         }
     };
 
     // GameDataRequest
-    struct GameDataRequest : public ISerializable {
+    struct GameDataRequest : public Serializable<GameDataRequest> {
         std::string sessionToken;
         std::string gameId;
 
-        std::string serialize() const override {
-             std::vector<std::string> parts = {sessionToken, gameId};
-             return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) gameId = parts[1];
+        static constexpr auto fields() {
+            return codec::fields<';'>(&GameDataRequest::sessionToken, &GameDataRequest::gameId);
         }
     };
 
-    struct GameDataDTO : public ISerializable {
+    struct GameDataDTO : public Serializable<GameDataDTO> {
         std::string id;
         std::string type;
         std::string level;
         std::string questionJson; // The raw JSON content
 
-        std::string serialize() const override {
-             std::vector<std::string> parts = {id, type, level, questionJson};
-             return utils::join(parts, '|');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, '|');
-            if (parts.size() >= 1) id = parts[0];
-            if (parts.size() >= 2) type = parts[1];
-            if (parts.size() >= 3) level = parts[2];
-            if (parts.size() >= 4) questionJson = parts[3];
+        static constexpr auto fields() {
+            return codec::fields<'|'>(
+                &GameDataDTO::id, &GameDataDTO::type, &GameDataDTO::level, &GameDataDTO::questionJson);
         }
     };
 
     // GameSubmitRequest
-    struct GameSubmitRequest : public ISerializable {
+    struct GameSubmitRequest : public Serializable<GameSubmitRequest> {
         std::string sessionToken;
         std::string gameId;
         std::string score;
         std::string detailsJson; // How they played, what they matched
 
-         std::string serialize() const override {
-             std::vector<std::string> parts = {sessionToken, gameId, score, detailsJson};
-             return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) gameId = parts[1];
-            if (parts.size() >= 3) score = parts[2];
-            if (parts.size() >= 4) detailsJson = parts[3];
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &GameSubmitRequest::sessionToken, &GameSubmitRequest::gameId, &GameSubmitRequest::score,
+                &GameSubmitRequest::detailsJson);
         }
     };
 
     // Game Management Payloads (Admin)
-    struct GameCreateRequest : public ISerializable {
+    struct GameCreateRequest : public Serializable<GameCreateRequest> {
         std::string sessionToken;
         std::string type;
         std::string level;
         std::string questionJson;
 
-        std::string serialize() const override {
-             std::vector<std::string> parts = {sessionToken, type, level, questionJson};
-             return utils::join(parts, '|');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, '|');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) type = parts[1];
-            if (parts.size() >= 3) level = parts[2];
-            if (parts.size() >= 4) questionJson = parts[3];
+        static constexpr auto fields() {
+            return codec::fields<'|'>(
+                &GameCreateRequest::sessionToken, &GameCreateRequest::type, &GameCreateRequest::level,
+                &GameCreateRequest::questionJson);
         }
     };
 
-    struct GameDeleteRequest : public ISerializable {
+    struct GameDeleteRequest : public Serializable<GameDeleteRequest> {
         std::string sessionToken;
         std::string gameId;
 
-        std::string serialize() const override {
-             std::vector<std::string> parts = {sessionToken, gameId};
-             return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) gameId = parts[1];
+        static constexpr auto fields() {
+            return codec::fields<';'>(&GameDeleteRequest::sessionToken, &GameDeleteRequest::gameId);
         }
     };
 
-    struct GameUpdateRequest : public ISerializable {
+    struct GameUpdateRequest : public Serializable<GameUpdateRequest> {
         std::string sessionToken;
         std::string gameId;
         std::string type;
         std::string level;
         std::string questionJson;
 
-        std::string serialize() const override {
-             std::vector<std::string> parts = {sessionToken, gameId, type, level, questionJson};
-             return utils::join(parts, '|');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, '|');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) gameId = parts[1];
-            if (parts.size() >= 3) type = parts[2];
-            if (parts.size() >= 4) level = parts[3];
-            if (parts.size() >= 5) questionJson = parts[4];
+        static constexpr auto fields() {
+            return codec::fields<'|'>(
+                &GameUpdateRequest::sessionToken, &GameUpdateRequest::gameId, &GameUpdateRequest::type,
+                &GameUpdateRequest::level, &GameUpdateRequest::questionJson);
         }
     };
 
 
     // Voice Call Payloads
-    struct VoiceCallRequest : public ISerializable {
+    struct VoiceCallRequest : public Serializable<VoiceCallRequest> {
         std::string sessionToken;
         std::string targetUser;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {sessionToken, targetUser};
-            return utils::join(parts, ';');
-        }
-
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) sessionToken = parts[0];
-            if (parts.size() >= 2) targetUser = parts[1];
+        static constexpr auto fields() {
+            return codec::fields<';'>(&VoiceCallRequest::sessionToken, &VoiceCallRequest::targetUser);
         }
     };
 
-    struct VoiceCallNotification : public ISerializable {
+    struct VoiceCallNotification : public Serializable<VoiceCallNotification> {
         std::string callerUsername;
         std::string callerId;
 
-        std::string serialize() const override {
-            std::vector<std::string> parts = {callerUsername, callerId};
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &VoiceCallNotification::callerUsername, &VoiceCallNotification::callerId);
+        }
+    };
+
+    // CHAT_READ_ACK: sessionToken;otherUser
+    // Marks every message from otherUser to the sender as read.
+    struct ChatReadAck : public Serializable<ChatReadAck> {
+        std::string sessionToken;
+        std::string otherUser;
+
+        static constexpr auto fields() {
+            return codec::fields<';'>(&ChatReadAck::sessionToken, &ChatReadAck::otherUser);
+        }
+    };
+
+    // UNREAD_DIGEST item: messageId;sender;messageType;content;timestamp
+    // Notifications use messageType "NOTIFICATION" and messageId "n<id>".
+    struct UnreadItemDTO : public Serializable<UnreadItemDTO> {
+        std::string messageId;
+        std::string sender;
+        std::string messageType;
+        std::string content;
+        std::string timestamp;
+
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &UnreadItemDTO::messageId, &UnreadItemDTO::sender, &UnreadItemDTO::messageType,
+                &UnreadItemDTO::content, &UnreadItemDTO::timestamp);
+        }
+    };
+
+    // UNREAD_DIGEST: item|item|... (oldest first)
+    struct UnreadDigestDTO : public Serializable<UnreadDigestDTO> {
+        std::vector<UnreadItemDTO> items;
+
+        static constexpr auto fields() {
+            return codec::fields<'|'>(codec::list(&UnreadDigestDTO::items, '|'));
+        }
+    };
+
+    // UNREAD_DIGEST_ACK / CHAT_RECEIVE_ACK: sessionToken;messageId,messageId,...
+    // Sent once a digest frame or a live message has been processed. Lists
+    // every item id, notifications ("n<id>") included.
+    struct DeliveryAck : public Serializable<DeliveryAck> {
+        std::string sessionToken;
+        std::vector<std::string> messageIds;
+
+        static constexpr auto fields() {
+            return codec::fields<';'>(&DeliveryAck::sessionToken, codec::list(&DeliveryAck::messageIds, ','));
+        }
+    };
+
+    // CALL_MEDIA_READY: peerUsername;relayPort;sessionId;token
+    // Audio is sent as UDP datagrams to the server host on relayPort (see common/media_packet.h).
+    struct CallMediaInfo : public Serializable<CallMediaInfo> {
+        std::string peerUsername;
+        std::string relayPort;
+        std::string sessionId;
+        std::string token;
+
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &CallMediaInfo::peerUsername, &CallMediaInfo::relayPort, &CallMediaInfo::sessionId,
+                &CallMediaInfo::token);
+        }
+    };
+
+    // Blob Transfer Payloads
+    // Chunk data is Base64 so it never collides with the ';' delimiter.
+
+    // BLOB_UPLOAD_CHUNK: sessionToken;uploadId;offset;totalSize;data
+    struct BlobUploadChunk : public Serializable<BlobUploadChunk> {
+        std::string sessionToken;
+        std::string uploadId;
+        std::string offset;
+        std::string totalSize;
+        std::string data;
+
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &BlobUploadChunk::sessionToken, &BlobUploadChunk::uploadId, &BlobUploadChunk::offset,
+                &BlobUploadChunk::totalSize, &BlobUploadChunk::data);
+        }
+    };
+
+    // BLOB_UPLOAD_SUCCESS / BLOB_UPLOAD_FAILURE: uploadId;hash;message
+    struct BlobUploadResult : public Serializable<BlobUploadResult> {
+        std::string uploadId;
+        std::string hash;
+        std::string message;
+
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &BlobUploadResult::uploadId, &BlobUploadResult::hash, &BlobUploadResult::message);
+        }
+    };
+
+    // BLOB_DOWNLOAD_REQUEST: sessionToken;hash;offset;accept
+    // Downloads are pulled one chunk per request so a slow reader never
+    // overruns the server's non-blocking socket. `accept` lists the encodings
+    // the client can decode (comma separated, e.g. "adpcm").
+    struct BlobDownloadRequest : public Serializable<BlobDownloadRequest> {
+        std::string sessionToken;
+        std::string hash;
+        std::string offset;
+        std::string accept;
+
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &BlobDownloadRequest::sessionToken, &BlobDownloadRequest::hash, &BlobDownloadRequest::offset,
+                &BlobDownloadRequest::accept);
+        }
+    };
+
+    // BLOB_DOWNLOAD_FAILURE: hash;message
+    struct BlobDownloadFailure : public Serializable<BlobDownloadFailure> {
+        std::string hash;
+        std::string message;
+
+        static constexpr auto fields() {
+            return codec::fields<';'>(&BlobDownloadFailure::hash, &BlobDownloadFailure::message);
+        }
+    };
+
+    // BLOB_DOWNLOAD_CHUNK: hash;offset;totalSize;encoding;data
+    // offset/totalSize refer to the bytes as served in `encoding` (empty = original).
+    struct BlobChunkDTO : public Serializable<BlobChunkDTO> {
+        std::string hash;
+        std::string offset;
+        std::string totalSize;
+        std::string encoding;
+        std::string data;
+
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &BlobChunkDTO::hash, &BlobChunkDTO::offset, &BlobChunkDTO::totalSize, &BlobChunkDTO::encoding,
+                &BlobChunkDTO::data);
+        }
+    };
+
+    // HELLO / HELLO_ACK: version;maxFrameSize;codecs;compression;features;maxBlobSize
+    // List fields are comma separated. In HELLO, codecs are in order of
+    // preference and maxFrameSize is the largest frame the client accepts.
+    // In HELLO_ACK each list holds what was agreed, maxFrameSize is the
+    // largest frame the server accepts, and maxBlobSize its attachment limit.
+    struct HelloDTO : public Serializable<HelloDTO> {
+        int version = 0;
+        int maxFrameSize = 0;
+        std::vector<std::string> codecs;      // "binary", "text"
+        std::vector<std::string> compression; // "deflate"
+        std::vector<std::string> features;    // protocol::feature names
+        int maxBlobSize = 0;
+
+        static constexpr auto fields() {
+            return codec::fields<';'>(
+                &HelloDTO::version, &HelloDTO::maxFrameSize, codec::list(&HelloDTO::codecs, ','),
+                codec::list(&HelloDTO::compression, ','), codec::list(&HelloDTO::features, ','),
+                &HelloDTO::maxBlobSize);
+        }
+
+        static bool contains(const std::vector<std::string>& list, std::string_view name) {
+            for (const auto& item : list) {
+                if (item == name) return true;
+            }
+            return false;
+        }
+    };
+
+    // Item lists sent as "count;item;item" (lesson, exercise, exam and result
+    // lists) or, with WithCount = false, "item;item" (game lists).
+    template <typename T, bool WithCount = true>
+    struct ListDTO {
+        std::vector<T> items;
+
+        std::string serialize() const {
+            std::vector<std::string> parts;
+            parts.reserve(items.size() + 1);
+            if (WithCount) parts.push_back(std::to_string(items.size()));
+            for (const auto& item : items) parts.push_back(item.serialize());
             return utils::join(parts, ';');
         }
 
-        void deserialize(const std::string& raw) override {
-            auto parts = utils::split(raw, ';');
-            if (parts.size() >= 1) callerUsername = parts[0];
-            if (parts.size() >= 2) callerId = parts[1];
+        void deserialize(std::string_view raw) {
+            items.clear();
+            auto parts = utils::splitView(raw, ';');
+            for (size_t i = WithCount ? 1 : 0; i < parts.size(); ++i) {
+                T item;
+                item.deserialize(parts[i]);
+                items.push_back(item);
+            }
+        }
+
+        void encode(codec::BinaryWriter& w) const {
+            codec::writeFields(w, items);
+        }
+
+        void decode(codec::BinaryReader& r) {
+            codec::readFields(r, items);
         }
     };
 
+    // ListDTO<T, WithCount> encoded one item at a time, for responses built
+    // incrementally (server/response_stream.h). header() followed by item()
+    // for each element gives the same bytes as serialize() / encode().
+    template <typename T, bool WithCount = true>
+    class ListDTOWriter {
+    private:
+        bool binary;
+        bool first = true;
+
+    public:
+        explicit ListDTOWriter(bool binary) : binary(binary) {}
+
+        std::string header(size_t count) const {
+            if (binary) {
+                codec::BinaryWriter w;
+                w.beginList(count);
+                return w.release();
+            }
+            return WithCount ? std::to_string(count) : std::string();
+        }
+
+        std::string item(const T& value) {
+            if (binary) {
+                first = false;
+                codec::BinaryWriter w;
+                codec::writeField(w, value);
+                return w.release();
+            }
+            std::string text = (WithCount || !first) ? ";" : "";
+            first = false;
+            return text + value.serialize();
+        }
+
+        // True until the first item() call
+        bool isFirst() const { return first; }
+    };
+
+    // Parse a payload in whichever codec its frame carries
+    template <typename T>
+    void decode(const protocol::Message& msg, T& dto) {
+        if (msg.binary) {
+            codec::BinaryReader reader(msg.payload(), msg.payloadSize());
+            dto.decode(reader);
+        } else {
+            dto.deserialize(msg.view());
+        }
+    }
+
+    // Build a frame for dto in the binary codec or the legacy text format
+    template <typename T>
+    protocol::Message encode(protocol::MsgCode code, const T& dto, bool binary) {
+        if (!binary) return protocol::Message(code, dto.serialize());
+
+        codec::BinaryWriter writer;
+        dto.encode(writer);
+        protocol::Message msg(code, writer.release());
+        msg.binary = true;
+        return msg;
+    }
+
 } // namespace Payloads
 
 #endif // COMMON_PAYLOADS_H
@@ -4,10 +4,14 @@
 #include <cstdint>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <optional>
 #include <cstring>
 #include <stdexcept>
 #include <arpa/inet.h>
 
+#include "common/compression.h"
+
 namespace protocol {
 
 // Message codes for client-server communication
@@ -150,92 +154,340 @@ enum class MsgCode : uint16_t {
     CALL_ENDED = 315,
     CALL_BUSY = 316,
     CALL_FAILED = 317,
+    CALL_MEDIA_READY = 318, // Relay session details pushed to both parties on answer
+
+    // Blob Transfer (330-339)
+    // Large chat attachments (voice notes) travel out-of-band in chunks;
+    // chat rows only carry a "blob:<sha256>" reference.
+    BLOB_UPLOAD_CHUNK = 330,
+    BLOB_UPLOAD_SUCCESS = 331,
+    BLOB_UPLOAD_FAILURE = 332,
+    BLOB_DOWNLOAD_REQUEST = 333,
+    BLOB_DOWNLOAD_CHUNK = 334,
+    BLOB_DOWNLOAD_FAILURE = 335,
+
+    // Offline Delivery (340-349)
+    // Messages and notifications that arrived while a user was offline are
+    // pushed right after LOGIN_SUCCESS, split into digest frames that fit the
+    // client's frame limit. Messages, live or in a digest, stay undelivered
+    // until the client acks them.
+    UNREAD_DIGEST = 340,
+    CHAT_READ_ACK = 341, // Fire-and-forget; no response
+    UNREAD_DIGEST_ACK = 342, // Fire-and-forget; no response
+    CHAT_RECEIVE_ACK = 343, // Ack of CHAT_PRIVATE_RECEIVE; fire-and-forget
 
     // Heartbeat and Disconnect (900-909)
     HEARTBEAT = 900,
     DISCONNECT_REQUEST = 901,
     DISCONNECT_ACK = 902,
+    CODEC_SELECT_REQUEST = 903, // Payload: "binary" or "text", then ",deflate" / ",chunked" options; allowed before login
+    CODEC_SELECT_SUCCESS = 904, // Payload: the codec and options now in effect
+    BATCH_REQUEST = 905,        // Payload: concatenated request frames, run in order
+    BATCH_RESPONSE = 906,       // Payload: concatenated reply frames, one or more per sub-request
+    NOT_MODIFIED = 907,         // Empty; the client's cached response (same content version) is current
+    HELLO = 908,                // Payload: Payloads::HelloDTO, the client's capabilities; allowed before login
+    HELLO_ACK = 909,            // Payload: Payloads::HelloDTO, what is now in effect plus the server's limits
+
+    // Chunked Responses (910-919)
+    // A large response sent as START, any number of CHUNKs and END instead of
+    // one frame, to connections that negotiated "chunked". Concatenating the
+    // chunks gives exactly the payload the single frame would have carried.
+    STREAM_START = 910, // Payload: [4B stream id][2B response code, with BINARY_PAYLOAD_FLAG if binary]
+    STREAM_CHUNK = 911, // Payload: [4B stream id][next bytes of the response payload]
+    STREAM_END = 912,   // Payload: [4B stream id][1B status: 0 = complete, 1 = aborted]
 
     // General Errors (990-999)
     GENERAL_FAILURE = 990,
     UNKNOWN_COMMAND_FAILURE = 991
 };
 
+// High bit of the code field marks a payload in the binary codec
+// (common/binary_codec.h) instead of the delimited text format.
+constexpr uint16_t BINARY_PAYLOAD_FLAG = 0x8000;
+
+// v2 frame: a 4-byte correlation id follows the code field. Clients that set
+// it get it echoed on the matching response, so several requests can be in
+// flight and answered in any order. Frames without it (legacy clients, server
+// pushes) keep the v1 layout.
+constexpr uint16_t CORRELATION_ID_FLAG = 0x4000;
+
+// The payload is deflated (common/compression.h). Only sent to peers that
+// negotiated "deflate", and only for payloads of at least
+// compression::MIN_COMPRESS_SIZE bytes. Receivers inflate transparently.
+constexpr uint16_t COMPRESSED_PAYLOAD_FLAG = 0x2000;
+// An 8-byte content version follows the correlation id (if any). On a
+// catalog request it is the version the client has cached (0 = none), which
+// opts in to NOT_MODIFIED; on the response it is the version of the content.
+constexpr uint16_t CONTENT_VERSION_FLAG = 0x1000;
+constexpr uint16_t FRAME_FLAGS_MASK =
+    BINARY_PAYLOAD_FLAG | CORRELATION_ID_FLAG | COMPRESSED_PAYLOAD_FLAG | CONTENT_VERSION_FLAG;
+
+// Version exchanged in HELLO. Bumped only for changes that cannot be
+// negotiated as a feature of their own.
+constexpr int PROTOCOL_VERSION = 1;
+
+// Largest frame (length prefix included) a peer accepts unless its HELLO
+// says otherwise. The server closes connections that send a bigger one.
+constexpr uint32_t MAX_FRAME_SIZE = 16 * 1024 * 1024;
+// Lowest limit a HELLO may advertise; stream and blob chunks must still fit
+constexpr uint32_t MIN_FRAME_SIZE = 128 * 1024;
+// Largest response a client reassembles from STREAM_* chunks
+constexpr size_t MAX_STREAMED_SIZE = 64 * 1024 * 1024;
+
+static_assert(compression::MAX_INFLATED_SIZE == MAX_FRAME_SIZE,
+              "a compressed payload must not inflate past the frame limit");
+
+// Optional features named in HELLO / HELLO_ACK
+namespace feature {
+constexpr std::string_view CORRELATION_ID = "correlation_id";   // v2 frames
+constexpr std::string_view CONTENT_VERSION = "content_version"; // Conditional fetch, NOT_MODIFIED
+constexpr std::string_view BATCH = "batch";                     // BATCH_REQUEST
+constexpr std::string_view CHUNKED = "chunked";                 // STREAM_* responses
+} // namespace feature
+
+// What a connection negotiated with HELLO (or the older CODEC_SELECT_REQUEST).
+// The defaults are what a client that never negotiated gets.
+struct Capabilities {
+    int version = 0; // 0 = no HELLO
+    uint32_t maxFrameSize = MAX_FRAME_SIZE;
+    bool binaryPayloads = false;
+    bool compression = false;
+    bool correlationIds = false;
+    bool contentVersions = false;
+    bool batch = false;
+    bool chunkedResponses = false;
+};
+
 // Message structure for network communication
 struct Message {
     MsgCode code;
     std::vector<uint8_t> data;
+    bool binary = false; // Payload encoding, carried in BINARY_PAYLOAD_FLAG
+    uint32_t correlationId = 0; // 0 = none (v1 frame), otherwise sent in a v2 frame
+    bool compress = false; // serialize() deflates the payload if it is large enough
+    std::optional<uint64_t> contentVersion; // Sent with CONTENT_VERSION_FLAG when set
+
+    // Set by deserializeView(): the payload is these bytes inside the
+    // caller's receive buffer rather than data. Read it through payload().
+    const uint8_t* borrowed = nullptr;
+    size_t borrowedSize = 0;
 
     Message() = default;
     Message(MsgCode c, const std::vector<uint8_t>& d) : code(c), data(d) {}
     Message(MsgCode c, const std::string& s)
         : code(c), data(s.begin(), s.end()) {}
 
+    // The payload bytes, owned (data) or borrowed
+    const uint8_t* payload() const { return borrowed ? borrowed : data.data(); }
+    size_t payloadSize() const { return borrowed ? borrowedSize : data.size(); }
+
     // Convert data to string
     std::string toString() const {
-        return std::string(data.begin(), data.end());
+        return std::string(view());
     }
 
-    // Serialize: [4 bytes length][2 bytes code][payload bytes...]
+    // Payload as text without copying; valid while this Message (and, for a
+    // view, the buffer it came from) is alive and unmodified
+    std::string_view view() const {
+        return std::string_view(reinterpret_cast<const char*>(payload()), payloadSize());
+    }
+
+    // Serialize: [4 bytes length][2 bytes code][4 bytes correlation id, v2 only]
+    //            [8 bytes content version, if set][payload bytes...]
     // Length includes the 4 bytes of length field itself.
     std::vector<uint8_t> serialize() const {
+        return serialize(correlationId, compress);
+    }
+
+    // Same, with the frame's correlation id and compression chosen by the
+    // caller (replies stamp the request's id without copying the payload)
+    std::vector<uint8_t> serialize(uint32_t frameCorrelationId, bool compressPayload) const {
+        std::vector<uint8_t> deflated;
+        bool compressed = compressPayload && payloadSize() >= compression::MIN_COMPRESS_SIZE &&
+                          compression::deflatePayload(payload(), payloadSize(), deflated);
+        const uint8_t* body = compressed ? deflated.data() : payload();
+        size_t bodySize = compressed ? deflated.size() : payloadSize();
+
         std::vector<uint8_t> packet;
-        uint32_t total_len = 4 + 2 + data.size();
+        uint32_t total_len = 4 + 2 + (frameCorrelationId != 0 ? 4 : 0) + (contentVersion ? 8 : 0) + bodySize;
         packet.reserve(total_len);
         
         uint32_t len_net = htonl(total_len);
         uint8_t* p_len = reinterpret_cast<uint8_t*>(&len_net);
         packet.insert(packet.end(), p_len, p_len + 4);
 
-        uint16_t code_net = htons(static_cast<uint16_t>(code));
+        uint16_t rawCode = static_cast<uint16_t>(code);
+        if (binary) rawCode |= BINARY_PAYLOAD_FLAG;
+        if (frameCorrelationId != 0) rawCode |= CORRELATION_ID_FLAG;
+        if (compressed) rawCode |= COMPRESSED_PAYLOAD_FLAG;
+        if (contentVersion) rawCode |= CONTENT_VERSION_FLAG;
+        uint16_t code_net = htons(rawCode);
         uint8_t* p_code = reinterpret_cast<uint8_t*>(&code_net);
         packet.insert(packet.end(), p_code, p_code + 2);
+
+        if (frameCorrelationId != 0) {
+            uint32_t id_net = htonl(frameCorrelationId);
+            uint8_t* p_id = reinterpret_cast<uint8_t*>(&id_net);
+            packet.insert(packet.end(), p_id, p_id + 4);
+        }
+
+        if (contentVersion) {
+            for (int shift = 56; shift >= 0; shift -= 8) {
+                packet.push_back(static_cast<uint8_t>(*contentVersion >> shift));
+            }
+        }
         
-        packet.insert(packet.end(), data.begin(), data.end());
+        packet.insert(packet.end(), body, body + bodySize);
         return packet;
     }
 
     // Deserialize from buffer
     // Expects buffer to start with a complete message.
     static Message deserialize(const std::vector<uint8_t>& buffer) {
-        if (buffer.size() < 6) { // 4 bytes length + 2 bytes code
+        return deserialize(buffer.data(), buffer.size());
+    }
+
+    // Same, reading the frame in place (e.g. straight from a receive buffer).
+    // A peer that did not negotiate deflate may not send compressed frames;
+    // with acceptCompressed false they are rejected before inflating.
+    static Message deserialize(const uint8_t* buffer, size_t size, bool acceptCompressed = true) {
+        return parse(buffer, size, acceptCompressed, false);
+    }
+
+    // Same, but an uncompressed payload is not copied: the Message borrows it
+    // from buffer, which must outlive it (a compressed one is inflated into data)
+    static Message deserializeView(const uint8_t* buffer, size_t size, bool acceptCompressed = true) {
+        return parse(buffer, size, acceptCompressed, true);
+    }
+
+    static Message parse(const uint8_t* buffer, size_t size, bool acceptCompressed, bool borrow) {
+        if (size < 6) { // 4 bytes length + 2 bytes code
             throw std::runtime_error("Invalid packet: too short");
         }
         
         uint32_t len_net;
-        std::memcpy(&len_net, buffer.data(), 4);
+        std::memcpy(&len_net, buffer, 4);
         uint32_t total_len = ntohl(len_net);
         
-        if (buffer.size() < total_len) {
+        if (size < total_len || total_len < 6) {
             throw std::runtime_error("Invalid packet: incomplete");
         }
 
         uint16_t code_net;
-        std::memcpy(&code_net, buffer.data() + 4, 2);
-        MsgCode c = static_cast<MsgCode>(ntohs(code_net));
-        
-        // Payload starts at offset 6, length is total_len - 6
-        std::vector<uint8_t> payload(buffer.begin() + 6, buffer.begin() + total_len);
-        return Message(c, payload);
+        std::memcpy(&code_net, buffer + 4, 2);
+        uint16_t rawCode = ntohs(code_net);
+        MsgCode c = static_cast<MsgCode>(rawCode & ~FRAME_FLAGS_MASK);
+
+        Message msg;
+        msg.code = c;
+        msg.binary = (rawCode & BINARY_PAYLOAD_FLAG) != 0;
+
+        // Payload starts after the header (6 bytes, +4 for v2, +8 with a content version)
+        // and runs to total_len
+        size_t headerLen = 6;
+        if (rawCode & CORRELATION_ID_FLAG) {
+            if (total_len < 10) {
+                throw std::runtime_error("Invalid packet: truncated correlation id");
+            }
+            uint32_t id_net;
+            std::memcpy(&id_net, buffer + 6, 4);
+            msg.correlationId = ntohl(id_net);
+            headerLen = 10;
+        }
+
+        if (rawCode & CONTENT_VERSION_FLAG) {
+            if (total_len < headerLen + 8) {
+                throw std::runtime_error("Invalid packet: truncated content version");
+            }
+            uint64_t version = 0;
+            for (size_t i = 0; i < 8; ++i) {
+                version = (version << 8) | buffer[headerLen + i];
+            }
+            msg.contentVersion = version;
+            headerLen += 8;
+        }
+
+        if (rawCode & COMPRESSED_PAYLOAD_FLAG) {
+            if (!acceptCompressed) {
+                throw std::runtime_error("Invalid packet: compression was not negotiated");
+            }
+            msg.data = compression::inflatePayload(buffer + headerLen, total_len - headerLen);
+        } else if (borrow) {
+            msg.borrowed = buffer + headerLen;
+            msg.borrowedSize = total_len - headerLen;
+        } else {
+            msg.data.assign(buffer + headerLen, buffer + total_len);
+        }
+        return msg;
+    }
+
+    // Length prefix of the frame at offset, or 0 if it has not arrived yet
+    static uint32_t peekLength(const std::vector<uint8_t>& buffer, size_t offset = 0) {
+        if (buffer.size() < offset + 4) return 0;
+
+        uint32_t len_net;
+        std::memcpy(&len_net, buffer.data() + offset, 4);
+        return ntohl(len_net);
     }
 
     // Helper to check if buffer has a full message
     // Returns 0 if not enough data to determine length, or if incomplete.
     // Returns total message length if complete message is present.
-    static uint32_t getFullLength(const std::vector<uint8_t>& buffer) {
-        if (buffer.size() < 4) return 0;
+    // offset skips frames the caller has already consumed.
+    static uint32_t getFullLength(const std::vector<uint8_t>& buffer, size_t offset = 0) {
+        if (buffer.size() < offset + 4) return 0;
         
         uint32_t len_net;
-        std::memcpy(&len_net, buffer.data(), 4);
+        std::memcpy(&len_net, buffer.data() + offset, 4);
         uint32_t total_len = ntohl(len_net);
         
-        if (buffer.size() >= total_len) {
+        if (buffer.size() - offset >= total_len) {
             return total_len;
         }
         return 0;
     }
 };
 
+// Split a BATCH_REQUEST / BATCH_RESPONSE payload back into its frames.
+// Throws on a truncated or malformed frame, or on a compressed one unless
+// acceptCompressed (see Message::deserialize).
+inline std::vector<Message> unpackFrames(const std::vector<uint8_t>& payload, bool acceptCompressed = true) {
+    std::vector<Message> frames;
+    size_t offset = 0;
+    while (offset < payload.size()) {
+        uint32_t len = Message::getFullLength(payload, offset);
+        if (len < 6) {
+            throw std::runtime_error("Invalid batch: truncated frame");
+        }
+        frames.push_back(Message::deserialize(payload.data() + offset, len, acceptCompressed));
+        offset += len;
+    }
+    return frames;
+}
+
+// Same, for a batch received in place: each frame borrows its payload from
+// batch's (see deserializeView), so batch must outlive them
+inline std::vector<Message> unpackFrameViews(const Message& batch, bool acceptCompressed = true) {
+    std::vector<Message> frames;
+    const uint8_t* payload = batch.payload();
+    size_t size = batch.payloadSize();
+    size_t offset = 0;
+    while (offset < size) {
+        if (size - offset < 6) {
+            throw std::runtime_error("Invalid batch: truncated frame");
+        }
+        uint32_t len_net;
+        std::memcpy(&len_net, payload + offset, 4);
+        uint32_t len = ntohl(len_net);
+        if (len < 6 || len > size - offset) {
+            throw std::runtime_error("Invalid batch: truncated frame");
+        }
+        frames.push_back(Message::deserializeView(payload + offset, len, acceptCompressed));
+        offset += len;
+    }
+    return frames;
+}
+
 } // namespace protocol
 
 #endif // PROTOCOL_H
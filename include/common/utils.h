@@ -1,7 +1,9 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <sstream>
 
@@ -10,8 +12,12 @@ namespace utils {
 // Generate a UUID-like session token
 std::string generateSessionToken();
 
-// Split string by delimiter
-std::vector<std::string> split(const std::string& str, char delimiter);
+// Split string by delimiter (a trailing delimiter yields no empty last token)
+std::vector<std::string> split(std::string_view str, char delimiter);
+
+// Same tokens as split() without copying them: the views point into str and
+// the vector lives in the current request arena (see common/arena.h)
+std::pmr::vector<std::string_view> splitView(std::string_view str, char delimiter);
 
 // Join vector of strings by delimiter
 std::string join(const std::vector<std::string>& v, char delimiter);
@@ -31,6 +37,12 @@ std::vector<char> readFile(const std::string& path);
 // Encode data to Base64
 std::string base64Encode(const std::vector<char>& data);
 
+// Decode Base64 text back to raw bytes (invalid characters are skipped)
+std::string base64Decode(const std::string& encoded);
+
+// SHA-256 digest of raw bytes as lowercase hex (64 chars)
+std::string sha256Hex(const std::string& data);
+
 } // namespace utils
 
 #endif // UTILS_H
@@ -0,0 +1,64 @@
+#ifndef SERVER_ATTEMPT_INDEX_H
+#define SERVER_ATTEMPT_INDEX_H
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace server {
+
+// Which users already have a result for each exam, so the one-attempt rule
+// can answer "not taken" (the common case) without a database query. An
+// exam's users are loaded on first use and kept current by every result the
+// server saves. The index only ever errs towards "possibly taken" (a result
+// deleted in the database), so callers confirm that answer with a query.
+class AttemptIndex {
+public:
+    enum class Answer {
+        NOT_TAKEN,      // Exact
+        POSSIBLY_TAKEN, // Confirm in the database
+        UNKNOWN         // Exam not loaded yet
+    };
+
+    Answer check(int examId, int userId) const;
+
+    // Claim the load of examId. False if it is loaded or already loading,
+    // in which case the caller asks the database itself.
+    bool beginLoad(int examId);
+    // Install the users read from the database. Results recorded since
+    // beginLoad() are kept, so a save racing the load is never lost.
+    void finishLoad(int examId, const std::vector<int>& userIds);
+    void abortLoad(int examId);
+
+    // A result was saved for userId on examId
+    void record(int examId, int userId);
+
+private:
+    // User ids as bits, in 64K-id chunks allocated on first use, so sparse
+    // and dense id ranges both stay small
+    class Bitmap {
+    public:
+        bool contains(int id) const;
+        void add(int id);
+
+    private:
+        static constexpr int CHUNK_BITS = 16;
+        using Chunk = std::array<uint64_t, (1 << CHUNK_BITS) / 64>;
+        std::unordered_map<uint32_t, std::unique_ptr<Chunk>> chunks;
+    };
+
+    struct Entry {
+        Bitmap users;
+        bool loaded = false;
+    };
+
+    mutable std::mutex mutex;
+    std::unordered_map<int, Entry> exams;
+};
+
+} // namespace server
+
+#endif // SERVER_ATTEMPT_INDEX_H
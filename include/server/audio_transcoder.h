@@ -0,0 +1,47 @@
+#ifndef SERVER_AUDIO_TRANSCODER_H
+#define SERVER_AUDIO_TRANSCODER_H
+
+#include "server/blob_store.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+namespace server {
+
+// Background worker that converts voice note blobs from PCM WAV to the
+// in-house ADPCM container (16 kHz mono), keeping the event loop free of
+// CPU-heavy audio work. Non-WAV blobs are left untouched.
+class AudioTranscoder {
+private:
+    std::shared_ptr<BlobStore> blobStore;
+
+    std::mutex queueMutex;
+    std::condition_variable queueCv;
+    std::deque<std::string> queue;
+    std::set<std::string> queued; // Dedup hashes already waiting
+    bool stopping = false;
+    std::thread worker;
+
+    void run();
+    void transcode(const std::string& hash);
+
+public:
+    static constexpr const char* ENCODING_ADPCM = "adpcm";
+
+    explicit AudioTranscoder(std::shared_ptr<BlobStore> store);
+    ~AudioTranscoder();
+
+    AudioTranscoder(const AudioTranscoder&) = delete;
+    AudioTranscoder& operator=(const AudioTranscoder&) = delete;
+
+    // Schedule a blob for compression (no-op if already queued)
+    void enqueue(const std::string& hash);
+};
+
+} // namespace server
+
+#endif // SERVER_AUDIO_TRANSCODER_H
@@ -0,0 +1,60 @@
+#ifndef SERVER_BLOB_STORE_H
+#define SERVER_BLOB_STORE_H
+
+#include <string>
+#include <cstdint>
+
+namespace server {
+
+// Content-addressed blob storage on the local filesystem.
+// Blobs are keyed by the SHA-256 of their bytes and laid out as
+// <root>/<first 2 hex chars>/<full hash>, so identical uploads are stored once.
+// A blob may later be replaced by an encoded form (e.g. compressed audio); a
+// "<hash>.ref" file then points at the encoded blob and the raw bytes are dropped.
+class BlobStore {
+private:
+    std::string rootDir;
+
+    std::string pathFor(const std::string& hash) const;
+    bool writeAtomically(const std::string& path, const std::string& bytes) const;
+
+public:
+    struct BlobInfo {
+        bool found = false;
+        std::string encoding;   // empty for raw bytes
+        std::string storedHash; // hash of the bytes actually on disk
+        int64_t size = -1;      // size of the stored bytes
+    };
+
+    explicit BlobStore(const std::string& rootDir = "data/blobs");
+
+    // Store bytes and return their hash. Existing blobs are not rewritten.
+    // Returns an empty string if the blob could not be written.
+    std::string put(const std::string& bytes);
+
+    // Check whether a blob with the given hash exists (raw or encoded)
+    bool exists(const std::string& hash) const;
+
+    // Resolve how a blob is currently stored
+    BlobInfo lookup(const std::string& hash) const;
+
+    // Size of a raw stored blob in bytes, or -1 if it does not exist
+    int64_t size(const std::string& hash) const;
+
+    // Store an encoded form of hash and drop the raw bytes
+    bool replaceWithEncoded(const std::string& hash, const std::string& encoding, const std::string& encodedBytes);
+
+    // Read up to maxLen bytes starting at offset into out
+    bool read(const std::string& hash, uint64_t offset, size_t maxLen, std::string& out) const;
+
+    // Validate that a string is a 64-char lowercase hex SHA-256 digest
+    static bool isValidHash(const std::string& hash);
+
+    // Chat rows reference blobs as "blob:<hash>"
+    static std::string toReference(const std::string& hash);
+    static bool parseReference(const std::string& content, std::string& hash);
+};
+
+} // namespace server
+
+#endif // SERVER_BLOB_STORE_H
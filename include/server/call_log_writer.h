@@ -0,0 +1,44 @@
+#ifndef SERVER_CALL_LOG_WRITER_H
+#define SERVER_CALL_LOG_WRITER_H
+
+#include "server/repository/call_log_repository.h"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace server {
+
+// Buffers finished calls and writes them to call_logs in batches from a
+// background thread, so call signaling never waits on the database.
+// A batch is flushed when it reaches MAX_BATCH entries or FLUSH_INTERVAL_MS
+// after the first buffered entry; anything left is flushed on shutdown.
+class CallLogWriter {
+private:
+    std::shared_ptr<CallLogRepository> repository;
+
+    std::mutex bufferMutex;
+    std::condition_variable bufferCv;
+    std::vector<CallLog> buffer;
+    bool stopping = false;
+    std::thread worker;
+
+    void run();
+
+public:
+    static constexpr size_t MAX_BATCH = 64;
+    static constexpr int FLUSH_INTERVAL_MS = 2000;
+
+    explicit CallLogWriter(std::shared_ptr<CallLogRepository> repo);
+    ~CallLogWriter();
+
+    CallLogWriter(const CallLogWriter&) = delete;
+    CallLogWriter& operator=(const CallLogWriter&) = delete;
+
+    void record(const CallLog& log);
+};
+
+} // namespace server
+
+#endif // SERVER_CALL_LOG_WRITER_H
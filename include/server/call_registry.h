@@ -0,0 +1,89 @@
+#ifndef SERVER_CALL_REGISTRY_H
+#define SERVER_CALL_REGISTRY_H
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace server {
+
+enum class CallState {
+    RINGING,
+    ACTIVE,
+    ENDED
+};
+
+struct CallSession {
+    uint64_t callId = 0;
+    std::string caller;
+    std::string callee;
+    int callerId = -1;
+    int calleeId = -1;
+    CallState state = CallState::RINGING;
+    uint32_t relaySessionId = 0;              // 0 until media is allocated
+    std::chrono::steady_clock::time_point ringingSince;
+    std::chrono::steady_clock::time_point answeredAt;
+    std::time_t startTime = 0;                // Wall clock, for call_logs
+
+    bool wasAnswered() const { return answeredAt != std::chrono::steady_clock::time_point(); }
+
+    const std::string& peerOf(const std::string& username) const {
+        return username == caller ? callee : caller;
+    }
+};
+
+// Live voice calls, indexed by caller, callee and relay session so every
+// busy check and lookup is O(1). A user takes part in at most one call.
+// State transitions: RINGING -> ACTIVE -> ENDED, or RINGING -> ENDED.
+// Ended calls are removed and handed back (state ENDED) for logging.
+// All methods are thread-safe.
+class CallRegistry {
+public:
+    enum class RingResult {
+        OK,
+        CALLER_BUSY,
+        CALLEE_BUSY
+    };
+
+private:
+    mutable std::mutex registryMutex;
+    uint64_t nextCallId = 1;
+    std::unordered_map<uint64_t, CallSession> calls;
+    std::unordered_map<std::string, uint64_t> byCaller;
+    std::unordered_map<std::string, uint64_t> byCallee;
+    std::unordered_map<uint32_t, uint64_t> byRelaySession;
+
+    // Caller must hold registryMutex
+    uint64_t findCallId(const std::string& username) const;
+    CallSession removeCall(uint64_t callId);
+
+public:
+    // Start ringing callee; fails if either party is already in a call
+    RingResult ring(const std::string& caller, int callerId, const std::string& callee, int calleeId);
+
+    // RINGING -> ACTIVE, only for the callee of a call placed by caller
+    bool answer(const std::string& callee, const std::string& caller, CallSession& out);
+
+    // Associate the media relay session of an active call
+    void attachRelaySession(uint64_t callId, uint32_t relaySessionId);
+
+    // End the call that username is part of. If peer is non-empty, the call
+    // must be with that peer.
+    bool end(const std::string& username, const std::string& peer, CallSession& out);
+
+    // End the active call carried by a relay session
+    bool endByRelaySession(uint32_t relaySessionId, CallSession& out);
+
+    // End calls that have been ringing longer than timeout
+    std::vector<CallSession> takeUnanswered(std::chrono::seconds timeout);
+
+    bool isBusy(const std::string& username) const;
+};
+
+} // namespace server
+
+#endif // SERVER_CALL_REGISTRY_H
@@ -0,0 +1,45 @@
+#ifndef SERVER_CATALOG_VERSIONS_H
+#define SERVER_CATALOG_VERSIONS_H
+
+#include "common/protocol.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace server {
+
+// Content versions for conditional fetch (CONTENT_VERSION_FLAG / NOT_MODIFIED).
+// Each catalog has one counter, bumped whenever the server changes that
+// content. Every response drawn from a catalog is valid for as long as the
+// counter stays put, so clients cache per request (code + parameters).
+// Counters start from the server's start time so that a restart, which may
+// follow a reseed, invalidates every client cache.
+class CatalogVersions {
+public:
+    enum class Catalog {
+        LESSONS,
+        EXERCISES,
+        EXAMS,
+        GAMES,
+        COUNT
+    };
+
+    CatalogVersions();
+
+    uint64_t current(Catalog catalog) const;
+    void bump(Catalog catalog);
+
+    // True if the request carries the current version of catalog; reply with notModified()
+    bool isNotModified(const protocol::Message& request, Catalog catalog) const;
+    protocol::Message notModified(Catalog catalog) const;
+
+    // Tag a response with the catalog version if the request opted in
+    void stamp(const protocol::Message& request, protocol::Message& response, Catalog catalog) const;
+
+private:
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(Catalog::COUNT)> versions;
+};
+
+} // namespace server
+
+#endif // SERVER_CATALOG_VERSIONS_H
@@ -4,7 +4,6 @@
 #include <memory>
 #include <vector>
 #include <string>
-#include <mutex>
 #include "common/protocol.h"
 
 namespace server {
@@ -12,26 +11,29 @@ namespace server {
 class SessionManager;
 class ConnectionManager;
 class RequestRouter;
+class Connection;
 
+// Decodes frames and routes them. Holds no per-connection state, so one
+// instance serves every Connection.
 class ClientHandler {
 public:
     ClientHandler(std::shared_ptr<SessionManager> sm,
                   std::shared_ptr<ConnectionManager> cm,
                   std::shared_ptr<RequestRouter> rr);
 
-    void processMessage(int clientFd, const std::vector<uint8_t>& data);
-    void handleClientDisconnect(int clientFd);
-    bool send_message(const protocol::Message& msg);
-    int get_user_id() const;
+    // frame points at one complete [len][code][payload] frame of size bytes.
+    // It is parsed in place (Message::deserializeView), not copied.
+    void processMessage(Connection& conn, const uint8_t* frame, size_t size);
+    void handleClientDisconnect(Connection& conn);
 
 private:
     std::shared_ptr<SessionManager> sessionManager_;
     std::shared_ptr<ConnectionManager> connectionManager_;
     std::shared_ptr<RequestRouter> requestRouter_;
-    int clientFd_;
 
-    void handleHeartbeat(const protocol::Message& msg);
-    void handleDisconnectRequest();
+    bool send_message(Connection& conn, const protocol::Message& msg);
+    void handleHeartbeat(Connection& conn, const protocol::Message& msg);
+    void handleDisconnectRequest(Connection& conn);
 };
 
 } // namespace server
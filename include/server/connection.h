@@ -0,0 +1,142 @@
+#ifndef SERVER_CONNECTION_H
+#define SERVER_CONNECTION_H
+
+#include "common/protocol.h"
+#include "server/outbox.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <sys/types.h>
+#include <vector>
+
+namespace server {
+
+// Role bits, so a route's permission check is a single mask test
+namespace roles {
+constexpr uint8_t NONE = 0;
+constexpr uint8_t STUDENT = 1 << 0;
+constexpr uint8_t TEACHER = 1 << 1;
+constexpr uint8_t ADMIN = 1 << 2;
+constexpr uint8_t ANY = STUDENT | TEACHER | ADMIN;
+
+inline uint8_t fromName(std::string_view name) {
+    if (name == "student") return STUDENT;
+    if (name == "teacher") return TEACHER;
+    if (name == "admin") return ADMIN;
+    return NONE;
+}
+} // namespace roles
+
+// One accepted client socket and everything the server knows about it.
+// Server owns one per fd for the life of the socket and passes it by
+// reference through ClientHandler, RequestRouter and the controllers, so
+// handling a request touches only its own connection's state.
+//
+// Requests on a connection run one at a time on its strand (see
+// StrandExecutor), which alone reads and writes the identity, capabilities
+// and input stats. Output from any thread (replies, and pushes from other users'
+// requests) goes through the outbox; the event loop writes everything queued
+// in one vectored send at the end of each pass (per-tick corking).
+class Connection {
+public:
+    struct Stats {
+        uint64_t framesIn = 0;
+        uint64_t bytesIn = 0;
+        uint64_t framesOut = 0;
+        uint64_t bytesOut = 0;
+        uint64_t writeCalls = 0; // Send syscalls; framesOut / writeCalls is the coalescing achieved
+        std::chrono::steady_clock::time_point connectedAt = std::chrono::steady_clock::now();
+    };
+
+    // More unsent output than this means the client stopped reading; the
+    // connection is closed rather than buffering without bound
+    static constexpr size_t MAX_PENDING_OUTPUT = 32 * 1024 * 1024;
+
+    // A writer that has queued this much flushes itself rather than waiting
+    // for the end of the pass, so a long streamed response stays bounded
+    static constexpr size_t CORK_LIMIT = 256 * 1024;
+
+    const int fd;
+    std::vector<uint8_t> input; // Received bytes not yet forming a complete frame
+
+    // Bound at login; -1 and empty until then (and again after logout)
+    int userId = -1;
+    std::string role;
+    uint8_t roleBits = roles::NONE; // role as roles:: bits
+    std::string sessionToken;       // Requests must carry this token
+    std::chrono::steady_clock::time_point sessionTouchedAt; // Last activity recorded in SessionManager
+
+    // Negotiated with HELLO / CODEC_SELECT_REQUEST. Changed only through
+    // setCapabilities(); other threads read capabilitiesSnapshot().
+    protocol::Capabilities capabilities;
+    // The out counters are written by flush() (the event loop, or a writer
+    // past CORK_LIMIT) under the mutex; read them through statsSnapshot()
+    Stats stats;
+
+    // Owned by the Server loop: the strand the connection's requests are
+    // posted to, and how many are still queued or running there. The key only
+    // changes (login, logout) once none are in flight, which keeps them in order.
+    uint64_t strandKey = 0;
+    std::atomic<int> inFlight{0};
+
+    // The event loop's, notified when a frame lands in an empty outbox. Set
+    // before the connection is shared; without one, frames are written at once.
+    std::shared_ptr<Wakeup> wakeup;
+
+    explicit Connection(int fd) : fd(fd) {}
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+
+    // Queue size bytes (one or more whole frames) from any thread, to be sent
+    // behind everything queued before. Returns size once queued, -1 if the
+    // connection is broken (including by this write exceeding MAX_PENDING_OUTPUT).
+    ssize_t write(const uint8_t* data, size_t size);
+    ssize_t write(std::vector<uint8_t>&& data);
+    ssize_t write(const std::vector<uint8_t>& data) { return write(data.data(), data.size()); }
+
+    // Queue a frame that may be shared with other connections (pushes)
+    bool push(Outbox::Frame frame);
+
+    // Send everything queued, as far as the socket allows, in as few
+    // syscalls as possible. Returns false if the connection is broken.
+    bool flush();
+
+    // Close the socket. Writes after this fail instead of reaching
+    // whichever connection reuses the fd.
+    void close();
+
+    void setCapabilities(const protocol::Capabilities& negotiated);
+    protocol::Capabilities capabilitiesSnapshot() const;
+    Stats statsSnapshot() const;
+
+    bool hasPendingOutput() const; // Taken from the outbox but not yet sent
+    bool hasQueuedFrames() const { return !outbox.empty(); }
+    bool isBroken() const;
+    bool isAuthenticated() const { return userId != -1; }
+
+private:
+    static constexpr size_t MAX_IOV = 64; // Frames per sendmsg()
+
+    // Add frame to the outbox and wake the loop; queued is set to the bytes
+    // now waiting there. Without a loop (no wakeup) the frame is sent at once.
+    bool enqueue(Outbox::Frame frame, size_t& queued);
+
+    mutable std::mutex mutex;          // Guards the pending state, capabilities writes and out stats
+    std::deque<Outbox::Frame> pending; // Unsent frames, the first from pendingOffset on
+    size_t pendingOffset = 0;
+    size_t pendingBytes = 0;
+    bool closed = false;
+    std::atomic<bool> broken{false};
+
+    Outbox outbox;
+    std::atomic<size_t> outboxBytes{0}; // Queued but not yet taken by flush()
+};
+
+} // namespace server
+
+#endif // SERVER_CONNECTION_H
@@ -2,36 +2,131 @@
 #define CONNECTION_MANAGER_H
 
 #include <string>
+#include <string_view>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
+#include "common/payloads.h"
 #include "common/protocol.h"
+#include "server/connection.h"
 #include "server/session.h"
+#include "server/repository/notification_repository.h"
 #include <vector>
 
 namespace server {
 
-class ClientHandler;
+// Notification topics a connection can subscribe to (see ConnectionManager::publish)
+namespace topics {
+inline std::string level(std::string_view level) { return "level:" + std::string(level); }
+inline std::string lesson(int lessonId) { return "lesson:" + std::to_string(lessonId); }
+inline std::string teacher(int teacherId) { return "teacher:" + std::to_string(teacherId); }
+inline std::string role(std::string_view role) { return "role:" + std::string(role); }
+} // namespace topics
 
 class ConnectionManager {
 public:
-    ConnectionManager(std::shared_ptr<SessionManager> sm);
+    ConnectionManager(std::shared_ptr<SessionManager> sm, std::shared_ptr<NotificationRepository> notifications);
 
-    void add_client(int user_id, ClientHandler* client);
-    void remove_client(int user_id);
-    ClientHandler* get_client(int user_id);
+    // Every open socket, registered by Server for the life of its Connection.
+    // Pushes reach conn only while it is attached (all methods are thread-safe).
+    void attach(Connection& conn);
+    void detach(Connection& conn);
 
-    // Send message to a specific user (all active sessions)
-    void sendToUser(int userId, const protocol::Message& msg);
+    // Index conn under its user once logged in (conn.userId set); a user
+    // may be logged in on several connections
+    void add_client(Connection& conn);
+    void remove_client(Connection& conn);
+
+    // Send message to a specific user (all active sessions). Returns the
+    // number of connections it was queued on: 0 if the user is offline or
+    // every push was dropped (frame limit, full or broken outbox).
+    size_t sendToUser(int userId, const protocol::Message& msg);
+
+    // Send a DTO to every session of a user, each in the codec it negotiated;
+    // returns what sendToUser(int, const Message&) does
+    template <typename T>
+    size_t sendToUser(int userId, protocol::MsgCode code, const T& dto);
+
+    // Push a DTO to one connection in the codec it negotiated. Unlike a reply
+    // it carries no correlation id. Returns false if conn is not attached or
+    // the frame was dropped.
+    template <typename T>
+    bool sendToConnection(Connection& conn, protocol::MsgCode code, const T& dto);
 
     // Check if user is online
     bool isUserOnline(int userId) const;
 
+    // Push NOTIFICATION_PUSH if the user is online, otherwise store it (see
+    // NotificationRepository) for the next login's digest. Called off the
+    // event loop: storing is a database round trip.
+    void notifyUser(int userId, const std::string& text);
+
+    // Topic subscriptions of a logged-in connection (see topics::). They are
+    // dropped with the connection's identity in remove_client().
+    void subscribe(Connection& conn, const std::string& topic);
+    void unsubscribe(Connection& conn, const std::string& topic);
+
+    // Push NOTIFICATION_PUSH to every online subscriber of topic. The frame
+    // is serialised once per compression setting and the same buffer queued
+    // on every recipient. Offline users do not receive it later. Returns the
+    // number of connections it was queued on.
+    size_t publish(const std::string& topic, const std::string& text);
+
 private:
-    std::unordered_map<int, ClientHandler*> active_clients_;
+    // Queue frame on conn's outbox; nothing here touches a socket. Callers
+    // hold mutex_, so the connection cannot be detached (and destroyed) meanwhile.
+    // Returns false if the frame was dropped.
+    bool sendTo(Connection& conn, const Outbox::Frame& frame, const protocol::Capabilities& capabilities);
+    size_t sendToUserLocked(int userId, const protocol::Message& msg);
+
+    std::unordered_map<int, Connection*> connections_;                // By fd
+    std::unordered_map<int, std::vector<Connection*>> user_connections_; // By user id, logged in only
+    std::unordered_map<std::string, std::unordered_set<Connection*>> topic_subscribers_;
+    std::unordered_map<Connection*, std::vector<std::string>> connection_topics_; // For unsubscribing on logout
     std::shared_ptr<SessionManager> sessionManager;
+    std::shared_ptr<NotificationRepository> notifications;
+    mutable std::mutex mutex_;
 };
 
+template <typename T>
+size_t ConnectionManager::sendToUser(int userId, protocol::MsgCode code, const T& dto) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = user_connections_.find(userId);
+    if (it == user_connections_.end()) return 0;
+
+    // Encode lazily: most users have every session on the same codec.
+    // Frames are indexed by [binary][compressed] and shared by the sessions.
+    Outbox::Frame frames[2][2];
+    size_t queued = 0;
+    for (Connection* conn : it->second) {
+        protocol::Capabilities capabilities = conn->capabilitiesSnapshot();
+        bool useBinary = capabilities.binaryPayloads;
+        bool useCompression = capabilities.compression;
+        Outbox::Frame& frame = frames[useBinary][useCompression];
+        if (!frame) {
+            frame = std::make_shared<const std::vector<uint8_t>>(
+                Payloads::encode(code, dto, useBinary).serialize(0, useCompression));
+        }
+        if (sendTo(*conn, frame, capabilities)) ++queued;
+    }
+    return queued;
+}
+
+template <typename T>
+bool ConnectionManager::sendToConnection(Connection& conn, protocol::MsgCode code, const T& dto) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = connections_.find(conn.fd);
+    if (it == connections_.end() || it->second != &conn) return false;
+
+    protocol::Capabilities capabilities = conn.capabilitiesSnapshot();
+    auto frame = std::make_shared<const std::vector<uint8_t>>(
+        Payloads::encode(code, dto, capabilities.binaryPayloads).serialize(0, capabilities.compression));
+    return sendTo(conn, frame, capabilities);
+}
+
 } // namespace server
 
 #endif // CONNECTION_MANAGER_H
@@ -3,25 +3,33 @@
 
 #include <memory>
 #include "server/session.h"
+#include "server/connection_manager.h"
 #include "server/repository/game_repository.h"
+#include "server/catalog_versions.h"
 #include "common/protocol.h"
 
 namespace server {
 
+class Connection;
+
 class AdminGameController {
 private:
     std::shared_ptr<SessionManager> sessionManager;
     std::shared_ptr<GameRepository> gameRepository;
+    std::shared_ptr<CatalogVersions> catalogVersions; // Bumped on every game change
+    std::shared_ptr<ConnectionManager> connectionManager; // Announces new games to their level
 
-    bool sendMessage(int clientFd, const protocol::Message& msg);
+    bool sendMessage(Connection& conn, const protocol::Message& msg);
 
 public:
     AdminGameController(std::shared_ptr<SessionManager> sm, 
-                        std::shared_ptr<GameRepository> gr);
+                        std::shared_ptr<GameRepository> gr,
+                        std::shared_ptr<CatalogVersions> cv,
+                        std::shared_ptr<ConnectionManager> cm);
 
-    void handleGameCreateRequest(int clientFd, const protocol::Message& msg);
-    void handleGameUpdateRequest(int clientFd, const protocol::Message& msg);
-    void handleGameDeleteRequest(int clientFd, const protocol::Message& msg);
+    void handleGameCreateRequest(Connection& conn, const protocol::Message& msg);
+    void handleGameUpdateRequest(Connection& conn, const protocol::Message& msg);
+    void handleGameDeleteRequest(Connection& conn, const protocol::Message& msg);
 };
 
 } // namespace server
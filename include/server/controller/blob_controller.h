@@ -0,0 +1,78 @@
+#ifndef SERVER_CONTROLLER_BLOB_CONTROLLER_H
+#define SERVER_CONTROLLER_BLOB_CONTROLLER_H
+
+#include "common/protocol.h"
+#include "server/session.h"
+#include "server/blob_store.h"
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace server {
+
+class Connection;
+
+// Chunked upload/download of chat attachments backed by the BlobStore
+class BlobController {
+private:
+    std::shared_ptr<SessionManager> sessionManager;
+    std::shared_ptr<BlobStore> blobStore;
+
+    struct PendingUpload {
+        int userId = -1;
+        std::string bytes; // Grows as chunks arrive; nothing is reserved up front
+        uint64_t totalSize = 0;
+        std::chrono::steady_clock::time_point lastActivity;
+    };
+
+    // What one user has open, checked against the per-user caps
+    struct UploadQuota {
+        size_t uploads = 0;
+        uint64_t declaredBytes = 0; // Sum of the open uploads' totalSize
+    };
+
+    // key: "<userId>:<uploadId>"
+    std::map<std::string, PendingUpload> pendingUploads;
+    std::map<int, UploadQuota> uploadQuotas;
+    std::mutex uploadsMutex; // Guards pendingUploads and uploadQuotas
+
+    // Drop an open upload and give its share of the quota back (uploadsMutex held)
+    std::map<std::string, PendingUpload>::iterator eraseUpload(std::map<std::string, PendingUpload>::iterator it);
+
+    // Last blob rebuilt for a client that cannot decode its stored encoding;
+    // shared so a download in progress keeps its copy if another replaces it
+    std::string legacyCacheHash;
+    std::shared_ptr<const std::string> legacyCacheBytes;
+    std::mutex legacyCacheMutex;
+
+    bool sendMessage(Connection& conn, const protocol::Message& msg);
+    static bool acceptsEncoding(const std::string& accept, const std::string& encoding);
+    std::shared_ptr<const std::string> decodeForLegacyClient(const std::string& hash, const BlobStore::BlobInfo& info);
+    void sendUploadFailure(Connection& conn, const std::string& uploadId, const std::string& reason, bool binary);
+    void sendDownloadFailure(Connection& conn, const std::string& hash, const std::string& reason, bool binary);
+
+public:
+    static constexpr uint64_t MAX_BLOB_SIZE = 16 * 1024 * 1024;
+    // Per user, so one client cannot hold many half-finished uploads open
+    static constexpr size_t MAX_PENDING_UPLOADS_PER_USER = 4;
+    static constexpr uint64_t MAX_PENDING_BYTES_PER_USER = 2 * MAX_BLOB_SIZE;
+    static constexpr size_t DOWNLOAD_CHUNK_SIZE = 48 * 1024;
+
+    BlobController(std::shared_ptr<SessionManager> sessionMgr,
+                   std::shared_ptr<BlobStore> store);
+
+    // Handle BLOB_UPLOAD_CHUNK (chunks must arrive in order)
+    void handleBlobUploadChunk(Connection& conn, const protocol::Message& msg);
+
+    // Handle BLOB_DOWNLOAD_REQUEST (one chunk per request)
+    void handleBlobDownloadRequest(Connection& conn, const protocol::Message& msg);
+
+    // Drop uploads that stalled mid-transfer
+    void processUploadTimeouts();
+};
+
+} // namespace server
+
+#endif // SERVER_CONTROLLER_BLOB_CONTROLLER_H
@@ -2,66 +2,105 @@
 #define SERVER_CONTROLLER_CHAT_CONTROLLER_H
 
 #include "server/repository/chat_repository.h"
+#include "server/repository/notification_repository.h"
 #include "server/connection_manager.h"
 #include "server/session.h"
 #include "server/repository/user_repository.h"
+#include "server/blob_store.h"
+#include "server/audio_transcoder.h"
+#include "server/media_relay.h"
+#include "server/call_registry.h"
+#include "server/call_log_writer.h"
 #include "common/payloads.h"
 #include "common/protocol.h"
 #include <memory>
-#include <chrono>
-#include <map>
+#include <mutex>
 #include <set>
+#include <utility>
+#include <vector>
 #include <string>
 
 namespace server {
 
+class Connection;
+
 class ChatController {
 private:
     std::shared_ptr<ChatRepository> chatRepository;
+    std::shared_ptr<NotificationRepository> notificationRepository;
     std::shared_ptr<UserRepository> userRepository;
     std::shared_ptr<ConnectionManager> connectionManager;
     std::shared_ptr<SessionManager> sessionManager;
+    std::shared_ptr<BlobStore> blobStore;
+    std::shared_ptr<AudioTranscoder> audioTranscoder;
+    std::shared_ptr<MediaRelay> mediaRelay;
+    std::shared_ptr<CallLogWriter> callLogWriter;
+    CallRegistry callRegistry;
+
+    // Delivery/read acknowledgements, coalesced until the next flush
+    std::vector<std::pair<int, int>> pendingDelivered; // (receiverId, messageId)
+    std::vector<std::pair<int, int>> pendingNotifications; // (userId, notificationId), deleted on flush
+    std::set<std::pair<int, int>> pendingReads; // (senderId, receiverId)
+    std::mutex acknowledgementsMutex;
+
+    // Turn AUDIO content into a blob reference and queue it for compression;
+    // legacy clients still send inline Base64.
+    // Returns false if the content references a blob the store does not have.
+    bool resolveAudioContent(std::string& content);
 
 public:
     ChatController(std::shared_ptr<ChatRepository> chatRepo,
+                   std::shared_ptr<NotificationRepository> notificationRepo,
                    std::shared_ptr<UserRepository> userRepo,
                    std::shared_ptr<ConnectionManager> connMgr,
-                   std::shared_ptr<SessionManager> sessionMgr);
+                   std::shared_ptr<SessionManager> sessionMgr,
+                   std::shared_ptr<BlobStore> store,
+                   std::shared_ptr<AudioTranscoder> transcoder,
+                   std::shared_ptr<MediaRelay> relay,
+                   std::shared_ptr<CallLogWriter> logWriter);
+    ~ChatController();
+
+    static constexpr int UNREAD_DIGEST_LIMIT = 500;
+    static constexpr size_t DIGEST_FRAME_OVERHEAD = 64; // Frame header and list count
 
     // Handle SEND_CHAT_PRIVATE_REQUEST
-    void handleUserSendPrivateMessage(int clientFd, const protocol::Message& msg);
+    void handleUserSendPrivateMessage(Connection& conn, const protocol::Message& msg);
 
     // Handle CHAT_HISTORY_REQUEST
-    void handleUserGetChatHistory(int clientFd, const protocol::Message& msg);
+    void handleUserGetChatHistory(Connection& conn, const protocol::Message& msg);
 
     // Handle RECENT_CHATS_REQUEST
-    void handleUserGetRecentChats(int clientFd, const protocol::Message& msg);
+    void handleUserGetRecentChats(Connection& conn, const protocol::Message& msg);
+
+    // Handle CHAT_READ_ACK
+    void handleChatReadAck(Connection& conn, const protocol::Message& msg);
+
+    // Handle UNREAD_DIGEST_ACK and CHAT_RECEIVE_ACK
+    void handleDeliveryAck(Connection& conn, const protocol::Message& msg);
+
+    // Push everything that reached userId while offline as UNREAD_DIGEST
+    // frames within conn's frame limit
+    void sendUnreadDigest(Connection& conn, int userId);
+
+    // Write coalesced delivery/read acknowledgements in bulk. Database round
+    // trips: run it off the event loop (RequestRouter::processTimeouts).
+    void flushAcknowledgements();
 
     // Voice Call Handlers
-    void handleCallInitiate(int clientFd, const protocol::Message& msg);
-    void handleCallAnswer(int clientFd, const protocol::Message& msg);
-    void handleCallDecline(int clientFd, const protocol::Message& msg);
-    void handleCallEnd(int clientFd, const protocol::Message& msg);
+    void handleCallInitiate(Connection& conn, const protocol::Message& msg);
+    void handleCallAnswer(Connection& conn, const protocol::Message& msg);
+    void handleCallDecline(Connection& conn, const protocol::Message& msg);
+    void handleCallEnd(Connection& conn, const protocol::Message& msg);
 
     // Call Timeout Processing
     void processCallTimeouts();
 
 private:
-    struct PendingCall {
-        std::string caller;
-        std::string receiver;
-        std::chrono::steady_clock::time_point startTime;
-    };
-
-    // key: receiver username (since one user can only receive one call at a time effectively)
-    // or key: caller? Better key: receiver, to easily check if they are being called.
-    // Actually, allowing key to be consistent. 
-    // Let's store by receiver for timeout checking? No, simple vector or map is fine.
-    // Map <Receiver, PendingCall> ensures one pending call per receiver.
-    std::map<std::string, PendingCall> pendingCalls;
-
-    // Set of users currently in a call (busy)
-    std::set<std::string> activeUsersInCall;
+    // Release media and log a call that ended by request of endedBy
+    void finishCall(const CallSession& call, const std::string& endedBy);
+
+    // Queue a call_logs row for the batched writer
+    void recordCall(const CallSession& call, const std::string& status);
 };
 
 } // namespace server
@@ -4,11 +4,14 @@
 #include "common/protocol.h"
 #include "server/session.h"
 #include "server/repository/exercise_repository.h"
+#include "server/catalog_versions.h"
 #include <memory>
 #include <string>
 
 namespace server {
 
+class Connection;
+
 /**
  * ExerciseHandler - Handles exercise-related messages from clients
  *
@@ -19,8 +22,9 @@ class ExerciseController {
 private:
     std::shared_ptr<SessionManager> sessionManager;
     std::shared_ptr<ExerciseRepository> exerciseRepository;
+    std::shared_ptr<CatalogVersions> catalogVersions;
 
-    bool sendMessage(int clientFd, const protocol::Message& msg);
+    bool sendMessage(Connection& conn, const protocol::Message& msg);
 
     // Helper to parse exercise type string
     ExerciseType parseExerciseType(const std::string& typeStr);
@@ -30,8 +34,10 @@ public:
      * Constructor
      * @param sm - Shared pointer to SessionManager for token validation
      * @param er - Shared pointer to ExerciseRepository for database operations
+     * @param cv - Catalog versions for conditional fetch (NOT_MODIFIED)
      */
-    ExerciseController(std::shared_ptr<SessionManager> sm, std::shared_ptr<ExerciseRepository> er);
+    ExerciseController(std::shared_ptr<SessionManager> sm, std::shared_ptr<ExerciseRepository> er,
+                       std::shared_ptr<CatalogVersions> cv);
 
     /**
      * Handle EXERCISE_LIST_REQUEST message
@@ -52,10 +58,10 @@ public:
      * 7. Send EXERCISE_LIST_SUCCESS with serialized data
      * 8. On error, send EXERCISE_LIST_FAILURE
      *
-     * @param clientFd - Client socket file descriptor
+     * @param conn - Client connection
      * @param msg - Incoming message from client
      */
-    void handleStudentExerciseListRequest(int clientFd, const protocol::Message& msg);
+    void handleStudentExerciseListRequest(Connection& conn, const protocol::Message& msg);
 
     /**
      * Handle STUDY_EXERCISE_REQUEST message
@@ -73,10 +79,10 @@ public:
      * 5. Send STUDY_EXERCISE_SUCCESS with serialized content
      * 6. On error, send STUDY_EXERCISE_FAILURE
      *
-     * @param clientFd - Client socket file descriptor
+     * @param conn - Client connection
      * @param msg - Incoming message from client
      */
-    void handleStudentStudyExerciseRequest(int clientFd, const protocol::Message& msg);
+    void handleStudentStudyExerciseRequest(Connection& conn, const protocol::Message& msg);
 
     /**
      * Handle specific exercise requests (MULTIPLE_CHOICE, FILL_IN, etc.)
@@ -84,7 +90,7 @@ public:
      * Expected payload format: <session_token>;<exercise_id>
      * The response code will match the request code + 1 (e.g. REQUEST -> SUCCESS).
      */
-    void handleStudentSpecificExerciseRequest(int clientFd, const protocol::Message& msg);
+    void handleStudentSpecificExerciseRequest(Connection& conn, const protocol::Message& msg);
 };
 
 } // namespace server
@@ -3,6 +3,7 @@
 
 #include "common/protocol.h"
 #include "server/session.h"
+#include "server/connection_manager.h"
 #include "server/repository/result_repository.h"
 #include "server/repository/exercise_repository.h"
 #include "server/repository/exam_repository.h"
@@ -11,29 +12,33 @@
 
 namespace server {
 
+class Connection;
+
 class FeedbackController {
 private:
     std::shared_ptr<SessionManager> sessionManager;
     std::shared_ptr<ResultRepository> resultRepo;
     std::shared_ptr<ExerciseRepository> exerciseRepo;
     std::shared_ptr<ExamRepository> examRepo;
+    std::shared_ptr<ConnectionManager> connectionManager; // Tells students their work was graded
 
-    bool sendMessage(int clientFd, const protocol::Message& msg);
+    bool sendMessage(Connection& conn, const protocol::Message& msg);
 
 public:
     FeedbackController(std::shared_ptr<SessionManager> sessionMgr, 
                        std::shared_ptr<ResultRepository> resultRepo,
                        std::shared_ptr<ExerciseRepository> exerciseRepo,
-                       std::shared_ptr<ExamRepository> examRepo);
+                       std::shared_ptr<ExamRepository> examRepo,
+                       std::shared_ptr<ConnectionManager> connMgr);
 
     // Teacher gets list of all student submissions
-    void handleGetSubmissions(int clientFd, const protocol::Message& msg);
+    void handleGetSubmissions(Connection& conn, const protocol::Message& msg);
     
     // Teacher submits grade for a submission
-    void handleGradeSubmission(int clientFd, const protocol::Message& msg);
+    void handleGradeSubmission(Connection& conn, const protocol::Message& msg);
     
     // Teacher adds feedback (audio or text) to a result
-    void handleAddFeedback(int clientFd, const protocol::Message& msg);
+    void handleAddFeedback(Connection& conn, const protocol::Message& msg);
 };
 
 } // namespace server
@@ -5,28 +5,33 @@
 #include "server/session.h"
 #include "server/repository/game_repository.h"
 #include "server/repository/result_repository.h"
+#include "server/catalog_versions.h"
 #include <memory>
 #include <string>
 
 namespace server {
 
+class Connection;
+
 class GameController {
 private:
     std::shared_ptr<SessionManager> sessionManager;
     std::shared_ptr<GameRepository> gameRepository;
     std::shared_ptr<ResultRepository> resultRepository;
+    std::shared_ptr<CatalogVersions> catalogVersions;
 
-    bool sendMessage(int clientFd, const protocol::Message& msg);
+    bool sendMessage(Connection& conn, const protocol::Message& msg);
 
 public:
     GameController(std::shared_ptr<SessionManager> sm, 
                    std::shared_ptr<GameRepository> gr,
-                   std::shared_ptr<ResultRepository> rr);
+                   std::shared_ptr<ResultRepository> rr,
+                   std::shared_ptr<CatalogVersions> cv);
 
-    void handleGameListRequest(int clientFd, const protocol::Message& msg);
-    void handleGameLevelListRequest(int clientFd, const protocol::Message& msg);
-    void handleGameDataRequest(int clientFd, const protocol::Message& msg);
-    void handleGameSubmitRequest(int clientFd, const protocol::Message& msg);
+    void handleGameListRequest(Connection& conn, const protocol::Message& msg);
+    void handleGameLevelListRequest(Connection& conn, const protocol::Message& msg);
+    void handleGameDataRequest(Connection& conn, const protocol::Message& msg);
+    void handleGameSubmitRequest(Connection& conn, const protocol::Message& msg);
 };
 
 } // namespace server
@@ -3,12 +3,16 @@
 
 #include "common/protocol.h"
 #include "server/session.h"
+#include "server/connection_manager.h"
 #include "server/repository/lesson_repository.h"
+#include "server/catalog_versions.h"
 #include <memory>
 #include <string>
 
 namespace server {
 
+class Connection;
+
 /**
  * LessonController - Handles lesson-related messages from clients
  *
@@ -19,9 +23,11 @@ class LessonController {
 private:
     std::shared_ptr<SessionManager> sessionManager;
     std::shared_ptr<LessonRepository> lessonRepository;
+    std::shared_ptr<CatalogVersions> catalogVersions;
+    std::shared_ptr<ConnectionManager> connectionManager; // Studying a lesson subscribes to its topic
 
     // Helper function to send a message to a client
-    bool sendMessage(int clientFd, const protocol::Message& msg);
+    bool sendMessage(Connection& conn, const protocol::Message& msg);
     
     // Helper to parse lesson type string
     LessonType parseLessonType(const std::string& typeStr);
@@ -31,8 +37,11 @@ public:
      * Constructor
      * @param sm - Shared pointer to SessionManager for token validation
      * @param lr - Shared pointer to LessonRepository for database operations
+     * @param cv - Catalog versions for conditional fetch (NOT_MODIFIED)
+     * @param cm - ConnectionManager for lesson topic subscriptions
      */
-    LessonController(std::shared_ptr<SessionManager> sm, std::shared_ptr<LessonRepository> lr);
+    LessonController(std::shared_ptr<SessionManager> sm, std::shared_ptr<LessonRepository> lr,
+                     std::shared_ptr<CatalogVersions> cv, std::shared_ptr<ConnectionManager> cm);
 
     /**
      * Handle LESSON_LIST_REQUEST message
@@ -52,10 +61,10 @@ public:
      * 7. Send LESSON_LIST_SUCCESS with serialized data
      * 8. On error, send LESSON_LIST_FAILURE
      * 
-     * @param clientFd - Client socket file descriptor
+     * @param conn - Client connection
      * @param msg - Incoming message from client
      */
-    void handleUserLessonListRequest(int clientFd, const protocol::Message& msg);
+    void handleUserLessonListRequest(Connection& conn, const protocol::Message& msg);
 
     /**
      * Handle STUDY_LESSON_REQUEST message
@@ -73,10 +82,10 @@ public:
      * 5. Send STUDY_LESSON_SUCCESS with serialized content
      * 6. On error, send STUDY_LESSON_FAILURE
      * 
-     * @param clientFd - Client socket file descriptor
+     * @param conn - Client connection
      * @param msg - Incoming message from client
      */
-    void handleUserStudyLessonRequest(int clientFd, const protocol::Message& msg);
+    void handleUserStudyLessonRequest(Connection& conn, const protocol::Message& msg);
 };
 
 } // namespace server
@@ -9,21 +9,22 @@
 
 namespace server {
 
+class Connection;
+
 class ResultController {
 private:
     std::shared_ptr<SessionManager> sessionManager;
     std::shared_ptr<ResultRepository> resultRepo;
 
-    bool sendMessage(int clientFd, const protocol::Message& msg);
+    bool sendMessage(Connection& conn, const protocol::Message& msg);
 
 public:
     ResultController(std::shared_ptr<SessionManager> sessionMgr, 
                   std::shared_ptr<ResultRepository> repo);
 
-    void handleStudentResultRequest(int clientFd, const protocol::Message& msg);
-    void handleStudentResultListRequest(int clientFd, const protocol::Message& msg);
-    void handleStudentResultDetailRequest(int clientFd, const protocol::Message& msg);
-    void handleTeacherPendingSubmissionsRequest(int clientFd, const protocol::Message& msg);
+    void handleStudentResultRequest(Connection& conn, const protocol::Message& msg);
+    void handleStudentResultListRequest(Connection& conn, const protocol::Message& msg);
+    void handleStudentResultDetailRequest(Connection& conn, const protocol::Message& msg);
 };
 
 } // namespace server
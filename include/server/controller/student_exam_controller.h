@@ -5,29 +5,34 @@
 #include "server/session.h"
 #include "server/repository/exam_repository.h"
 #include "server/repository/result_repository.h"
+#include "server/catalog_versions.h"
 #include <memory>
 #include <string>
 
 namespace server {
 
+class Connection;
+
 class StudentExamController {
 private:
     std::shared_ptr<SessionManager> sessionManager;
     std::shared_ptr<ExamRepository> examRepository;
     std::shared_ptr<ResultRepository> resultRepository;
+    std::shared_ptr<CatalogVersions> catalogVersions;
 
-    bool sendMessage(int clientFd, const protocol::Message& msg);
+    bool sendMessage(Connection& conn, const protocol::Message& msg);
 
 public:
     StudentExamController(std::shared_ptr<SessionManager> sessionMgr, 
                           std::shared_ptr<ExamRepository> examRepo,
-                          std::shared_ptr<ResultRepository> resultRepo);
+                          std::shared_ptr<ResultRepository> resultRepo,
+                          std::shared_ptr<CatalogVersions> catalogVersions);
 
     // Student gets list of exams
-    void handleGetExams(int clientFd, const protocol::Message& msg);
+    void handleGetExams(Connection& conn, const protocol::Message& msg);
     
     // Student requests exam content (with "already taken" check)
-    void handleExamRequest(int clientFd, const protocol::Message& msg);
+    void handleExamRequest(Connection& conn, const protocol::Message& msg);
 };
 
 } // namespace server
@@ -11,6 +11,8 @@
 
 namespace server {
 
+class Connection;
+
 class SubmissionController {
 private:
     std::shared_ptr<SessionManager> sessionManager;
@@ -18,7 +20,7 @@ private:
     std::shared_ptr<ExerciseRepository> exerciseRepo;
     std::shared_ptr<ExamRepository> examRepo;
 
-    bool sendMessage(int clientFd, const protocol::Message& msg);
+    bool sendMessage(Connection& conn, const protocol::Message& msg);
 
 public:
     SubmissionController(std::shared_ptr<SessionManager> sessionMgr, 
@@ -26,8 +28,8 @@ public:
                       std::shared_ptr<ExerciseRepository> exerciseRepo,
                       std::shared_ptr<ExamRepository> examRepo);
 
-    void handleStudentSubmission(int clientFd, const protocol::Message& msg);
-    void handleTeacherGradeSubmission(int clientFd, const protocol::Message& msg);
+    void handleStudentSubmission(Connection& conn, const protocol::Message& msg);
+    void handleTeacherGradeSubmission(Connection& conn, const protocol::Message& msg);
 };
 
 } // namespace server
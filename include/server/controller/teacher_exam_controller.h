@@ -9,19 +9,21 @@
 
 namespace server {
 
+class Connection;
+
 class TeacherExamController {
 private:
     std::shared_ptr<SessionManager> sessionManager;
     std::shared_ptr<ExamRepository> examRepository;
 
-    bool sendMessage(int clientFd, const protocol::Message& msg);
+    bool sendMessage(Connection& conn, const protocol::Message& msg);
 
 public:
     TeacherExamController(std::shared_ptr<SessionManager> sessionMgr, 
                           std::shared_ptr<ExamRepository> examRepo);
 
     // Teacher views exam content (no "already taken" check - for grading)
-    void handleExamReview(int clientFd, const protocol::Message& msg);
+    void handleExamReview(Connection& conn, const protocol::Message& msg);
 };
 
 } // namespace server
@@ -10,7 +10,7 @@ namespace server {
 class UserRepository;
 class SessionManager;
 class ConnectionManager;
-class ClientHandler;
+class Connection;
 
 class UserController {
 public:
@@ -18,16 +18,16 @@ public:
                    std::shared_ptr<SessionManager> sessionMgr,
                    std::shared_ptr<ConnectionManager> connMgr);
 
-    void handleUserLoginRequest(int clientFd, const protocol::Message& msg, ClientHandler* clientHandler);
-    void handleUserLogoutRequest(int clientFd, const protocol::Message& msg);
-    void handleUserRegisterRequest(int clientFd, const protocol::Message& msg);
+    void handleUserLoginRequest(Connection& conn, const protocol::Message& msg);
+    void handleUserLogoutRequest(Connection& conn, const protocol::Message& msg);
+    void handleUserRegisterRequest(Connection& conn, const protocol::Message& msg);
 
 private:
     std::shared_ptr<UserRepository> userRepo;
     std::shared_ptr<SessionManager> sessionMgr;
     std::shared_ptr<ConnectionManager> connMgr;
 
-    void sendMessage(int clientFd, const protocol::Message& msg);
+    void sendMessage(Connection& conn, const protocol::Message& msg);
 };
 
 } // namespace server
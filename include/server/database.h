@@ -4,6 +4,8 @@
 #include <string>
 #include <postgresql/libpq-fe.h>
 #include <mutex>
+#include <functional>
+#include <vector>
 
 namespace server {
 
@@ -13,6 +15,16 @@ private:
     std::string connInfo;
     std::mutex dbMutex;
 
+    // forEachRow() runs on connections of its own, so onRow never holds
+    // dbMutex. One is opened per concurrent stream (at most one per worker
+    // thread) and a few idle ones are kept for reuse.
+    std::vector<PGconn*> idleStreamConnections;
+    std::mutex streamMutex;
+    static constexpr size_t MAX_IDLE_STREAM_CONNECTIONS = 2;
+
+    PGconn* acquireStreamConnection();
+    void releaseStreamConnection(PGconn* streamConn);
+
 public:
     Database(const std::string& conninfo);
     ~Database();
@@ -27,6 +39,14 @@ public:
     // Prepared statement support
     PGresult* execParams(const std::string& sql, int nParams, const char* const* paramValues);
 
+    // Run a query in libpq single-row mode, calling onRow with a one-row result
+    // per row as it arrives, so the full result set is never held in memory.
+    // onRow returns false to stop early (remaining rows are discarded).
+    // The query runs on a streaming connection, not the shared one, so other
+    // queries proceed while onRow writes. Returns false if the query failed.
+    bool forEachRow(const std::string& sql, int nParams, const char* const* paramValues,
+                    const std::function<bool(PGresult* row)>& onRow);
+
     void printResult(PGresult* res);
     
     std::mutex& getMutex() { return dbMutex; }
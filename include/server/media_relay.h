@@ -0,0 +1,108 @@
+#ifndef SERVER_MEDIA_RELAY_H
+#define SERVER_MEDIA_RELAY_H
+
+#include <netinet/in.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace server {
+
+// UDP relay for voice call audio. Each answered call gets a relay session with
+// one token per party; datagrams (see common/media_packet.h) are authenticated
+// by token, the sender's address is latched (so peers behind NAT work), and
+// packets are forwarded to the other party through a small reordering buffer.
+// Runs on its own thread; allocate/release are called from the event loop.
+class MediaRelay {
+public:
+    struct Allocation {
+        uint32_t sessionId = 0; // 0 means allocation failed
+        uint64_t callerToken = 0;
+        uint64_t calleeToken = 0;
+        int port = 0;
+    };
+
+    struct LegStats {
+        uint64_t received = 0;
+        uint64_t forwarded = 0;
+        uint64_t lost = 0;   // Sequence gaps skipped by the jitter buffer
+        uint64_t late = 0;   // Arrived after their slot was played out (incl. duplicates)
+        uint64_t noPeer = 0; // Dropped because the other party has not registered yet
+    };
+
+    static constexpr size_t JITTER_SLOTS = 8;
+    static constexpr int JITTER_HOLD_MS = 40;
+    static constexpr int SESSION_IDLE_TIMEOUT_SECONDS = 30;
+
+    explicit MediaRelay(int port);
+    ~MediaRelay();
+
+    MediaRelay(const MediaRelay&) = delete;
+    MediaRelay& operator=(const MediaRelay&) = delete;
+
+    bool start();
+    void stop();
+    int getPort() const { return port; }
+
+    Allocation allocate();
+    void release(uint32_t sessionId);
+
+    // Sessions torn down for inactivity since the last call (for signaling cleanup)
+    std::vector<uint32_t> takeExpiredSessions();
+
+private:
+    struct JitterBuffer {
+        struct Slot {
+            bool used = false;
+            uint16_t sequence = 0;
+            std::vector<uint8_t> payload;
+            std::chrono::steady_clock::time_point arrival;
+        };
+
+        bool started = false;
+        uint16_t expected = 0;
+        size_t buffered = 0;
+        std::array<Slot, JITTER_SLOTS> slots;
+    };
+
+    struct Leg {
+        uint64_t token = 0;
+        bool hasAddress = false;
+        sockaddr_in address{};
+        JitterBuffer jitter; // Packets from this leg waiting to go to the other leg
+        LegStats stats;
+    };
+
+    struct Session {
+        Leg legs[2]; // 0 = caller, 1 = callee
+        std::chrono::steady_clock::time_point lastActivity;
+    };
+
+    int port;
+    int sock;
+    std::atomic<bool> running;
+    std::thread worker;
+
+    std::mutex mutex;
+    std::unordered_map<uint32_t, Session> sessions;
+    std::vector<uint32_t> expired;
+
+    void run();
+    void handleDatagram(uint8_t* data, size_t len, const sockaddr_in& from,
+                        std::chrono::steady_clock::time_point now);
+    void sendToPeer(Session& session, int fromLeg, const uint8_t* data, size_t len);
+    void drain(Session& session, int fromLeg);
+    void skipToOldest(Session& session, int fromLeg);
+    void flushJitterBuffers(std::chrono::steady_clock::time_point now);
+    void expireIdleSessions(std::chrono::steady_clock::time_point now);
+    void logSessionStats(uint32_t sessionId, const Session& session, const char* reason);
+};
+
+} // namespace server
+
+#endif // SERVER_MEDIA_RELAY_H
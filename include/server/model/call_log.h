@@ -0,0 +1,35 @@
+#ifndef SERVER_MODEL_CALL_LOG_H
+#define SERVER_MODEL_CALL_LOG_H
+
+#include <ctime>
+#include <string>
+
+namespace server {
+
+// One row of call_logs. Times are Unix seconds; status is one of
+// COMPLETED, MISSED, BUSY, DECLINED, FAILED (see init_db.sql).
+class CallLog {
+private:
+    int callerId;
+    int receiverId;
+    std::time_t startTime;
+    std::time_t endTime;
+    std::string status;
+    int duration;
+
+public:
+    CallLog() : callerId(-1), receiverId(-1), startTime(0), endTime(0), duration(0) {}
+    CallLog(int callerId, int receiverId, std::time_t startTime, std::time_t endTime, const std::string& status, int duration)
+        : callerId(callerId), receiverId(receiverId), startTime(startTime), endTime(endTime), status(status), duration(duration) {}
+
+    int getCallerId() const { return callerId; }
+    int getReceiverId() const { return receiverId; }
+    std::time_t getStartTime() const { return startTime; }
+    std::time_t getEndTime() const { return endTime; }
+    std::string getStatus() const { return status; }
+    int getDuration() const { return duration; }
+};
+
+} // namespace server
+
+#endif // SERVER_MODEL_CALL_LOG_H
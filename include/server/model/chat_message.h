@@ -1,6 +1,7 @@
 #ifndef SERVER_MODEL_CHAT_MESSAGE_H
 #define SERVER_MODEL_CHAT_MESSAGE_H
 
+#include "common/payloads.h"
 #include <string>
 
 namespace server {
@@ -35,6 +36,13 @@ public:
     void setMessageType(const std::string& messageType) { this->messageType = messageType; }
     void setTimestamp(const std::string& timestamp) { this->timestamp = timestamp; }
     void setIsRead(bool isRead) { this->isRead = isRead; }
+
+    // The other side of the conversation, as seen by userId
+    int otherParticipant(int userId) const { return senderId == userId ? receiverId : senderId; }
+
+    // userId's recent-chats entry for this message; otherUsername names
+    // otherParticipant(userId)
+    Payloads::RecentChatDTO toRecentChatDTO(int userId, const std::string& otherUsername) const;
 };
 
 } // namespace server
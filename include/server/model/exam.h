@@ -58,6 +58,17 @@ public:
     Payloads::ExamMetadataDTO toMetadataDTO() const;
 };
 
+// The columns an exam list shows, loaded without the questions
+struct ExamMetadata {
+    int examId = -1;
+    int lessonId = -1;
+    std::string title;
+    std::string type;
+    std::string level;
+
+    Payloads::ExamMetadataDTO toDTO() const;
+};
+
 // Container for multiple exams with filtering capabilities
 class ExamList {
 private:
@@ -85,6 +85,17 @@ public:
     Payloads::ExerciseMetadataDTO toMetadataDTO() const;
 };
 
+// The columns an exercise list shows, loaded without the questions
+struct ExerciseMetadata {
+    int exerciseId = -1;
+    int lessonId = -1;
+    std::string title;
+    std::string type;
+    std::string level;
+
+    Payloads::ExerciseMetadataDTO toDTO() const;
+};
+
 // Container for multiple exercises with filtering capabilities
 class ExerciseList {
 private:
@@ -70,6 +70,16 @@ public:
     Payloads::LessonMetadataDTO toMetadataDTO() const;
 };
 
+// The columns a lesson list shows, loaded without the lesson content
+struct LessonMetadata {
+    int lessonId = -1;
+    std::string title;
+    std::string topic;
+    std::string level;
+
+    Payloads::LessonMetadataDTO toDTO() const;
+};
+
 // Container for multiple lessons with filtering capabilities
 class LessonList {
 private:
@@ -0,0 +1,68 @@
+#ifndef SERVER_OUTBOX_H
+#define SERVER_OUTBOX_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace server {
+
+// Frames bound for one connection, pushed from any thread and written by the
+// event loop that owns the socket. Producers never lock: a push is one
+// compare-and-swap onto a stack, and the single consumer takes the whole
+// stack with one exchange and restores arrival order. Frames are shared, so a
+// push fanned out to several sessions is serialised once.
+class Outbox {
+public:
+    using Frame = std::shared_ptr<const std::vector<uint8_t>>;
+
+    Outbox() = default;
+    ~Outbox();
+
+    Outbox(const Outbox&) = delete;
+    Outbox& operator=(const Outbox&) = delete;
+
+    // Any thread. Returns true if the outbox was empty, i.e. whoever drains it
+    // has to be woken.
+    bool push(Frame frame);
+
+    // Owner only: every frame pushed so far, oldest first
+    std::vector<Frame> take();
+
+    bool empty() const { return head.load(std::memory_order_acquire) == nullptr; }
+
+private:
+    struct Node {
+        Frame frame;
+        Node* next;
+    };
+
+    std::atomic<Node*> head{nullptr}; // Newest first
+};
+
+// An eventfd the event loop selects on, so pushes from worker threads wake it
+// without waiting for the select() timeout. Any number of notify() calls
+// before clear() wake it once, and only the first makes a syscall, so a
+// fan-out to thousands of connections costs one write. notify() is
+// async-signal-safe, so Server::stop() uses it from the signal handler.
+class Wakeup {
+public:
+    Wakeup();
+    ~Wakeup();
+
+    Wakeup(const Wakeup&) = delete;
+    Wakeup& operator=(const Wakeup&) = delete;
+
+    int fd() const { return eventFd; }
+    void notify();
+    void clear();
+
+private:
+    int eventFd;
+    std::atomic<bool> signalled{false};
+};
+
+} // namespace server
+
+#endif // SERVER_OUTBOX_H
@@ -0,0 +1,63 @@
+#ifndef REPLY_CONTEXT_H
+#define REPLY_CONTEXT_H
+
+#include <cstdint>
+#include <sys/types.h>
+#include <vector>
+
+#include "common/protocol.h"
+#include "server/connection.h"
+
+namespace server {
+
+// Marks the request this thread is handling so replies can echo its
+// correlation id (v2 frames). Only frames written back to the requesting
+// connection through sendReply() carry the id; pushes to other users never
+// do. Replies are compressed, streamed (ResponseStream), held to the frame
+// limit and queued according to what the connection negotiated.
+class ReplyScope {
+private:
+    Connection* previousConnection;
+    uint32_t previousId;
+
+public:
+    ReplyScope(Connection& connection, uint32_t correlationId);
+    ~ReplyScope();
+    ReplyScope(const ReplyScope&) = delete;
+    ReplyScope& operator=(const ReplyScope&) = delete;
+};
+
+// While alive, replies to conn are appended to `frames` instead of being
+// queued for the socket (BATCH_REQUEST collects its sub-responses this way)
+class ReplyCapture {
+private:
+    Connection* previousConnection;
+    std::vector<uint8_t>* previousFrames;
+
+public:
+    ReplyCapture(Connection& conn, std::vector<uint8_t>& frames);
+    ~ReplyCapture();
+    ReplyCapture(const ReplyCapture&) = delete;
+    ReplyCapture& operator=(const ReplyCapture&) = delete;
+};
+
+// Serialize msg for conn, stamping the current request's correlation id
+// when conn is the requester and msg has none of its own, and compressing
+// it if the requester negotiated that
+std::vector<uint8_t> frameReply(Connection& conn, const protocol::Message& msg);
+
+// Whether replies to conn may be sent as STREAM_START/CHUNK/END: it is the
+// requester, negotiated "chunked", and no capture (batch) is open
+bool replyAcceptsChunks(Connection& conn);
+
+// Frame msg with frameReply() and queue it for conn: on its outbox (sent at
+// the end of the loop pass) or into the open capture. Only the requester is
+// answered this way; output for other connections goes through
+// ConnectionManager's pushes. A reply larger than the requester's frame
+// limit is replaced by GENERAL_FAILURE. Returns the bytes accepted, or -1 on
+// error.
+ssize_t sendReply(Connection& conn, const protocol::Message& msg);
+
+} // namespace server
+
+#endif // REPLY_CONTEXT_H
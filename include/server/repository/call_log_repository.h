@@ -0,0 +1,24 @@
+#ifndef SERVER_REPOSITORY_CALL_LOG_REPOSITORY_H
+#define SERVER_REPOSITORY_CALL_LOG_REPOSITORY_H
+
+#include "server/database.h"
+#include "server/model/call_log.h"
+#include <memory>
+#include <vector>
+
+namespace server {
+
+class CallLogRepository {
+private:
+    std::shared_ptr<Database> db;
+
+public:
+    explicit CallLogRepository(std::shared_ptr<Database> db);
+
+    // Insert all entries in a single statement
+    bool saveCallLogs(const std::vector<CallLog>& logs);
+};
+
+} // namespace server
+
+#endif // SERVER_REPOSITORY_CALL_LOG_REPOSITORY_H
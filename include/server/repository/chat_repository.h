@@ -6,6 +6,7 @@
 #include <vector>
 #include <memory>
 #include <optional>
+#include <utility>
 
 namespace server {
 
@@ -26,8 +27,18 @@ public:
     // Returns a list of ChatMessage where each message represents the last interaction with a unique user
     std::vector<ChatMessage> getRecentChats(int userId);
 
+    // Messages to receiverId not yet delivered (offline outbox), oldest first
+    std::vector<ChatMessage> getUndeliveredMessages(int receiverId, int limit);
+
     // Mark messages as read
     void markMessagesAsRead(int senderId, int receiverId);
+
+    // Bulk variant: each pair is (senderId, receiverId); one statement per call
+    void markMessagesAsRead(const std::vector<std::pair<int, int>>& conversations);
+
+    // Bulk delivery acknowledgement: each pair is (receiverId, messageId);
+    // ids not addressed to that receiver are left alone
+    void markMessagesAsDelivered(const std::vector<std::pair<int, int>>& deliveries);
 };
 
 } // namespace server
@@ -2,6 +2,7 @@
 #define EXAM_LOADER_H
 
 #include "server/database.h"
+#include "server/single_flight.h"
 #include "server/model/exam.h"
 #include "common/payloads.h"
 #include <string>
@@ -15,21 +16,22 @@ namespace server {
 class ExamRepository {
 private:
     std::shared_ptr<Database> db;
+    SingleFlight<int, Exam> byIdLoads; // Concurrent requests for one id share a load
     bool parseExamFromRow(PGresult* result, int row, Exam& exam) const;
     // Helper to parse JSON array from PostgreSQL JSONB field
     std::vector<Question> parseQuestions(const std::string& jsonStr) const;
 
+    Exam fetchExamById(int examId);
+
 public:
     ExamRepository(std::shared_ptr<Database> database);
 
-    // Load all exams from database
-    ExamList loadAllExams();
-
     // Load a specific exam by ID with full content
     Exam loadExamById(int examId);
 
-    // Load exams filtered by lesson ID, type, and/or level
-    ExamList loadExamsByFilter(int lessonId, const std::string& type, const std::string& level);
+    // List view: id, lesson, title, type and level only, in the same order,
+    // without reading or parsing the questions. -1 / empty means no filter.
+    std::vector<ExamMetadata> loadExamMetadata(int lessonId, const std::string& type, const std::string& level);
 };
 
 } // namespace server
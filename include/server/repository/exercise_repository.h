@@ -2,6 +2,7 @@
 #define EXERCISE_LOADER_H
 
 #include "server/database.h"
+#include "server/single_flight.h"
 #include "server/model/exercise.h"
 #include "common/payloads.h"
 #include <string>
@@ -15,21 +16,22 @@ namespace server {
 class ExerciseRepository {
 private:
     std::shared_ptr<Database> db;
+    SingleFlight<int, Exercise> byIdLoads; // Concurrent requests for one id share a load
     bool parseExerciseFromRow(PGresult* result, int row, Exercise& exercise) const;
     // Helper to parse JSON array from PostgreSQL JSONB field
     std::vector<Question> parseQuestions(const std::string& jsonStr) const;
 
+    Exercise fetchExerciseById(int exerciseId);
+
 public:
     ExerciseRepository(std::shared_ptr<Database> database);
 
-    // Load all exercises
-    ExerciseList loadAllExercises();
-
     // Load a specific exercise by ID
     Exercise loadExerciseById(int exerciseId);
 
-    // Load exercises filtered by lesson ID, type, and/or level
-    ExerciseList loadExercisesByFilter(int lessonId, const std::string& type, const std::string& level);
+    // List view: id, lesson, title, type and level only, in the same order,
+    // without reading or parsing the questions. -1 / empty means no filter.
+    std::vector<ExerciseMetadata> loadExerciseMetadata(int lessonId, const std::string& type, const std::string& level);
 };
 
 } // namespace server
@@ -5,6 +5,7 @@
 #include <vector>
 #include <string>
 #include "server/database.h"
+#include "server/single_flight.h"
 #include "server/model/game.h"
 #include <postgresql/libpq-fe.h>
 
@@ -25,7 +26,9 @@ public:
 
 private:
     std::shared_ptr<Database> db;
+    SingleFlight<int, Game> byIdLoads; // Concurrent requests for one id share a load
     bool parseGameFromRow(PGresult* result, int row, Game& game) const;
+    Game fetchGameById(int id);
 };
 
 } // namespace server
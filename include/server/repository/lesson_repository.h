@@ -2,6 +2,7 @@
 #define LESSON_REPOSITORY_H
 
 #include "server/database.h"
+#include "server/single_flight.h"
 #include "server/model/lesson.h"
 #include "common/payloads.h"
 #include <string>
@@ -15,21 +16,22 @@ namespace server {
 class LessonRepository {
 private:
     std::shared_ptr<Database> db;
+    SingleFlight<int, Lesson> byIdLoads; // Concurrent requests for one id share a load
     bool parseLessonFromRow(PGresult* result, int row, Lesson& lesson) const;
     // Helper to parse JSON array from PostgreSQL JSONB field
     std::vector<std::string> parseJsonArray(const std::string& jsonStr) const;
 
+    Lesson fetchLessonById(int lessonId);
+
 public:
     LessonRepository(std::shared_ptr<Database> database);
 
-    // Load all lessons from database
-    LessonList loadAllLessons();
-
     // Load a specific lesson by ID with full content
     Lesson loadLessonById(int lessonId);
 
-    // Load lessons filtered by topic and/or level
-    LessonList loadLessonsByFilter(const std::string& topic, const std::string& level);
+    // List view: id, title, topic and level only, in the same order, without
+    // reading the lesson content. Empty means no filter.
+    std::vector<LessonMetadata> loadLessonMetadata(const std::string& topic, const std::string& level);
 };
 
 } // namespace server
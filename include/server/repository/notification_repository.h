@@ -0,0 +1,44 @@
+#ifndef SERVER_REPOSITORY_NOTIFICATION_REPOSITORY_H
+#define SERVER_REPOSITORY_NOTIFICATION_REPOSITORY_H
+
+#include "server/database.h"
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace server {
+
+// Notifications for users who were offline (missed calls, grades). They wait
+// in offline_notifications until the client acknowledges the digest frame
+// that carried them, so neither a restart nor a lost frame drops one.
+class NotificationRepository {
+private:
+    std::shared_ptr<Database> db;
+
+public:
+    struct Notification {
+        int id;
+        std::string content;
+        std::string createdAt;
+    };
+
+    // Oldest dropped beyond this many per user
+    static constexpr int MAX_PER_USER = 50;
+
+    explicit NotificationRepository(std::shared_ptr<Database> db);
+
+    // Store a notification for userId. Returns its id, or -1 on failure.
+    int save(int userId, const std::string& content);
+
+    // userId's notifications, oldest first
+    std::vector<Notification> getPending(int userId);
+
+    // Bulk removal: each pair is (userId, notificationId); ids not
+    // belonging to that user are left alone
+    void remove(const std::vector<std::pair<int, int>>& notifications);
+};
+
+} // namespace server
+
+#endif // SERVER_REPOSITORY_NOTIFICATION_REPOSITORY_H
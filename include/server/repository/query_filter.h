@@ -0,0 +1,54 @@
+#ifndef SERVER_REPOSITORY_QUERY_FILTER_H
+#define SERVER_REPOSITORY_QUERY_FILTER_H
+
+#include "server/database.h"
+#include <string>
+#include <vector>
+
+namespace server {
+
+// Optional "column = value" filters of a list query. Each filter that is set
+// adds its condition and its parameter together, so the $n placeholders
+// always match the parameter array.
+class QueryFilter {
+private:
+    std::vector<std::string> values;
+    std::vector<std::string> conditions;
+
+public:
+    // Skipped when value is empty
+    QueryFilter& equals(const std::string& column, const std::string& value) {
+        if (value.empty()) return *this;
+        values.push_back(value);
+        conditions.push_back(column + " = $" + std::to_string(values.size()));
+        return *this;
+    }
+
+    // Skipped when value is -1
+    QueryFilter& equals(const std::string& column, int value) {
+        return value == -1 ? *this : equals(column, std::to_string(value));
+    }
+
+    // " WHERE a = $1 AND b = $2", or empty when no filter is set
+    std::string where() const {
+        std::string clause;
+        for (size_t i = 0; i < conditions.size(); ++i) {
+            clause += (i == 0 ? " WHERE " : " AND ") + conditions[i];
+        }
+        return clause;
+    }
+
+    // Run select + where() + suffix (e.g. an ORDER BY) with the filter values
+    PGresult* exec(Database& db, const std::string& select, const std::string& suffix) const {
+        std::vector<const char*> params;
+        params.reserve(values.size());
+        for (const auto& value : values) {
+            params.push_back(value.c_str());
+        }
+        return db.execParams(select + where() + suffix, static_cast<int>(params.size()), params.data());
+    }
+};
+
+} // namespace server
+
+#endif // SERVER_REPOSITORY_QUERY_FILTER_H
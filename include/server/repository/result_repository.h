@@ -2,16 +2,46 @@
 #define SERVER_REPOSITORY_RESULT_REPOSITORY_H
 
 #include "server/database.h"
+#include "server/attempt_index.h"
 #include "common/payloads.h"
+#include <functional>
 #include <memory>
 #include <vector>
 #include <string>
 
 namespace server {
 
+// Which submissions forEachSubmission() visits, and where the page starts.
+// Empty strings and -1 match everything.
+struct SubmissionFilter {
+    static constexpr size_t DEFAULT_LIMIT = 100;
+    static constexpr size_t MAX_LIMIT = 500;
+
+    std::string status;
+    std::string targetType;
+    int targetId = -1;
+    std::string student; // Username
+    std::string from;    // submitted_at >= from
+    std::string to;      // submitted_at < to
+    size_t limit = DEFAULT_LIMIT;
+
+    // Keyset cursor: the sort key of the last row already seen
+    bool hasCursor = false;
+    std::string afterStatus;
+    std::string afterSubmittedAt;
+    int afterResultId = 0;
+
+    // Parse a Payloads::submissionCursor() string; false if malformed
+    bool setCursor(const std::string& cursor);
+};
+
 class ResultRepository {
 private:
     std::shared_ptr<Database> db;
+    AttemptIndex examAttempts; // Answers hasResult(.., "exam", ..) negatives without a query
+
+    // Read every user with a result for examId into examAttempts
+    void loadExamAttempts(int examId);
 
 public:
     ResultRepository(std::shared_ptr<Database> database);
@@ -22,7 +52,9 @@ public:
                    const std::string& feedback, const std::string& status);
 
     // Update an existing result (for grading)
-    bool updateResult(int resultId, double score, const std::string& feedback, const std::string& status, const std::string& gradingDetails = "");
+    // studentId, if given, receives the owner of the updated result
+    bool updateResult(int resultId, double score, const std::string& feedback, const std::string& status,
+                      const std::string& gradingDetails = "", int* studentId = nullptr);
 
     // Get a specific result
     bool getResult(int userId, const std::string& targetType, int targetId, 
@@ -31,11 +63,13 @@ public:
     // Get all results for a user and target type
     std::vector<Payloads::ResultSummaryDTO> getResultsByUser(int userId, const std::string& targetType);
 
-    // Get pending submissions for teachers (legacy)
-    std::vector<Payloads::PendingSubmissionDTO> getPendingSubmissions();
-
-    // Get all submissions for teacher review (using SubmissionDTO)
-    std::vector<Payloads::SubmissionDTO> getSubmissions();
+    // Visit one page of submissions for teacher review (pending first, newest
+    // first) matching filter, as rows arrive from the database. The page starts
+    // after the filter's cursor, so its cost does not grow with the history.
+    // onRow gets the page's row count with each row and returns false to stop.
+    // Returns the number of rows visited, or -1 if the query failed.
+    long forEachSubmission(const SubmissionFilter& filter,
+                           const std::function<bool(size_t total, const Payloads::SubmissionDTO&)>& onRow);
 
     // Add feedback to a result
     bool addFeedback(int resultId, const std::string& feedbackContent, const std::string& feedbackType);
@@ -43,7 +77,7 @@ public:
     // Get detailed result
     bool getResultDetail(int userId, const std::string& targetType, int targetId, Payloads::ResultDetailDTO& detail);
 
-    // Check if result exists
+    // Check if result exists. For exams a "no" usually comes from memory.
     bool hasResult(int userId, const std::string& targetType, int targetId);
 };
 
@@ -5,10 +5,11 @@
 #include "server/connection_manager.h"
 #include "server/database.h"
 #include "server/repository/result_repository.h"
-#include "server/middleware.h"
+#include "server/media_relay.h"
 #include "common/protocol.h"
+#include <cstdint>
 #include <memory>
-#include <vector>
+#include <string>
 
 namespace server {
 
@@ -23,7 +24,8 @@ class TeacherExamController;
 class FeedbackController;
 class GameController;
 class AdminGameController;
-class ClientHandler;
+class BlobController;
+class Connection;
 
 class RequestRouter {
 private:
@@ -32,9 +34,6 @@ private:
     std::shared_ptr<Database> db;
     std::shared_ptr<ResultRepository> resultRepo;
 
-    // Middlewares
-    std::vector<std::shared_ptr<Middleware>> middlewares;
-
     // Controllers
     std::shared_ptr<UserController> userController;
     std::shared_ptr<ChatController> chatController;
@@ -47,17 +46,44 @@ private:
     std::shared_ptr<FeedbackController> feedbackController;
     std::shared_ptr<GameController> gameController;
     std::shared_ptr<AdminGameController> adminGameController;
+    std::shared_ptr<BlobController> blobController;
+
+    using Handler = void (RequestRouter::*)(Connection& conn, const protocol::Message& msg);
+
+    // How one request code is handled and who may send it. The table is
+    // constant and indexed by code, so routing a request is one lookup and
+    // its permission check one mask test against the connection's role.
+    struct Route {
+        protocol::MsgCode code;
+        Handler handler;
+        bool requiresAuth;
+        uint8_t allowedRoles; // roles:: bits, checked only once authenticated
+        bool batchable;
+    };
+    static const Route routes[];
+    static const Route* findRoute(protocol::MsgCode code);
+
+    // Handler for routes served by a controller: (this->*Controller)->*Method
+    template <auto Controller, auto Method>
+    void invoke(Connection& conn, const protocol::Message& msg);
+
+    void sendErrorResponse(Connection& conn, protocol::MsgCode code, const std::string& message, bool binary);
+    void handleHello(Connection& conn, const protocol::Message& msg);
+    void handleCodecSelect(Connection& conn, const protocol::Message& msg);
+    void handleBatch(Connection& conn, const protocol::Message& msg);
+    void handleLogin(Connection& conn, const protocol::Message& msg);
 
-    void sendErrorResponse(int clientFd, protocol::MsgCode code, const std::string& message);
+    // Returns false (after replying with the error) if conn may not send msg
+    bool authorize(Connection& conn, const Route& route, const protocol::Message& msg);
 
 public:
     RequestRouter(std::shared_ptr<SessionManager> sessionMgr,
                   std::shared_ptr<ConnectionManager> connMgr,
                   std::shared_ptr<Database> database,
-                  std::shared_ptr<ResultRepository> resultRepo);
+                  std::shared_ptr<ResultRepository> resultRepo,
+                  std::shared_ptr<MediaRelay> mediaRelay);
 
-    void registerMiddleware(std::shared_ptr<Middleware> middleware);
-    void handleMessage(int clientFd, const protocol::Message& msg, ClientHandler* clientHandler = nullptr);
+    void handleMessage(Connection& conn, const protocol::Message& msg);
 
     // Periodic tasks
     void processTimeouts();
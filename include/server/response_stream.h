@@ -0,0 +1,59 @@
+#ifndef SERVER_RESPONSE_STREAM_H
+#define SERVER_RESPONSE_STREAM_H
+
+#include "common/protocol.h"
+#include "server/connection.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace server {
+
+// Builds a response payload incrementally. Handlers write the payload in
+// pieces (typically one list item at a time, see Payloads::ListDTOWriter) and
+// call finish(). To a requester that negotiated "chunked", every CHUNK_SIZE
+// bytes go out as a STREAM_CHUNK frame between STREAM_START and STREAM_END,
+// so memory stays bounded however large the response is. Anyone else gets
+// the usual single frame at finish().
+class ResponseStream {
+private:
+    Connection& conn;
+    protocol::MsgCode code;
+    bool binary;
+    bool chunked;       // Sending STREAM_* frames rather than one frame
+    uint32_t streamId = 0;
+    std::string buffer; // Unsent bytes (the whole payload when not chunked)
+    bool started = false;
+    bool finished = false;
+    bool failed = false;
+
+    bool sendFrame(const protocol::Message& frame);
+    bool flushChunk();
+    void end(uint8_t status);
+
+public:
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    ResponseStream(Connection& conn, protocol::MsgCode code, bool binary);
+    // Sends STREAM_END with the aborted status if finish() was never reached
+    ~ResponseStream();
+
+    ResponseStream(const ResponseStream&) = delete;
+    ResponseStream& operator=(const ResponseStream&) = delete;
+
+    // Append bytes to the payload. Returns false once the client can no
+    // longer be reached, so producers can stop early.
+    bool write(std::string_view bytes);
+
+    // Send whatever is left and complete the response
+    bool finish();
+
+    bool isChunked() const { return chunked; }
+    // Whether any frame has gone out; after that, errors cannot be reported
+    // with a separate failure response
+    bool hasStarted() const { return started; }
+};
+
+} // namespace server
+
+#endif // SERVER_RESPONSE_STREAM_H
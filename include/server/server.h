@@ -6,8 +6,11 @@
 #include "server/connection_manager.h"
 #include "server/request_router.h"
 #include "server/client_handler.h"
+#include "server/connection.h"
+#include "server/strand_executor.h"
+#include "server/media_relay.h"
+#include <atomic>
 #include <vector>
-#include <set>
 #include <map>
 #include <memory>
 
@@ -15,7 +18,8 @@ class Server {
 private:
     int serverSocket;
     int port;
-    bool running;
+    std::atomic<bool> running; // Until stop(), which may run in a signal handler
+    bool shutDown = false;
     std::string dbConnInfo;
     
     std::shared_ptr<server::Database> database;
@@ -28,9 +32,23 @@ private:
     std::shared_ptr<server::ClientHandler> clientHandler;
     std::shared_ptr<server::RequestRouter> requestRouter;
 
+    // Voice call audio relay (UDP, listens on port + 1)
+    std::shared_ptr<server::MediaRelay> mediaRelay;
+
+    // Runs requests off the event loop, in order per user (inline if no workers)
+    std::unique_ptr<server::StrandExecutor> executor;
+
+    // Set while a processTimeouts() run is queued or running on the
+    // executor, so a slow database round trip never queues up another
+    std::atomic<bool> timeoutsPending{false};
+
+    // Signalled when a push lands in a connection's outbox, so select()
+    // returns and the loop writes it
+    std::shared_ptr<server::Wakeup> wakeup;
     
-    std::set<int> clientSockets;
-    std::map<int, std::vector<uint8_t>> clientBuffers;
+    // One per accepted socket, keyed by fd. Queued requests hold a reference
+    // too, so a connection outlives its removal until they have run.
+    std::map<int, std::shared_ptr<server::Connection>> connections;
     
     // Initialize server socket
     bool initSocket();
@@ -39,22 +57,35 @@ private:
     int acceptClient();
     
     // Handle client data
-    void handleClientData(int clientFd);
+    void handleClientData(const std::shared_ptr<server::Connection>& conn);
+    static constexpr size_t RECV_CHUNK = 4096; // Bytes read per recv()
+
+    // Run a task for conn on its strand: the user's once logged in, the
+    // connection's own before that
+    void postToStrand(const std::shared_ptr<server::Connection>& conn, server::StrandExecutor::Task task);
     
-    // Remove client
-    void removeClient(int clientFd);
+    // Remove client; its socket is closed once its queued requests have run
+    void removeClient(std::shared_ptr<server::Connection> conn);
+
+    // Join the worker and relay threads and close every socket. Runs on the
+    // event loop thread once run() has left the loop (or from ~Server).
+    void shutdown();
 
 public:
-    Server(int port = 8080, const std::string& dbConn = "host=localhost port=5432 dbname=english_learning user=postgres password=yourpass");
+    static constexpr const char* DEFAULT_DB_CONN = "host=localhost port=5432 dbname=english_learning user=postgres password=yourpass";
+
+    // workers: threads running requests; 0 keeps everything on the event loop
+    Server(int port = 8080, const std::string& dbConn = DEFAULT_DB_CONN, size_t workers = 0);
     ~Server();
 
     // Start server
     bool start();
     
-    // Main event loop with select()
+    // Main event loop with select(); shuts the server down when it returns
     void run();
     
-    // Stop server
+    // Ask run() to return. Only clears a flag and writes the wakeup eventfd,
+    // so it is async-signal-safe.
     void stop();
 };
 
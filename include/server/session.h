@@ -11,8 +11,13 @@
 
 namespace server {
 
+class Connection;
+
 class SessionManager {
 public:
+    // Minimum time between recorded activity updates for one connection
+    static constexpr std::chrono::seconds TOUCH_INTERVAL{1};
+
     SessionManager();
     SessionManager(std::shared_ptr<Database> db);
 
@@ -21,6 +26,11 @@ public:
     void remove_session(const std::string& session_id);
     void update_session(const std::string& session_id);
     int get_user_id_by_session(const std::string& session_id);
+    // Resolve the session token of a request arriving on conn. The identity
+    // was bound to conn at login, so this compares strings instead of taking
+    // the lock; activity is recorded at most once per TOUCH_INTERVAL.
+    // Returns the user id, or -1 if session_id is not conn's session.
+    int authenticate(Connection& conn, const std::string& session_id);
     int get_user_id_by_fd(int client_fd);
     std::string get_user_role_by_fd(int client_fd);
     std::vector<int> get_fds_by_user_id(int user_id);
@@ -33,6 +43,8 @@ private:
         std::chrono::steady_clock::time_point last_active;
     };
 
+    void erase_session(const std::string& session_id); // Caller holds mutex_
+
     std::unordered_map<std::string, Session> sessions_;
     std::unordered_map<int, std::string> fd_to_session_id_;
     std::shared_ptr<Database> db_;
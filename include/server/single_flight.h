@@ -0,0 +1,108 @@
+#ifndef SERVER_SINGLE_FLIGHT_H
+#define SERVER_SINGLE_FLIGHT_H
+
+#include "common/logger.h"
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace server {
+
+// Shares one in-flight load between concurrent callers asking for the same
+// key. The first caller runs the load; everyone arriving before it finishes
+// waits for that result instead of repeating the query and parse (hundreds of
+// students opening the same exam at once). Nothing is cached: a caller after
+// the load completes starts a new one.
+template <typename Key, typename Value>
+class SingleFlight {
+public:
+    struct Stats {
+        uint64_t loads = 0;     // Loads actually run
+        uint64_t coalesced = 0; // Callers served by another caller's load
+    };
+
+    // name labels the log line written when a load was shared, which also
+    // reports the running totals
+    explicit SingleFlight(std::string name) : name(std::move(name)) {}
+
+    SingleFlight(const SingleFlight&) = delete;
+    SingleFlight& operator=(const SingleFlight&) = delete;
+
+    template <typename Load>
+    Value run(const Key& key, Load&& load) {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto it = inFlight.find(key);
+        if (it != inFlight.end()) {
+            std::shared_ptr<Flight> flight = it->second;
+            ++flight->waiters;
+            coalesced.fetch_add(1, std::memory_order_relaxed);
+            lock.unlock();
+            return flight->result.get();
+        }
+
+        auto flight = std::make_shared<Flight>();
+        std::promise<Value> promise;
+        flight->result = promise.get_future().share();
+        inFlight.emplace(key, flight);
+        loads.fetch_add(1, std::memory_order_relaxed);
+        lock.unlock();
+
+        try {
+            promise.set_value(load());
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+
+        lock.lock();
+        auto current = inFlight.find(key);
+        if (current != inFlight.end() && current->second == flight) {
+            inFlight.erase(current);
+        }
+        int waiters = flight->waiters;
+        lock.unlock();
+
+        if (waiters > 0 && logger::serverLogger) {
+            Stats s = stats();
+            logger::serverLogger->info("[SingleFlight] " + name + " load shared with " + std::to_string(waiters) +
+                                       " concurrent requests (" + std::to_string(s.loads) + " loads, " +
+                                       std::to_string(s.coalesced) + " coalesced so far)");
+        }
+        return flight->result.get();
+    }
+
+    // Callers from now on start a fresh load rather than joining one that
+    // began before a write to key
+    void forget(const Key& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        inFlight.erase(key);
+    }
+
+    Stats stats() const {
+        Stats s;
+        s.loads = loads.load(std::memory_order_relaxed);
+        s.coalesced = coalesced.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    struct Flight {
+        std::shared_future<Value> result;
+        int waiters = 0; // Guarded by mutex
+    };
+
+    const std::string name;
+    std::mutex mutex;
+    std::map<Key, std::shared_ptr<Flight>> inFlight;
+    std::atomic<uint64_t> loads{0};
+    std::atomic<uint64_t> coalesced{0};
+};
+
+} // namespace server
+
+#endif // SERVER_SINGLE_FLIGHT_H
@@ -0,0 +1,98 @@
+#ifndef SERVER_STRAND_EXECUTOR_H
+#define SERVER_STRAND_EXECUTOR_H
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace server {
+
+// Runs request handlers on a pool of worker threads. Tasks posted under the
+// same key (a strand: one user, or one connection before login) run one at a
+// time in the order posted; different keys run in parallel. A strand with work
+// is queued on one worker, chosen by key, and idle workers steal strands from
+// busy ones, so a few heavy users do not hold up everyone hashed alongside them.
+// With zero workers post() runs the task inline on the caller's thread.
+class StrandExecutor {
+public:
+    using Task = std::function<void()>;
+
+    struct Stats {
+        uint64_t executed = 0;
+        uint64_t stolen = 0; // Strands a worker took from another worker's queue
+    };
+
+    explicit StrandExecutor(size_t workers);
+    ~StrandExecutor();
+
+    StrandExecutor(const StrandExecutor&) = delete;
+    StrandExecutor& operator=(const StrandExecutor&) = delete;
+
+    // Strand keys: users and not-yet-logged-in connections never collide
+    static uint64_t userKey(int userId) { return static_cast<uint32_t>(userId); }
+    static uint64_t connectionKey(int fd) { return (uint64_t{1} << 32) | static_cast<uint32_t>(fd); }
+    // Periodic server work (timeouts, acknowledgement flushes)
+    static uint64_t maintenanceKey() { return uint64_t{2} << 32; }
+
+    void post(uint64_t key, Task task);
+
+    // Run everything already posted, then join the workers. Later posts run inline.
+    void stop();
+
+    bool isInline() const { return workers.empty(); }
+    size_t workerCount() const { return workers.size(); }
+    Stats stats() const;
+
+private:
+    // Tasks run per strand before it goes to the back of the queue, so one
+    // busy user cannot monopolise a worker
+    static constexpr size_t STRAND_BATCH = 16;
+    static constexpr size_t SHARDS = 16;
+
+    struct Strand {
+        const uint64_t key;
+        std::deque<Task> tasks; // Guarded by the shard mutex
+        bool scheduled = false; // In some worker's queue or running
+        explicit Strand(uint64_t key) : key(key) {}
+    };
+
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_map<uint64_t, std::shared_ptr<Strand>> strands; // Only strands with work
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::shared_ptr<Strand>> ready;
+        std::thread thread;
+    };
+
+    std::array<Shard, SHARDS> shards;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    std::mutex idleMutex;
+    std::condition_variable idle;
+    long readyCount = 0; // Strands queued on any worker; guarded by idleMutex
+    bool stopping = false;
+
+    std::atomic<uint64_t> executed{0};
+    std::atomic<uint64_t> stolen{0};
+
+    Shard& shardFor(uint64_t key) { return shards[key % SHARDS]; }
+    void schedule(std::shared_ptr<Strand> strand, size_t worker);
+    std::shared_ptr<Strand> take(size_t self);
+    void runStrand(std::shared_ptr<Strand> strand, size_t self);
+    void workerLoop(size_t self);
+};
+
+} // namespace server
+
+#endif // SERVER_STRAND_EXECUTOR_H
@@ -476,11 +476,18 @@ Page {
                     "timestamp": timestamp
                 })
                 chatListView.positionViewAtEnd()
+                if (sender === currentRecipient) {
+                    networkManager.markChatRead(sender)
+                }
             }
             // Refresh recent chats to update last message
             networkManager.requestRecentChats()
         }
 
+        function onNotificationReceived(message) {
+            addSystemMessage(message)
+        }
+
         function onChatMessageSent(content) {
             var now = new Date()
             var timestamp = now.toLocaleTimeString()
@@ -1,5 +1,6 @@
 #include "NetworkManager.h"
 #include "common/payloads.h"
+#include "common/adpcm.h"
 #include <QDebug>
 #include <QDir>
 #include <QFile>
@@ -29,10 +30,7 @@ void NetworkManager::connectToServer(const QString &host, int port) {
     emit connectionStatusChanged(success);
     
     if (success) {
-        // Start polling for messages only after login usually, but we might receive initial handshake?
-        // The current protocol doesn't send anything immediately after connect, only after login.
-        // But we should be ready. However, login() is synchronous and waits for response.
-        // So we should NOT poll during login.
+        // Polling starts after login; the protocol sends nothing before it
     } else {
         emit errorOccurred("Failed to connect to server");
     }
@@ -48,9 +46,8 @@ void NetworkManager::login(const QString &username, const QString &password) {
         emit connectionStatusChanged(true);
     }
 
-    // Stop polling during synchronous login to avoid stealing the response
-    m_pollTimer->stop();
-
+    // The login response is matched by correlation id, so frames that arrive
+    // first are kept for checkMessages() instead of being mistaken for it
     bool success = m_client->login(username.toStdString(), password.toStdString());
     
     if (success) {
@@ -202,29 +199,35 @@ void NetworkManager::requestResultDetail(const QString &targetType, const QStrin
 }
 
 void NetworkManager::sendPrivateMessage(const QString &recipient, const QString &content, const QString &type) {
-    // If type is AUDIO, content is expected to be Base64 encoded audio data
-    // We don't need to do anything special here, just pass it.
-    // But if the UI passes a file path, we might need to read and encode it?
-    // The requirement says "Implement audio recording and Base64 encoding/decoding (Client)".
-    // If the UI (QML) records audio, it likely saves to a file.
-    // So `content` might be a file path.
-    // If `type` is AUDIO and `content` looks like a file path, read and encode it.
-    
+    // AUDIO content is a path to a recorded file. The bytes are uploaded out-of-band
+    // as a blob and the chat message only carries "blob:<sha256>".
     std::string finalContent = content.toStdString();
     
     if (type == "AUDIO") {
         QFile file(content);
         if (file.exists()) {
-            if (file.open(QIODevice::ReadOnly)) {
-                QByteArray fileData = file.readAll();
-                finalContent = fileData.toBase64().toStdString();
-                file.close();
-            } else {
+            if (!file.open(QIODevice::ReadOnly)) {
                 emit chatError("Failed to read audio file");
                 return;
             }
+            QByteArray fileData = file.readAll();
+            file.close();
+
+            QString hash = QString(QCryptographicHash::hash(fileData, QCryptographicHash::Sha256).toHex());
+
+            // Keep our own copy in the cache so history never has to download it again
+            QString cachedPath = audioCachePath(hash);
+            if (!QFile::exists(cachedPath)) {
+                QFile::copy(content, cachedPath);
+            }
+
+            if (!m_client->uploadBlob(hash.toStdString(), fileData.toStdString())) {
+                emit chatError("Failed to upload audio");
+                return;
+            }
+            finalContent = "blob:" + hash.toStdString();
         } else {
-            // Assume it's already base64 or raw content if not a file
+            // Assume it's already a blob reference or Base64 content if not a file
         }
     }
 
@@ -235,14 +238,75 @@ void NetworkManager::sendPrivateMessage(const QString &recipient, const QString
     }
 }
 
+QString NetworkManager::audioCachePath(const QString &hash) const {
+    QDir dir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/audio");
+    if (!dir.exists()) dir.mkpath(".");
+    return dir.filePath(QString("audio_%1.wav").arg(hash));
+}
+
+QString NetworkManager::cacheLegacyAudio(const std::string &base64Content) const {
+    // Messages stored before the blob store existed still carry inline Base64
+    QByteArray audioData = QByteArray::fromBase64(base64Content.c_str());
+    QString hash = QString(QCryptographicHash::hash(audioData, QCryptographicHash::Sha256).toHex());
+    QString filePath = audioCachePath(hash);
+
+    QFile file(filePath);
+    if (!file.exists()) {
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(audioData);
+            file.close();
+        } else {
+            qDebug() << "Failed to save audio file:" << filePath;
+        }
+    }
+    return filePath;
+}
+
+void NetworkManager::fetchAudio(const QString &hash) {
+    if (m_blobDownloads.contains(hash)) return; // Already in flight
+
+    m_blobDownloads.insert(hash, BlobDownload());
+    if (!m_client->requestBlobChunk(hash.toStdString(), 0, "adpcm")) {
+        m_blobDownloads.remove(hash);
+        emit chatError("Failed to request audio");
+    }
+}
+
 void NetworkManager::requestChatHistory(const QString &otherUser) {
     if (m_client->requestChatHistory(otherUser.toStdString())) {
-        // Success
+        // Opening a conversation reads it
+        markChatRead(otherUser);
     } else {
         emit chatError("Failed to request chat history");
     }
 }
 
+void NetworkManager::markChatRead(const QString &otherUser) {
+    m_client->acknowledgeChatRead(otherUser.toStdString());
+}
+
+void NetworkManager::deliverChatMessage(const Payloads::ChatMessageDTO &dto) {
+    QString content = QString::fromStdString(dto.content);
+    if (dto.messageType == "AUDIO") {
+        if (content.startsWith("blob:")) {
+            QString hash = content.mid(5);
+            QString filePath = audioCachePath(hash);
+            if (!QFile::exists(filePath)) {
+                // Deliver the message once the audio has been downloaded
+                m_pendingAudioMessages[hash].append({QString::fromStdString(dto.sender),
+                                                     QString::fromStdString(dto.timestamp)});
+                fetchAudio(hash);
+                return;
+            }
+            content = filePath;
+        } else {
+            content = cacheLegacyAudio(dto.content);
+        }
+    }
+
+    emit chatMessageReceived(QString::fromStdString(dto.sender), content, QString::fromStdString(dto.messageType), QString::fromStdString(dto.timestamp));
+}
+
 void NetworkManager::requestRecentChats() {
     if (m_client->requestRecentChats()) {
         // Success
@@ -466,68 +530,56 @@ void NetworkManager::checkMessages() {
             case protocol::MsgCode::CHAT_PRIVATE_RECEIVE: {
                 Payloads::ChatMessageDTO dto;
                 dto.deserialize(msg.toString());
-                
-                QString content = QString::fromStdString(dto.content);
-                if (dto.messageType == "AUDIO") {
-                    // Save audio to file
-                    QByteArray audioData = QByteArray::fromBase64(dto.content.c_str());
-                    QString downloadsPath = QStandardPaths::writableLocation(QStandardPaths::DownloadLocation);
-                    QDir dir(downloadsPath);
-                    if (!dir.exists()) dir.mkpath(".");
-                    
-                    QString fileName = QString("audio_%1_%2.wav").arg(QString::fromStdString(dto.sender)).arg(QDateTime::currentMSecsSinceEpoch());
-                    QString filePath = dir.filePath(fileName);
-                    
-                    QFile file(filePath);
-                    if (file.open(QIODevice::WriteOnly)) {
-                        file.write(audioData);
-                        file.close();
-                        content = filePath; // Update content to be the file path
-                    } else {
-                        qDebug() << "Failed to save audio file:" << filePath;
+                deliverChatMessage(dto);
+                // Undelivered on the server until acked (then it is in the next digest)
+                m_client->acknowledgeChatMessage(dto.messageId);
+                break;
+            }
+            case protocol::MsgCode::UNREAD_DIGEST: {
+                // Everything that arrived while we were offline, oldest first
+                Payloads::UnreadDigestDTO digest;
+                digest.deserialize(msg.toString());
+                std::vector<std::string> delivered;
+                for (const auto &item : digest.items) {
+                    delivered.push_back(item.messageId);
+                    if (item.messageType == "NOTIFICATION") {
+                        emit notificationReceived(QString::fromStdString(item.content));
+                        continue;
                     }
+                    Payloads::ChatMessageDTO dto;
+                    dto.sender = item.sender;
+                    dto.messageType = item.messageType;
+                    dto.content = item.content;
+                    dto.timestamp = item.timestamp;
+                    deliverChatMessage(dto);
                 }
-                
-                emit chatMessageReceived(QString::fromStdString(dto.sender), content, QString::fromStdString(dto.messageType), QString::fromStdString(dto.timestamp));
+                // The server keeps them (messages undelivered, notifications
+                // stored) until this arrives
+                m_client->acknowledgeUnreadDigest(delivered);
                 break;
             }
+            case protocol::MsgCode::NOTIFICATION_PUSH:
+                emit notificationReceived(QString::fromStdString(msg.toString()));
+                break;
             case protocol::MsgCode::CHAT_HISTORY_SUCCESS: {
                 Payloads::ChatHistoryDTO historyDto;
                 historyDto.deserialize(msg.toString());
                 
-                // Process history to save audio files if needed
-                // We need to reconstruct the DTO with file paths instead of Base64
-                // But ChatHistoryDTO contains a vector of ChatMessageDTO.
-                // We can iterate and modify, then serialize again? Or just emit the modified list?
-                // The signal expects a string (serialized data).
-                // If we modify the content, we need to re-serialize.
-                
+                // Replace blob references with cache paths. Missing audio is fetched
+                // in the background and announced through audioReady().
                 for (auto& dto : historyDto.messages) {
-                    if (dto.messageType == "AUDIO") {
-                        // Check if we already have this file? 
-                        // Generating a unique name based on timestamp/sender might duplicate if we fetch history multiple times.
-                        // Ideally, we should hash the content or use message ID (but DTO doesn't have ID).
-                        // For now, let's save it again or check if existing.
-                        // To avoid re-saving, we could check if content is already a path? No, it's Base64 from server.
-                        
-                        QByteArray audioData = QByteArray::fromBase64(dto.content.c_str());
-                        QString downloadsPath = QStandardPaths::writableLocation(QStandardPaths::DownloadLocation);
-                        QDir dir(downloadsPath);
-                        if (!dir.exists()) dir.mkpath(".");
-                        
-                        // Use a hash of content for filename to avoid duplicates
-                        QString hash = QString(QCryptographicHash::hash(audioData, QCryptographicHash::Md5).toHex());
-                        QString fileName = QString("audio_%1.wav").arg(hash);
-                        QString filePath = dir.filePath(fileName);
-                        
-                        QFile file(filePath);
-                        if (!file.exists()) {
-                            if (file.open(QIODevice::WriteOnly)) {
-                                file.write(audioData);
-                                file.close();
-                            }
+                    if (dto.messageType != "AUDIO") continue;
+
+                    QString content = QString::fromStdString(dto.content);
+                    if (content.startsWith("blob:")) {
+                        QString hash = content.mid(5);
+                        QString filePath = audioCachePath(hash);
+                        if (!QFile::exists(filePath)) {
+                            fetchAudio(hash);
                         }
                         dto.content = filePath.toStdString();
+                    } else {
+                        dto.content = cacheLegacyAudio(dto.content).toStdString();
                     }
                 }
                 
@@ -537,6 +589,93 @@ void NetworkManager::checkMessages() {
             case protocol::MsgCode::CHAT_HISTORY_FAILURE:
                 emit chatError("Failed to get chat history");
                 break;
+            // Blob Transfer
+            case protocol::MsgCode::BLOB_UPLOAD_SUCCESS:
+                break;
+            case protocol::MsgCode::BLOB_UPLOAD_FAILURE: {
+                Payloads::BlobUploadResult result;
+                result.deserialize(msg.toString());
+                emit chatError("Audio upload failed: " + QString::fromStdString(result.message));
+                break;
+            }
+            case protocol::MsgCode::BLOB_DOWNLOAD_CHUNK: {
+                Payloads::BlobChunkDTO chunk;
+                chunk.deserialize(msg.toString());
+
+                QString hash = QString::fromStdString(chunk.hash);
+                auto it = m_blobDownloads.find(hash);
+                if (it == m_blobDownloads.end()) break;
+
+                qint64 totalSize = QString::fromStdString(chunk.totalSize).toLongLong();
+                QString encoding = QString::fromStdString(chunk.encoding);
+                qint64 offset = QString::fromStdString(chunk.offset).toLongLong();
+
+                if (offset != it->data.size()) break; // Stale chunk
+
+                // The server may compress the blob mid-download; start over in the new form
+                if (offset > 0 && (encoding != it->encoding || totalSize != it->totalSize)) {
+                    it->data.clear();
+                    it->encoding.clear();
+                    it->totalSize = -1;
+                    m_client->requestBlobChunk(chunk.hash, 0, "adpcm");
+                    break;
+                }
+
+                it->encoding = encoding;
+                it->totalSize = totalSize;
+                it->data.append(QByteArray::fromBase64(chunk.data.c_str()));
+                if (it->data.size() < totalSize) {
+                    m_client->requestBlobChunk(chunk.hash, static_cast<uint64_t>(it->data.size()), "adpcm");
+                    break;
+                }
+
+                QByteArray audioData = it->data;
+                m_blobDownloads.erase(it);
+
+                if (encoding == "adpcm") {
+                    // Compressed voice note: expand back to WAV for the player
+                    audio::PcmAudio pcm;
+                    if (!audio::decodeAdpcm(audioData.toStdString(), pcm)) {
+                        m_pendingAudioMessages.remove(hash);
+                        emit chatError("Downloaded audio is corrupt");
+                        break;
+                    }
+                    std::string wav = audio::buildWav(pcm);
+                    audioData = QByteArray(wav.data(), static_cast<int>(wav.size()));
+                } else {
+                    QString actualHash = QString(QCryptographicHash::hash(audioData, QCryptographicHash::Sha256).toHex());
+                    if (actualHash != hash) {
+                        qDebug() << "Audio blob hash mismatch:" << hash;
+                        m_pendingAudioMessages.remove(hash);
+                        emit chatError("Downloaded audio is corrupt");
+                        break;
+                    }
+                }
+
+                QString filePath = audioCachePath(hash);
+                QFile file(filePath);
+                if (!file.open(QIODevice::WriteOnly)) {
+                    qDebug() << "Failed to save audio file:" << filePath;
+                    break;
+                }
+                file.write(audioData);
+                file.close();
+
+                emit audioReady(hash, filePath);
+                for (const auto& pending : m_pendingAudioMessages.take(hash)) {
+                    emit chatMessageReceived(pending.sender, filePath, "AUDIO", pending.timestamp);
+                }
+                break;
+            }
+            case protocol::MsgCode::BLOB_DOWNLOAD_FAILURE: {
+                Payloads::BlobDownloadFailure failure;
+                failure.deserialize(msg.toString());
+                QString hash = QString::fromStdString(failure.hash);
+                m_blobDownloads.remove(hash);
+                m_pendingAudioMessages.remove(hash);
+                emit chatError("Failed to download audio");
+                break;
+            }
             case protocol::MsgCode::RECENT_CHATS_SUCCESS:
                 emit recentChatsReceived(QString::fromStdString(msg.toString()));
                 break;
@@ -567,6 +706,15 @@ void NetworkManager::checkMessages() {
             case protocol::MsgCode::CALL_FAILED:
                 emit callFailed(QString::fromStdString(msg.toString()));
                 break;
+            case protocol::MsgCode::CALL_MEDIA_READY: {
+                Payloads::CallMediaInfo media;
+                media.deserialize(msg.toString());
+                emit callMediaReady(QString::fromStdString(media.peerUsername),
+                                    QString::fromStdString(media.relayPort).toInt(),
+                                    QString::fromStdString(media.sessionId),
+                                    QString::fromStdString(media.token));
+                break;
+            }
 
             // Admin Game Management Responses
             case protocol::MsgCode::GAME_CREATE_SUCCESS:
@@ -5,8 +5,12 @@
 #include <QString>
 #include <QThread>
 #include <QTimer>
+#include <QHash>
+#include <QList>
+#include <QByteArray>
 #include <memory>
 #include "client/network.h"
+#include "common/payloads.h"
 
 class NetworkManager : public QObject {
     Q_OBJECT
@@ -38,6 +42,7 @@ public:
     Q_INVOKABLE void sendPrivateMessage(const QString &recipient, const QString &content, const QString &type = "TEXT");
     Q_INVOKABLE void requestChatHistory(const QString &otherUser);
     Q_INVOKABLE void requestRecentChats();
+    Q_INVOKABLE void markChatRead(const QString &otherUser);
 
     // Voice Calls
     Q_INVOKABLE void initiateCall(const QString &targetUser);
@@ -90,12 +95,16 @@ signals:
     void recentChatsReceived(const QString &chatsData);
     void chatMessageSent(const QString &message);
     void chatError(const QString &message);
+    void audioReady(const QString &hash, const QString &filePath);
+    void notificationReceived(const QString &message);
 
     // Voice Call Signals
     void incomingCall(const QString &callerUsername, const QString &callerId);
     void callAnswered(const QString &username);
     void callEnded(const QString &reason);
     void callFailed(const QString &reason);
+    // UDP relay details for the call audio path (see common/media_packet.h)
+    void callMediaReady(const QString &peerUsername, int relayPort, const QString &sessionId, const QString &token);
 
     // Game Signals
     void gameListReceived(const QString &listData);
@@ -118,6 +127,24 @@ private slots:
 private:
     std::unique_ptr<client::NetworkClient> m_client;
     QTimer *m_pollTimer;
+
+    // Chat audio is fetched lazily by content hash and cached on disk
+    struct PendingAudioMessage {
+        QString sender;
+        QString timestamp;
+    };
+    struct BlobDownload {
+        QByteArray data;
+        QString encoding;
+        qint64 totalSize = -1;
+    };
+    QHash<QString, BlobDownload> m_blobDownloads;
+    QHash<QString, QList<PendingAudioMessage>> m_pendingAudioMessages;
+
+    QString audioCachePath(const QString &hash) const;
+    void deliverChatMessage(const Payloads::ChatMessageDTO &dto);
+    QString cacheLegacyAudio(const std::string &base64Content) const;
+    void fetchAudio(const QString &hash);
 };
 
 #endif // NETWORKMANAGER_H
@@ -1,5 +1,6 @@
 #include "client/network.h"
 #include "common/payloads.h"
+#include "common/compression.h"
 #include "common/logger.h"
 #include "common/utils.h"
 #include <sys/socket.h>
@@ -8,12 +9,27 @@
 #include <fcntl.h>
 #include <cstring>
 #include <stdexcept>
+#include <iterator>
+#include <algorithm>
 
 namespace client {
 
+namespace {
+
+// Conditional fetch cache key: the request code and its parameters, without
+// the session token, so entries survive a re-login
+template <typename T>
+std::string catalogKey(protocol::MsgCode code, T req) {
+    req.sessionToken.clear();
+    return std::to_string(static_cast<int>(code)) + ":" + req.serialize();
+}
+
+} // namespace
+
 NetworkClient::NetworkClient(const std::string& host, int port)
     : sockfd(-1), serverHost(host), serverPort(port), 
-      connected(false), loggedIn(false), heartbeatInterval(10) {
+      connected(false), loggedIn(false), binaryPayloads(false), compressPayloads(false), heartbeatInterval(10),
+      nextCorrelationId(1), batching(false) {
 }
 
 NetworkClient::~NetworkClient() {
@@ -111,6 +127,16 @@ void NetworkClient::disconnect() {
         sockfd = -1;
         connected = false;
         loggedIn = false;
+        binaryPayloads = false;
+        compressPayloads = false;
+        serverCapabilities = protocol::Capabilities();
+        pendingMessages.clear();
+        receiveBuffer.clear();
+        batching = false;
+        batchFrames.clear();
+        catalogCache.clear();
+        pendingCatalogRequests.clear();
+        streams.clear();
         
         if (logger::clientLogger) {
             logger::clientLogger->info("Disconnected from server");
@@ -133,7 +159,8 @@ bool NetworkClient::login(const std::string& username, const std::string& passwo
     std::string payload = req.serialize();
     protocol::Message loginMsg(protocol::MsgCode::LOGIN_REQUEST, payload);
     
-    if (!sendMessage(loginMsg)) {
+    uint32_t requestId = sendRequest(loginMsg);
+    if (requestId == 0) {
         if (logger::clientLogger) {
             logger::clientLogger->error("Failed to send login request");
         }
@@ -142,7 +169,7 @@ bool NetworkClient::login(const std::string& username, const std::string& passwo
 
     // Wait for response
     try {
-        protocol::Message response = receiveMessage();
+        protocol::Message response = receiveResponse(requestId);
         
         if (response.code == protocol::MsgCode::LOGIN_SUCCESS) {
             // Extract session token from response
@@ -196,7 +223,8 @@ bool NetworkClient::logout() {
     std::string payload = sessionToken;
     protocol::Message logoutMsg(protocol::MsgCode::LOGOUT_REQUEST, payload);
     
-    if (!sendMessage(logoutMsg)) {
+    uint32_t requestId = sendRequest(logoutMsg);
+    if (requestId == 0) {
         if (logger::clientLogger) {
             logger::clientLogger->error("Failed to send logout request");
         }
@@ -205,7 +233,7 @@ bool NetworkClient::logout() {
 
     // Wait for response
     try {
-        protocol::Message response = receiveMessage();
+        protocol::Message response = receiveResponse(requestId);
         
         if (response.code == protocol::MsgCode::LOGOUT_SUCCESS) {
             loggedIn = false;
@@ -248,7 +276,8 @@ bool NetworkClient::registerUser(const std::string& username, const std::string&
     std::string payload = req.serialize();
     protocol::Message registerMsg(protocol::MsgCode::REGISTER_REQUEST, payload);
     
-    if (!sendMessage(registerMsg)) {
+    uint32_t requestId = sendRequest(registerMsg);
+    if (requestId == 0) {
         if (logger::clientLogger) {
             logger::clientLogger->error("Failed to send register request");
         }
@@ -257,7 +286,7 @@ bool NetworkClient::registerUser(const std::string& username, const std::string&
 
     // Wait for response
     try {
-        protocol::Message response = receiveMessage();
+        protocol::Message response = receiveResponse(requestId);
         
         if (response.code == protocol::MsgCode::REGISTER_SUCCESS) {
             if (logger::clientLogger) {
@@ -304,6 +333,101 @@ bool NetworkClient::sendHeartbeat() {
     return false;
 }
 
+bool NetworkClient::negotiateBinaryPayloads() {
+    return negotiatePayloads(true, compressPayloads);
+}
+
+bool NetworkClient::negotiatePayloads(bool binary, bool deflate) {
+    if (!connected) {
+        return false;
+    }
+
+    if (!sendHello(binary, deflate) && !selectCodec(binary, deflate)) {
+        binaryPayloads = false;
+        compressPayloads = false;
+    }
+    return binaryPayloads == binary && compressPayloads == deflate;
+}
+
+bool NetworkClient::sendHello(bool binary, bool deflate) {
+    Payloads::HelloDTO hello;
+    hello.version = protocol::PROTOCOL_VERSION;
+    hello.maxFrameSize = static_cast<int>(protocol::MAX_FRAME_SIZE);
+    if (binary) hello.codecs.push_back("binary");
+    hello.codecs.push_back("text");
+    if (deflate) hello.compression.push_back("deflate");
+    // Everything NetworkClient handles on its own
+    hello.features = {std::string(protocol::feature::CORRELATION_ID), std::string(protocol::feature::CONTENT_VERSION),
+                      std::string(protocol::feature::BATCH), std::string(protocol::feature::CHUNKED)};
+
+    // Always sent as text: a server that predates HELLO rejects it with a
+    // GENERAL_FAILURE (login required) it can still word in text
+    uint32_t requestId = sendRequest(Payloads::encode(protocol::MsgCode::HELLO, hello, false));
+    if (requestId == 0) {
+        return false;
+    }
+
+    try {
+        protocol::Message response = receiveResponse(requestId);
+        if (response.code != protocol::MsgCode::HELLO_ACK) {
+            return false;
+        }
+
+        Payloads::HelloDTO ack;
+        Payloads::decode(response, ack);
+        serverCapabilities = protocol::Capabilities();
+        serverCapabilities.version = ack.version;
+        if (ack.maxFrameSize > 0) {
+            serverCapabilities.maxFrameSize = static_cast<uint32_t>(ack.maxFrameSize);
+        }
+        serverCapabilities.binaryPayloads = Payloads::HelloDTO::contains(ack.codecs, "binary");
+        serverCapabilities.compression = Payloads::HelloDTO::contains(ack.compression, "deflate");
+        serverCapabilities.correlationIds = Payloads::HelloDTO::contains(ack.features, protocol::feature::CORRELATION_ID);
+        serverCapabilities.contentVersions = Payloads::HelloDTO::contains(ack.features, protocol::feature::CONTENT_VERSION);
+        serverCapabilities.batch = Payloads::HelloDTO::contains(ack.features, protocol::feature::BATCH);
+        serverCapabilities.chunkedResponses = Payloads::HelloDTO::contains(ack.features, protocol::feature::CHUNKED);
+
+        binaryPayloads = serverCapabilities.binaryPayloads;
+        compressPayloads = serverCapabilities.compression;
+        if (logger::clientLogger) {
+            logger::clientLogger->info("Server HELLO_ACK: " + ack.serialize());
+        }
+        return true;
+    } catch (const std::exception& e) {
+        if (logger::clientLogger) {
+            logger::clientLogger->warn("No HELLO response: " + std::string(e.what()));
+        }
+        return false;
+    }
+}
+
+bool NetworkClient::selectCodec(bool binary, bool deflate) {
+    // Chunked responses are always accepted; readFrame() reassembles them
+    std::string options = std::string(binary ? "binary" : "text") + (deflate ? ",deflate" : "") + ",chunked";
+    protocol::Message msg(protocol::MsgCode::CODEC_SELECT_REQUEST, options);
+    uint32_t requestId = sendRequest(msg);
+    if (requestId == 0) {
+        return false;
+    }
+
+    // Servers that predate the codec ignore the request; stay on text then.
+    // Older servers answer just the codec, without the options they lack.
+    try {
+        protocol::Message response = receiveResponse(requestId);
+        bool accepted = response.code == protocol::MsgCode::CODEC_SELECT_SUCCESS;
+        auto selected = utils::splitView(response.view(), ',');
+        binaryPayloads = accepted && !selected.empty() && selected[0] == "binary";
+        compressPayloads = accepted && std::find(selected.begin() + (selected.empty() ? 0 : 1), selected.end(),
+                                                 "deflate") != selected.end();
+    } catch (const std::exception& e) {
+        if (logger::clientLogger) {
+            logger::clientLogger->warn("No codec select response, using text payloads: " + std::string(e.what()));
+        }
+        return false;
+    }
+    return true;
+}
+
 bool NetworkClient::shouldSendHeartbeat() {
     if (!loggedIn) {
         return false;
@@ -320,40 +444,244 @@ bool NetworkClient::sendMessage(const protocol::Message& msg) {
         return false;
     }
 
-    std::vector<uint8_t> data = msg.serialize();
+    // Batched frames are compressed together as one BATCH_REQUEST instead
+    std::vector<uint8_t> data = msg.serialize(msg.correlationId, compressPayloads && !batching);
+    // The server closes the connection on frames over its limit
+    if (data.size() > serverCapabilities.maxFrameSize) {
+        if (logger::clientLogger) {
+            logger::clientLogger->error("Frame of " + std::to_string(data.size()) + " bytes exceeds the server's limit");
+        }
+        return false;
+    }
     
     if (logger::messageLogger) {
-        logger::messageLogger->logMessage("Client->Server", msg.toString());
+        logger::messageLogger->logMessage(batching ? "Client->Server (batched)" : "Client->Server", msg.binary
+            ? "<binary payload, " + std::to_string(msg.data.size()) + " bytes>"
+            : msg.toString());
+    }
+
+    if (batching) {
+        batchFrames.insert(batchFrames.end(), data.begin(), data.end());
+        return true;
     }
     
     return sendData(data);
 }
 
+void NetworkClient::beginBatch() {
+    batching = true;
+    batchFrames.clear();
+}
+
+uint32_t NetworkClient::sendBatch() {
+    batching = false;
+    if (batchFrames.empty()) {
+        return 0;
+    }
+
+    protocol::Message batch(protocol::MsgCode::BATCH_REQUEST, batchFrames);
+    batchFrames.clear();
+    return sendRequest(std::move(batch));
+}
+
+void NetworkClient::appendUnpacked(std::vector<protocol::Message>& out, protocol::Message msg) {
+    if (msg.code != protocol::MsgCode::BATCH_RESPONSE) {
+        applyCatalogCache(msg);
+        out.push_back(std::move(msg));
+        return;
+    }
+    for (auto& frame : protocol::unpackFrames(msg.data)) {
+        applyCatalogCache(frame);
+        out.push_back(std::move(frame));
+    }
+}
+
+bool NetworkClient::absorbStreamFrame(protocol::Message& msg) {
+    if (msg.code != protocol::MsgCode::STREAM_START && msg.code != protocol::MsgCode::STREAM_CHUNK &&
+        msg.code != protocol::MsgCode::STREAM_END) {
+        return false;
+    }
+    if (msg.data.size() < 4) {
+        throw std::runtime_error("Stream frame truncated");
+    }
+
+    const uint8_t* p = msg.data.data();
+    uint32_t streamId = (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                        (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+
+    if (msg.code == protocol::MsgCode::STREAM_START) {
+        if (msg.data.size() < 6) {
+            throw std::runtime_error("Stream start truncated");
+        }
+        uint16_t rawCode = static_cast<uint16_t>((p[4] << 8) | p[5]);
+        streams[streamId] = PartialStream{
+            static_cast<protocol::MsgCode>(rawCode & ~protocol::BINARY_PAYLOAD_FLAG),
+            (rawCode & protocol::BINARY_PAYLOAD_FLAG) != 0, msg.correlationId, {}};
+        return true;
+    }
+
+    auto it = streams.find(streamId);
+    if (it == streams.end()) {
+        return true; // Started before a reconnect, or already aborted; nothing to add to
+    }
+
+    if (msg.code == protocol::MsgCode::STREAM_CHUNK) {
+        std::vector<uint8_t>& data = it->second.data;
+        if (data.size() + msg.data.size() - 4 > protocol::MAX_STREAMED_SIZE) {
+            streams.erase(it);
+            throw std::runtime_error("Streamed response too large");
+        }
+        data.insert(data.end(), msg.data.begin() + 4, msg.data.end());
+        return true;
+    }
+
+    PartialStream stream = std::move(it->second);
+    streams.erase(it);
+    bool complete = msg.data.size() > 4 && msg.data[4] == 0;
+    if (complete) {
+        msg = protocol::Message(stream.code, std::move(stream.data));
+        msg.binary = stream.binary;
+    } else {
+        // The server gave up midway; the caller still gets an answer for its id
+        msg = protocol::Message(protocol::MsgCode::GENERAL_FAILURE, "Response aborted by server");
+    }
+    msg.correlationId = stream.correlationId;
+    return false;
+}
+
+bool NetworkClient::sendCatalogRequest(protocol::Message msg, const std::string& cacheKey) {
+    auto cached = catalogCache.find(cacheKey);
+    msg.contentVersion = cached != catalogCache.end() ? cached->second.version : 0;
+
+    uint32_t requestId = sendRequest(std::move(msg));
+    if (requestId == 0) {
+        return false;
+    }
+    pendingCatalogRequests[requestId] = cacheKey;
+    return true;
+}
+
+void NetworkClient::applyCatalogCache(protocol::Message& msg) {
+    if (pendingCatalogRequests.empty() || msg.correlationId == 0) {
+        return;
+    }
+    auto pending = pendingCatalogRequests.find(msg.correlationId);
+    if (pending == pendingCatalogRequests.end()) {
+        return;
+    }
+    std::string cacheKey = std::move(pending->second);
+    pendingCatalogRequests.erase(pending);
+
+    if (msg.code == protocol::MsgCode::NOT_MODIFIED) {
+        auto cached = catalogCache.find(cacheKey);
+        if (cached != catalogCache.end()) {
+            uint32_t correlationId = msg.correlationId;
+            msg = cached->second.response;
+            msg.correlationId = correlationId;
+        }
+        return;
+    }
+
+    // Only successful, versioned responses are worth keeping
+    if (msg.contentVersion) {
+        if (catalogCache.size() >= MAX_CATALOG_CACHE && !catalogCache.count(cacheKey)) {
+            catalogCache.clear();
+        }
+        catalogCache[cacheKey] = CachedResponse{*msg.contentVersion, msg};
+    }
+}
+
+uint32_t NetworkClient::sendRequest(protocol::Message msg) {
+    uint32_t correlationId = nextCorrelationId++;
+    if (nextCorrelationId == 0) nextCorrelationId = 1; // 0 means "no id"
+
+    msg.correlationId = correlationId;
+    return sendMessage(msg) ? correlationId : 0;
+}
+
+protocol::Message NetworkClient::receiveResponse(uint32_t correlationId) {
+    for (auto it = pendingMessages.begin(); it != pendingMessages.end(); ++it) {
+        if (it->correlationId == correlationId) {
+            protocol::Message response = std::move(*it);
+            pendingMessages.erase(it);
+            applyCatalogCache(response);
+            return response;
+        }
+    }
+
+    while (true) {
+        protocol::Message msg = readFrame();
+        if (msg.correlationId == correlationId) {
+            applyCatalogCache(msg);
+            return msg;
+        }
+        // A push or another request's response; keep it for the poll loop
+        pendingMessages.push_back(std::move(msg));
+    }
+}
+
 protocol::Message NetworkClient::receiveMessage() {
-    // Check if we already have a complete message in buffer
-    uint32_t msgLen = protocol::Message::getFullLength(receiveBuffer);
-    
-    while (msgLen == 0) {
-        // Need more data
-        std::vector<uint8_t> newData = receiveData();
-        if (newData.empty()) {
-            // Check again, maybe receiveData timed out but we have partial data?
-            // Actually receiveData throws if no data received after timeout?
-            // The original receiveData returned empty vector on timeout.
-            // But receiveMessage threw runtime_error if empty.
-            // We should probably throw if we can't get a full message.
-            throw std::runtime_error("Timeout waiting for message");
+    protocol::Message msg;
+    if (!pendingMessages.empty()) {
+        msg = std::move(pendingMessages.front());
+        pendingMessages.pop_front();
+    } else {
+        msg = readFrame();
+    }
+
+    if (msg.code != protocol::MsgCode::BATCH_RESPONSE) {
+        applyCatalogCache(msg);
+        return msg;
+    }
+
+    // Hand out the first sub-response now and queue the rest in order
+    std::vector<protocol::Message> frames;
+    appendUnpacked(frames, std::move(msg));
+    if (frames.empty()) {
+        return protocol::Message(protocol::MsgCode::BATCH_RESPONSE, "");
+    }
+    pendingMessages.insert(pendingMessages.begin(),
+                           std::make_move_iterator(frames.begin() + 1),
+                           std::make_move_iterator(frames.end()));
+    return std::move(frames.front());
+}
+
+protocol::Message NetworkClient::readFrame() {
+    while (true) {
+        // Check if we already have a complete message in buffer
+        uint32_t msgLen = protocol::Message::getFullLength(receiveBuffer);
+
+        while (msgLen == 0) {
+            if (protocol::Message::peekLength(receiveBuffer) > protocol::MAX_FRAME_SIZE) {
+                throw std::runtime_error("Frame exceeds the advertised limit");
+            }
+
+            // Need more data
+            std::vector<uint8_t> newData = receiveData();
+            if (newData.empty()) {
+                // Check again, maybe receiveData timed out but we have partial data?
+                // Actually receiveData throws if no data received after timeout?
+                // The original receiveData returned empty vector on timeout.
+                // But receiveMessage threw runtime_error if empty.
+                // We should probably throw if we can't get a full message.
+                throw std::runtime_error("Timeout waiting for message");
+            }
+
+            receiveBuffer.insert(receiveBuffer.end(), newData.begin(), newData.end());
+            msgLen = protocol::Message::getFullLength(receiveBuffer);
+        }
+
+        // Extract message
+        std::vector<uint8_t> msgData(receiveBuffer.begin(), receiveBuffer.begin() + msgLen);
+        receiveBuffer.erase(receiveBuffer.begin(), receiveBuffer.begin() + msgLen);
+
+        protocol::Message msg = protocol::Message::deserialize(msgData);
+        // Pieces of a chunked response are not frames of their own; keep
+        // reading until the whole response is in
+        if (!absorbStreamFrame(msg)) {
+            return msg;
         }
-        
-        receiveBuffer.insert(receiveBuffer.end(), newData.begin(), newData.end());
-        msgLen = protocol::Message::getFullLength(receiveBuffer);
     }
-    
-    // Extract message
-    std::vector<uint8_t> msgData(receiveBuffer.begin(), receiveBuffer.begin() + msgLen);
-    receiveBuffer.erase(receiveBuffer.begin(), receiveBuffer.begin() + msgLen);
-    
-    return protocol::Message::deserialize(msgData);
 }
 
 bool NetworkClient::sendData(const std::vector<uint8_t>& data) {
@@ -392,6 +720,10 @@ bool NetworkClient::sendData(const std::vector<uint8_t>& data) {
 
 std::vector<protocol::Message> NetworkClient::pollMessages() {
     std::vector<protocol::Message> messages;
+    for (auto& pending : pendingMessages) {
+        appendUnpacked(messages, std::move(pending));
+    }
+    pendingMessages.clear();
     
     if (sockfd < 0) return messages;
 
@@ -417,6 +749,12 @@ std::vector<protocol::Message> NetworkClient::pollMessages() {
     
     // Process all complete messages in buffer
     while (true) {
+        if (protocol::Message::peekLength(receiveBuffer) > protocol::MAX_FRAME_SIZE) {
+            // The stream cannot be resynchronised past a frame we will not buffer
+            connected = false;
+            break;
+        }
+
         uint32_t msgLen = protocol::Message::getFullLength(receiveBuffer);
         
         if (msgLen == 0) {
@@ -428,12 +766,15 @@ std::vector<protocol::Message> NetworkClient::pollMessages() {
         
         try {
             protocol::Message msg = protocol::Message::deserialize(msgData);
+            if (absorbStreamFrame(msg)) {
+                continue;
+            }
             if (logger::messageLogger) {
                 logger::messageLogger->logMessage("Server", msg.toString());
             }
-            messages.push_back(msg);
+            appendUnpacked(messages, std::move(msg));
         } catch (...) {
-            // Should not happen if getFullLength returned > 0
+            // Malformed frame (or batch payload); drop it
         }
     }
     
@@ -483,16 +824,15 @@ bool NetworkClient::requestLessonList(const std::string& topic, const std::strin
     req.sessionToken = sessionToken;
     req.topic = topic;
     req.level = level;
-    std::string payload = req.serialize();
 
     if (logger::clientLogger) {
-        logger::clientLogger->debug("Sending LESSON_LIST_REQUEST with payload: " + payload);
+        logger::clientLogger->debug("Sending LESSON_LIST_REQUEST with payload: " + req.serialize());
     }
 
     // Send lesson list request
-    protocol::Message msg(protocol::MsgCode::LESSON_LIST_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::LESSON_LIST_REQUEST, req, binaryPayloads);
     
-    if (!sendMessage(msg)) {
+    if (!sendCatalogRequest(msg, catalogKey(protocol::MsgCode::LESSON_LIST_REQUEST, req))) {
         if (logger::clientLogger) {
             logger::clientLogger->error("Failed to send LESSON_LIST_REQUEST");
         }
@@ -519,12 +859,11 @@ bool NetworkClient::requestStudyLesson(int lessonId, const std::string& lessonTy
     req.sessionToken = sessionToken;
     req.lessonId = std::to_string(lessonId);
     req.lessonType = lessonType;
-    std::string payload = req.serialize();
 
     // Send study lesson request
-    protocol::Message msg(protocol::MsgCode::STUDY_LESSON_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::STUDY_LESSON_REQUEST, req, binaryPayloads);
     
-    if (!sendMessage(msg)) {
+    if (!sendCatalogRequest(msg, catalogKey(protocol::MsgCode::STUDY_LESSON_REQUEST, req))) {
         if (logger::clientLogger) {
             logger::clientLogger->error("Failed to send STUDY_LESSON_REQUEST");
         }
@@ -549,10 +888,9 @@ bool NetworkClient::requestExercise(protocol::MsgCode exerciseType, int exercise
     Payloads::SpecificExerciseRequest req;
     req.sessionToken = sessionToken;
     req.exerciseId = std::to_string(exerciseId);
-    std::string payload = req.serialize();
-    protocol::Message msg(exerciseType, payload);
+    protocol::Message msg = Payloads::encode(exerciseType, req, binaryPayloads);
 
-    if (!sendMessage(msg)) {
+    if (!sendCatalogRequest(msg, catalogKey(exerciseType, req))) {
         if (logger::clientLogger) {
             logger::clientLogger->error("Failed to send exercise request");
         }
@@ -575,8 +913,7 @@ bool NetworkClient::submitAnswer(const std::string& targetType, int targetId, co
     req.targetType = targetType;
     req.targetId = std::to_string(targetId);
     req.answer = answer;
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::SUBMIT_ANSWER_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::SUBMIT_ANSWER_REQUEST, req, binaryPayloads);
 
     if (!sendMessage(msg)) {
         if (logger::clientLogger) {
@@ -589,6 +926,10 @@ bool NetworkClient::submitAnswer(const std::string& targetType, int targetId, co
 }
 
 bool NetworkClient::requestPendingSubmissions() {
+    return requestPendingSubmissions(Payloads::PendingSubmissionsRequest{});
+}
+
+bool NetworkClient::requestPendingSubmissions(Payloads::PendingSubmissionsRequest req) {
     if (!connected || !loggedIn) {
         if (logger::clientLogger) {
             logger::clientLogger->error("Not logged in - cannot request pending submissions");
@@ -596,10 +937,8 @@ bool NetworkClient::requestPendingSubmissions() {
         return false;
     }
 
-    Payloads::PendingSubmissionsRequest req;
     req.sessionToken = sessionToken;
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::PENDING_SUBMISSIONS_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::PENDING_SUBMISSIONS_REQUEST, req, binaryPayloads);
 
     if (!sendMessage(msg)) {
         if (logger::clientLogger) {
@@ -625,8 +964,7 @@ bool NetworkClient::submitGrade(const std::string& resultId, const std::string&
     req.score = score;
     req.feedback = feedback;
     req.gradingDetails = gradingDetails;
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::GRADE_SUBMISSION_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::GRADE_SUBMISSION_REQUEST, req, binaryPayloads);
 
     if (!sendMessage(msg)) {
         if (logger::clientLogger) {
@@ -649,8 +987,7 @@ bool NetworkClient::requestResultList() {
     Payloads::ResultListRequest req;
     req.sessionToken = sessionToken;
     req.targetType = ""; // Fetch all
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::RESULT_LIST_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::RESULT_LIST_REQUEST, req, binaryPayloads);
 
     if (!sendMessage(msg)) {
         if (logger::clientLogger) {
@@ -675,8 +1012,7 @@ bool NetworkClient::requestResultDetail(const std::string& targetType, const std
     req.targetType = targetType;
     req.targetId = targetId;
     
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::RESULT_DETAIL_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::RESULT_DETAIL_REQUEST, req, binaryPayloads);
 
     if (!sendMessage(msg)) {
         if (logger::clientLogger) {
@@ -699,10 +1035,9 @@ bool NetworkClient::requestExercises() {
     Payloads::ExerciseListRequest req;
     req.sessionToken = sessionToken;
     // Default empty filters for now as per original code
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::EXERCISE_LIST_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::EXERCISE_LIST_REQUEST, req, binaryPayloads);
 
-    if (!sendMessage(msg)) {
+    if (!sendCatalogRequest(msg, catalogKey(protocol::MsgCode::EXERCISE_LIST_REQUEST, req))) {
         if (logger::clientLogger) {
             logger::clientLogger->error("Failed to send get exercises request");
         }
@@ -722,10 +1057,9 @@ bool NetworkClient::requestExams() {
 
     Payloads::ExamListRequest req;
     req.sessionToken = sessionToken;
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::EXAM_LIST_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::EXAM_LIST_REQUEST, req, binaryPayloads);
 
-    if (!sendMessage(msg)) {
+    if (!sendCatalogRequest(msg, catalogKey(protocol::MsgCode::EXAM_LIST_REQUEST, req))) {
         if (logger::clientLogger) {
             logger::clientLogger->error("Failed to send get exams request");
         }
@@ -746,10 +1080,9 @@ bool NetworkClient::requestExam(int examId) {
     Payloads::ExamRequest req;
     req.sessionToken = sessionToken;
     req.examId = std::to_string(examId);
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::EXAM_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::EXAM_REQUEST, req, binaryPayloads);
 
-    if (!sendMessage(msg)) {
+    if (!sendCatalogRequest(msg, catalogKey(protocol::MsgCode::EXAM_REQUEST, req))) {
         if (logger::clientLogger) {
             logger::clientLogger->error("Failed to send exam request");
         }
@@ -770,8 +1103,7 @@ bool NetworkClient::requestExamReview(int examId) {
     Payloads::ExamRequest req;
     req.sessionToken = sessionToken;
     req.examId = std::to_string(examId);
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::EXAM_REVIEW_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::EXAM_REVIEW_REQUEST, req, binaryPayloads);
 
     if (!sendMessage(msg)) {
         if (logger::clientLogger) {
@@ -796,8 +1128,7 @@ bool NetworkClient::sendPrivateMessage(const std::string& recipient, const std::
     req.recipient = recipient;
     req.content = content;
     req.messageType = type;
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::SEND_CHAT_PRIVATE_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::SEND_CHAT_PRIVATE_REQUEST, req, binaryPayloads);
 
     if (!sendMessage(msg)) {
         if (logger::clientLogger) {
@@ -820,8 +1151,7 @@ bool NetworkClient::requestChatHistory(const std::string& otherUser) {
     Payloads::ChatHistoryRequest req;
     req.sessionToken = sessionToken;
     req.otherUser = otherUser;
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::CHAT_HISTORY_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::CHAT_HISTORY_REQUEST, req, binaryPayloads);
 
     if (!sendMessage(msg)) {
         if (logger::clientLogger) {
@@ -833,7 +1163,44 @@ bool NetworkClient::requestChatHistory(const std::string& otherUser) {
     return true;
 }
 
+bool NetworkClient::acknowledgeChatRead(const std::string& otherUser) {
+    if (!connected || !loggedIn) {
+        return false;
+    }
+
+    Payloads::ChatReadAck ack;
+    ack.sessionToken = sessionToken;
+    ack.otherUser = otherUser;
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::CHAT_READ_ACK, ack, binaryPayloads);
+
+    return sendMessage(msg);
+}
 
+bool NetworkClient::acknowledgeUnreadDigest(const std::vector<std::string>& messageIds) {
+    if (!connected || !loggedIn || messageIds.empty()) {
+        return false;
+    }
+
+    Payloads::DeliveryAck ack;
+    ack.sessionToken = sessionToken;
+    ack.messageIds = messageIds;
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::UNREAD_DIGEST_ACK, ack, binaryPayloads);
+
+    return sendMessage(msg);
+}
+
+bool NetworkClient::acknowledgeChatMessage(const std::string& messageId) {
+    if (!connected || !loggedIn || messageId.empty()) {
+        return false;
+    }
+
+    Payloads::DeliveryAck ack;
+    ack.sessionToken = sessionToken;
+    ack.messageIds.push_back(messageId);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::CHAT_RECEIVE_ACK, ack, binaryPayloads);
+
+    return sendMessage(msg);
+}
 
 bool NetworkClient::requestRecentChats() {
     if (!connected || !loggedIn) {
@@ -845,8 +1212,7 @@ bool NetworkClient::requestRecentChats() {
 
     Payloads::RecentChatsRequest req;
     req.sessionToken = sessionToken;
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::RECENT_CHATS_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::RECENT_CHATS_REQUEST, req, binaryPayloads);
 
     if (!sendMessage(msg)) {
         if (logger::clientLogger) {
@@ -858,6 +1224,65 @@ bool NetworkClient::requestRecentChats() {
     return true;
 }
 
+bool NetworkClient::uploadBlob(const std::string& uploadId, const std::string& bytes) {
+    if (!connected || !loggedIn) {
+        if (logger::clientLogger) {
+            logger::clientLogger->error("Not logged in - cannot upload blob");
+        }
+        return false;
+    }
+
+    if (bytes.empty()) {
+        return false;
+    }
+
+    for (size_t offset = 0; offset < bytes.size(); offset += BLOB_CHUNK_SIZE) {
+        size_t len = std::min(BLOB_CHUNK_SIZE, bytes.size() - offset);
+
+        Payloads::BlobUploadChunk chunk;
+        chunk.sessionToken = sessionToken;
+        chunk.uploadId = uploadId;
+        chunk.offset = std::to_string(offset);
+        chunk.totalSize = std::to_string(bytes.size());
+        chunk.data = utils::base64Encode(std::vector<char>(bytes.begin() + offset, bytes.begin() + offset + len));
+        protocol::Message msg = Payloads::encode(protocol::MsgCode::BLOB_UPLOAD_CHUNK, chunk, binaryPayloads);
+
+        if (!sendMessage(msg)) {
+            if (logger::clientLogger) {
+                logger::clientLogger->error("Failed to send blob chunk at offset " + std::to_string(offset));
+            }
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool NetworkClient::requestBlobChunk(const std::string& hash, uint64_t offset, const std::string& accept) {
+    if (!connected || !loggedIn) {
+        if (logger::clientLogger) {
+            logger::clientLogger->error("Not logged in - cannot download blob");
+        }
+        return false;
+    }
+
+    Payloads::BlobDownloadRequest req;
+    req.sessionToken = sessionToken;
+    req.hash = hash;
+    req.offset = std::to_string(offset);
+    req.accept = accept;
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::BLOB_DOWNLOAD_REQUEST, req, binaryPayloads);
+
+    if (!sendMessage(msg)) {
+        if (logger::clientLogger) {
+            logger::clientLogger->error("Failed to send blob download request");
+        }
+        return false;
+    }
+
+    return true;
+}
+
 bool NetworkClient::initiateCall(const std::string& targetUser) {
     if (!connected || !loggedIn) {
         if (logger::clientLogger) {
@@ -869,8 +1294,7 @@ bool NetworkClient::initiateCall(const std::string& targetUser) {
     Payloads::VoiceCallRequest req;
     req.sessionToken = sessionToken;
     req.targetUser = targetUser;
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::CALL_INITIATE_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::CALL_INITIATE_REQUEST, req, binaryPayloads);
 
     if (!sendMessage(msg)) {
         if (logger::clientLogger) {
@@ -890,8 +1314,7 @@ bool NetworkClient::answerCall(const std::string& callerUser) {
     Payloads::VoiceCallRequest req;
     req.sessionToken = sessionToken;
     req.targetUser = callerUser;
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::CALL_ANSWER_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::CALL_ANSWER_REQUEST, req, binaryPayloads);
 
     return sendMessage(msg);
 }
@@ -904,8 +1327,7 @@ bool NetworkClient::declineCall(const std::string& callerUser) {
     Payloads::VoiceCallRequest req;
     req.sessionToken = sessionToken;
     req.targetUser = callerUser;
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::CALL_DECLINE_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::CALL_DECLINE_REQUEST, req, binaryPayloads);
 
     return sendMessage(msg);
 }
@@ -918,8 +1340,7 @@ bool NetworkClient::endCall(const std::string& otherUser) {
     Payloads::VoiceCallRequest req;
     req.sessionToken = sessionToken;
     req.targetUser = otherUser;
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::CALL_END_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::CALL_END_REQUEST, req, binaryPayloads);
 
     return sendMessage(msg);
 }
@@ -940,8 +1361,7 @@ bool NetworkClient::requestCreateGame(const std::string& type, const std::string
     req.type = type;
     req.level = level;
     req.questionJson = questionJson;
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::GAME_CREATE_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::GAME_CREATE_REQUEST, req, binaryPayloads);
 
     if (!sendMessage(msg)) {
         if (logger::clientLogger) {
@@ -967,8 +1387,7 @@ bool NetworkClient::requestUpdateGame(const std::string& gameId, const std::stri
     req.type = type;
     req.level = level;
     req.questionJson = questionJson;
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::GAME_UPDATE_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::GAME_UPDATE_REQUEST, req, binaryPayloads);
 
     if (!sendMessage(msg)) {
         if (logger::clientLogger) {
@@ -991,8 +1410,7 @@ bool NetworkClient::requestDeleteGame(const std::string& gameId) {
     Payloads::GameDeleteRequest req;
     req.sessionToken = sessionToken;
     req.gameId = gameId;
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::GAME_DELETE_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::GAME_DELETE_REQUEST, req, binaryPayloads);
 
     if (!sendMessage(msg)) {
         if (logger::clientLogger) {
@@ -1017,10 +1435,9 @@ bool NetworkClient::requestGameList() {
 
     Payloads::GameListRequest req;
     req.sessionToken = sessionToken;
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::GAME_LIST_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::GAME_LIST_REQUEST, req, binaryPayloads);
 
-    if (!sendMessage(msg)) {
+    if (!sendCatalogRequest(msg, catalogKey(protocol::MsgCode::GAME_LIST_REQUEST, req))) {
         if (logger::clientLogger) {
             logger::clientLogger->error("Failed to send game list request");
         }
@@ -1041,10 +1458,9 @@ bool NetworkClient::requestGameLevelList(const std::string& gameType) {
     Payloads::GameLevelListRequest req;
     req.sessionToken = sessionToken;
     req.gameType = gameType;
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::GAME_LEVEL_LIST_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::GAME_LEVEL_LIST_REQUEST, req, binaryPayloads);
 
-    if (!sendMessage(msg)) {
+    if (!sendCatalogRequest(msg, catalogKey(protocol::MsgCode::GAME_LEVEL_LIST_REQUEST, req))) {
         if (logger::clientLogger) {
             logger::clientLogger->error("Failed to send game level list request");
         }
@@ -1065,10 +1481,9 @@ bool NetworkClient::requestGameData(const std::string& gameId) {
     Payloads::GameDataRequest req;
     req.sessionToken = sessionToken;
     req.gameId = gameId;
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::GAME_DATA_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::GAME_DATA_REQUEST, req, binaryPayloads);
 
-    if (!sendMessage(msg)) {
+    if (!sendCatalogRequest(msg, catalogKey(protocol::MsgCode::GAME_DATA_REQUEST, req))) {
         if (logger::clientLogger) {
             logger::clientLogger->error("Failed to send game data request");
         }
@@ -1091,8 +1506,7 @@ bool NetworkClient::submitGameResult(const std::string& gameId, const std::strin
     req.gameId = gameId;
     req.score = score;
     req.detailsJson = detailsJson;
-    std::string payload = req.serialize();
-    protocol::Message msg(protocol::MsgCode::GAME_SUBMIT_REQUEST, payload);
+    protocol::Message msg = Payloads::encode(protocol::MsgCode::GAME_SUBMIT_REQUEST, req, binaryPayloads);
 
     if (!sendMessage(msg)) {
         if (logger::clientLogger) {
@@ -0,0 +1,255 @@
+#include "common/adpcm.h"
+#include <algorithm>
+#include <cstring>
+
+namespace audio {
+
+namespace {
+
+const char ADPCM_MAGIC[4] = {'A', 'D', 'P', '1'};
+const size_t ADPCM_HEADER_SIZE = 12;
+const size_t BLOCK_HEADER_SIZE = 4;
+
+const int INDEX_TABLE[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+const int STEP_TABLE[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+uint16_t readU16(const std::string& b, size_t pos) {
+    return static_cast<uint16_t>(static_cast<uint8_t>(b[pos]) | (static_cast<uint8_t>(b[pos + 1]) << 8));
+}
+
+uint32_t readU32(const std::string& b, size_t pos) {
+    return static_cast<uint32_t>(readU16(b, pos)) | (static_cast<uint32_t>(readU16(b, pos + 2)) << 16);
+}
+
+void writeU16(std::string& b, uint16_t v) {
+    b += static_cast<char>(v & 0xFF);
+    b += static_cast<char>((v >> 8) & 0xFF);
+}
+
+void writeU32(std::string& b, uint32_t v) {
+    writeU16(b, static_cast<uint16_t>(v & 0xFFFF));
+    writeU16(b, static_cast<uint16_t>(v >> 16));
+}
+
+int16_t clamp16(int v) {
+    return static_cast<int16_t>(std::max(-32768, std::min(32767, v)));
+}
+
+struct AdpcmState {
+    int predictor = 0;
+    int index = 0;
+};
+
+// Decode one nibble and advance the state (shared by encoder and decoder
+// so the encoder tracks exactly what the decoder will reconstruct)
+int16_t decodeNibble(AdpcmState& st, uint8_t code) {
+    int step = STEP_TABLE[st.index];
+    int diff = step >> 3;
+    if (code & 4) diff += step;
+    if (code & 2) diff += step >> 1;
+    if (code & 1) diff += step >> 2;
+    st.predictor = clamp16((code & 8) ? st.predictor - diff : st.predictor + diff);
+    st.index = std::max(0, std::min(88, st.index + INDEX_TABLE[code]));
+    return static_cast<int16_t>(st.predictor);
+}
+
+uint8_t encodeSample(AdpcmState& st, int16_t sample) {
+    int step = STEP_TABLE[st.index];
+    int diff = sample - st.predictor;
+    uint8_t code = 0;
+    if (diff < 0) {
+        code = 8;
+        diff = -diff;
+    }
+    if (diff >= step) { code |= 4; diff -= step; }
+    if (diff >= (step >> 1)) { code |= 2; diff -= step >> 1; }
+    if (diff >= (step >> 2)) { code |= 1; }
+    decodeNibble(st, code);
+    return code;
+}
+
+} // namespace
+
+bool parseWav(const std::string& bytes, PcmAudio& out) {
+    if (bytes.size() < 12 || bytes.compare(0, 4, "RIFF") != 0 || bytes.compare(8, 4, "WAVE") != 0) {
+        return false;
+    }
+
+    uint16_t format = 0, channels = 0, bitsPerSample = 0;
+    uint32_t sampleRate = 0;
+    size_t dataPos = 0, dataLen = 0;
+
+    size_t pos = 12;
+    while (pos + 8 <= bytes.size()) {
+        std::string id = bytes.substr(pos, 4);
+        uint32_t len = readU32(bytes, pos + 4);
+        size_t body = pos + 8;
+        if (body + len > bytes.size()) len = static_cast<uint32_t>(bytes.size() - body);
+
+        if (id == "fmt " && len >= 16) {
+            format = readU16(bytes, body);
+            channels = readU16(bytes, body + 2);
+            sampleRate = readU32(bytes, body + 4);
+            bitsPerSample = readU16(bytes, body + 14);
+            if (format == 0xFFFE && len >= 26) format = readU16(bytes, body + 24); // WAVE_FORMAT_EXTENSIBLE
+        } else if (id == "data") {
+            dataPos = body;
+            dataLen = len;
+        }
+        pos = body + len + (len & 1);
+    }
+
+    if (format != 1 || channels == 0 || sampleRate == 0 || dataPos == 0 ||
+        (bitsPerSample != 8 && bitsPerSample != 16)) {
+        return false;
+    }
+
+    size_t bytesPerSample = bitsPerSample / 8;
+    size_t frameSize = bytesPerSample * channels;
+    size_t frames = dataLen / frameSize;
+
+    out.sampleRate = sampleRate;
+    out.samples.clear();
+    out.samples.reserve(frames);
+    for (size_t f = 0; f < frames; ++f) {
+        int sum = 0;
+        for (size_t c = 0; c < channels; ++c) {
+            size_t p = dataPos + f * frameSize + c * bytesPerSample;
+            if (bitsPerSample == 16) {
+                sum += static_cast<int16_t>(readU16(bytes, p));
+            } else {
+                sum += (static_cast<int>(static_cast<uint8_t>(bytes[p])) - 128) << 8;
+            }
+        }
+        out.samples.push_back(clamp16(sum / static_cast<int>(channels)));
+    }
+    return true;
+}
+
+std::string buildWav(const PcmAudio& pcm) {
+    uint32_t dataLen = static_cast<uint32_t>(pcm.samples.size() * 2);
+    std::string wav;
+    wav.reserve(44 + dataLen);
+    wav += "RIFF";
+    writeU32(wav, 36 + dataLen);
+    wav += "WAVE";
+    wav += "fmt ";
+    writeU32(wav, 16);
+    writeU16(wav, 1);                  // PCM
+    writeU16(wav, 1);                  // mono
+    writeU32(wav, pcm.sampleRate);
+    writeU32(wav, pcm.sampleRate * 2); // byte rate
+    writeU16(wav, 2);                  // block align
+    writeU16(wav, 16);                 // bits per sample
+    wav += "data";
+    writeU32(wav, dataLen);
+    for (int16_t s : pcm.samples) {
+        writeU16(wav, static_cast<uint16_t>(s));
+    }
+    return wav;
+}
+
+PcmAudio downsample(const PcmAudio& in, uint32_t targetRate) {
+    if (in.sampleRate <= targetRate || targetRate == 0 || in.samples.empty()) {
+        return in;
+    }
+
+    PcmAudio out;
+    out.sampleRate = targetRate;
+    double ratio = static_cast<double>(in.sampleRate) / targetRate;
+    size_t outCount = static_cast<size_t>(in.samples.size() / ratio);
+    out.samples.reserve(outCount);
+
+    // Average the input window each output sample covers (cheap anti-aliasing)
+    for (size_t i = 0; i < outCount; ++i) {
+        size_t begin = static_cast<size_t>(i * ratio);
+        size_t end = std::min(in.samples.size(), static_cast<size_t>((i + 1) * ratio));
+        if (end <= begin) end = begin + 1;
+        long sum = 0;
+        for (size_t j = begin; j < end; ++j) sum += in.samples[j];
+        out.samples.push_back(clamp16(static_cast<int>(sum / static_cast<long>(end - begin))));
+    }
+    return out;
+}
+
+std::string encodeAdpcm(const PcmAudio& pcm) {
+    std::string out(ADPCM_MAGIC, 4);
+    writeU32(out, pcm.sampleRate);
+    writeU32(out, static_cast<uint32_t>(pcm.samples.size()));
+
+    AdpcmState st;
+    for (size_t start = 0; start < pcm.samples.size(); start += ADPCM_BLOCK_SAMPLES) {
+        size_t end = std::min(pcm.samples.size(), start + ADPCM_BLOCK_SAMPLES);
+
+        // Each block restarts from its first sample so blocks decode independently
+        st.predictor = pcm.samples[start];
+        writeU16(out, static_cast<uint16_t>(static_cast<int16_t>(st.predictor)));
+        out += static_cast<char>(st.index);
+        out += '\0';
+
+        uint8_t packed = 0;
+        bool low = true;
+        for (size_t i = start + 1; i < end; ++i) {
+            uint8_t code = encodeSample(st, pcm.samples[i]);
+            if (low) {
+                packed = code;
+            } else {
+                out += static_cast<char>(packed | (code << 4));
+            }
+            low = !low;
+        }
+        if (!low) out += static_cast<char>(packed);
+    }
+    return out;
+}
+
+bool isAdpcm(const std::string& bytes) {
+    return bytes.size() >= ADPCM_HEADER_SIZE && std::memcmp(bytes.data(), ADPCM_MAGIC, 4) == 0;
+}
+
+bool decodeAdpcm(const std::string& bytes, PcmAudio& out) {
+    if (!isAdpcm(bytes)) return false;
+
+    out.sampleRate = readU32(bytes, 4);
+    uint32_t sampleCount = readU32(bytes, 8);
+    out.samples.clear();
+    out.samples.reserve(sampleCount);
+
+    size_t pos = ADPCM_HEADER_SIZE;
+    while (out.samples.size() < sampleCount) {
+        if (pos + BLOCK_HEADER_SIZE > bytes.size()) return false;
+
+        AdpcmState st;
+        st.predictor = static_cast<int16_t>(readU16(bytes, pos));
+        st.index = std::min<int>(88, static_cast<uint8_t>(bytes[pos + 2]));
+        pos += BLOCK_HEADER_SIZE;
+        out.samples.push_back(static_cast<int16_t>(st.predictor));
+
+        size_t remaining = std::min<size_t>(ADPCM_BLOCK_SAMPLES, sampleCount - (out.samples.size() - 1)) - 1;
+        for (size_t i = 0; i < remaining; ++i) {
+            size_t byteIndex = pos + i / 2;
+            if (byteIndex >= bytes.size()) return false;
+            uint8_t b = static_cast<uint8_t>(bytes[byteIndex]);
+            uint8_t code = (i % 2 == 0) ? (b & 0x0F) : (b >> 4);
+            out.samples.push_back(decodeNibble(st, code));
+        }
+        pos += (remaining + 1) / 2;
+    }
+    return true;
+}
+
+} // namespace audio
@@ -0,0 +1,27 @@
+#include "common/arena.h"
+
+namespace arena {
+
+namespace {
+
+thread_local std::pmr::memory_resource* installed = nullptr;
+
+} // namespace
+
+RequestArena::RequestArena()
+    : resource(initial, sizeof(initial), std::pmr::get_default_resource()) {}
+
+std::pmr::memory_resource* current() {
+    return installed ? installed : std::pmr::get_default_resource();
+}
+
+Scope::Scope(RequestArena& a) : arena(a), previous(installed) {
+    installed = arena.get();
+}
+
+Scope::~Scope() {
+    installed = previous;
+    arena.reset();
+}
+
+} // namespace arena
@@ -0,0 +1,160 @@
+#include "common/compression.h"
+#include <zlib.h>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace compression {
+
+namespace {
+
+// Preset dictionary shared by client and server. deflate finds matches
+// against it from the first byte, so it holds the strings our payloads repeat
+// most: question JSON keys, exercise/exam types, levels, statuses and common
+// English. zlib favours the end of the dictionary, so the most frequent
+// strings come last. Changing it breaks compatibility with older peers.
+const char DICTIONARY[] =
+    "https://example.com/videos/https://example.com/audio/.mp4.mp3"
+    "vocabulary grammar text_content video_url audio_url image_url media_url "
+    "sentence_order order_sentence rewrite_sentence write_paragraph speaking_topic "
+    "fill_in_blank fill_blank word_match picture_match sentence_match "
+    "lesson exercise exam game submitted pending graded NOTIFICATION TEXT AUDIO "
+    "teacher student admin beginner;intermediate;advanced;"
+    " the correct answer is  Choose the correct  Fill in the blank  sentence. "
+    "{\"word_pair\": [\"{\"word\": \"\"image_url\": \"\"correct_sentence\": "
+    "\"sentence_parts\": [\"\"options\": [\"\", \"\"], \"answer\": \"\", \"explanation\": \""
+    "\"}, {\"text\": \"\", \"type\": \"multiple_choice\", \"options\": [\"";
+
+constexpr int WINDOW_BITS = -15; // Raw deflate: the frame header already carries the length
+constexpr int LEVEL = 6;
+
+// deflate's best case is a 258-byte match in about two bits, so no stream
+// inflates to more than this many times its own size
+constexpr size_t MAX_EXPANSION = 1032;
+
+// First output buffer of inflatePayload(), doubled as the stream needs
+constexpr size_t INITIAL_OUTPUT = 4096;
+
+void putLength(uint8_t* out, uint32_t value) {
+    out[0] = static_cast<uint8_t>(value >> 24);
+    out[1] = static_cast<uint8_t>(value >> 16);
+    out[2] = static_cast<uint8_t>(value >> 8);
+    out[3] = static_cast<uint8_t>(value);
+}
+
+uint32_t getLength(const uint8_t* in) {
+    return (static_cast<uint32_t>(in[0]) << 24) | (static_cast<uint32_t>(in[1]) << 16) |
+           (static_cast<uint32_t>(in[2]) << 8) | static_cast<uint32_t>(in[3]);
+}
+
+// Streams are set up once per thread and reset between payloads;
+// deflateInit allocates a few hundred KB, too much to repeat per frame.
+struct Deflater {
+    z_stream stream{};
+    bool ready = false;
+
+    Deflater() {
+        ready = deflateInit2(&stream, LEVEL, Z_DEFLATED, WINDOW_BITS, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    }
+    ~Deflater() {
+        if (ready) deflateEnd(&stream);
+    }
+};
+
+struct Inflater {
+    z_stream stream{};
+    bool ready = false;
+
+    Inflater() {
+        ready = inflateInit2(&stream, WINDOW_BITS) == Z_OK;
+    }
+    ~Inflater() {
+        if (ready) inflateEnd(&stream);
+    }
+};
+
+const Bytef* dictionary() { return reinterpret_cast<const Bytef*>(DICTIONARY); }
+constexpr uInt DICTIONARY_SIZE = sizeof(DICTIONARY) - 1;
+
+} // namespace
+
+bool deflatePayload(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    out.clear();
+    if (size == 0 || size > MAX_INFLATED_SIZE) return false;
+
+    thread_local Deflater deflater;
+    if (!deflater.ready) return false;
+
+    z_stream& zs = deflater.stream;
+    deflateReset(&zs);
+    deflateSetDictionary(&zs, dictionary(), DICTIONARY_SIZE);
+
+    // Not worth sending unless it saves something over the raw payload
+    size_t limit = size - 1;
+    out.resize(4 + deflateBound(&zs, static_cast<uLong>(size)));
+    putLength(out.data(), static_cast<uint32_t>(size));
+
+    zs.next_in = const_cast<Bytef*>(data);
+    zs.avail_in = static_cast<uInt>(size);
+    zs.next_out = out.data() + 4;
+    zs.avail_out = static_cast<uInt>(out.size() - 4);
+
+    if (deflate(&zs, Z_FINISH) != Z_STREAM_END || 4 + zs.total_out > limit) {
+        out.clear();
+        return false;
+    }
+
+    out.resize(4 + zs.total_out);
+    return true;
+}
+
+std::vector<uint8_t> inflatePayload(const uint8_t* data, size_t size) {
+    if (size < 4) {
+        throw std::runtime_error("Compressed payload truncated");
+    }
+
+    // The prefix is the peer's claim; check it against what the stream could
+    // possibly hold before trusting it with any memory
+    uint32_t originalSize = getLength(data);
+    size_t compressedSize = size - 4;
+    if (originalSize > MAX_INFLATED_SIZE || originalSize > compressedSize * MAX_EXPANSION) {
+        throw std::runtime_error("Compressed payload too large: " + std::to_string(originalSize));
+    }
+
+    thread_local Inflater inflater;
+    if (!inflater.ready) {
+        throw std::runtime_error("Failed to initialise inflate");
+    }
+
+    z_stream& zs = inflater.stream;
+    inflateReset(&zs);
+    inflateSetDictionary(&zs, dictionary(), DICTIONARY_SIZE);
+    zs.next_in = const_cast<Bytef*>(data + 4);
+    zs.avail_in = static_cast<uInt>(compressedSize);
+
+    // Grow the output as the stream fills it rather than reserving the
+    // declared size up front; it must come to that size exactly
+    std::vector<uint8_t> out(std::min<size_t>(originalSize, std::max(compressedSize * 4, INITIAL_OUTPUT)));
+    size_t produced = 0;
+    while (true) {
+        zs.next_out = out.data() + produced;
+        zs.avail_out = static_cast<uInt>(out.size() - produced);
+        int rc = inflate(&zs, Z_NO_FLUSH);
+        produced = out.size() - zs.avail_out;
+
+        if (rc == Z_STREAM_END) break;
+        // Input used up with room to spare (truncated), or full at the
+        // declared size with more to come
+        if ((rc != Z_OK && rc != Z_BUF_ERROR) || zs.avail_out != 0 || out.size() == originalSize) {
+            throw std::runtime_error("Corrupt compressed payload");
+        }
+        out.resize(std::min<size_t>(originalSize, out.size() * 2));
+    }
+
+    if (produced != originalSize) {
+        throw std::runtime_error("Corrupt compressed payload");
+    }
+    return out;
+}
+
+} // namespace compression
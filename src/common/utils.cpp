@@ -1,9 +1,11 @@
 #include "common/utils.h"
+#include "common/arena.h"
 #include <random>
 #include <iomanip>
 #include <sstream>
 #include <algorithm>
 #include <fstream>
+#include <cstdint>
 
 namespace utils {
 
@@ -26,15 +28,34 @@ std::string generateSessionToken() {
     return ss.str();
 }
 
-std::vector<std::string> split(const std::string& str, char delimiter) {
-    std::vector<std::string> tokens;
-    std::stringstream ss(str);
-    std::string token;
-    
-    while (std::getline(ss, token, delimiter)) {
-        tokens.push_back(token);
+namespace {
+
+// Calls emit(token) for each field, matching std::getline tokenization
+template <typename Emit>
+void forEachToken(std::string_view str, char delimiter, Emit emit) {
+    size_t start = 0;
+    while (start < str.size()) {
+        size_t end = str.find(delimiter, start);
+        if (end == std::string_view::npos) {
+            emit(str.substr(start));
+            return;
+        }
+        emit(str.substr(start, end - start));
+        start = end + 1;
     }
-    
+}
+
+} // namespace
+
+std::vector<std::string> split(std::string_view str, char delimiter) {
+    std::vector<std::string> tokens;
+    forEachToken(str, delimiter, [&](std::string_view token) { tokens.emplace_back(token); });
+    return tokens;
+}
+
+std::pmr::vector<std::string_view> splitView(std::string_view str, char delimiter) {
+    std::pmr::vector<std::string_view> tokens(arena::current());
+    forEachToken(str, delimiter, [&](std::string_view token) { tokens.push_back(token); });
     return tokens;
 }
 
@@ -149,4 +170,113 @@ std::string base64Encode(const std::vector<char>& data) {
     return ret;
 }
 
+std::string base64Decode(const std::string& encoded) {
+    static const std::string base64_chars =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZ"
+        "abcdefghijklmnopqrstuvwxyz"
+        "0123456789+/";
+
+    std::string ret;
+    ret.reserve(encoded.size() / 4 * 3);
+
+    uint32_t buffer = 0;
+    int bits = 0;
+    for (char c : encoded) {
+        if (c == '=') break;
+        size_t value = base64_chars.find(c);
+        if (value == std::string::npos) continue; // Skip whitespace / line breaks
+
+        buffer = (buffer << 6) | static_cast<uint32_t>(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            ret += static_cast<char>((buffer >> bits) & 0xFF);
+        }
+    }
+
+    return ret;
+}
+
+namespace {
+
+const uint32_t SHA256_K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+inline uint32_t rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+void sha256Block(uint32_t state[8], const unsigned char* block) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; ++i) {
+        w[i] = (uint32_t(block[i * 4]) << 24) | (uint32_t(block[i * 4 + 1]) << 16) |
+               (uint32_t(block[i * 4 + 2]) << 8) | uint32_t(block[i * 4 + 3]);
+    }
+    for (int i = 16; i < 64; ++i) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+    for (int i = 0; i < 64; ++i) {
+        uint32_t S1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+        uint32_t ch = (e & f) ^ (~e & g);
+        uint32_t t1 = h + S1 + ch + SHA256_K[i] + w[i];
+        uint32_t S0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = S0 + maj;
+
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+} // namespace
+
+std::string sha256Hex(const std::string& data) {
+    uint32_t state[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+        0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+    };
+
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data.data());
+    size_t fullBlocks = data.size() / 64;
+    for (size_t i = 0; i < fullBlocks; ++i) {
+        sha256Block(state, bytes + i * 64);
+    }
+
+    // Padding: 0x80, zeros, then the message length in bits (big-endian)
+    unsigned char tail[128] = {0};
+    size_t rem = data.size() % 64;
+    std::copy(bytes + fullBlocks * 64, bytes + data.size(), tail);
+    tail[rem] = 0x80;
+    size_t tailLen = (rem < 56) ? 64 : 128;
+    uint64_t bitLen = static_cast<uint64_t>(data.size()) * 8;
+    for (int i = 0; i < 8; ++i) {
+        tail[tailLen - 1 - i] = static_cast<unsigned char>(bitLen >> (i * 8));
+    }
+    sha256Block(state, tail);
+    if (tailLen == 128) sha256Block(state, tail + 64);
+
+    std::stringstream ss;
+    for (uint32_t v : state) {
+        ss << std::hex << std::setw(8) << std::setfill('0') << v;
+    }
+    return ss.str();
+}
+
 } // namespace utils
@@ -0,0 +1,58 @@
+#include "server/attempt_index.h"
+
+namespace server {
+
+bool AttemptIndex::Bitmap::contains(int id) const {
+    if (id < 0) return false;
+    uint32_t bits = static_cast<uint32_t>(id);
+    auto it = chunks.find(bits >> CHUNK_BITS);
+    if (it == chunks.end()) return false;
+    uint32_t offset = bits & ((1u << CHUNK_BITS) - 1);
+    return ((*it->second)[offset / 64] >> (offset % 64)) & 1;
+}
+
+void AttemptIndex::Bitmap::add(int id) {
+    if (id < 0) return;
+    uint32_t bits = static_cast<uint32_t>(id);
+    auto& chunk = chunks[bits >> CHUNK_BITS];
+    if (!chunk) chunk = std::make_unique<Chunk>(Chunk{});
+    uint32_t offset = bits & ((1u << CHUNK_BITS) - 1);
+    (*chunk)[offset / 64] |= uint64_t{1} << (offset % 64);
+}
+
+AttemptIndex::Answer AttemptIndex::check(int examId, int userId) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = exams.find(examId);
+    if (it == exams.end() || !it->second.loaded) return Answer::UNKNOWN;
+    return it->second.users.contains(userId) ? Answer::POSSIBLY_TAKEN : Answer::NOT_TAKEN;
+}
+
+bool AttemptIndex::beginLoad(int examId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return exams.try_emplace(examId).second;
+}
+
+void AttemptIndex::finishLoad(int examId, const std::vector<int>& userIds) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Entry& entry = exams[examId];
+    for (int userId : userIds) {
+        entry.users.add(userId);
+    }
+    entry.loaded = true;
+}
+
+void AttemptIndex::abortLoad(int examId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    exams.erase(examId);
+}
+
+void AttemptIndex::record(int examId, int userId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // Untracked exams pick the result up when they are loaded
+    auto it = exams.find(examId);
+    if (it != exams.end()) {
+        it->second.users.add(userId);
+    }
+}
+
+} // namespace server
@@ -0,0 +1,86 @@
+#include "server/audio_transcoder.h"
+#include "common/adpcm.h"
+#include "common/logger.h"
+#include <chrono>
+
+namespace server {
+
+AudioTranscoder::AudioTranscoder(std::shared_ptr<BlobStore> store)
+    : blobStore(store), worker(&AudioTranscoder::run, this) {}
+
+AudioTranscoder::~AudioTranscoder() {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    queueCv.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void AudioTranscoder::enqueue(const std::string& hash) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        if (!queued.insert(hash).second) return;
+        queue.push_back(hash);
+    }
+    queueCv.notify_one();
+}
+
+void AudioTranscoder::run() {
+    while (true) {
+        std::string hash;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueCv.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (stopping) return;
+            hash = queue.front();
+            queue.pop_front();
+        }
+
+        transcode(hash);
+
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queued.erase(hash);
+    }
+}
+
+void AudioTranscoder::transcode(const std::string& hash) {
+    BlobStore::BlobInfo info = blobStore->lookup(hash);
+    if (!info.found || !info.encoding.empty()) {
+        return; // Gone or already encoded
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::string raw;
+    if (!blobStore->read(hash, 0, static_cast<size_t>(info.size), raw)) {
+        if (logger::serverLogger) logger::serverLogger->error("[Transcoder] Failed to read blob " + hash);
+        return;
+    }
+
+    audio::PcmAudio pcm;
+    if (!audio::parseWav(raw, pcm)) {
+        if (logger::serverLogger) logger::serverLogger->debug("[Transcoder] Blob " + hash + " is not PCM WAV, skipping");
+        return;
+    }
+
+    std::string encoded = audio::encodeAdpcm(audio::downsample(pcm, audio::VOICE_SAMPLE_RATE));
+    if (encoded.size() >= raw.size()) {
+        return; // Nothing to gain
+    }
+
+    if (!blobStore->replaceWithEncoded(hash, ENCODING_ADPCM, encoded)) {
+        if (logger::serverLogger) logger::serverLogger->error("[Transcoder] Failed to store encoded blob for " + hash);
+        return;
+    }
+
+    if (logger::serverLogger) {
+        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        logger::serverLogger->info("[Transcoder] " + hash + ": " + std::to_string(raw.size()) + " -> " +
+                                   std::to_string(encoded.size()) + " bytes in " + std::to_string(ms) + "ms");
+    }
+}
+
+} // namespace server
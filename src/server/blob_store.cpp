@@ -0,0 +1,171 @@
+#include "server/blob_store.h"
+#include "common/logger.h"
+#include "common/utils.h"
+#include <atomic>
+#include <fstream>
+#include <cstdio>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace server {
+
+namespace {
+const std::string REFERENCE_PREFIX = "blob:";
+const std::string ENCODED_SUFFIX = ".ref";
+std::atomic<unsigned> tmpCounter{0};
+}
+
+BlobStore::BlobStore(const std::string& rootDir) : rootDir(rootDir) {
+    mkdir("data", 0755);
+    mkdir(rootDir.c_str(), 0755);
+}
+
+std::string BlobStore::pathFor(const std::string& hash) const {
+    return rootDir + "/" + hash.substr(0, 2) + "/" + hash;
+}
+
+std::string BlobStore::put(const std::string& bytes) {
+    std::string hash = utils::sha256Hex(bytes);
+
+    if (exists(hash)) {
+        if (logger::serverLogger) {
+            logger::serverLogger->debug("[BlobStore] Dedup hit for " + hash);
+        }
+        return hash;
+    }
+
+    std::string shardDir = rootDir + "/" + hash.substr(0, 2);
+    mkdir(shardDir.c_str(), 0755);
+
+    if (!writeAtomically(pathFor(hash), bytes)) {
+        return "";
+    }
+
+    if (logger::serverLogger) {
+        logger::serverLogger->info("[BlobStore] Stored blob " + hash + " (" + std::to_string(bytes.size()) + " bytes)");
+    }
+    return hash;
+}
+
+bool BlobStore::writeAtomically(const std::string& path, const std::string& bytes) const {
+    // Write to a temp file first so a partially written blob is never visible under its hash.
+    // Uploads and the transcoder may write concurrently, hence the per-call counter.
+    std::string tmpPath = path + ".tmp." + std::to_string(getpid()) + "." + std::to_string(tmpCounter++);
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out || !out.write(bytes.data(), bytes.size())) {
+            if (logger::serverLogger) {
+                logger::serverLogger->error("[BlobStore] Failed to write " + tmpPath);
+            }
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        if (logger::serverLogger) {
+            logger::serverLogger->error("[BlobStore] Failed to publish " + path);
+        }
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool BlobStore::exists(const std::string& hash) const {
+    return lookup(hash).found;
+}
+
+BlobStore::BlobInfo BlobStore::lookup(const std::string& hash) const {
+    BlobInfo info;
+    if (!isValidHash(hash)) return info;
+
+    int64_t rawSize = size(hash);
+    if (rawSize >= 0) {
+        info.found = true;
+        info.storedHash = hash;
+        info.size = rawSize;
+        return info;
+    }
+
+    // Encoded replacement: "<encoding>;<storedHash>"
+    std::ifstream ref(pathFor(hash) + ENCODED_SUFFIX);
+    std::string line;
+    if (!ref || !std::getline(ref, line)) return info;
+
+    size_t sep = line.find(';');
+    if (sep == std::string::npos) return info;
+
+    std::string storedHash = line.substr(sep + 1);
+    int64_t storedSize = size(storedHash);
+    if (storedSize < 0) return info;
+
+    info.found = true;
+    info.encoding = line.substr(0, sep);
+    info.storedHash = storedHash;
+    info.size = storedSize;
+    return info;
+}
+
+bool BlobStore::replaceWithEncoded(const std::string& hash, const std::string& encoding, const std::string& encodedBytes) {
+    if (!isValidHash(hash) || encoding.empty()) return false;
+
+    std::string storedHash = put(encodedBytes);
+    if (storedHash.empty()) return false;
+
+    if (!writeAtomically(pathFor(hash) + ENCODED_SUFFIX, encoding + ";" + storedHash + "\n")) {
+        return false;
+    }
+
+    // Readers resolve through the .ref file from now on
+    std::remove(pathFor(hash).c_str());
+
+    if (logger::serverLogger) {
+        logger::serverLogger->info("[BlobStore] Replaced " + hash + " with " + encoding + " blob " + storedHash);
+    }
+    return true;
+}
+
+int64_t BlobStore::size(const std::string& hash) const {
+    if (!isValidHash(hash)) return -1;
+    struct stat st;
+    if (stat(pathFor(hash).c_str(), &st) != 0) return -1;
+    return static_cast<int64_t>(st.st_size);
+}
+
+bool BlobStore::read(const std::string& hash, uint64_t offset, size_t maxLen, std::string& out) const {
+    out.clear();
+    if (!isValidHash(hash)) return false;
+
+    std::ifstream in(pathFor(hash), std::ios::binary);
+    if (!in) return false;
+
+    in.seekg(static_cast<std::streamoff>(offset), std::ios::beg);
+    if (!in) return false;
+
+    out.resize(maxLen);
+    in.read(&out[0], static_cast<std::streamsize>(maxLen));
+    out.resize(static_cast<size_t>(in.gcount()));
+    return true;
+}
+
+bool BlobStore::isValidHash(const std::string& hash) {
+    if (hash.size() != 64) return false;
+    for (char c : hash) {
+        bool isHex = (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+        if (!isHex) return false;
+    }
+    return true;
+}
+
+std::string BlobStore::toReference(const std::string& hash) {
+    return REFERENCE_PREFIX + hash;
+}
+
+bool BlobStore::parseReference(const std::string& content, std::string& hash) {
+    if (content.compare(0, REFERENCE_PREFIX.size(), REFERENCE_PREFIX) != 0) return false;
+    hash = content.substr(REFERENCE_PREFIX.size());
+    return isValidHash(hash);
+}
+
+} // namespace server
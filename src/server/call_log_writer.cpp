@@ -0,0 +1,57 @@
+#include "server/call_log_writer.h"
+#include "common/logger.h"
+#include <chrono>
+
+namespace server {
+
+CallLogWriter::CallLogWriter(std::shared_ptr<CallLogRepository> repo)
+    : repository(repo), worker(&CallLogWriter::run, this) {}
+
+CallLogWriter::~CallLogWriter() {
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        stopping = true;
+    }
+    bufferCv.notify_all();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void CallLogWriter::record(const CallLog& log) {
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(bufferMutex);
+        buffer.push_back(log);
+        // Otherwise the worker is already counting down for a partial batch
+        wake = buffer.size() == 1 || buffer.size() >= MAX_BATCH;
+    }
+    if (wake) bufferCv.notify_one();
+}
+
+void CallLogWriter::run() {
+    while (true) {
+        std::vector<CallLog> batch;
+        bool stop;
+        {
+            std::unique_lock<std::mutex> lock(bufferMutex);
+            bufferCv.wait(lock, [this] { return stopping || !buffer.empty(); });
+            if (!stopping && buffer.size() < MAX_BATCH) {
+                bufferCv.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MS),
+                                  [this] { return stopping || buffer.size() >= MAX_BATCH; });
+            }
+            batch.swap(buffer);
+            stop = stopping;
+        }
+
+        if (!batch.empty() && !repository->saveCallLogs(batch)) {
+            if (logger::serverLogger) {
+                logger::serverLogger->error("[CallLog] Dropped " + std::to_string(batch.size()) + " call log entries");
+            }
+        }
+
+        if (stop) return;
+    }
+}
+
+} // namespace server
@@ -0,0 +1,111 @@
+#include "server/call_registry.h"
+
+namespace server {
+
+uint64_t CallRegistry::findCallId(const std::string& username) const {
+    auto it = byCaller.find(username);
+    if (it != byCaller.end()) return it->second;
+    it = byCallee.find(username);
+    if (it != byCallee.end()) return it->second;
+    return 0;
+}
+
+CallSession CallRegistry::removeCall(uint64_t callId) {
+    auto it = calls.find(callId);
+    CallSession call = it->second;
+    calls.erase(it);
+    call.state = CallState::ENDED;
+
+    byCaller.erase(call.caller);
+    byCallee.erase(call.callee);
+    if (call.relaySessionId != 0) byRelaySession.erase(call.relaySessionId);
+    return call;
+}
+
+CallRegistry::RingResult CallRegistry::ring(const std::string& caller, int callerId,
+                                            const std::string& callee, int calleeId) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    if (findCallId(caller) != 0) return RingResult::CALLER_BUSY;
+    if (findCallId(callee) != 0) return RingResult::CALLEE_BUSY;
+
+    CallSession call;
+    call.callId = nextCallId++;
+    call.caller = caller;
+    call.callee = callee;
+    call.callerId = callerId;
+    call.calleeId = calleeId;
+    call.state = CallState::RINGING;
+    call.ringingSince = std::chrono::steady_clock::now();
+    call.startTime = std::time(nullptr);
+
+    byCaller[caller] = call.callId;
+    byCallee[callee] = call.callId;
+    calls[call.callId] = call;
+    return RingResult::OK;
+}
+
+bool CallRegistry::answer(const std::string& callee, const std::string& caller, CallSession& out) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto idx = byCallee.find(callee);
+    if (idx == byCallee.end()) return false;
+
+    CallSession& call = calls[idx->second];
+    if (call.state != CallState::RINGING || call.caller != caller) return false;
+
+    call.state = CallState::ACTIVE;
+    call.answeredAt = std::chrono::steady_clock::now();
+    out = call;
+    return true;
+}
+
+void CallRegistry::attachRelaySession(uint64_t callId, uint32_t relaySessionId) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto it = calls.find(callId);
+    if (it == calls.end() || it->second.state != CallState::ACTIVE) return;
+
+    it->second.relaySessionId = relaySessionId;
+    byRelaySession[relaySessionId] = callId;
+}
+
+bool CallRegistry::end(const std::string& username, const std::string& peer, CallSession& out) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    uint64_t callId = findCallId(username);
+    if (callId == 0) return false;
+    if (!peer.empty() && calls[callId].peerOf(username) != peer) return false;
+
+    out = removeCall(callId);
+    return true;
+}
+
+bool CallRegistry::endByRelaySession(uint32_t relaySessionId, CallSession& out) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    auto idx = byRelaySession.find(relaySessionId);
+    if (idx == byRelaySession.end()) return false;
+
+    out = removeCall(idx->second);
+    return true;
+}
+
+std::vector<CallSession> CallRegistry::takeUnanswered(std::chrono::seconds timeout) {
+    std::vector<CallSession> expired;
+    auto now = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::vector<uint64_t> ids;
+    for (const auto& pair : calls) {
+        if (pair.second.state == CallState::RINGING && now - pair.second.ringingSince > timeout) {
+            ids.push_back(pair.first);
+        }
+    }
+    for (uint64_t id : ids) {
+        expired.push_back(removeCall(id));
+    }
+    return expired;
+}
+
+bool CallRegistry::isBusy(const std::string& username) const {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return findCallId(username) != 0;
+}
+
+} // namespace server
@@ -0,0 +1,39 @@
+#include "server/catalog_versions.h"
+#include <chrono>
+
+namespace server {
+
+CatalogVersions::CatalogVersions() {
+    // Seconds since the epoch, shifted to leave room for bumps
+    uint64_t start = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+    for (auto& version : versions) {
+        version = start << 20;
+    }
+}
+
+uint64_t CatalogVersions::current(Catalog catalog) const {
+    return versions[static_cast<size_t>(catalog)].load();
+}
+
+void CatalogVersions::bump(Catalog catalog) {
+    versions[static_cast<size_t>(catalog)].fetch_add(1);
+}
+
+bool CatalogVersions::isNotModified(const protocol::Message& request, Catalog catalog) const {
+    return request.contentVersion && *request.contentVersion == current(catalog);
+}
+
+protocol::Message CatalogVersions::notModified(Catalog catalog) const {
+    protocol::Message response(protocol::MsgCode::NOT_MODIFIED, "");
+    response.contentVersion = current(catalog);
+    return response;
+}
+
+void CatalogVersions::stamp(const protocol::Message& request, protocol::Message& response, Catalog catalog) const {
+    if (request.contentVersion) {
+        response.contentVersion = current(catalog);
+    }
+}
+
+} // namespace server
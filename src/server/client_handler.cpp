@@ -1,7 +1,10 @@
 #include "server/client_handler.h"
+#include "server/connection.h"
+#include "server/reply_context.h"
 #include "server/session.h"
 #include "server/connection_manager.h"
 #include "server/request_router.h"
+#include "common/arena.h"
 #include "common/logger.h"
 #include "common/utils.h"
 #include <sys/socket.h>
@@ -16,19 +19,30 @@ ClientHandler::ClientHandler(
     std::shared_ptr<RequestRouter> rr)
     : sessionManager_(sm), connectionManager_(cm), requestRouter_(rr) {}
 
-void ClientHandler::processMessage(int clientFd, const std::vector<uint8_t>& data) {
-    clientFd_ = clientFd;
+void ClientHandler::processMessage(Connection& conn, const uint8_t* frame, size_t size) {
+    int clientFd = conn.fd;
     protocol::Message response; // Declare response here
     
-    if (data.empty()) {
+    if (size == 0) {
         if (logger::serverLogger) {
             logger::serverLogger->warn("Received empty data from fd=" + std::to_string(clientFd));
         }
         return;
     }
 
+    // Parse temporaries, reset after every message; one per thread so
+    // handlers stay reentrant
+    thread_local arena::RequestArena requestArena;
+    arena::Scope requestScope(requestArena);
+    uint32_t correlationId = 0;
+    conn.stats.framesIn++;
+    conn.stats.bytesIn += size;
+
     try {
-        protocol::Message msg = protocol::Message::deserialize(data);
+        // Compressed frames only from a client that negotiated deflate
+        protocol::Message msg = protocol::Message::deserializeView(frame, size, conn.capabilities.compression);
+        correlationId = msg.correlationId;
+        ReplyScope replyScope(conn, correlationId);
         
         if (logger::serverLogger) {
             logger::serverLogger->debug("Received message code: " + std::to_string(static_cast<uint16_t>(msg.code)) +
@@ -36,46 +50,55 @@ void ClientHandler::processMessage(int clientFd, const std::vector<uint8_t>& dat
         }
 
         if (logger::messageLogger) {
-            logger::messageLogger->logMessage("Client(" + std::to_string(clientFd) + ")", msg.toString());
+            // Blob chunks are bulk media; log their size rather than the Base64 body
+            std::string logged;
+            if (msg.code == protocol::MsgCode::BLOB_UPLOAD_CHUNK) {
+                logged = "<blob chunk, " + std::to_string(msg.payloadSize()) + " bytes>";
+            } else if (msg.binary) {
+                logged = "<binary payload, " + std::to_string(msg.payloadSize()) + " bytes>";
+            } else {
+                logged = msg.toString();
+            }
+            logger::messageLogger->logMessage("Client(" + std::to_string(clientFd) + ")", logged);
         }
 
             switch (msg.code) {
             case protocol::MsgCode::HEARTBEAT:
-                handleHeartbeat(msg);
+                handleHeartbeat(conn, msg);
                 break;
             case protocol::MsgCode::DISCONNECT_REQUEST:
-                handleDisconnectRequest();
+                handleDisconnectRequest(conn);
                 break;
 
             default:
                 // Delegate all other messages (including LOGIN/LOGOUT) to the RequestRouter
-                requestRouter_->handleMessage(clientFd, msg, this);
+                requestRouter_->handleMessage(conn, msg);
                 break;
         }
     } catch (const std::exception& e) {
         if (logger::serverLogger) {
             logger::serverLogger->error("Error processing message from fd=" + std::to_string(clientFd) + ": " + e.what());
         }
+        ReplyScope replyScope(conn, correlationId);
         response = protocol::Message(protocol::MsgCode::GENERAL_FAILURE, "Server error processing message");
-        send_message(response);
+        send_message(conn, response);
     }
 }
 
 
-void ClientHandler::handleHeartbeat(const protocol::Message& msg) {
+void ClientHandler::handleHeartbeat(Connection& conn, const protocol::Message& msg) {
     std::string sessionId = msg.toString();
     
     if (sessionId.empty()) {
         if (logger::serverLogger) {
             logger::serverLogger->error("No session token in heartbeat from fd=" + 
-                                       std::to_string(clientFd_));
+                                       std::to_string(conn.fd));
         }
         return;
     }
 
-    // Validate and update session
-    if (sessionManager_->is_session_valid(sessionId)) {
-        sessionManager_->update_session(sessionId);
+    // Validate the session; authenticate() records the activity
+    if (sessionManager_->authenticate(conn, sessionId) != -1) {
         
         if (logger::heartbeatLogger) {
             logger::heartbeatLogger->info("Heartbeat from session " + sessionId);
@@ -83,48 +106,52 @@ void ClientHandler::handleHeartbeat(const protocol::Message& msg) {
     } else {
         if (logger::heartbeatLogger) {
             logger::heartbeatLogger->warn("Invalid session in heartbeat from fd=" + 
-                                      std::to_string(clientFd_));
+                                      std::to_string(conn.fd));
         }
     }
 }
 
-void ClientHandler::handleDisconnectRequest() {
+void ClientHandler::handleDisconnectRequest(Connection& conn) {
     // Send acknowledgment
     protocol::Message response(protocol::MsgCode::DISCONNECT_ACK, "Disconnect acknowledged");
-    send_message(response);
+    send_message(conn, response);
     
     if (logger::serverLogger) {
-        logger::serverLogger->info("Disconnect request from fd=" + std::to_string(clientFd_));
+        logger::serverLogger->info("Disconnect request from fd=" + std::to_string(conn.fd));
     }
 }
 
-void ClientHandler::handleClientDisconnect(int clientFd) {
+void ClientHandler::handleClientDisconnect(Connection& conn) {
     // Unregister client
-    int userId = sessionManager_->get_user_id_by_fd(clientFd);
-    if (userId != -1) {
-        connectionManager_->remove_client(userId);
-    }
+    connectionManager_->detach(conn);
 
     // Remove session if exists
-    sessionManager_->remove_session_by_fd(clientFd);
+    sessionManager_->remove_session_by_fd(conn.fd);
     
     if (logger::serverLogger) {
-        logger::serverLogger->info("Client disconnected (fd=" + std::to_string(clientFd) + ")");
+        // The event loop may still be flushing (and counting) output
+        Connection::Stats stats = conn.statsSnapshot();
+        auto seconds = std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now() - stats.connectedAt).count();
+        logger::serverLogger->info("Client disconnected (fd=" + std::to_string(conn.fd) + ", " +
+                                   std::to_string(seconds) + "s, in " + std::to_string(stats.framesIn) +
+                                   " frames/" + std::to_string(stats.bytesIn) + " bytes, out " +
+                                   std::to_string(stats.framesOut) + " frames/" +
+                                   std::to_string(stats.bytesOut) + " bytes in " +
+                                   std::to_string(stats.writeCalls) + " writes)");
     }
 }
 
-bool ClientHandler::send_message(const protocol::Message& msg) {
-    std::vector<uint8_t> data = msg.serialize();
-    
+bool ClientHandler::send_message(Connection& conn, const protocol::Message& msg) {
     if (logger::messageLogger) {
-        logger::messageLogger->logMessage("Server->Client(" + std::to_string(clientFd_) + ")", msg.toString());
+        logger::messageLogger->logMessage("Server->Client(" + std::to_string(conn.fd) + ")", msg.toString());
     }
 
-    ssize_t sent = send(clientFd_, data.data(), data.size(), 0);
+    ssize_t sent = sendReply(conn, msg);
     
     if (sent < 0) {
         if (logger::serverLogger) {
-            logger::serverLogger->error("Failed to send message to fd=" + std::to_string(clientFd_));
+            logger::serverLogger->error("Failed to send message to fd=" + std::to_string(conn.fd));
         }
         return false;
     }
@@ -132,9 +159,5 @@ bool ClientHandler::send_message(const protocol::Message& msg) {
     return true;
 }
 
-int ClientHandler::get_user_id() const {
-    return sessionManager_->get_user_id_by_fd(clientFd_);
-}
-
 } // namespace server
 
@@ -0,0 +1,158 @@
+#include "server/connection.h"
+#include "common/logger.h"
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace server {
+
+ssize_t Connection::write(const uint8_t* data, size_t size) {
+    if (broken.load(std::memory_order_acquire)) {
+        return -1;
+    }
+    return write(std::vector<uint8_t>(data, data + size));
+}
+
+ssize_t Connection::write(std::vector<uint8_t>&& data) {
+    size_t size = data.size();
+    size_t queued = 0;
+    if (!enqueue(std::make_shared<const std::vector<uint8_t>>(std::move(data)), queued)) {
+        return -1;
+    }
+    // Only the writer's own replies flush early; pushes wait for the loop
+    if (wakeup && queued >= CORK_LIMIT && !flush()) {
+        return -1;
+    }
+    return static_cast<ssize_t>(size);
+}
+
+bool Connection::push(Outbox::Frame frame) {
+    size_t queued = 0;
+    return enqueue(std::move(frame), queued);
+}
+
+bool Connection::enqueue(Outbox::Frame frame, size_t& queued) {
+    if (broken.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    size_t size = frame->size();
+    queued = outboxBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    if (queued > MAX_PENDING_OUTPUT) {
+        outboxBytes.fetch_sub(size, std::memory_order_relaxed);
+        if (logger::serverLogger) {
+            logger::serverLogger->warn("fd=" + std::to_string(fd) + " is not reading its output; closing");
+        }
+        broken.store(true, std::memory_order_release);
+        return false;
+    }
+
+    if (!wakeup) {
+        outbox.push(std::move(frame));
+        return flush();
+    }
+    if (outbox.push(std::move(frame))) {
+        wakeup->notify();
+    }
+    return true;
+}
+
+bool Connection::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (Outbox::Frame& frame : outbox.take()) {
+        outboxBytes.fetch_sub(frame->size(), std::memory_order_relaxed);
+        if (closed) continue;
+        pendingBytes += frame->size();
+        pending.push_back(std::move(frame));
+    }
+    if (!broken.load(std::memory_order_relaxed) && pendingBytes - pendingOffset > MAX_PENDING_OUTPUT) {
+        if (logger::serverLogger) {
+            logger::serverLogger->warn("fd=" + std::to_string(fd) + " is not reading its output; closing");
+        }
+        broken.store(true, std::memory_order_release);
+    }
+
+    while (!broken.load(std::memory_order_relaxed) && !pending.empty()) {
+        // Everything queued this pass goes out in one syscall where the socket takes it
+        iovec iov[MAX_IOV];
+        size_t count = 0;
+        for (auto it = pending.begin(); it != pending.end() && count < MAX_IOV; ++it, ++count) {
+            size_t skip = count == 0 ? pendingOffset : 0;
+            iov[count].iov_base = const_cast<uint8_t*>((*it)->data() + skip);
+            iov[count].iov_len = (*it)->size() - skip;
+        }
+        msghdr message{};
+        message.msg_iov = iov;
+        message.msg_iovlen = count;
+
+        ssize_t n = ::sendmsg(fd, &message, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+            if (logger::serverLogger) {
+                logger::serverLogger->error("Send to fd=" + std::to_string(fd) + " failed: " + std::strerror(errno));
+            }
+            broken.store(true, std::memory_order_release);
+            break;
+        }
+        stats.writeCalls++;
+
+        size_t sent = static_cast<size_t>(n);
+        while (!pending.empty()) {
+            size_t frameSize = pending.front()->size();
+            if (sent < frameSize - pendingOffset) {
+                pendingOffset += sent;
+                break;
+            }
+            sent -= frameSize - pendingOffset;
+            stats.framesOut++;
+            stats.bytesOut += frameSize;
+            pendingBytes -= frameSize;
+            pending.pop_front();
+            pendingOffset = 0;
+        }
+    }
+    return !broken.load(std::memory_order_relaxed);
+}
+
+void Connection::close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (closed) return;
+    closed = true;
+    broken.store(true, std::memory_order_release);
+    pending.clear();
+    pendingOffset = 0;
+    pendingBytes = 0;
+    for (const Outbox::Frame& frame : outbox.take()) {
+        outboxBytes.fetch_sub(frame->size(), std::memory_order_relaxed);
+    }
+    ::close(fd);
+}
+
+void Connection::setCapabilities(const protocol::Capabilities& negotiated) {
+    std::lock_guard<std::mutex> lock(mutex);
+    capabilities = negotiated;
+}
+
+protocol::Capabilities Connection::capabilitiesSnapshot() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return capabilities;
+}
+
+Connection::Stats Connection::statsSnapshot() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+bool Connection::hasPendingOutput() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return !pending.empty();
+}
+
+bool Connection::isBroken() const {
+    return broken.load(std::memory_order_acquire);
+}
+
+} // namespace server
@@ -1,51 +1,178 @@
 #include "server/connection_manager.h"
 #include "common/logger.h"
-#include <sys/socket.h>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
 namespace server {
 
-ConnectionManager::ConnectionManager(std::shared_ptr<SessionManager> sm) : sessionManager(sm) {}
+ConnectionManager::ConnectionManager(std::shared_ptr<SessionManager> sm,
+                                     std::shared_ptr<NotificationRepository> notifications)
+    : sessionManager(sm), notifications(notifications) {}
 
-void ConnectionManager::add_client(int user_id, ClientHandler* client) {
-    active_clients_[user_id] = client;
+void ConnectionManager::attach(Connection& conn) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    connections_[conn.fd] = &conn;
 }
 
-void ConnectionManager::remove_client(int user_id) {
-    active_clients_.erase(user_id);
+void ConnectionManager::detach(Connection& conn) {
+    remove_client(conn);
+    std::lock_guard<std::mutex> lock(mutex_);
+    connections_.erase(conn.fd);
 }
 
-ClientHandler* ConnectionManager::get_client(int user_id) {
-    auto it = active_clients_.find(user_id);
-    if (it != active_clients_.end()) {
-        return it->second;
+void ConnectionManager::add_client(Connection& conn) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& conns = user_connections_[conn.userId];
+    if (std::find(conns.begin(), conns.end(), &conn) == conns.end()) {
+        conns.push_back(&conn);
     }
-    return nullptr;
 }
 
-void ConnectionManager::sendToUser(int userId, const protocol::Message& msg) {
-    if (!sessionManager) return;
+void ConnectionManager::remove_client(Connection& conn) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto subscribed = connection_topics_.find(&conn);
+    if (subscribed != connection_topics_.end()) {
+        for (const std::string& topic : subscribed->second) {
+            auto subscribers = topic_subscribers_.find(topic);
+            if (subscribers == topic_subscribers_.end()) continue;
+            subscribers->second.erase(&conn);
+            if (subscribers->second.empty()) topic_subscribers_.erase(subscribers);
+        }
+        connection_topics_.erase(subscribed);
+    }
 
-    std::vector<int> fds = sessionManager->get_fds_by_user_id(userId);
-    std::vector<uint8_t> data = msg.serialize();
+    auto it = user_connections_.find(conn.userId);
+    if (it == user_connections_.end()) return;
 
-    for (int fd : fds) {
-        ssize_t sent = send(fd, data.data(), data.size(), 0);
-        if (sent < 0) {
-            if (logger::serverLogger) {
-                logger::serverLogger->error("Failed to send push notification to fd=" + std::to_string(fd));
-            }
-        } else {
-            if (logger::serverLogger) {
-                logger::serverLogger->debug("Sent push notification to fd=" + std::to_string(fd));
-            }
+    auto& conns = it->second;
+    conns.erase(std::remove(conns.begin(), conns.end(), &conn), conns.end());
+    if (conns.empty()) {
+        user_connections_.erase(it);
+    }
+}
+
+size_t ConnectionManager::sendToUser(int userId, const protocol::Message& msg) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return sendToUserLocked(userId, msg);
+}
+
+size_t ConnectionManager::sendToUserLocked(int userId, const protocol::Message& msg) {
+    auto it = user_connections_.find(userId);
+    if (it == user_connections_.end()) return 0;
+
+    Outbox::Frame frames[2]; // Indexed by whether the connection negotiated compression
+    size_t queued = 0;
+
+    for (Connection* conn : it->second) {
+        protocol::Capabilities capabilities = conn->capabilitiesSnapshot();
+        bool useCompression = capabilities.compression;
+        Outbox::Frame& frame = frames[useCompression];
+        if (!frame) {
+            frame = std::make_shared<const std::vector<uint8_t>>(
+                msg.serialize(msg.correlationId, msg.compress || useCompression));
         }
+        if (sendTo(*conn, frame, capabilities)) ++queued;
     }
+    return queued;
+}
+
+bool ConnectionManager::sendTo(Connection& conn, const Outbox::Frame& frame,
+                               const protocol::Capabilities& capabilities) {
+    if (frame->size() > capabilities.maxFrameSize) {
+        if (logger::serverLogger) {
+            logger::serverLogger->warn("Push of " + std::to_string(frame->size()) + " bytes exceeds the frame limit of fd=" +
+                                       std::to_string(conn.fd) + "; dropped");
+        }
+        return false;
+    }
+
+    if (!conn.push(frame)) {
+        if (logger::serverLogger) {
+            logger::serverLogger->error("Failed to queue push notification for fd=" + std::to_string(conn.fd));
+        }
+        return false;
+    }
+    if (logger::serverLogger) {
+        logger::serverLogger->debug("Queued push notification for fd=" + std::to_string(conn.fd));
+    }
+    return true;
 }
 
 bool ConnectionManager::isUserOnline(int userId) const {
-    auto it = active_clients_.find(userId);
-    return it != active_clients_.end() && it->second != nullptr;
+    std::lock_guard<std::mutex> lock(mutex_);
+    return user_connections_.count(userId) > 0;
+}
+
+void ConnectionManager::notifyUser(int userId, const std::string& text) {
+    protocol::Message push(protocol::MsgCode::NOTIFICATION_PUSH, text);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (user_connections_.count(userId) > 0) {
+            sendToUserLocked(userId, push);
+            return;
+        }
+    }
+
+    // Stored outside the lock, which every push takes
+    int id = notifications->save(userId, text);
+
+    // A login between the check and the insert may have read its digest
+    // already; push it now rather than at the login after. At worst the
+    // client sees it twice.
+    if (id != -1 && sendToUser(userId, push) > 0) {
+        notifications->remove({{userId, id}});
+    }
+}
+
+void ConnectionManager::subscribe(Connection& conn, const std::string& topic) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (topic_subscribers_[topic].insert(&conn).second) {
+        connection_topics_[&conn].push_back(topic);
+    }
+}
+
+void ConnectionManager::unsubscribe(Connection& conn, const std::string& topic) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto subscribers = topic_subscribers_.find(topic);
+    if (subscribers == topic_subscribers_.end() || subscribers->second.erase(&conn) == 0) return;
+    if (subscribers->second.empty()) topic_subscribers_.erase(subscribers);
+
+    auto& subscribed = connection_topics_[&conn];
+    subscribed.erase(std::remove(subscribed.begin(), subscribed.end(), topic), subscribed.end());
+    if (subscribed.empty()) connection_topics_.erase(&conn);
+}
+
+size_t ConnectionManager::publish(const std::string& topic, const std::string& text) {
+    protocol::Message msg(protocol::MsgCode::NOTIFICATION_PUSH, text);
+    Outbox::Frame frames[2]; // Indexed by whether the connection negotiated compression
+    size_t queued = 0;
+    size_t dropped = 0;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = topic_subscribers_.find(topic);
+    if (it == topic_subscribers_.end()) return 0;
+
+    // No per-recipient work beyond queueing the shared frame; failures are
+    // logged once for the whole fan-out
+    for (Connection* conn : it->second) {
+        protocol::Capabilities capabilities = conn->capabilitiesSnapshot();
+        Outbox::Frame& frame = frames[capabilities.compression];
+        if (!frame) {
+            frame = std::make_shared<const std::vector<uint8_t>>(msg.serialize(0, capabilities.compression));
+        }
+        if (frame->size() <= capabilities.maxFrameSize && conn->push(frame)) {
+            ++queued;
+        } else {
+            ++dropped;
+        }
+    }
+
+    if (logger::serverLogger) {
+        logger::serverLogger->info("Published to " + topic + ": " + std::to_string(queued) + " connections" +
+                                   (dropped ? ", " + std::to_string(dropped) + " dropped" : std::string()));
+    }
+    return queued;
 }
 
 } // namespace server
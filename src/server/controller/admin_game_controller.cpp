@@ -1,4 +1,5 @@
 #include "server/controller/admin_game_controller.h"
+#include "server/reply_context.h"
 #include "common/payloads.h"
 #include "common/logger.h"
 #include <vector>
@@ -7,32 +8,32 @@
 namespace server {
 
 AdminGameController::AdminGameController(std::shared_ptr<SessionManager> sm, 
-                                         std::shared_ptr<GameRepository> gr)
-    : sessionManager(sm), gameRepository(gr) {}
-
-bool AdminGameController::sendMessage(int clientFd, const protocol::Message& msg) {
-    if (clientFd < 0) return false;
-    std::vector<uint8_t> data = msg.serialize();
-    return send(clientFd, data.data(), data.size(), 0) != -1;
+                                         std::shared_ptr<GameRepository> gr,
+                                         std::shared_ptr<CatalogVersions> cv,
+                                         std::shared_ptr<ConnectionManager> cm)
+    : sessionManager(sm), gameRepository(gr), catalogVersions(cv), connectionManager(cm) {}
+
+bool AdminGameController::sendMessage(Connection& conn, const protocol::Message& msg) {
+    if (conn.fd < 0) return false;
+    return sendReply(conn, msg) != -1;
 }
 
-void AdminGameController::handleGameCreateRequest(int clientFd, const protocol::Message& msg) {
-    auto payloadStr = msg.toString();
+void AdminGameController::handleGameCreateRequest(Connection& conn, const protocol::Message& msg) {
     Payloads::GameCreateRequest req;
-    req.deserialize(payloadStr);
+    Payloads::decode(msg, req);
 
-    // Note: RBAC Middleware should have already verified the admin role.
+    // Note: the route table should have already verified the admin role.
     // We double check session validity here just in case.
-    if (!sessionManager->is_session_valid(req.sessionToken)) {
+    if (sessionManager->authenticate(conn, req.sessionToken) == -1) {
          protocol::Message response(protocol::MsgCode::GAME_CREATE_FAILURE, "Invalid session");
-         sendMessage(clientFd, response);
+         sendMessage(conn, response);
          return; 
     }
 
-    // Role check (redundant if middleware works, but safe)
-    if (sessionManager->get_user_role_by_fd(clientFd) != "admin") {
+    // Role check (redundant with the route table, but safe)
+    if (conn.roleBits != roles::ADMIN) {
          protocol::Message response(protocol::MsgCode::GAME_CREATE_FAILURE, "Unauthorized");
-         sendMessage(clientFd, response);
+         sendMessage(conn, response);
          return;
     }
 
@@ -40,31 +41,33 @@ void AdminGameController::handleGameCreateRequest(int clientFd, const protocol::
     int newId = gameRepository->createGame(newGame);
 
     if (newId > 0) {
+        catalogVersions->bump(CatalogVersions::Catalog::GAMES);
         Payloads::GenericResponse resp;
         resp.success = true;
         resp.message = std::to_string(newId); // Return the ID of created game
-        protocol::Message response(protocol::MsgCode::GAME_CREATE_SUCCESS, resp.serialize());
-        sendMessage(clientFd, response);
+        protocol::Message response = Payloads::encode(protocol::MsgCode::GAME_CREATE_SUCCESS, resp, msg.binary);
+        sendMessage(conn, response);
+
+        connectionManager->publish(topics::level(req.level), "New " + req.type + " game for level " + req.level);
     } else {
         protocol::Message response(protocol::MsgCode::GAME_CREATE_FAILURE, "Failed to create game");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
     }
 }
 
-void AdminGameController::handleGameUpdateRequest(int clientFd, const protocol::Message& msg) {
-    auto payloadStr = msg.toString();
+void AdminGameController::handleGameUpdateRequest(Connection& conn, const protocol::Message& msg) {
     Payloads::GameUpdateRequest req;
-    req.deserialize(payloadStr);
+    Payloads::decode(msg, req);
 
-    if (!sessionManager->is_session_valid(req.sessionToken)) {
+    if (sessionManager->authenticate(conn, req.sessionToken) == -1) {
          protocol::Message response(protocol::MsgCode::GAME_UPDATE_FAILURE, "Invalid session");
-         sendMessage(clientFd, response);
+         sendMessage(conn, response);
          return; 
     }
 
-    if (sessionManager->get_user_role_by_fd(clientFd) != "admin") {
+    if (conn.roleBits != roles::ADMIN) {
          protocol::Message response(protocol::MsgCode::GAME_UPDATE_FAILURE, "Unauthorized");
-         sendMessage(clientFd, response);
+         sendMessage(conn, response);
          return;
     }
 
@@ -72,45 +75,46 @@ void AdminGameController::handleGameUpdateRequest(int clientFd, const protocol::
     bool success = gameRepository->updateGame(game);
 
     if (success) {
+        catalogVersions->bump(CatalogVersions::Catalog::GAMES);
         Payloads::GenericResponse resp;
         resp.success = true;
         resp.message = "Game updated successfully";
-        protocol::Message response(protocol::MsgCode::GAME_UPDATE_SUCCESS, resp.serialize());
-        sendMessage(clientFd, response);
+        protocol::Message response = Payloads::encode(protocol::MsgCode::GAME_UPDATE_SUCCESS, resp, msg.binary);
+        sendMessage(conn, response);
     } else {
         protocol::Message response(protocol::MsgCode::GAME_UPDATE_FAILURE, "Failed to update game");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
     }
 }
 
-void AdminGameController::handleGameDeleteRequest(int clientFd, const protocol::Message& msg) {
-    auto payloadStr = msg.toString();
+void AdminGameController::handleGameDeleteRequest(Connection& conn, const protocol::Message& msg) {
     Payloads::GameDeleteRequest req;
-    req.deserialize(payloadStr);
+    Payloads::decode(msg, req);
 
-    if (!sessionManager->is_session_valid(req.sessionToken)) {
+    if (sessionManager->authenticate(conn, req.sessionToken) == -1) {
          protocol::Message response(protocol::MsgCode::GAME_DELETE_FAILURE, "Invalid session");
-         sendMessage(clientFd, response);
+         sendMessage(conn, response);
          return; 
     }
 
-    if (sessionManager->get_user_role_by_fd(clientFd) != "admin") {
+    if (conn.roleBits != roles::ADMIN) {
          protocol::Message response(protocol::MsgCode::GAME_DELETE_FAILURE, "Unauthorized");
-         sendMessage(clientFd, response);
+         sendMessage(conn, response);
          return;
     }
 
     bool success = gameRepository->deleteGame(std::stoi(req.gameId));
 
     if (success) {
+        catalogVersions->bump(CatalogVersions::Catalog::GAMES);
         Payloads::GenericResponse resp;
         resp.success = true;
         resp.message = "Game deleted successfully";
-        protocol::Message response(protocol::MsgCode::GAME_DELETE_SUCCESS, resp.serialize());
-        sendMessage(clientFd, response);
+        protocol::Message response = Payloads::encode(protocol::MsgCode::GAME_DELETE_SUCCESS, resp, msg.binary);
+        sendMessage(conn, response);
     } else {
         protocol::Message response(protocol::MsgCode::GAME_DELETE_FAILURE, "Failed to delete game");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
     }
 }
 
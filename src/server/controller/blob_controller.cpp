@@ -0,0 +1,266 @@
+#include "server/controller/blob_controller.h"
+#include "server/reply_context.h"
+#include "common/payloads.h"
+#include "common/utils.h"
+#include "common/logger.h"
+#include "common/adpcm.h"
+#include "server/audio_transcoder.h"
+#include <sys/socket.h>
+#include <vector>
+
+namespace server {
+
+namespace {
+const int UPLOAD_IDLE_TIMEOUT_SECONDS = 30;
+}
+
+BlobController::BlobController(std::shared_ptr<SessionManager> sessionMgr,
+                               std::shared_ptr<BlobStore> store)
+    : sessionManager(sessionMgr), blobStore(store) {}
+
+bool BlobController::sendMessage(Connection& conn, const protocol::Message& msg) {
+    ssize_t sent = sendReply(conn, msg);
+    if (sent < 0) {
+        if (logger::serverLogger) {
+            logger::serverLogger->error("[Blob] Failed to send message to fd=" + std::to_string(conn.fd));
+        }
+        return false;
+    }
+    return true;
+}
+
+void BlobController::sendUploadFailure(Connection& conn, const std::string& uploadId, const std::string& reason, bool binary) {
+    Payloads::BlobUploadResult result;
+    result.uploadId = uploadId;
+    result.message = reason;
+    sendMessage(conn, Payloads::encode(protocol::MsgCode::BLOB_UPLOAD_FAILURE, result, binary));
+}
+
+void BlobController::sendDownloadFailure(Connection& conn, const std::string& hash, const std::string& reason, bool binary) {
+    Payloads::BlobDownloadFailure failure;
+    failure.hash = hash;
+    failure.message = reason;
+    sendMessage(conn, Payloads::encode(protocol::MsgCode::BLOB_DOWNLOAD_FAILURE, failure, binary));
+}
+
+void BlobController::handleBlobUploadChunk(Connection& conn, const protocol::Message& msg) {
+    Payloads::BlobUploadChunk req;
+    Payloads::decode(msg, req);
+
+    int userId = sessionManager->authenticate(conn, req.sessionToken);
+    if (userId == -1) {
+        sendUploadFailure(conn, req.uploadId, "Invalid session", msg.binary);
+        return;
+    }
+
+    uint64_t offset = 0;
+    uint64_t totalSize = 0;
+    try {
+        offset = std::stoull(req.offset);
+        totalSize = std::stoull(req.totalSize);
+    } catch (...) {
+        sendUploadFailure(conn, req.uploadId, "Invalid chunk header", msg.binary);
+        return;
+    }
+
+    if (req.uploadId.empty() || totalSize == 0 || totalSize > MAX_BLOB_SIZE) {
+        sendUploadFailure(conn, req.uploadId, "Invalid upload size", msg.binary);
+        return;
+    }
+
+    std::string chunk = utils::base64Decode(req.data);
+    std::string key = std::to_string(userId) + ":" + req.uploadId;
+    std::string completed;
+    {
+        std::unique_lock<std::mutex> lock(uploadsMutex);
+        auto it = pendingUploads.find(key);
+        if (offset == 0) {
+            // A new upload (or a restart of an abandoned one with the same id)
+            if (it != pendingUploads.end()) {
+                eraseUpload(it);
+            }
+            UploadQuota& quota = uploadQuotas[userId];
+            if (quota.uploads >= MAX_PENDING_UPLOADS_PER_USER ||
+                quota.declaredBytes + totalSize > MAX_PENDING_BYTES_PER_USER) {
+                if (quota.uploads == 0) uploadQuotas.erase(userId);
+                lock.unlock();
+                if (logger::serverLogger) {
+                    logger::serverLogger->warn("[Blob] Rejecting upload " + req.uploadId + " from user " +
+                                               std::to_string(userId) + ": too many uploads in progress");
+                }
+                sendUploadFailure(conn, req.uploadId, "Too many uploads in progress", msg.binary);
+                return;
+            }
+            quota.uploads++;
+            quota.declaredBytes += totalSize;
+
+            PendingUpload upload;
+            upload.userId = userId;
+            upload.totalSize = totalSize;
+            it = pendingUploads.emplace(key, std::move(upload)).first;
+        } else if (it == pendingUploads.end() || it->second.bytes.size() != offset || it->second.totalSize != totalSize) {
+            if (it != pendingUploads.end()) {
+                eraseUpload(it);
+            }
+            lock.unlock();
+            sendUploadFailure(conn, req.uploadId, "Out of order chunk", msg.binary);
+            return;
+        }
+
+        PendingUpload& upload = it->second;
+        if (upload.bytes.size() + chunk.size() > upload.totalSize) {
+            eraseUpload(it);
+            lock.unlock();
+            sendUploadFailure(conn, req.uploadId, "Upload exceeds declared size", msg.binary);
+            return;
+        }
+        upload.bytes += chunk;
+        upload.lastActivity = std::chrono::steady_clock::now();
+
+        if (upload.bytes.size() < upload.totalSize) {
+            return; // Wait for more chunks
+        }
+
+        completed = std::move(upload.bytes);
+        eraseUpload(it);
+    }
+
+    std::string hash = blobStore->put(completed);
+
+    if (hash.empty()) {
+        sendUploadFailure(conn, req.uploadId, "Failed to store blob", msg.binary);
+        return;
+    }
+
+    if (logger::serverLogger) {
+        logger::serverLogger->info("[Blob] Upload " + req.uploadId + " from user " + std::to_string(userId) +
+                                   " complete: " + hash);
+    }
+
+    Payloads::BlobUploadResult result;
+    result.uploadId = req.uploadId;
+    result.hash = hash;
+    result.message = "OK";
+    sendMessage(conn, Payloads::encode(protocol::MsgCode::BLOB_UPLOAD_SUCCESS, result, msg.binary));
+}
+
+void BlobController::handleBlobDownloadRequest(Connection& conn, const protocol::Message& msg) {
+    Payloads::BlobDownloadRequest req;
+    Payloads::decode(msg, req);
+
+    if (sessionManager->authenticate(conn, req.sessionToken) == -1) {
+        sendDownloadFailure(conn, req.hash, "Invalid session", msg.binary);
+        return;
+    }
+
+    BlobStore::BlobInfo info = blobStore->lookup(req.hash);
+    if (!info.found) {
+        sendDownloadFailure(conn, req.hash, "Blob not found", msg.binary);
+        return;
+    }
+
+    // Serve the stored encoding if the client can decode it, otherwise rebuild the original format
+    bool passThrough = info.encoding.empty() || acceptsEncoding(req.accept, info.encoding);
+    std::shared_ptr<const std::string> rebuilt;
+    int64_t totalSize = info.size;
+    if (!passThrough) {
+        rebuilt = decodeForLegacyClient(req.hash, info);
+        if (!rebuilt) {
+            sendDownloadFailure(conn, req.hash, "Unsupported encoding", msg.binary);
+            return;
+        }
+        totalSize = static_cast<int64_t>(rebuilt->size());
+    }
+
+    uint64_t offset = 0;
+    try {
+        if (!req.offset.empty()) offset = std::stoull(req.offset);
+    } catch (...) {
+        offset = static_cast<uint64_t>(totalSize) + 1;
+    }
+    if (offset > static_cast<uint64_t>(totalSize)) {
+        sendDownloadFailure(conn, req.hash, "Invalid offset", msg.binary);
+        return;
+    }
+
+    std::string bytes;
+    if (rebuilt) {
+        bytes = rebuilt->substr(offset, DOWNLOAD_CHUNK_SIZE);
+    } else if (!blobStore->read(info.storedHash, offset, DOWNLOAD_CHUNK_SIZE, bytes)) {
+        sendDownloadFailure(conn, req.hash, "Read error", msg.binary);
+        return;
+    }
+
+    Payloads::BlobChunkDTO chunk;
+    chunk.hash = req.hash;
+    chunk.offset = std::to_string(offset);
+    chunk.totalSize = std::to_string(totalSize);
+    chunk.encoding = passThrough ? info.encoding : "";
+    chunk.data = utils::base64Encode(std::vector<char>(bytes.begin(), bytes.end()));
+    sendMessage(conn, Payloads::encode(protocol::MsgCode::BLOB_DOWNLOAD_CHUNK, chunk, msg.binary));
+}
+
+bool BlobController::acceptsEncoding(const std::string& accept, const std::string& encoding) {
+    for (const auto& candidate : utils::split(accept, ',')) {
+        if (candidate == encoding) return true;
+    }
+    return false;
+}
+
+std::shared_ptr<const std::string> BlobController::decodeForLegacyClient(const std::string& hash,
+                                                                        const BlobStore::BlobInfo& info) {
+    {
+        std::lock_guard<std::mutex> lock(legacyCacheMutex);
+        if (legacyCacheHash == hash) {
+            return legacyCacheBytes;
+        }
+    }
+
+    if (info.encoding != AudioTranscoder::ENCODING_ADPCM) {
+        return nullptr;
+    }
+
+    std::string encoded;
+    audio::PcmAudio pcm;
+    if (!blobStore->read(info.storedHash, 0, static_cast<size_t>(info.size), encoded) ||
+        !audio::decodeAdpcm(encoded, pcm)) {
+        return nullptr;
+    }
+
+    // A download spans many requests; keep the last rebuilt file around
+    auto rebuilt = std::make_shared<const std::string>(audio::buildWav(pcm));
+    std::lock_guard<std::mutex> lock(legacyCacheMutex);
+    legacyCacheHash = hash;
+    legacyCacheBytes = rebuilt;
+    return rebuilt;
+}
+
+std::map<std::string, BlobController::PendingUpload>::iterator
+BlobController::eraseUpload(std::map<std::string, PendingUpload>::iterator it) {
+    auto quota = uploadQuotas.find(it->second.userId);
+    if (quota != uploadQuotas.end()) {
+        quota->second.declaredBytes -= it->second.totalSize;
+        if (--quota->second.uploads == 0) {
+            uploadQuotas.erase(quota);
+        }
+    }
+    return pendingUploads.erase(it);
+}
+
+void BlobController::processUploadTimeouts() {
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(uploadsMutex);
+    for (auto it = pendingUploads.begin(); it != pendingUploads.end();) {
+        auto idle = std::chrono::duration_cast<std::chrono::seconds>(now - it->second.lastActivity).count();
+        if (idle > UPLOAD_IDLE_TIMEOUT_SECONDS) {
+            if (logger::serverLogger) {
+                logger::serverLogger->warn("[Blob] Dropping stalled upload " + it->first);
+            }
+            it = eraseUpload(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+} // namespace server
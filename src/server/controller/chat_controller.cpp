@@ -1,49 +1,76 @@
 #include "server/controller/chat_controller.h"
+#include "server/reply_context.h"
 #include "common/logger.h"
+#include "common/utils.h"
+#include <charconv>
 #include <chrono>
 #include <ctime>
 #include <iomanip>
+#include <map>
 #include <sstream>
 #include <sys/socket.h>
 
 namespace server {
 
 ChatController::ChatController(std::shared_ptr<ChatRepository> chatRepo,
+                               std::shared_ptr<NotificationRepository> notificationRepo,
                                std::shared_ptr<UserRepository> userRepo,
                                std::shared_ptr<ConnectionManager> connMgr,
-                               std::shared_ptr<SessionManager> sessionMgr)
-    : chatRepository(chatRepo), userRepository(userRepo), connectionManager(connMgr), sessionManager(sessionMgr) {}
+                               std::shared_ptr<SessionManager> sessionMgr,
+                               std::shared_ptr<BlobStore> store,
+                               std::shared_ptr<AudioTranscoder> transcoder,
+                               std::shared_ptr<MediaRelay> relay,
+                               std::shared_ptr<CallLogWriter> logWriter)
+    : chatRepository(chatRepo), notificationRepository(notificationRepo), userRepository(userRepo), connectionManager(connMgr), sessionManager(sessionMgr),
+      blobStore(store), audioTranscoder(transcoder), mediaRelay(relay), callLogWriter(logWriter) {}
+
+ChatController::~ChatController() {
+    flushAcknowledgements();
+}
 
-void ChatController::handleUserSendPrivateMessage(int clientFd, const protocol::Message& msg) {
-    std::string payload = msg.toString();
-    
-    if (logger::serverLogger) {
-        logger::serverLogger->debug("handleSendPrivateMessage: Raw payload=" + payload);
+bool ChatController::resolveAudioContent(std::string& content) {
+    std::string hash;
+    if (BlobStore::parseReference(content, hash)) {
+        if (!blobStore->exists(hash)) return false;
+    } else {
+        // Legacy inline upload: move the bytes into the blob store
+        std::string bytes = utils::base64Decode(content);
+        if (bytes.empty()) return false;
+
+        hash = blobStore->put(bytes);
+        if (hash.empty()) return false;
+
+        content = BlobStore::toReference(hash);
     }
 
+    // Compress off the event loop; the reference stays valid either way
+    audioTranscoder->enqueue(hash);
+    return true;
+}
+
+void ChatController::handleUserSendPrivateMessage(Connection& conn, const protocol::Message& msg) {
     Payloads::PrivateMessageRequest req;
     try {
-        req.deserialize(payload);
+        Payloads::decode(msg, req);
     } catch (const std::exception& e) {
         if (logger::serverLogger) {
             logger::serverLogger->error("handleSendPrivateMessage: Deserialization failed: " + std::string(e.what()));
         }
         protocol::Message response(protocol::MsgCode::CHAT_MESSAGE_FAILURE, "Invalid message format");
-        std::vector<uint8_t> data = response.serialize();
-        send(clientFd, data.data(), data.size(), 0);
+        sendReply(conn, response);
         return;
     }
 
     if (logger::serverLogger) {
-        logger::serverLogger->debug("handleSendPrivateMessage: recipient=" + req.recipient + ", content=" + req.content);
+        logger::serverLogger->debug("handleSendPrivateMessage: recipient=" + req.recipient + ", type=" + req.messageType +
+                                    ", length=" + std::to_string(req.content.size()));
     }
 
-    int senderId = sessionManager->get_user_id_by_session(req.sessionToken);
+    int senderId = sessionManager->authenticate(conn, req.sessionToken);
     if (senderId == -1) {
         if (logger::serverLogger) logger::serverLogger->warn("handleSendPrivateMessage: Invalid session token");
         protocol::Message response(protocol::MsgCode::CHAT_MESSAGE_FAILURE, "Invalid session");
-        std::vector<uint8_t> data = response.serialize();
-        send(clientFd, data.data(), data.size(), 0);
+        sendReply(conn, response);
         return;
     }
 
@@ -51,8 +78,7 @@ void ChatController::handleUserSendPrivateMessage(int clientFd, const protocol::
     if (sender.getId() == -1) {
         if (logger::serverLogger) logger::serverLogger->warn("handleSendPrivateMessage: Sender not found for ID " + std::to_string(senderId));
         protocol::Message response(protocol::MsgCode::CHAT_MESSAGE_FAILURE, "Sender not found");
-        std::vector<uint8_t> data = response.serialize();
-        send(clientFd, data.data(), data.size(), 0);
+        sendReply(conn, response);
         return;
     }
 
@@ -60,16 +86,21 @@ void ChatController::handleUserSendPrivateMessage(int clientFd, const protocol::
     if (receiverId == -1) {
         if (logger::serverLogger) logger::serverLogger->warn("handleSendPrivateMessage: Recipient not found: " + req.recipient);
         protocol::Message response(protocol::MsgCode::CHAT_MESSAGE_FAILURE, "Recipient not found");
-        std::vector<uint8_t> data = response.serialize();
-        send(clientFd, data.data(), data.size(), 0);
+        sendReply(conn, response);
         return;
     }
     User receiver = userRepository->findById(receiverId);
 
+    if (req.messageType == "AUDIO" && !resolveAudioContent(req.content)) {
+        if (logger::serverLogger) logger::serverLogger->warn("handleSendPrivateMessage: Unknown or invalid audio blob");
+        protocol::Message response(protocol::MsgCode::CHAT_MESSAGE_FAILURE, "Audio upload not found");
+        sendReply(conn, response);
+        return;
+    }
+
     if (logger::serverLogger) {
         logger::serverLogger->debug("Handling send message: senderId=" + std::to_string(senderId) + 
-                                   ", receiverId=" + std::to_string(receiverId) + 
-                                   ", content=" + req.content);
+                                   ", receiverId=" + std::to_string(receiverId));
     }
 
     // Create ChatMessage object
@@ -84,8 +115,7 @@ void ChatController::handleUserSendPrivateMessage(int clientFd, const protocol::
     int msgId = chatRepository->saveMessage(chatMsg);
     if (msgId == -1) {
         protocol::Message response(protocol::MsgCode::CHAT_MESSAGE_FAILURE, "Failed to save message");
-        std::vector<uint8_t> data = response.serialize();
-        send(clientFd, data.data(), data.size(), 0);
+        sendReply(conn, response);
         return;
     }
 
@@ -102,37 +132,34 @@ void ChatController::handleUserSendPrivateMessage(int clientFd, const protocol::
     pushDto.messageType = chatMsg.getMessageType();
     pushDto.content = chatMsg.getContent();
     pushDto.timestamp = timestamp;
-    
-    std::string pushPayload = pushDto.serialize();
-    protocol::Message pushMsg(protocol::MsgCode::CHAT_PRIVATE_RECEIVE, pushPayload);
+    pushDto.messageId = std::to_string(msgId);
 
-    // Send to recipient if online
-    connectionManager->sendToUser(receiverId, pushMsg);
+    // Stays undelivered (is_delivered = FALSE) until the recipient sends
+    // CHAT_RECEIVE_ACK, as digest items do; if the push never arrives
+    // (offline, dropped, socket gone before the flush) the next login's
+    // digest has it
+    connectionManager->sendToUser(receiverId, protocol::MsgCode::CHAT_PRIVATE_RECEIVE, pushDto);
 
     // Send success to sender
     protocol::Message response(protocol::MsgCode::CHAT_MESSAGE_SUCCESS, "Message sent");
-    std::vector<uint8_t> data = response.serialize();
-    send(clientFd, data.data(), data.size(), 0);
+    sendReply(conn, response);
 }
 
-void ChatController::handleUserGetChatHistory(int clientFd, const protocol::Message& msg) {
-    std::string payload = msg.toString();
+void ChatController::handleUserGetChatHistory(Connection& conn, const protocol::Message& msg) {
     Payloads::ChatHistoryRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
 
-    int userId1 = sessionManager->get_user_id_by_session(req.sessionToken);
+    int userId1 = sessionManager->authenticate(conn, req.sessionToken);
     if (userId1 == -1) {
         protocol::Message response(protocol::MsgCode::CHAT_HISTORY_FAILURE, "Invalid session");
-        std::vector<uint8_t> data = response.serialize();
-        send(clientFd, data.data(), data.size(), 0);
+        sendReply(conn, response);
         return;
     }
 
     int userId2 = userRepository->getUserId(req.otherUser);
     if (userId2 == -1) {
         protocol::Message response(protocol::MsgCode::CHAT_HISTORY_FAILURE, "User not found");
-        std::vector<uint8_t> data = response.serialize();
-        send(clientFd, data.data(), data.size(), 0);
+        sendReply(conn, response);
         return;
     }
 
@@ -155,21 +182,18 @@ void ChatController::handleUserGetChatHistory(int clientFd, const protocol::Mess
         historyDto.messages.push_back(dto);
     }
 
-    protocol::Message response(protocol::MsgCode::CHAT_HISTORY_SUCCESS, historyDto.serialize());
-    std::vector<uint8_t> data = response.serialize();
-    send(clientFd, data.data(), data.size(), 0);
+    protocol::Message response = Payloads::encode(protocol::MsgCode::CHAT_HISTORY_SUCCESS, historyDto, msg.binary);
+    sendReply(conn, response);
 }
 
-void ChatController::handleUserGetRecentChats(int clientFd, const protocol::Message& msg) {
-    std::string payload = msg.toString();
+void ChatController::handleUserGetRecentChats(Connection& conn, const protocol::Message& msg) {
     Payloads::RecentChatsRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
 
-    int userId = sessionManager->get_user_id_by_session(req.sessionToken);
+    int userId = sessionManager->authenticate(conn, req.sessionToken);
     if (userId == -1) {
         protocol::Message response(protocol::MsgCode::RECENT_CHATS_FAILURE, "Invalid session");
-        std::vector<uint8_t> data = response.serialize();
-        send(clientFd, data.data(), data.size(), 0);
+        sendReply(conn, response);
         return;
     }
 
@@ -179,44 +203,178 @@ void ChatController::handleUserGetRecentChats(int clientFd, const protocol::Mess
         logger::serverLogger->debug("getRecentChats returned " + std::to_string(recentChats.size()) + " messages for userId=" + std::to_string(userId));
     }
 
-    // Convert to DTOs
-    // We need a DTO that holds a list of recent chats summaries.
-    // Since we don't have a specific RecentChatsDTO, we can reuse a string format or create a DTO.
-    // The client expects "userId;username;lastMessage;timestamp|..."
-    
-    std::stringstream ss;
+    Payloads::RecentChatsDTO dto;
+    dto.chats.reserve(recentChats.size());
     for (const auto& m : recentChats) {
-        int otherId = (m.getSenderId() == userId) ? m.getReceiverId() : m.getSenderId();
-        User otherUser = userRepository->findById(otherId);
+        User otherUser = userRepository->findById(m.otherParticipant(userId));
         std::string otherUsername = (otherUser.getId() != -1) ? otherUser.getUsername() : "Unknown";
-        
-        ss << otherId << ";" 
-           << otherUsername << ";" 
-           << m.getContent() << ";" 
-           << m.getTimestamp() << "|";
+        dto.chats.push_back(m.toRecentChatDTO(userId, otherUsername));
     }
-    
-    protocol::Message response(protocol::MsgCode::RECENT_CHATS_SUCCESS, ss.str());
-    std::vector<uint8_t> data = response.serialize();
-    send(clientFd, data.data(), data.size(), 0);
+
+    sendReply(conn, Payloads::encode(protocol::MsgCode::RECENT_CHATS_SUCCESS, dto, msg.binary));
+}
+
+void ChatController::handleChatReadAck(Connection& conn, const protocol::Message& msg) {
+    Payloads::ChatReadAck ack;
+    Payloads::decode(msg, ack);
+
+    int readerId = sessionManager->authenticate(conn, ack.sessionToken);
+    if (readerId == -1) return;
+
+    int senderId = userRepository->getUserId(ack.otherUser);
+    if (senderId == -1) return;
+
+    std::lock_guard<std::mutex> lock(acknowledgementsMutex);
+    pendingReads.insert({senderId, readerId});
 }
 
-void ChatController::handleCallInitiate(int clientFd, const protocol::Message& msg) {
+void ChatController::handleDeliveryAck(Connection& conn, const protocol::Message& msg) {
+    Payloads::DeliveryAck ack;
+    Payloads::decode(msg, ack);
+
+    int receiverId = sessionManager->authenticate(conn, ack.sessionToken);
+    if (receiverId == -1) return;
+
+    // Message ids, and "n<id>" for notifications
+    std::lock_guard<std::mutex> lock(acknowledgementsMutex);
+    for (const auto& id : ack.messageIds) {
+        bool notification = !id.empty() && id[0] == 'n';
+        const char* begin = id.data() + (notification ? 1 : 0);
+        int itemId = 0;
+        std::from_chars(begin, id.data() + id.size(), itemId);
+        if (itemId <= 0) continue;
+
+        if (notification) {
+            pendingNotifications.emplace_back(receiverId, itemId);
+        } else {
+            pendingDelivered.emplace_back(receiverId, itemId);
+        }
+    }
+}
+
+void ChatController::sendUnreadDigest(Connection& conn, int userId) {
+    std::vector<ChatMessage> undelivered = chatRepository->getUndeliveredMessages(userId, UNREAD_DIGEST_LIMIT);
+    auto notifications = notificationRepository->getPending(userId);
+    if (undelivered.empty() && notifications.empty()) return;
+
+    std::vector<Payloads::UnreadItemDTO> items;
+    items.reserve(undelivered.size() + notifications.size());
+    std::map<int, std::string> senderNames; // Few distinct senders per digest
+    for (const auto& m : undelivered) {
+        auto name = senderNames.find(m.getSenderId());
+        if (name == senderNames.end()) {
+            User sender = userRepository->findById(m.getSenderId());
+            name = senderNames.emplace(m.getSenderId(), sender.getId() != -1 ? sender.getUsername() : "Unknown").first;
+        }
+
+        Payloads::UnreadItemDTO item;
+        item.messageId = std::to_string(m.getId());
+        item.sender = name->second;
+        item.messageType = m.getMessageType();
+        item.content = m.getContent();
+        item.timestamp = m.getTimestamp();
+        items.push_back(item);
+    }
+
+    for (const auto& notification : notifications) {
+        Payloads::UnreadItemDTO item;
+        item.messageId = "n" + std::to_string(notification.id);
+        item.sender = "System";
+        item.messageType = "NOTIFICATION";
+        item.content = notification.content;
+        item.timestamp = notification.createdAt;
+        items.push_back(item);
+    }
+
+    // Pack items into frames by their encoded size. Nothing is marked
+    // delivered or deleted here: the client acks each frame with
+    // UNREAD_DIGEST_ACK, and whatever it never acks (a lost frame, an item
+    // over the limit) is in the next login's digest.
+    protocol::Capabilities capabilities = conn.capabilitiesSnapshot();
+    size_t budget = capabilities.maxFrameSize - DIGEST_FRAME_OVERHEAD;
+    size_t frames = 0;
+    size_t skipped = 0;
+
+    Payloads::UnreadDigestDTO digest;
+    size_t digestSize = 0;
+    auto flush = [&]() {
+        if (digest.items.empty()) return true;
+        bool queued = connectionManager->sendToConnection(conn, protocol::MsgCode::UNREAD_DIGEST, digest);
+        if (queued) ++frames;
+        digest.items.clear();
+        digestSize = 0;
+        return queued;
+    };
+
+    for (auto& item : items) {
+        size_t itemSize;
+        if (capabilities.binaryPayloads) {
+            codec::BinaryWriter w;
+            codec::writeField(w, item);
+            itemSize = w.data().size();
+        } else {
+            itemSize = item.serialize().size() + 1; // '|' separator
+        }
+
+        if (itemSize > budget) {
+            // Left undelivered; the conversation's history still has it
+            ++skipped;
+            continue;
+        }
+        if (digestSize + itemSize > budget && !flush()) break;
+        digest.items.push_back(std::move(item));
+        digestSize += itemSize;
+    }
+    flush();
+
     if (logger::serverLogger) {
-        logger::serverLogger->debug("[VoiceCall] Handling Call Initiate request from fd=" + std::to_string(clientFd));
+        if (skipped > 0) {
+            logger::serverLogger->warn("Unread digest for userId=" + std::to_string(userId) + ": " + std::to_string(skipped) +
+                                       " items exceed the frame limit of fd=" + std::to_string(conn.fd) + "; left out");
+        }
+        logger::serverLogger->info("Sent unread digest to userId=" + std::to_string(userId) + " in " +
+                                   std::to_string(frames) + " frames: " + std::to_string(undelivered.size()) + " messages, " +
+                                   std::to_string(notifications.size()) + " notifications");
+    }
+}
+
+void ChatController::flushAcknowledgements() {
+    // Take the batch and write it without holding up handlers adding to the next
+    std::vector<std::pair<int, int>> delivered;
+    std::vector<std::pair<int, int>> notifications;
+    std::set<std::pair<int, int>> reads;
+    {
+        std::lock_guard<std::mutex> lock(acknowledgementsMutex);
+        delivered.swap(pendingDelivered);
+        notifications.swap(pendingNotifications);
+        reads.swap(pendingReads);
+    }
+
+    if (!delivered.empty()) {
+        chatRepository->markMessagesAsDelivered(delivered);
+    }
+    if (!notifications.empty()) {
+        notificationRepository->remove(notifications);
+    }
+    if (!reads.empty()) {
+        chatRepository->markMessagesAsRead(std::vector<std::pair<int, int>>(reads.begin(), reads.end()));
+    }
+}
+
+void ChatController::handleCallInitiate(Connection& conn, const protocol::Message& msg) {
+    if (logger::serverLogger) {
+        logger::serverLogger->debug("[VoiceCall] Handling Call Initiate request from fd=" + std::to_string(conn.fd));
     }
-    std::string payload = msg.toString();
     Payloads::VoiceCallRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
 
-    int callerId = sessionManager->get_user_id_by_session(req.sessionToken);
+    int callerId = sessionManager->authenticate(conn, req.sessionToken);
     if (callerId == -1) {
         if (logger::serverLogger) {
-            logger::serverLogger->warn("[VoiceCall] Initiate failed: Invalid session for fd=" + std::to_string(clientFd));
+            logger::serverLogger->warn("[VoiceCall] Initiate failed: Invalid session for fd=" + std::to_string(conn.fd));
         }
         protocol::Message response(protocol::MsgCode::CALL_FAILED, "Invalid session");
-        std::vector<uint8_t> data = response.serialize();
-        send(clientFd, data.data(), data.size(), 0);
+        sendReply(conn, response);
         return;
     }
 
@@ -228,8 +386,7 @@ void ChatController::handleCallInitiate(int clientFd, const protocol::Message& m
             logger::serverLogger->warn("[VoiceCall] Initiate failed: Target user '" + req.targetUser + "' not found.");
         }
         protocol::Message response(protocol::MsgCode::CALL_FAILED, "User not found");
-        std::vector<uint8_t> data = response.serialize();
-        send(clientFd, data.data(), data.size(), 0);
+        sendReply(conn, response);
         return;
     }
 
@@ -238,57 +395,31 @@ void ChatController::handleCallInitiate(int clientFd, const protocol::Message& m
     if (logger::serverLogger) {
         logger::serverLogger->debug("[VoiceCall] Target '" + req.targetUser + "' online status: " + (isTargetOnline ? "Online" : "Offline"));
     }
-    
-    // Check if sender is already in a call (Single Call Session)
-    if (activeUsersInCall.count(caller.getUsername()) > 0 || pendingCalls.count(caller.getUsername()) > 0) {
+
+    // Register the call as ringing; either party may already be in a call (Single Call Session)
+    CallRegistry::RingResult ringResult = callRegistry.ring(caller.getUsername(), callerId, req.targetUser, targetId);
+
+    if (ringResult == CallRegistry::RingResult::CALLER_BUSY) {
         if (logger::serverLogger) {
             logger::serverLogger->info("[VoiceCall] Initiate failed: Caller '" + caller.getUsername() + "' is already in a call.");
         }
         protocol::Message response(protocol::MsgCode::CALL_FAILED, "You are already in a call");
-        std::vector<uint8_t> data = response.serialize();
-        send(clientFd, data.data(), data.size(), 0);
+        sendReply(conn, response);
         return;
     }
 
-    // Check if target is busy (in a call or receiving a call)
-    bool targetIsBusy = false;
-    if (activeUsersInCall.count(req.targetUser) > 0) targetIsBusy = true;
-    if (pendingCalls.count(req.targetUser) > 0) targetIsBusy = true; // Receiving a call
-    
-    // Check if target is initiating a call (caller in pendingCalls)
-    for (const auto& pair : pendingCalls) {
-        if (pair.second.caller == req.targetUser) {
-            targetIsBusy = true;
-            break;
-        }
-    }
-
-    if (targetIsBusy) {
+    if (ringResult == CallRegistry::RingResult::CALLEE_BUSY) {
         if (logger::serverLogger) {
             logger::serverLogger->info("[VoiceCall] Initiate failed: Target '" + req.targetUser + "' is busy.");
         }
         protocol::Message response(protocol::MsgCode::CALL_FAILED, "User is busy");
-        std::vector<uint8_t> data = response.serialize();
-        send(clientFd, data.data(), data.size(), 0);
-        
-        // Log busy attempt
-        ChatMessage sysMsg;
-        sysMsg.setSenderId(callerId);
-        sysMsg.setReceiverId(targetId);
-        sysMsg.setContent("Call Failed: User Busy");
-        sysMsg.setMessageType("SYSTEM");
-        sysMsg.setIsRead(false);
-        chatRepository->saveMessage(sysMsg);
+        sendReply(conn, response);
+
+        std::time_t now = std::time(nullptr);
+        callLogWriter->record(CallLog(callerId, targetId, now, now, "BUSY", 0));
         return;
     }
 
-    // Register Pending Call (Wait State)
-    PendingCall call;
-    call.caller = caller.getUsername();
-    call.receiver = req.targetUser;
-    call.startTime = std::chrono::steady_clock::now();
-    pendingCalls[req.targetUser] = call;
-
     // Send incoming call notification ONLY if target is online
     if (isTargetOnline) {
         if (logger::serverLogger) {
@@ -298,8 +429,7 @@ void ChatController::handleCallInitiate(int clientFd, const protocol::Message& m
         notification.callerUsername = caller.getUsername();
         notification.callerId = std::to_string(callerId);
         
-        protocol::Message callNotification(protocol::MsgCode::CALL_INCOMING, notification.serialize());
-        connectionManager->sendToUser(targetId, callNotification);
+        connectionManager->sendToUser(targetId, protocol::MsgCode::CALL_INCOMING, notification);
     } else {
         if (logger::serverLogger) {
             logger::serverLogger->info("[VoiceCall] Target '" + req.targetUser + "' is offline. Waiting for timeout logic.");
@@ -309,81 +439,71 @@ void ChatController::handleCallInitiate(int clientFd, const protocol::Message& m
     if (logger::serverLogger) {
         logger::serverLogger->info("[VoiceCall] Call initiated successfully: " + caller.getUsername() + " -> " + req.targetUser);
     }
-
-    // Save SYSTEM message
-    ChatMessage sysMsg;
-    sysMsg.setSenderId(callerId);
-    sysMsg.setReceiverId(targetId);
-    sysMsg.setContent("Call Initiated");
-    sysMsg.setMessageType("SYSTEM");
-    sysMsg.setIsRead(false);
-    chatRepository->saveMessage(sysMsg);
 }
 
-void ChatController::handleCallAnswer(int clientFd, const protocol::Message& msg) {
-    (void)clientFd;
+void ChatController::handleCallAnswer(Connection& conn, const protocol::Message& msg) {
     if (logger::serverLogger) {
         logger::serverLogger->debug("[VoiceCall] Handling Call Answer request.");
     }
-    std::string payload = msg.toString();
     Payloads::VoiceCallRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
 
-    int answererId = sessionManager->get_user_id_by_session(req.sessionToken);
+    int answererId = sessionManager->authenticate(conn, req.sessionToken);
     if (answererId == -1) return;
 
     User answerer = userRepository->findById(answererId);
-    int callerId = userRepository->getUserId(req.targetUser);
-    if (callerId == -1) return;
-
-    // Verify this call was pending
     std::string answererName = answerer.getUsername();
-    if (pendingCalls.count(answererName) == 0 || pendingCalls[answererName].caller != req.targetUser) {
+
+    // Verify this call was ringing for the answerer (RINGING -> ACTIVE)
+    CallSession call;
+    if (!callRegistry.answer(answererName, req.targetUser, call)) {
         if (logger::serverLogger) {
             logger::serverLogger->warn("[VoiceCall] Answer failed: No pending call found for " + answererName + " from " + req.targetUser);
         }
         return; 
     }
-
-    // Remove from pending
-    pendingCalls.erase(answererName);
-
-    // Add to active users
-    activeUsersInCall.insert(answererName);
-    activeUsersInCall.insert(req.targetUser);
+    int callerId = call.callerId;
 
     // Notify caller that call was answered
     Payloads::VoiceCallNotification notification;
     notification.callerUsername = answerer.getUsername();
     notification.callerId = std::to_string(answererId);
     
-    protocol::Message response(protocol::MsgCode::CALL_ANSWER_REQUEST, notification.serialize());
-    connectionManager->sendToUser(callerId, response);
+    connectionManager->sendToUser(callerId, protocol::MsgCode::CALL_ANSWER_REQUEST, notification);
+
+    // Allocate the media path; signaling still completes if the relay is unavailable
+    MediaRelay::Allocation relay = mediaRelay ? mediaRelay->allocate() : MediaRelay::Allocation();
+    if (relay.sessionId != 0) {
+        callRegistry.attachRelaySession(call.callId, relay.sessionId);
+
+        Payloads::CallMediaInfo callerMedia;
+        callerMedia.peerUsername = answererName;
+        callerMedia.relayPort = std::to_string(relay.port);
+        callerMedia.sessionId = std::to_string(relay.sessionId);
+        callerMedia.token = std::to_string(relay.callerToken);
+        connectionManager->sendToUser(callerId, protocol::MsgCode::CALL_MEDIA_READY, callerMedia);
+
+        Payloads::CallMediaInfo calleeMedia;
+        calleeMedia.peerUsername = req.targetUser;
+        calleeMedia.relayPort = std::to_string(relay.port);
+        calleeMedia.sessionId = std::to_string(relay.sessionId);
+        calleeMedia.token = std::to_string(relay.calleeToken);
+        connectionManager->sendToUser(answererId, protocol::MsgCode::CALL_MEDIA_READY, calleeMedia);
+    }
 
     if (logger::serverLogger) {
         logger::serverLogger->info("[VoiceCall] Call connected: " + req.targetUser + " <-> " + answererName);
     }
-
-    // Save SYSTEM message
-    ChatMessage sysMsg;
-    sysMsg.setSenderId(answererId);
-    sysMsg.setReceiverId(callerId);
-    sysMsg.setContent("Call Answered");
-    sysMsg.setMessageType("SYSTEM");
-    sysMsg.setIsRead(false);
-    chatRepository->saveMessage(sysMsg);
 }
 
-void ChatController::handleCallDecline(int clientFd, const protocol::Message& msg) {
-    (void)clientFd;
+void ChatController::handleCallDecline(Connection& conn, const protocol::Message& msg) {
     if (logger::serverLogger) {
         logger::serverLogger->debug("[VoiceCall] Handling Call Decline request.");
     }
-    std::string payload = msg.toString();
     Payloads::VoiceCallRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
 
-    int declinerId = sessionManager->get_user_id_by_session(req.sessionToken);
+    int declinerId = sessionManager->authenticate(conn, req.sessionToken);
     if (declinerId == -1) return;
 
     User decliner = userRepository->findById(declinerId);
@@ -392,14 +512,10 @@ void ChatController::handleCallDecline(int clientFd, const protocol::Message& ms
 
     std::string declinerName = decliner.getUsername();
 
-    // Remove from pending if exists
-    bool callFound = false;
-    if (pendingCalls.count(declinerName) > 0) {
-        pendingCalls.erase(declinerName);
-        callFound = true;
-    }
-
-    if (!callFound && logger::serverLogger) {
+    CallSession call;
+    if (callRegistry.end(declinerName, req.targetUser, call)) {
+        finishCall(call, declinerName);
+    } else if (logger::serverLogger) {
         logger::serverLogger->debug("[VoiceCall] Decline: No pending call found for " + declinerName);
     }
 
@@ -410,46 +526,28 @@ void ChatController::handleCallDecline(int clientFd, const protocol::Message& ms
     if (logger::serverLogger) {
         logger::serverLogger->info("[VoiceCall] Call declined by " + decliner.getUsername() + " (Caller: " + req.targetUser + ")");
     }
-
-    // Save SYSTEM message
-    ChatMessage sysMsg;
-    sysMsg.setSenderId(declinerId);
-    sysMsg.setReceiverId(callerId);
-    sysMsg.setContent("Call Declined");
-    sysMsg.setMessageType("SYSTEM");
-    sysMsg.setIsRead(false);
-    chatRepository->saveMessage(sysMsg);
 }
 
-void ChatController::handleCallEnd(int clientFd, const protocol::Message& msg) {
-    (void)clientFd;
+void ChatController::handleCallEnd(Connection& conn, const protocol::Message& msg) {
     if (logger::serverLogger) {
         logger::serverLogger->debug("[VoiceCall] Handling Call End request.");
     }
-    std::string payload = msg.toString();
     Payloads::VoiceCallRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
 
-    int enderId = sessionManager->get_user_id_by_session(req.sessionToken);
+    int enderId = sessionManager->authenticate(conn, req.sessionToken);
     if (enderId == -1) return;
 
     User ender = userRepository->findById(enderId);
     int otherId = userRepository->getUserId(req.targetUser);
     if (otherId == -1) return;
 
-    // Remove both from active users
-    activeUsersInCall.erase(ender.getUsername());
-    activeUsersInCall.erase(req.targetUser);
-
-    // Also check pending calls just in case (e.g. cancelling an initiated call)
+    // Covers both hanging up an active call and cancelling one still ringing
+    CallSession call;
     bool wasPending = false;
-    if (pendingCalls.count(req.targetUser) > 0 && pendingCalls[req.targetUser].caller == ender.getUsername()) {
-        pendingCalls.erase(req.targetUser);
-        wasPending = true;
-    }
-    if (pendingCalls.count(ender.getUsername()) > 0) {
-        pendingCalls.erase(ender.getUsername());
-        wasPending = true;
+    if (callRegistry.end(ender.getUsername(), req.targetUser, call)) {
+        wasPending = !call.wasAnswered();
+        finishCall(call, ender.getUsername());
     }
 
     // Notify other party
@@ -459,75 +557,66 @@ void ChatController::handleCallEnd(int clientFd, const protocol::Message& msg) {
     if (logger::serverLogger) {
         logger::serverLogger->info("[VoiceCall] Call ended by " + ender.getUsername() + " with " + req.targetUser + (wasPending ? " (Cancelled Pending)" : ""));
     }
+}
+
+void ChatController::finishCall(const CallSession& call, const std::string& endedBy) {
+    if (call.relaySessionId != 0 && mediaRelay) {
+        mediaRelay->release(call.relaySessionId);
+    }
+
+    std::string status;
+    if (call.wasAnswered()) status = "COMPLETED";
+    else if (endedBy == call.callee) status = "DECLINED";
+    else status = "MISSED"; // Cancelled by the caller or never answered
+    recordCall(call, status);
+}
 
-    // Save SYSTEM message
-    ChatMessage sysMsg;
-    sysMsg.setSenderId(enderId);
-    sysMsg.setReceiverId(otherId);
-    sysMsg.setContent("Call Ended");
-    sysMsg.setMessageType("SYSTEM");
-    sysMsg.setIsRead(false);
-    chatRepository->saveMessage(sysMsg);
+void ChatController::recordCall(const CallSession& call, const std::string& status) {
+    int duration = 0;
+    if (call.wasAnswered()) {
+        duration = static_cast<int>(std::chrono::duration_cast<std::chrono::seconds>(
+            std::chrono::steady_clock::now() - call.answeredAt).count());
+    }
+    callLogWriter->record(CallLog(call.callerId, call.calleeId, call.startTime, std::time(nullptr), status, duration));
 }
 
 void ChatController::processCallTimeouts() {
-    auto now = std::chrono::steady_clock::now();
-    std::vector<std::string> timedOutReceivers;
-
-    // Check for timeouts
-    for (const auto& pair : pendingCalls) {
-        auto elapsed = std::chrono::duration_cast<std::chrono::seconds>(now - pair.second.startTime).count();
-        if (elapsed > 7) { // 5s requested + 2s buffer
-            timedOutReceivers.push_back(pair.first);
+    // Active calls whose relay session went silent are treated as dropped
+    if (mediaRelay) {
+        for (uint32_t sessionId : mediaRelay->takeExpiredSessions()) {
+            CallSession call;
+            if (!callRegistry.endByRelaySession(sessionId, call)) continue;
+
+            protocol::Message response(protocol::MsgCode::CALL_ENDED, "Call dropped (no audio)");
+            connectionManager->sendToUser(call.callerId, response);
+            connectionManager->sendToUser(call.calleeId, response);
+            recordCall(call, "FAILED");
+
+            if (logger::serverLogger) {
+                logger::serverLogger->info("[VoiceCall] Call dropped: " + call.caller + " <-> " + call.callee);
+            }
         }
     }
 
-    // Handle timeouts
-    for (const auto& receiver : timedOutReceivers) {
-        const PendingCall& call = pendingCalls[receiver];
-        
-        int callerId = userRepository->getUserId(call.caller);
-        int receiverId = userRepository->getUserId(call.receiver);
-
+    // Unanswered calls: 5s requested + 2s buffer
+    for (const CallSession& call : callRegistry.takeUnanswered(std::chrono::seconds(7))) {
         // Notify Caller: User busy (Unified message for offline/busy/timeout)
-        if (callerId != -1) {
-            protocol::Message response(protocol::MsgCode::CALL_FAILED, "User is busy");
-            connectionManager->sendToUser(callerId, response);
-            
-            // Log for Caller
-            ChatMessage sysMsg;
-            sysMsg.setSenderId(callerId); // Caller is "Sender" of this event? Or Self?
-            // Usually SYSTEM msg has system id? But here we emulate.
-            // Let's use callerId -> receiverId for "Call Failed"
-            sysMsg.setSenderId(callerId);
-            sysMsg.setReceiverId(receiverId != -1 ? receiverId : 0); // Need receiver ID
-            sysMsg.setContent("Call Failed: User is busy");
-            sysMsg.setMessageType("SYSTEM");
-            sysMsg.setIsRead(true); // Read by caller implicitly?
-            chatRepository->saveMessage(sysMsg);
-        }
+        protocol::Message callerResponse(protocol::MsgCode::CALL_FAILED, "User is busy");
+        connectionManager->sendToUser(call.callerId, callerResponse);
 
-        // Notify Receiver: Cancel/Missed Call (to stop ringing if online, and log history)
-        if (receiverId != -1) {
-            protocol::Message response(protocol::MsgCode::CALL_ENDED, "Missed call");
-            connectionManager->sendToUser(receiverId, response);
-            
-            // Log Missed Call for Receiver
-            ChatMessage sysMsg;
-            sysMsg.setSenderId(callerId != -1 ? callerId : 0);
-            sysMsg.setReceiverId(receiverId);
-            sysMsg.setContent("Missed Call");
-            sysMsg.setMessageType("SYSTEM");
-            sysMsg.setIsRead(false);
-            chatRepository->saveMessage(sysMsg);
+        // Notify Receiver: Cancel/Missed Call (to stop ringing if online, or on next login)
+        if (connectionManager->isUserOnline(call.calleeId)) {
+            protocol::Message receiverResponse(protocol::MsgCode::CALL_ENDED, "Missed call");
+            connectionManager->sendToUser(call.calleeId, receiverResponse);
+        } else {
+            connectionManager->notifyUser(call.calleeId, "Missed call from " + call.caller);
         }
 
+        recordCall(call, "MISSED");
+
         if (logger::serverLogger) {
-            logger::serverLogger->info("Call timed out: " + call.caller + " -> " + call.receiver);
+            logger::serverLogger->info("Call timed out: " + call.caller + " -> " + call.callee);
         }
-        
-        // Remove from pending
-        pendingCalls.erase(receiver);
     }
 }
 
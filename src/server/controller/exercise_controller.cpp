@@ -1,4 +1,5 @@
 #include "server/controller/exercise_controller.h"
+#include "server/reply_context.h"
 #include "common/payloads.h"
 #include "common/utils.h"
 #include "common/logger.h"
@@ -13,22 +14,22 @@ namespace server {
 // Constructor
 // ============================================================================
 
-ExerciseController::ExerciseController(std::shared_ptr<SessionManager> sessionMgr, std::shared_ptr<ExerciseRepository> exerciseRepo)
-    : sessionManager(sessionMgr), exerciseRepository(exerciseRepo) {
+ExerciseController::ExerciseController(std::shared_ptr<SessionManager> sessionMgr, std::shared_ptr<ExerciseRepository> exerciseRepo,
+                                       std::shared_ptr<CatalogVersions> catalogVersions)
+    : sessionManager(sessionMgr), exerciseRepository(exerciseRepo), catalogVersions(catalogVersions) {
 }
 
 // ============================================================================
 // Helper Functions
 // ============================================================================
 
-bool ExerciseController::sendMessage(int clientFd, const protocol::Message& msg) {
+bool ExerciseController::sendMessage(Connection& conn, const protocol::Message& msg) {
     try {
-        std::vector<uint8_t> serialized = msg.serialize();
-        ssize_t bytesSent = send(clientFd, serialized.data(), serialized.size(), 0);
+        ssize_t bytesSent = sendReply(conn, msg);
         
         if (bytesSent < 0) {
             if (logger::serverLogger) {
-                logger::serverLogger->error("Failed to send message to fd=" + std::to_string(clientFd));
+                logger::serverLogger->error("Failed to send message to fd=" + std::to_string(conn.fd));
             }
             return false;
         }
@@ -57,15 +58,15 @@ ExerciseType ExerciseController::parseExerciseType(const std::string& typeStr) {
 // Message Handlers
 // ============================================================================
 
-void ExerciseController::handleStudentExerciseListRequest(int clientFd, const protocol::Message& msg) {
+void ExerciseController::handleStudentExerciseListRequest(Connection& conn, const protocol::Message& msg) {
     std::string payload = msg.toString();
     
     if (logger::serverLogger) {
-        logger::serverLogger->debug("[DEBUG] Handling EXERCISE_LIST_REQUEST from fd=" + std::to_string(clientFd) + ", payload: " + payload);
+        logger::serverLogger->debug("[DEBUG] Handling EXERCISE_LIST_REQUEST from fd=" + std::to_string(conn.fd) + ", payload: " + payload);
     }
     
     Payloads::ExerciseListRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
     
     std::string sessionToken = req.sessionToken;
     std::string type = req.type;
@@ -80,64 +81,53 @@ void ExerciseController::handleStudentExerciseListRequest(int clientFd, const pr
     }
     
     // Validate session token
-    if (!sessionManager->is_session_valid(sessionToken)) {
+    if (sessionManager->authenticate(conn, sessionToken) == -1) {
         std::string errorMsg = "Invalid or expired session token in EXERCISE_LIST_REQUEST from fd=" +
-                             std::to_string(clientFd);
+                             std::to_string(conn.fd);
         if (logger::serverLogger) {
             logger::serverLogger->warn("[WARN] " + errorMsg);
         }
         protocol::Message response(protocol::MsgCode::EXERCISE_LIST_FAILURE, errorMsg);
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
+        return;
+    }
+
+    // Conditional fetch: the client's cached copy is still current
+    if (catalogVersions->isNotModified(msg, CatalogVersions::Catalog::EXERCISES)) {
+        sendMessage(conn, catalogVersions->notModified(CatalogVersions::Catalog::EXERCISES));
         return;
     }
-    
-    // Update session activity
-    sessionManager->update_session(sessionToken);
-    
-    // Load exercises from database
-    ExerciseList exerciseList;
     
     try {
-        if (type.empty() && level.empty() && lessonId == -1) {
-            if (logger::serverLogger) {
-                logger::serverLogger->debug("[DEBUG] Loading all exercises");
-            }
-            exerciseList = exerciseRepository->loadAllExercises();
-        } else {
-            if (logger::serverLogger) {
-                logger::serverLogger->debug("[DEBUG] Loading filtered exercises");
-            }
-            exerciseList = exerciseRepository->loadExercisesByFilter(lessonId, type, level);
-        }
+        // Load exercise metadata from database; the list never needs the questions
+        std::vector<ExerciseMetadata> exercises = exerciseRepository->loadExerciseMetadata(lessonId, type, level);
         
-        int exerciseCount = exerciseList.count();
+        int exerciseCount = static_cast<int>(exercises.size());
         if (logger::serverLogger) {
             logger::serverLogger->info("[INFO] Loaded " + std::to_string(exerciseCount) + " exercises");
         }
         
         // Serialize exercise list for network transmission
         // Serialize exercise list using DTOs
-        std::vector<std::string> serializedDtos;
-        for (const auto& exercise : exerciseList.getExercises()) {
-            serializedDtos.push_back(exercise.toMetadataDTO().serialize());
-        }
-        std::string serializedList = std::to_string(serializedDtos.size());
-        if (!serializedDtos.empty()) {
-            serializedList += ";" + utils::join(serializedDtos, ';');
+        Payloads::ListDTO<Payloads::ExerciseMetadataDTO> list;
+        list.items.reserve(exercises.size());
+        for (const auto& exercise : exercises) {
+            list.items.push_back(exercise.toDTO());
         }
         
         // Send success response
-        protocol::Message response(protocol::MsgCode::EXERCISE_LIST_SUCCESS, serializedList);
+        protocol::Message response = Payloads::encode(protocol::MsgCode::EXERCISE_LIST_SUCCESS, list, msg.binary);
+        catalogVersions->stamp(msg, response, CatalogVersions::Catalog::EXERCISES);
         
-        if (sendMessage(clientFd, response)) {
+        if (sendMessage(conn, response)) {
             if (logger::serverLogger) {
                 logger::serverLogger->info("[INFO] Successfully sent " + std::to_string(exerciseCount) +
-                                         " exercises to fd=" + std::to_string(clientFd));
+                                         " exercises to fd=" + std::to_string(conn.fd));
             }
         } else {
             if (logger::serverLogger) {
                 logger::serverLogger->error("[ERROR] Failed to send exercise list to fd=" +
-                                          std::to_string(clientFd));
+                                          std::to_string(conn.fd));
             }
         }
     } catch (const std::exception& e) {
@@ -146,37 +136,39 @@ void ExerciseController::handleStudentExerciseListRequest(int clientFd, const pr
             logger::serverLogger->error("[ERROR] " + errorMsg);
         }
         protocol::Message response(protocol::MsgCode::EXERCISE_LIST_FAILURE, errorMsg);
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
     }
 }
 
-void ExerciseController::handleStudentStudyExerciseRequest(int clientFd, const protocol::Message& msg) {
-    std::string payload = msg.toString();
+void ExerciseController::handleStudentStudyExerciseRequest(Connection& conn, const protocol::Message& msg) {
     
     if (logger::serverLogger) {
-        logger::serverLogger->debug("Handling STUDY_EXERCISE_REQUEST from fd=" + std::to_string(clientFd));
+        logger::serverLogger->debug("Handling STUDY_EXERCISE_REQUEST from fd=" + std::to_string(conn.fd));
     }
     
     Payloads::StudyExerciseRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
     
     std::string sessionToken = req.sessionToken;
     std::string exerciseIdStr = req.exerciseId;
     std::string exerciseTypeStr = req.exerciseType;
     
     // Validate session token
-    if (!sessionManager->is_session_valid(sessionToken)) {
+    if (sessionManager->authenticate(conn, sessionToken) == -1) {
         if (logger::serverLogger) {
             logger::serverLogger->warn("Invalid session token in STUDY_EXERCISE_REQUEST from fd=" +
-                                      std::to_string(clientFd));
+                                      std::to_string(conn.fd));
         }
         protocol::Message response(protocol::MsgCode::STUDY_EXERCISE_FAILURE, "Invalid or expired session");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
+        return;
+    }
+
+    // Conditional fetch: the client's cached copy is still current
+    if (catalogVersions->isNotModified(msg, CatalogVersions::Catalog::EXERCISES)) {
+        sendMessage(conn, catalogVersions->notModified(CatalogVersions::Catalog::EXERCISES));
         return;
     }
-    
-    // Update session activity
-    sessionManager->update_session(sessionToken);
     
     // Parse exercise ID
     int exerciseId;
@@ -185,10 +177,10 @@ void ExerciseController::handleStudentStudyExerciseRequest(int clientFd, const p
     } catch (const std::exception& e) {
         if (logger::serverLogger) {
             logger::serverLogger->error("Invalid exercise_id in STUDY_EXERCISE_REQUEST from fd=" +
-                                       std::to_string(clientFd));
+                                       std::to_string(conn.fd));
         }
         protocol::Message response(protocol::MsgCode::STUDY_EXERCISE_FAILURE, "Invalid exercise ID");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
     
@@ -202,10 +194,10 @@ void ExerciseController::handleStudentStudyExerciseRequest(int clientFd, const p
     if (exercise.getExerciseId() == -1) {
         if (logger::serverLogger) {
             logger::serverLogger->warn("Exercise " + std::to_string(exerciseId) + " not found for fd=" +
-                                      std::to_string(clientFd));
+                                      std::to_string(conn.fd));
         }
         protocol::Message response(protocol::MsgCode::STUDY_EXERCISE_FAILURE, "Exercise not found");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
     
@@ -213,31 +205,27 @@ void ExerciseController::handleStudentStudyExerciseRequest(int clientFd, const p
         logger::serverLogger->info("ExerciseController: Found exercise " + std::to_string(exerciseId) + ", serializing...");
     }
     
-    // Serialize only the requested content type
-    // Serialize using DTO
-    Payloads::ExerciseDTO dto = exercise.toDTO();
-    std::string serializedContent = dto.serialize();
-    
-    // Send success response
-    protocol::Message response(protocol::MsgCode::STUDY_EXERCISE_SUCCESS, serializedContent);
+    // Send success response in the request's codec
+    protocol::Message response =
+        Payloads::encode(protocol::MsgCode::STUDY_EXERCISE_SUCCESS, exercise.toDTO(), msg.binary);
+    catalogVersions->stamp(msg, response, CatalogVersions::Catalog::EXERCISES);
     
-    if (sendMessage(clientFd, response)) {
+    if (sendMessage(conn, response)) {
         if (logger::serverLogger) {
             logger::serverLogger->info("Sent exercise " + std::to_string(exerciseId) +
-                                      " (" + exerciseTypeStr + ") to fd=" + std::to_string(clientFd));
+                                      " (" + exerciseTypeStr + ") to fd=" + std::to_string(conn.fd));
         }
     } else {
         if (logger::serverLogger) {
-            logger::serverLogger->error("Failed to send exercise content to fd=" + std::to_string(clientFd));
+            logger::serverLogger->error("Failed to send exercise content to fd=" + std::to_string(conn.fd));
         }
     }
 }
 
-void ExerciseController::handleStudentSpecificExerciseRequest(int clientFd, const protocol::Message& msg) {
-    std::string payload = msg.toString();
+void ExerciseController::handleStudentSpecificExerciseRequest(Connection& conn, const protocol::Message& msg) {
     
     Payloads::SpecificExerciseRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
     
     std::string sessionToken = req.sessionToken;
     std::string exerciseIdStr = req.exerciseId;
@@ -245,26 +233,30 @@ void ExerciseController::handleStudentSpecificExerciseRequest(int clientFd, cons
     protocol::MsgCode successCode = static_cast<protocol::MsgCode>(static_cast<int>(msg.code) + 1);
     protocol::MsgCode failureCode = static_cast<protocol::MsgCode>(static_cast<int>(msg.code) + 2);
     
-    if (!sessionManager->is_session_valid(sessionToken)) {
+    if (sessionManager->authenticate(conn, sessionToken) == -1) {
         if (logger::serverLogger) {
-            logger::serverLogger->warn("ExerciseController: Invalid session token for specific exercise request from fd=" + std::to_string(clientFd));
+            logger::serverLogger->warn("ExerciseController: Invalid session token for specific exercise request from fd=" + std::to_string(conn.fd));
         }
         protocol::Message response(failureCode, "Invalid session");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
+        return;
+    }
+
+    // Conditional fetch: the client's cached copy is still current
+    if (catalogVersions->isNotModified(msg, CatalogVersions::Catalog::EXERCISES)) {
+        sendMessage(conn, catalogVersions->notModified(CatalogVersions::Catalog::EXERCISES));
         return;
     }
-    
-    sessionManager->update_session(sessionToken);
     
     int exerciseId;
     try {
         exerciseId = std::stoi(exerciseIdStr);
     } catch (...) {
         if (logger::serverLogger) {
-            logger::serverLogger->error("ExerciseController: Invalid exercise ID '" + exerciseIdStr + "' in specific exercise request from fd=" + std::to_string(clientFd));
+            logger::serverLogger->error("ExerciseController: Invalid exercise ID '" + exerciseIdStr + "' in specific exercise request from fd=" + std::to_string(conn.fd));
         }
         protocol::Message response(failureCode, "Invalid exercise ID");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
     
@@ -276,10 +268,10 @@ void ExerciseController::handleStudentSpecificExerciseRequest(int clientFd, cons
     
     if (exercise.getExerciseId() == -1) {
         if (logger::serverLogger) {
-            logger::serverLogger->warn("ExerciseController: Exercise " + std::to_string(exerciseId) + " not found for specific request from fd=" + std::to_string(clientFd));
+            logger::serverLogger->warn("ExerciseController: Exercise " + std::to_string(exerciseId) + " not found for specific request from fd=" + std::to_string(conn.fd));
         }
         protocol::Message response(failureCode, "Exercise not found");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
     
@@ -291,7 +283,8 @@ void ExerciseController::handleStudentSpecificExerciseRequest(int clientFd, cons
     std::string content = dto.serialize();
     
     protocol::Message response(successCode, content);
-    sendMessage(clientFd, response);
+    catalogVersions->stamp(msg, response, CatalogVersions::Catalog::EXERCISES);
+    sendMessage(conn, response);
 }
 
 } // namespace server
\ No newline at end of file
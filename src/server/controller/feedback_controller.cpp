@@ -1,9 +1,13 @@
 #include "server/controller/feedback_controller.h"
+#include "server/reply_context.h"
+#include "server/response_stream.h"
 #include "common/payloads.h"
 #include "common/utils.h"
 #include "common/logger.h"
 #include <sys/socket.h>
+#include <algorithm>
 #include <sstream>
+#include <stdexcept>
 #include <vector>
 
 namespace server {
@@ -11,81 +15,109 @@ namespace server {
 FeedbackController::FeedbackController(std::shared_ptr<SessionManager> sessionMgr, 
                                        std::shared_ptr<ResultRepository> resultRepo,
                                        std::shared_ptr<ExerciseRepository> exerciseRepo,
-                                       std::shared_ptr<ExamRepository> examRepo)
-    : sessionManager(sessionMgr), resultRepo(resultRepo), exerciseRepo(exerciseRepo), examRepo(examRepo) {
+                                       std::shared_ptr<ExamRepository> examRepo,
+                                       std::shared_ptr<ConnectionManager> connMgr)
+    : sessionManager(sessionMgr), resultRepo(resultRepo), exerciseRepo(exerciseRepo), examRepo(examRepo),
+      connectionManager(connMgr) {
 }
 
-bool FeedbackController::sendMessage(int clientFd, const protocol::Message& msg) {
-    std::vector<uint8_t> data = msg.serialize();
-    ssize_t sent = send(clientFd, data.data(), data.size(), 0);
+bool FeedbackController::sendMessage(Connection& conn, const protocol::Message& msg) {
+    ssize_t sent = sendReply(conn, msg);
     if (sent < 0) {
         if (logger::serverLogger) {
-            logger::serverLogger->error("Failed to send message to fd=" + std::to_string(clientFd));
+            logger::serverLogger->error("Failed to send message to fd=" + std::to_string(conn.fd));
         }
         return false;
     }
     return true;
 }
 
-void FeedbackController::handleGetSubmissions(int clientFd, const protocol::Message& msg) {
-    std::string payload = msg.toString();
+void FeedbackController::handleGetSubmissions(Connection& conn, const protocol::Message& msg) {
     
     if (logger::serverLogger) {
-        logger::serverLogger->debug("[FeedbackController] Getting submissions for fd=" + std::to_string(clientFd));
+        logger::serverLogger->debug("[FeedbackController] Getting submissions for fd=" + std::to_string(conn.fd));
     }
 
     Payloads::PendingSubmissionsRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
 
-    if (!sessionManager->is_session_valid(req.sessionToken)) {
+    if (sessionManager->authenticate(conn, req.sessionToken) == -1) {
         protocol::Message response(protocol::MsgCode::PENDING_SUBMISSIONS_FAILURE, "Invalid session");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
-    sessionManager->update_session(req.sessionToken);
+    // Filters and page position; every field is optional
+    SubmissionFilter filter;
+    filter.status = req.status;
+    filter.targetType = req.targetType;
+    filter.student = req.student;
+    filter.from = req.from;
+    filter.to = req.to;
+    try {
+        if (!req.targetId.empty()) {
+            filter.targetId = std::stoi(req.targetId);
+        }
+        if (!req.limit.empty()) {
+            int limit = std::stoi(req.limit);
+            if (limit <= 0) throw std::invalid_argument("limit");
+            filter.limit = std::min(static_cast<size_t>(limit), SubmissionFilter::MAX_LIMIT);
+        }
+    } catch (...) {
+        protocol::Message response(protocol::MsgCode::PENDING_SUBMISSIONS_FAILURE, "Invalid filter");
+        sendMessage(conn, response);
+        return;
+    }
+    if (!req.after.empty() && !filter.setCursor(req.after)) {
+        protocol::Message response(protocol::MsgCode::PENDING_SUBMISSIONS_FAILURE, "Invalid cursor");
+        sendMessage(conn, response);
+        return;
+    }
 
-    // Get all submissions (both pending and graded)
-    auto submissions = resultRepo->getSubmissions();
+    // Stream the page as rows arrive, so even a full page is never held in
+    // memory whole
+    ResponseStream stream(conn, protocol::MsgCode::PENDING_SUBMISSIONS_SUCCESS, msg.binary);
+    Payloads::ListDTOWriter<Payloads::SubmissionDTO> writer(msg.binary);
 
-    // Serialize using SubmissionDTO
-    std::vector<std::string> serializedDtos;
-    for (const auto& sub : submissions) {
-        serializedDtos.push_back(sub.serialize());
-    }
+    long submissionCount = resultRepo->forEachSubmission(filter, [&](size_t total, const Payloads::SubmissionDTO& submission) {
+        if (writer.isFirst() && !stream.write(writer.header(total))) return false;
+        return stream.write(writer.item(submission));
+    });
 
-    std::string responsePayload = std::to_string(serializedDtos.size());
-    if (!serializedDtos.empty()) {
-        responsePayload += ";" + utils::join(serializedDtos, ';');
+    if (submissionCount < 0) {
+        if (stream.hasStarted()) return; // Destructor ends the stream as aborted
+        protocol::Message response(protocol::MsgCode::PENDING_SUBMISSIONS_FAILURE, "Failed to load submissions");
+        sendMessage(conn, response);
+        return;
     }
 
-    protocol::Message response(protocol::MsgCode::PENDING_SUBMISSIONS_SUCCESS, responsePayload);
-    sendMessage(clientFd, response);
+    if (submissionCount == 0) {
+        stream.write(writer.header(0));
+    }
+    stream.finish();
 
     if (logger::serverLogger) {
-        logger::serverLogger->info("[FeedbackController] Sent " + std::to_string(submissions.size()) + " submissions to fd=" + std::to_string(clientFd));
+        logger::serverLogger->info("[FeedbackController] Sent " + std::to_string(submissionCount) + " submissions to fd=" + std::to_string(conn.fd) +
+                                   (filter.hasCursor ? " (continued page)" : ""));
     }
 }
 
-void FeedbackController::handleGradeSubmission(int clientFd, const protocol::Message& msg) {
-    std::string payload = msg.toString();
+void FeedbackController::handleGradeSubmission(Connection& conn, const protocol::Message& msg) {
     
     if (logger::serverLogger) {
-        logger::serverLogger->debug("[FeedbackController] Handling grade submission from fd=" + std::to_string(clientFd));
+        logger::serverLogger->debug("[FeedbackController] Handling grade submission from fd=" + std::to_string(conn.fd));
     }
 
     Payloads::GradeSubmissionRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
 
-    int userId = sessionManager->get_user_id_by_session(req.sessionToken);
+    int userId = sessionManager->authenticate(conn, req.sessionToken);
     if (userId == -1) {
         protocol::Message response(protocol::MsgCode::GRADE_SUBMISSION_FAILURE, "Invalid or expired session");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
-    sessionManager->update_session(req.sessionToken);
-
     int resultId = 0;
     double score = 0.0;
     try {
@@ -93,48 +125,51 @@ void FeedbackController::handleGradeSubmission(int clientFd, const protocol::Mes
         score = std::stod(req.score);
     } catch (...) {
         protocol::Message response(protocol::MsgCode::GRADE_SUBMISSION_FAILURE, "Invalid result ID or score");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
-    if (resultRepo->updateResult(resultId, score, req.feedback, "graded", req.gradingDetails)) {
+    int studentId = -1;
+    if (resultRepo->updateResult(resultId, score, req.feedback, "graded", req.gradingDetails, &studentId)) {
         protocol::Message response(protocol::MsgCode::GRADE_SUBMISSION_SUCCESS, "Grade updated successfully");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
+
+        // Held in the offline outbox if the student is not connected
+        if (studentId != -1) {
+            connectionManager->notifyUser(studentId, "Your submission was graded: " + req.score);
+        }
         
         if (logger::serverLogger) {
             logger::serverLogger->info("[FeedbackController] Grade submitted for result ID " + req.resultId);
         }
     } else {
         protocol::Message response(protocol::MsgCode::GRADE_SUBMISSION_FAILURE, "Failed to update grade");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
     }
 }
 
-void FeedbackController::handleAddFeedback(int clientFd, const protocol::Message& msg) {
-    std::string payload = msg.toString();
+void FeedbackController::handleAddFeedback(Connection& conn, const protocol::Message& msg) {
     
     if (logger::serverLogger) {
-        logger::serverLogger->debug("[FeedbackController] Adding feedback from fd=" + std::to_string(clientFd));
+        logger::serverLogger->debug("[FeedbackController] Adding feedback from fd=" + std::to_string(conn.fd));
     }
 
     Payloads::AddFeedbackRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
 
-    int userId = sessionManager->get_user_id_by_session(req.sessionToken);
+    int userId = sessionManager->authenticate(conn, req.sessionToken);
     if (userId == -1) {
         protocol::Message response(protocol::MsgCode::GRADE_SUBMISSION_FAILURE, "Invalid or expired session");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
-    sessionManager->update_session(req.sessionToken);
-
     int resultId = 0;
     try {
         resultId = std::stoi(req.resultId);
     } catch (...) {
         protocol::Message response(protocol::MsgCode::GRADE_SUBMISSION_FAILURE, "Invalid result ID");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
@@ -147,14 +182,14 @@ void FeedbackController::handleAddFeedback(int clientFd, const protocol::Message
     // Use updateResult to add feedback (keeping existing score)
     if (resultRepo->addFeedback(resultId, feedbackContent, req.feedbackType)) {
         protocol::Message response(protocol::MsgCode::GRADE_SUBMISSION_SUCCESS, "Feedback added successfully");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         
         if (logger::serverLogger) {
             logger::serverLogger->info("[FeedbackController] Feedback added for result ID " + req.resultId);
         }
     } else {
         protocol::Message response(protocol::MsgCode::GRADE_SUBMISSION_FAILURE, "Failed to add feedback");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
     }
 }
 
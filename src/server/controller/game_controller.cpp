@@ -1,4 +1,5 @@
 #include "server/controller/game_controller.h"
+#include "server/reply_context.h"
 #include "common/payloads.h"
 #include "common/logger.h"
 #include <vector>
@@ -10,27 +11,32 @@ namespace server {
 
 GameController::GameController(std::shared_ptr<SessionManager> sm, 
                                std::shared_ptr<GameRepository> gr,
-                               std::shared_ptr<ResultRepository> rr)
-    : sessionManager(sm), gameRepository(gr), resultRepository(rr) {}
+                               std::shared_ptr<ResultRepository> rr,
+                               std::shared_ptr<CatalogVersions> cv)
+    : sessionManager(sm), gameRepository(gr), resultRepository(rr), catalogVersions(cv) {}
 
-bool GameController::sendMessage(int clientFd, const protocol::Message& msg) {
-    if (clientFd < 0) return false;
-    std::vector<uint8_t> data = msg.serialize();
-    return send(clientFd, data.data(), data.size(), 0) != -1;
+bool GameController::sendMessage(Connection& conn, const protocol::Message& msg) {
+    if (conn.fd < 0) return false;
+    return sendReply(conn, msg) != -1;
 }
 
-void GameController::handleGameListRequest(int clientFd, const protocol::Message& msg) {
-    auto payloadStr = msg.toString();
+void GameController::handleGameListRequest(Connection& conn, const protocol::Message& msg) {
     Payloads::GameListRequest req;
-    req.deserialize(payloadStr);
+    Payloads::decode(msg, req);
 
-    if (!sessionManager->is_session_valid(req.sessionToken)) {
+    if (sessionManager->authenticate(conn, req.sessionToken) == -1) {
          // Should send failure or disconnect
          return; 
     }
 
+    // Conditional fetch: the client's cached copy is still current
+    if (catalogVersions->isNotModified(msg, CatalogVersions::Catalog::GAMES)) {
+        sendMessage(conn, catalogVersions->notModified(CatalogVersions::Catalog::GAMES));
+        return;
+    }
+
     std::vector<std::string> types = gameRepository->getGameTypes();
-    std::vector<std::string> serializedGames;
+    Payloads::ListDTO<Payloads::GameMetadataDTO, false> list;
 
     for (const auto& type : types) {
         Payloads::GameMetadataDTO dto;
@@ -41,54 +47,64 @@ void GameController::handleGameListRequest(int clientFd, const protocol::Message
         else if (type == "image_match") dto.description = "Match words to the correct images.";
         else dto.description = "A fun game to learn English.";
         
-        serializedGames.push_back(dto.serialize());
+        list.items.push_back(dto);
     }
 
-    std::string responsePayload = utils::join(serializedGames, ';'); // Use ; to separate items
-    protocol::Message response(protocol::MsgCode::GAME_LIST_SUCCESS, responsePayload);
-    sendMessage(clientFd, response);
+    protocol::Message response = Payloads::encode(protocol::MsgCode::GAME_LIST_SUCCESS, list, msg.binary);
+    catalogVersions->stamp(msg, response, CatalogVersions::Catalog::GAMES);
+    sendMessage(conn, response);
 }
 
-void GameController::handleGameLevelListRequest(int clientFd, const protocol::Message& msg) {
-    auto payloadStr = msg.toString();
+void GameController::handleGameLevelListRequest(Connection& conn, const protocol::Message& msg) {
     Payloads::GameLevelListRequest req;
-    req.deserialize(payloadStr);
+    Payloads::decode(msg, req);
 
-    if (!sessionManager->is_session_valid(req.sessionToken)) {
+    if (sessionManager->authenticate(conn, req.sessionToken) == -1) {
          return;
     }
 
+    // Conditional fetch: the client's cached copy is still current
+    if (catalogVersions->isNotModified(msg, CatalogVersions::Catalog::GAMES)) {
+        sendMessage(conn, catalogVersions->notModified(CatalogVersions::Catalog::GAMES));
+        return;
+    }
+
     std::vector<Game> games = gameRepository->getLevelsByType(req.gameType);
-    std::vector<std::string> serializedLevels;
+    Payloads::ListDTO<Payloads::GameLevelDTO, false> list;
 
     for (const auto& game : games) {
         Payloads::GameLevelDTO dto;
         dto.id = std::to_string(game.getId());
         dto.level = game.getLevel();
         dto.status = "unlocked"; // Logic to determine lock status could go here (e.g., check previous level result)
-        serializedLevels.push_back(dto.serialize());
+        list.items.push_back(dto);
     }
 
-    std::string responsePayload = utils::join(serializedLevels, ';');
-    protocol::Message response(protocol::MsgCode::GAME_LEVEL_LIST_SUCCESS, responsePayload);
-    sendMessage(clientFd, response);
+    protocol::Message response = Payloads::encode(protocol::MsgCode::GAME_LEVEL_LIST_SUCCESS, list, msg.binary);
+    catalogVersions->stamp(msg, response, CatalogVersions::Catalog::GAMES);
+    sendMessage(conn, response);
 }
 
-void GameController::handleGameDataRequest(int clientFd, const protocol::Message& msg) {
-    auto payloadStr = msg.toString();
+void GameController::handleGameDataRequest(Connection& conn, const protocol::Message& msg) {
     Payloads::GameDataRequest req;
-    req.deserialize(payloadStr);
+    Payloads::decode(msg, req);
 
-    if (!sessionManager->is_session_valid(req.sessionToken)) {
+    if (sessionManager->authenticate(conn, req.sessionToken) == -1) {
          return;
     }
 
+    // Conditional fetch: the client's cached copy is still current
+    if (catalogVersions->isNotModified(msg, CatalogVersions::Catalog::GAMES)) {
+        sendMessage(conn, catalogVersions->notModified(CatalogVersions::Catalog::GAMES));
+        return;
+    }
+
     int gameId = std::stoi(req.gameId);
     Game game = gameRepository->getGameById(gameId);
 
     if (game.getId() == 0) {
         protocol::Message response(protocol::MsgCode::GAME_DATA_FAILURE, "Game not found");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
@@ -121,22 +137,21 @@ void GameController::handleGameDataRequest(int clientFd, const protocol::Message
          }
     }
 
-    protocol::Message response(protocol::MsgCode::GAME_DATA_SUCCESS, dto.serialize());
-    sendMessage(clientFd, response);
+    protocol::Message response = Payloads::encode(protocol::MsgCode::GAME_DATA_SUCCESS, dto, msg.binary);
+    catalogVersions->stamp(msg, response, CatalogVersions::Catalog::GAMES);
+    sendMessage(conn, response);
 }
 
-void GameController::handleGameSubmitRequest(int clientFd, const protocol::Message& msg) {
-    auto payloadStr = msg.toString();
+void GameController::handleGameSubmitRequest(Connection& conn, const protocol::Message& msg) {
     Payloads::GameSubmitRequest req;
-    req.deserialize(payloadStr);
+    Payloads::decode(msg, req);
 
-    if (!sessionManager->is_session_valid(req.sessionToken)) {
+    int userId = sessionManager->authenticate(conn, req.sessionToken);
+    if (userId == -1) {
         protocol::Message response(protocol::MsgCode::GAME_SUBMIT_FAILURE, "Invalid session");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
-
-    int userId = sessionManager->get_user_id_by_session(req.sessionToken);
     int gameId = std::stoi(req.gameId);
     double score = std::stod(req.score);
 
@@ -147,11 +162,11 @@ void GameController::handleGameSubmitRequest(int clientFd, const protocol::Messa
         Payloads::GenericResponse resp;
         resp.success = true;
         resp.message = "Game result saved successfully";
-        protocol::Message response(protocol::MsgCode::GAME_SUBMIT_SUCCESS, resp.serialize());
-        sendMessage(clientFd, response);
+        protocol::Message response = Payloads::encode(protocol::MsgCode::GAME_SUBMIT_SUCCESS, resp, msg.binary);
+        sendMessage(conn, response);
     } else {
          protocol::Message response(protocol::MsgCode::GAME_SUBMIT_FAILURE, "Failed to save result");
-         sendMessage(clientFd, response);
+         sendMessage(conn, response);
     }
 }
 
@@ -1,4 +1,5 @@
 #include "server/controller/lesson_controller.h"
+#include "server/reply_context.h"
 #include "common/logger.h"
 #include "common/payloads.h"
 #include "common/utils.h"
@@ -12,22 +13,24 @@ namespace server {
 // Constructor
 // ============================================================================
 
-LessonController::LessonController(std::shared_ptr<SessionManager> sessionMgr, std::shared_ptr<LessonRepository> lessonRepo)
-    : sessionManager(sessionMgr), lessonRepository(lessonRepo) {
+LessonController::LessonController(std::shared_ptr<SessionManager> sessionMgr, std::shared_ptr<LessonRepository> lessonRepo,
+                                   std::shared_ptr<CatalogVersions> catalogVersions,
+                                   std::shared_ptr<ConnectionManager> connMgr)
+    : sessionManager(sessionMgr), lessonRepository(lessonRepo), catalogVersions(catalogVersions),
+      connectionManager(connMgr) {
 }
 
 // ============================================================================
 // Helper Functions
 // ============================================================================
 
-bool LessonController::sendMessage(int clientFd, const protocol::Message& msg) {
+bool LessonController::sendMessage(Connection& conn, const protocol::Message& msg) {
     try {
-        std::vector<uint8_t> serialized = msg.serialize();
-        ssize_t bytesSent = send(clientFd, serialized.data(), serialized.size(), 0);
+        ssize_t bytesSent = sendReply(conn, msg);
         
         if (bytesSent < 0) {
             if (logger::serverLogger) {
-                logger::serverLogger->error("Failed to send message to fd=" + std::to_string(clientFd));
+                logger::serverLogger->error("Failed to send message to fd=" + std::to_string(conn.fd));
             }
             return false;
         }
@@ -57,17 +60,17 @@ LessonType LessonController::parseLessonType(const std::string& typeStr) {
 // Message Handlers
 // ============================================================================
 
-void LessonController::handleUserLessonListRequest(int clientFd, const protocol::Message& msg) {
+void LessonController::handleUserLessonListRequest(Connection& conn, const protocol::Message& msg) {
     std::string payload = msg.toString();
     
     if (logger::serverLogger) {
-        logger::serverLogger->debug("[DEBUG] Handling LESSON_LIST_REQUEST from fd=" + std::to_string(clientFd) + 
+        logger::serverLogger->debug("[DEBUG] Handling LESSON_LIST_REQUEST from fd=" + std::to_string(conn.fd) + 
                                   ", payload: " + payload);
     }
     
     // Deserialize request using Payloads
     Payloads::LessonListRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
     
     std::string sessionToken = req.sessionToken;
     std::string topic = req.topic;
@@ -80,64 +83,53 @@ void LessonController::handleUserLessonListRequest(int clientFd, const protocol:
     }
     
     // Validate session token
-    if (!sessionManager->is_session_valid(sessionToken)) {
+    if (sessionManager->authenticate(conn, sessionToken) == -1) {
         std::string errorMsg = "Invalid or expired session token in LESSON_LIST_REQUEST from fd=" + 
-                             std::to_string(clientFd);
+                             std::to_string(conn.fd);
         if (logger::serverLogger) {
             logger::serverLogger->warn("[WARN] " + errorMsg);
         }
         protocol::Message response(protocol::MsgCode::LESSON_LIST_FAILURE, errorMsg);
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
+        return;
+    }
+
+    // Conditional fetch: the client's cached copy is still current
+    if (catalogVersions->isNotModified(msg, CatalogVersions::Catalog::LESSONS)) {
+        sendMessage(conn, catalogVersions->notModified(CatalogVersions::Catalog::LESSONS));
         return;
     }
-    
-    // Update session activity
-    sessionManager->update_session(sessionToken);
-    
-    // Load lessons from database
-    LessonList lessonList;
     
     try {
-        if (topic.empty() && level.empty()) {
-            if (logger::serverLogger) {
-                logger::serverLogger->debug("[DEBUG] Loading all lessons");
-            }
-            lessonList = lessonRepository->loadAllLessons();
-        } else {
-            if (logger::serverLogger) {
-                logger::serverLogger->debug("[DEBUG] Loading filtered lessons");
-            }
-            lessonList = lessonRepository->loadLessonsByFilter(topic, level);
-        }
+        // Load lesson metadata from database; the list never needs the content
+        std::vector<LessonMetadata> lessons = lessonRepository->loadLessonMetadata(topic, level);
         
-        int lessonCount = lessonList.count();
+        int lessonCount = static_cast<int>(lessons.size());
         if (logger::serverLogger) {
             logger::serverLogger->info("[INFO] Loaded " + std::to_string(lessonCount) + " lessons");
         }
         
         // Serialize lesson list for network transmission
         // Convert to DTOs and serialize
-        const auto& lessons = lessonList.getLessons();
-        std::vector<std::string> serializedLessons;
-        serializedLessons.push_back(std::to_string(lessons.size()));
+        Payloads::ListDTO<Payloads::LessonMetadataDTO> list;
+        list.items.reserve(lessons.size());
         
         for (const auto& lesson : lessons) {
-            serializedLessons.push_back(lesson.toMetadataDTO().serialize());
+            list.items.push_back(lesson.toDTO());
         }
         
-        std::string responsePayload = utils::join(serializedLessons, ';');
-        
-        protocol::Message response(protocol::MsgCode::LESSON_LIST_SUCCESS, responsePayload);
+        protocol::Message response = Payloads::encode(protocol::MsgCode::LESSON_LIST_SUCCESS, list, msg.binary);
+        catalogVersions->stamp(msg, response, CatalogVersions::Catalog::LESSONS);
         
-        if (sendMessage(clientFd, response)) {
+        if (sendMessage(conn, response)) {
             if (logger::serverLogger) {
                 logger::serverLogger->info("[INFO] Successfully sent " + std::to_string(lessonCount) + 
-                                         " lessons to fd=" + std::to_string(clientFd));
+                                         " lessons to fd=" + std::to_string(conn.fd));
             }
         } else {
             if (logger::serverLogger) {
                 logger::serverLogger->error("[ERROR] Failed to send lesson list to fd=" + 
-                                          std::to_string(clientFd));
+                                          std::to_string(conn.fd));
             }
         }
     } catch (const std::exception& e) {
@@ -146,51 +138,58 @@ void LessonController::handleUserLessonListRequest(int clientFd, const protocol:
             logger::serverLogger->error("[ERROR] " + errorMsg);
         }
         protocol::Message response(protocol::MsgCode::LESSON_LIST_FAILURE, errorMsg);
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
     }
 }
 
-void LessonController::handleUserStudyLessonRequest(int clientFd, const protocol::Message& msg) {
-    std::string payload = msg.toString();
+void LessonController::handleUserStudyLessonRequest(Connection& conn, const protocol::Message& msg) {
     
     if (logger::serverLogger) {
-        logger::serverLogger->debug("Handling STUDY_LESSON_REQUEST from fd=" + std::to_string(clientFd));
+        logger::serverLogger->debug("Handling STUDY_LESSON_REQUEST from fd=" + std::to_string(conn.fd));
     }
     
     // Deserialize request using Payloads
     Payloads::StudyLessonRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
     
     std::string sessionToken = req.sessionToken;
     std::string lessonIdStr = req.lessonId;
     std::string lessonTypeStr = req.lessonType;
     
     // Validate session token
-    if (!sessionManager->is_session_valid(sessionToken)) {
+    if (sessionManager->authenticate(conn, sessionToken) == -1) {
         if (logger::serverLogger) {
             logger::serverLogger->warn("Invalid session token in STUDY_LESSON_REQUEST from fd=" + 
-                                      std::to_string(clientFd));
+                                      std::to_string(conn.fd));
         }
         protocol::Message response(protocol::MsgCode::STUDY_LESSON_FAILURE, "Invalid or expired session");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
-    
-    // Update session activity
-    sessionManager->update_session(sessionToken);
-    
+
     // Parse lesson ID
-    // Load lesson
     int lessonId = std::stoi(req.lessonId);
+
+    // Announcements for this lesson (e.g. a new exam on it) reach the student
+    // from now on, including when their cached copy is still current
+    connectionManager->subscribe(conn, topics::lesson(lessonId));
+
+    // Conditional fetch: the client's cached copy is still current
+    if (catalogVersions->isNotModified(msg, CatalogVersions::Catalog::LESSONS)) {
+        sendMessage(conn, catalogVersions->notModified(CatalogVersions::Catalog::LESSONS));
+        return;
+    }
+    
+    // Load lesson
     server::Lesson lesson = lessonRepository->loadLessonById(lessonId);
     
     if (lesson.getLessonId() == -1) {
         protocol::Message response(protocol::MsgCode::STUDY_LESSON_FAILURE, "Lesson not found");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
     
-    // Convert to DTO and serialize
+    // Convert to DTO and encode in the request's codec
     // Note: The original code supported partial loading (VIDEO, AUDIO, etc.)
     // For this refactor, we are using the full LessonDTO which supports all fields.
     // If partial loading is strictly required for bandwidth, we might need separate DTOs or optional fields.
@@ -199,20 +198,18 @@ void LessonController::handleUserStudyLessonRequest(int clientFd, const protocol
     // If the client requested a specific type, we could potentially clear other fields in the DTO before sending,
     // but sending the full object is safer for now as it guarantees all data is available.
     
-    Payloads::LessonDTO dto = lesson.toDTO();
-    std::string responsePayload = dto.serialize();
-    
-    protocol::Message response(protocol::MsgCode::STUDY_LESSON_SUCCESS, responsePayload);
-    // sendMessage(clientFd, response); // Removed duplicate call
+    protocol::Message response = Payloads::encode(protocol::MsgCode::STUDY_LESSON_SUCCESS, lesson.toDTO(), msg.binary);
+    catalogVersions->stamp(msg, response, CatalogVersions::Catalog::LESSONS);
+    // sendMessage(conn, response); // Removed duplicate call
     
-    if (sendMessage(clientFd, response)) {
+    if (sendMessage(conn, response)) {
         if (logger::serverLogger) {
             logger::serverLogger->info("Sent lesson " + std::to_string(lessonId) + 
-                                      " (" + lessonTypeStr + ") to fd=" + std::to_string(clientFd));
+                                      " (" + lessonTypeStr + ") to fd=" + std::to_string(conn.fd));
         }
     } else {
         if (logger::serverLogger) {
-            logger::serverLogger->error("Failed to send lesson content to fd=" + std::to_string(clientFd));
+            logger::serverLogger->error("Failed to send lesson content to fd=" + std::to_string(conn.fd));
         }
     }
 }
@@ -1,4 +1,5 @@
 #include "server/controller/result_controller.h"
+#include "server/reply_context.h"
 #include "common/payloads.h"
 #include "common/utils.h"
 #include "common/logger.h"
@@ -22,14 +23,13 @@ ResultController::ResultController(std::shared_ptr<SessionManager> sessionMgr,
 // Helper Functions
 // ============================================================================
 
-bool ResultController::sendMessage(int clientFd, const protocol::Message& msg) {
+bool ResultController::sendMessage(Connection& conn, const protocol::Message& msg) {
     try {
-        std::vector<uint8_t> serialized = msg.serialize();
-        ssize_t bytesSent = send(clientFd, serialized.data(), serialized.size(), 0);
+        ssize_t bytesSent = sendReply(conn, msg);
         
         if (bytesSent < 0) {
             if (logger::serverLogger) {
-                logger::serverLogger->error("Failed to send message to fd=" + std::to_string(clientFd));
+                logger::serverLogger->error("Failed to send message to fd=" + std::to_string(conn.fd));
             }
             return false;
         }
@@ -45,12 +45,12 @@ bool ResultController::sendMessage(int clientFd, const protocol::Message& msg) {
 // Message Handlers
 // ============================================================================
 
-void ResultController::handleStudentResultRequest(int clientFd, const protocol::Message& msg) {
+void ResultController::handleStudentResultRequest(Connection& conn, const protocol::Message& msg) {
     std::string payload = msg.toString();
-    logger::serverLogger->debug("Handling result request from fd=" + std::to_string(clientFd) + ", payload: " + payload);
+    logger::serverLogger->debug("Handling result request from fd=" + std::to_string(conn.fd) + ", payload: " + payload);
 
     Payloads::ResultRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
 
     std::string sessionToken = req.sessionToken;
     std::string targetType = req.targetType;
@@ -59,18 +59,16 @@ void ResultController::handleStudentResultRequest(int clientFd, const protocol::
         targetId = std::stoi(req.targetId);
     } catch (...) {
         protocol::Message response(protocol::MsgCode::RESULT_LIST_FAILURE, "Invalid target ID");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
-    int userId = sessionManager->get_user_id_by_session(sessionToken);
+    int userId = sessionManager->authenticate(conn, sessionToken);
     if (userId == -1) {
         protocol::Message response(protocol::MsgCode::RESULT_LIST_FAILURE, "Invalid or expired session");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
-    sessionManager->update_session(sessionToken);
-
     double score;
     std::string feedback;
     std::string status;
@@ -79,21 +77,21 @@ void ResultController::handleStudentResultRequest(int clientFd, const protocol::
         Payloads::ResultDTO dto;
         dto.score = std::to_string(score);
         dto.feedback = feedback;
-        protocol::Message response(protocol::MsgCode::RESULT_LIST_SUCCESS, dto.serialize());
-        sendMessage(clientFd, response);
+        protocol::Message response = Payloads::encode(protocol::MsgCode::RESULT_LIST_SUCCESS, dto, msg.binary);
+        sendMessage(conn, response);
     } else {
         protocol::Message response(protocol::MsgCode::RESULT_LIST_FAILURE, "Result not found");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
     }
 }
 
-void ResultController::handleStudentResultListRequest(int clientFd, const protocol::Message& msg) {
+void ResultController::handleStudentResultListRequest(Connection& conn, const protocol::Message& msg) {
     std::string payload = msg.toString();
-    logger::serverLogger->debug("Handling done/undone list request from fd=" + std::to_string(clientFd) + ", payload: " + payload);
+    logger::serverLogger->debug("Handling done/undone list request from fd=" + std::to_string(conn.fd) + ", payload: " + payload);
 
     logger::serverLogger->debug("Deserializing payload");
     Payloads::ResultListRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
 
     std::string sessionToken = req.sessionToken;
     std::string targetType = req.targetType;
@@ -105,22 +103,19 @@ void ResultController::handleStudentResultListRequest(int clientFd, const protoc
     }
 
     logger::serverLogger->debug("Getting user ID");
-    int userId = sessionManager->get_user_id_by_session(sessionToken);
+    int userId = sessionManager->authenticate(conn, sessionToken);
     logger::serverLogger->debug("User ID: " + std::to_string(userId));
 
     if (userId == -1) {
         protocol::Message response(protocol::MsgCode::RESULT_LIST_FAILURE, "Invalid or expired session");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
-    logger::serverLogger->debug("Updating session");
-    sessionManager->update_session(sessionToken);
-
     if (!resultRepo) {
         logger::serverLogger->error("ResultRepository is null in handleDoneUndoneListRequest");
         protocol::Message response(protocol::MsgCode::RESULT_LIST_FAILURE, "Internal server error");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
@@ -128,85 +123,42 @@ void ResultController::handleStudentResultListRequest(int clientFd, const protoc
     std::vector<Payloads::ResultSummaryDTO> results = resultRepo->getResultsByUser(userId, targetType);
     logger::serverLogger->debug("resultRepo->getResultsByUser returned " + std::to_string(results.size()) + " results");
     
-    std::vector<std::string> serializedDtos;
-    for (const auto& dto : results) {
-        serializedDtos.push_back(dto.serialize());
-    }
-    
-    std::string responsePayload = std::to_string(serializedDtos.size());
-    if (!serializedDtos.empty()) {
-            responsePayload += ";" + utils::join(serializedDtos, ';');
-    }
-    protocol::Message response(protocol::MsgCode::RESULT_LIST_SUCCESS, responsePayload);
-    sendMessage(clientFd, response);
+    Payloads::ListDTO<Payloads::ResultSummaryDTO> list;
+    list.items = std::move(results);
+    protocol::Message response = Payloads::encode(protocol::MsgCode::RESULT_LIST_SUCCESS, list, msg.binary);
+    sendMessage(conn, response);
 }
 
-void ResultController::handleStudentResultDetailRequest(int clientFd, const protocol::Message& msg) {
-    std::string payload = msg.toString();
-    logger::serverLogger->debug("Handling result detail request from fd=" + std::to_string(clientFd));
+void ResultController::handleStudentResultDetailRequest(Connection& conn, const protocol::Message& msg) {
+    logger::serverLogger->debug("Handling result detail request from fd=" + std::to_string(conn.fd));
 
     Payloads::ResultDetailRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
 
-    int userId = sessionManager->get_user_id_by_session(req.sessionToken);
+    int userId = sessionManager->authenticate(conn, req.sessionToken);
     if (userId == -1) {
         protocol::Message response(protocol::MsgCode::RESULT_LIST_FAILURE, "Invalid or expired session");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
-    sessionManager->update_session(req.sessionToken);
-
     Payloads::ResultDetailDTO detail;
     int targetId = 0;
     try {
         targetId = std::stoi(req.targetId);
     } catch (...) {
         protocol::Message response(protocol::MsgCode::RESULT_LIST_FAILURE, "Invalid target ID");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
     if (resultRepo->getResultDetail(userId, req.targetType, targetId, detail)) {
-        protocol::Message response(protocol::MsgCode::RESULT_DETAIL_SUCCESS, detail.serialize());
-        sendMessage(clientFd, response);
+        protocol::Message response = Payloads::encode(protocol::MsgCode::RESULT_DETAIL_SUCCESS, detail, msg.binary);
+        sendMessage(conn, response);
     } else {
         protocol::Message response(protocol::MsgCode::RESULT_LIST_FAILURE, "Result not found");
-        sendMessage(clientFd, response);
-    }
-}
-
-void ResultController::handleTeacherPendingSubmissionsRequest(int clientFd, const protocol::Message& msg) {
-    std::string payload = msg.toString();
-    logger::serverLogger->debug("Handling pending submissions request from fd=" + std::to_string(clientFd));
-
-    Payloads::PendingSubmissionsRequest req;
-    req.deserialize(payload);
-
-    // Verify admin/teacher role (simplified: just check valid session for now, ideally check role)
-    int userId = sessionManager->get_user_id_by_session(req.sessionToken);
-    if (userId == -1) {
-        protocol::Message response(protocol::MsgCode::RESULT_LIST_FAILURE, "Invalid or expired session");
-        sendMessage(clientFd, response);
-        return;
-    }
-
-    sessionManager->update_session(req.sessionToken);
-
-    std::vector<Payloads::PendingSubmissionDTO> submissions = resultRepo->getPendingSubmissions();
-    
-    std::vector<std::string> serializedDtos;
-    for (const auto& dto : submissions) {
-        serializedDtos.push_back(dto.serialize());
-    }
-    
-    std::string responsePayload = std::to_string(serializedDtos.size());
-    if (!serializedDtos.empty()) {
-            responsePayload += ";" + utils::join(serializedDtos, ';');
+        sendMessage(conn, response);
     }
-    // Reusing RESULT_LIST_SUCCESS for now, or create a new MsgCode
-    protocol::Message response(protocol::MsgCode::PENDING_SUBMISSIONS_SUCCESS, responsePayload);
-    sendMessage(clientFd, response);
 }
 
 } // namespace server
\ No newline at end of file
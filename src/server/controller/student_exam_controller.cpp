@@ -1,4 +1,5 @@
 #include "server/controller/student_exam_controller.h"
+#include "server/reply_context.h"
 #include "common/payloads.h"
 #include "common/utils.h"
 #include "common/logger.h"
@@ -10,79 +11,69 @@ namespace server {
 
 StudentExamController::StudentExamController(std::shared_ptr<SessionManager> sessionMgr, 
                                              std::shared_ptr<ExamRepository> examRepo,
-                                             std::shared_ptr<ResultRepository> resultRepo)
-    : sessionManager(sessionMgr), examRepository(examRepo), resultRepository(resultRepo) {
+                                             std::shared_ptr<ResultRepository> resultRepo,
+                                             std::shared_ptr<CatalogVersions> catalogVersions)
+    : sessionManager(sessionMgr), examRepository(examRepo), resultRepository(resultRepo),
+      catalogVersions(catalogVersions) {
 }
 
-void StudentExamController::handleGetExams(int clientFd, const protocol::Message &msg) {
-    std::string payload = msg.toString();
+void StudentExamController::handleGetExams(Connection& conn, const protocol::Message &msg) {
 
     if (logger::serverLogger) {
-        logger::serverLogger->debug("[StudentExamController] Handling EXAM_LIST_REQUEST from fd=" + std::to_string(clientFd));
+        logger::serverLogger->debug("[StudentExamController] Handling EXAM_LIST_REQUEST from fd=" + std::to_string(conn.fd));
     }
 
     Payloads::ExamListRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
 
     std::string sessionToken = req.sessionToken;
     std::string type = req.type;
     std::string level = req.level;
     int lessonId = req.lessonId.empty() ? -1 : std::stoi(req.lessonId);
 
-    if (!sessionManager->is_session_valid(sessionToken)) {
+    if (sessionManager->authenticate(conn, sessionToken) == -1) {
         protocol::Message response(protocol::MsgCode::EXAM_LIST_FAILURE, "Invalid or expired session");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
-    sessionManager->update_session(sessionToken);
-
-    ExamList examList;
+    // Conditional fetch: the client's cached copy is still current
+    if (catalogVersions->isNotModified(msg, CatalogVersions::Catalog::EXAMS)) {
+        sendMessage(conn, catalogVersions->notModified(CatalogVersions::Catalog::EXAMS));
+        return;
+    }
 
     try {
-        if (type.empty() && level.empty() && lessonId == -1) {
-            examList = examRepository->loadAllExams();
-        } else {
-            examList = examRepository->loadExamsByFilter(lessonId, type, level);
-        }
+        // The list shows metadata only, so the questions are never loaded
+        std::vector<ExamMetadata> exams = examRepository->loadExamMetadata(lessonId, type, level);
 
-        std::vector<std::string> serializedDtos;
-        for (const auto& exam : examList.getExams()) {
-            serializedDtos.push_back(exam.toMetadataDTO().serialize());
-        }
-        std::string serializedList = std::to_string(serializedDtos.size());
-        if (!serializedDtos.empty()) {
-            serializedList += ";" + utils::join(serializedDtos, ';');
+        Payloads::ListDTO<Payloads::ExamMetadataDTO> list;
+        list.items.reserve(exams.size());
+        for (const auto& exam : exams) {
+            list.items.push_back(exam.toDTO());
         }
 
-        protocol::Message response(protocol::MsgCode::EXAM_LIST_SUCCESS, serializedList);
-        sendMessage(clientFd, response);
+        protocol::Message response = Payloads::encode(protocol::MsgCode::EXAM_LIST_SUCCESS, list, msg.binary);
+        catalogVersions->stamp(msg, response, CatalogVersions::Catalog::EXAMS);
+        sendMessage(conn, response);
 
         if (logger::serverLogger) {
-            logger::serverLogger->info("[StudentExamController] Sent " + std::to_string(examList.count()) + " exams to fd=" + std::to_string(clientFd));
+            logger::serverLogger->info("[StudentExamController] Sent " + std::to_string(exams.size()) + " exams to fd=" + std::to_string(conn.fd));
         }
     } catch (const std::exception& e) {
         protocol::Message response(protocol::MsgCode::EXAM_LIST_FAILURE, std::string("Error: ") + e.what());
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
     }
 }
 
-void StudentExamController::handleExamRequest(int clientFd, const protocol::Message &msg) {
-    std::string payload = msg.toString();
+void StudentExamController::handleExamRequest(Connection& conn, const protocol::Message &msg) {
     Payloads::ExamRequest req;
-    req.deserialize(payload);
-
-    if (!sessionManager->is_session_valid(req.sessionToken)) {
-        protocol::Message response(protocol::MsgCode::EXAM_FAILURE, "Invalid session");
-        sendMessage(clientFd, response);
-        return;
-    }
-    sessionManager->update_session(req.sessionToken);
+    Payloads::decode(msg, req);
 
-    int userId = sessionManager->get_user_id_by_session(req.sessionToken);
+    int userId = sessionManager->authenticate(conn, req.sessionToken);
     if (userId == -1) {
         protocol::Message response(protocol::MsgCode::EXAM_FAILURE, "Invalid session");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
@@ -91,7 +82,7 @@ void StudentExamController::handleExamRequest(int clientFd, const protocol::Mess
         examId = std::stoi(req.examId);
     } catch (...) {
         protocol::Message response(protocol::MsgCode::EXAM_FAILURE, "Invalid exam ID");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
@@ -105,7 +96,13 @@ void StudentExamController::handleExamRequest(int clientFd, const protocol::Mess
             logger::serverLogger->info("[StudentExamController] Exam already taken by student " + std::to_string(userId));
         }
         protocol::Message response(protocol::MsgCode::EXAM_ALREADY_TAKEN, "Exam already taken");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
+        return;
+    }
+
+    // Checked after the retake rule so a cached exam never bypasses it
+    if (catalogVersions->isNotModified(msg, CatalogVersions::Catalog::EXAMS)) {
+        sendMessage(conn, catalogVersions->notModified(CatalogVersions::Catalog::EXAMS));
         return;
     }
 
@@ -113,22 +110,22 @@ void StudentExamController::handleExamRequest(int clientFd, const protocol::Mess
     
     if (exam.getExamId() == -1) {
         protocol::Message response(protocol::MsgCode::EXAM_FAILURE, "Exam not found");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
     Payloads::ExamDTO dto = exam.toDTO();
-    protocol::Message response(protocol::MsgCode::EXAM_SUCCESS, dto.serialize());
-    sendMessage(clientFd, response);
+    protocol::Message response = Payloads::encode(protocol::MsgCode::EXAM_SUCCESS, dto, msg.binary);
+    catalogVersions->stamp(msg, response, CatalogVersions::Catalog::EXAMS);
+    sendMessage(conn, response);
 }
 
-bool StudentExamController::sendMessage(int clientFd, const protocol::Message& msg) {
-    std::vector<uint8_t> data = msg.serialize();
-    ssize_t sent = send(clientFd, data.data(), data.size(), 0);
+bool StudentExamController::sendMessage(Connection& conn, const protocol::Message& msg) {
+    ssize_t sent = sendReply(conn, msg);
     
     if (sent < 0) {
         if (logger::serverLogger) {
-            logger::serverLogger->error("Failed to send message to fd=" + std::to_string(clientFd));
+            logger::serverLogger->error("Failed to send message to fd=" + std::to_string(conn.fd));
         }
         return false;
     }
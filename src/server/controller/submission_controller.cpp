@@ -1,4 +1,5 @@
 #include "server/controller/submission_controller.h"
+#include "server/reply_context.h"
 #include "common/payloads.h"
 #include "common/utils.h"
 #include "common/logger.h"
@@ -24,14 +25,13 @@ SubmissionController::SubmissionController(std::shared_ptr<SessionManager> sessi
 // Helper Functions
 // ============================================================================
 
-bool SubmissionController::sendMessage(int clientFd, const protocol::Message& msg) {
+bool SubmissionController::sendMessage(Connection& conn, const protocol::Message& msg) {
     try {
-        std::vector<uint8_t> serialized = msg.serialize();
-        ssize_t bytesSent = send(clientFd, serialized.data(), serialized.size(), 0);
+        ssize_t bytesSent = sendReply(conn, msg);
         
         if (bytesSent < 0) {
             if (logger::serverLogger) {
-                logger::serverLogger->error("Failed to send message to fd=" + std::to_string(clientFd));
+                logger::serverLogger->error("Failed to send message to fd=" + std::to_string(conn.fd));
             }
             return false;
         }
@@ -47,12 +47,12 @@ bool SubmissionController::sendMessage(int clientFd, const protocol::Message& ms
 // Message Handlers
 // ============================================================================
 
-void SubmissionController::handleStudentSubmission(int clientFd, const protocol::Message& msg) {
+void SubmissionController::handleStudentSubmission(Connection& conn, const protocol::Message& msg) {
     std::string payload = msg.toString();
-    logger::serverLogger->debug("Handling submission from fd=" + std::to_string(clientFd) + ", payload: " + payload);
+    logger::serverLogger->debug("Handling submission from fd=" + std::to_string(conn.fd) + ", payload: " + payload);
 
     Payloads::SubmitAnswerRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
 
     std::string sessionToken = req.sessionToken;
     std::string targetType = req.targetType;
@@ -61,25 +61,23 @@ void SubmissionController::handleStudentSubmission(int clientFd, const protocol:
         targetId = std::stoi(req.targetId);
     } catch (...) {
         protocol::Message response(protocol::MsgCode::SUBMIT_ANSWER_FAILURE, "Invalid target ID");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
     std::string userAnswer = req.answer;
 
-    int userId = sessionManager->get_user_id_by_session(sessionToken);
+    int userId = sessionManager->authenticate(conn, sessionToken);
     if (userId == -1) {
         protocol::Message response(protocol::MsgCode::SUBMIT_ANSWER_FAILURE, "Invalid or expired session");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
-    sessionManager->update_session(sessionToken);
-
     // Check if exam already taken (by the requesting user)
     if (targetType == "exam") {
         if (resultRepo->hasResult(userId, targetType, targetId)) {
             protocol::Message response(protocol::MsgCode::SUBMIT_ANSWER_FAILURE, "Exam already taken");
-            sendMessage(clientFd, response);
+            sendMessage(conn, response);
             return;
         }
     }
@@ -167,31 +165,28 @@ void SubmissionController::handleStudentSubmission(int clientFd, const protocol:
         Payloads::ResultDTO resultDto;
         resultDto.score = std::to_string(score);
         resultDto.feedback = feedback;
-        protocol::Message response(protocol::MsgCode::SUBMIT_ANSWER_SUCCESS, resultDto.serialize());
-        sendMessage(clientFd, response);
+        protocol::Message response = Payloads::encode(protocol::MsgCode::SUBMIT_ANSWER_SUCCESS, resultDto, msg.binary);
+        sendMessage(conn, response);
     } else {
         protocol::Message response(protocol::MsgCode::SUBMIT_ANSWER_FAILURE, "Failed to save result");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
     }
 }
 
-void SubmissionController::handleTeacherGradeSubmission(int clientFd, const protocol::Message& msg) {
-    std::string payload = msg.toString();
-    logger::serverLogger->debug("Handling grade submission from fd=" + std::to_string(clientFd));
+void SubmissionController::handleTeacherGradeSubmission(Connection& conn, const protocol::Message& msg) {
+    logger::serverLogger->debug("Handling grade submission from fd=" + std::to_string(conn.fd));
 
     Payloads::GradeSubmissionRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
 
     // Verify admin/teacher role (simplified)
-    int userId = sessionManager->get_user_id_by_session(req.sessionToken);
+    int userId = sessionManager->authenticate(conn, req.sessionToken);
     if (userId == -1) {
         protocol::Message response(protocol::MsgCode::GRADE_SUBMISSION_FAILURE, "Invalid or expired session");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
-    sessionManager->update_session(req.sessionToken);
-
     int resultId = 0;
     double score = 0.0;
     try {
@@ -199,16 +194,16 @@ void SubmissionController::handleTeacherGradeSubmission(int clientFd, const prot
         score = std::stod(req.score);
     } catch (...) {
         protocol::Message response(protocol::MsgCode::GRADE_SUBMISSION_FAILURE, "Invalid result ID or score");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
     if (resultRepo->updateResult(resultId, score, req.feedback, "graded", req.gradingDetails)) {
         protocol::Message response(protocol::MsgCode::GRADE_SUBMISSION_SUCCESS, "Grade updated successfully");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
     } else {
         protocol::Message response(protocol::MsgCode::GRADE_SUBMISSION_FAILURE, "Failed to update grade");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
     }
 }
 
@@ -1,4 +1,5 @@
 #include "server/controller/teacher_exam_controller.h"
+#include "server/reply_context.h"
 #include "common/payloads.h"
 #include "common/utils.h"
 #include "common/logger.h"
@@ -12,24 +13,22 @@ TeacherExamController::TeacherExamController(std::shared_ptr<SessionManager> ses
     : sessionManager(sessionMgr), examRepository(examRepo) {
 }
 
-void TeacherExamController::handleExamReview(int clientFd, const protocol::Message &msg) {
-    std::string payload = msg.toString();
+void TeacherExamController::handleExamReview(Connection& conn, const protocol::Message &msg) {
     Payloads::ExamRequest req;
-    req.deserialize(payload);
+    Payloads::decode(msg, req);
 
-    if (!sessionManager->is_session_valid(req.sessionToken)) {
+    if (sessionManager->authenticate(conn, req.sessionToken) == -1) {
         protocol::Message response(protocol::MsgCode::EXAM_FAILURE, "Invalid session");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
-    sessionManager->update_session(req.sessionToken);
 
     int examId;
     try {
         examId = std::stoi(req.examId);
     } catch (...) {
         protocol::Message response(protocol::MsgCode::EXAM_FAILURE, "Invalid exam ID");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
@@ -42,22 +41,21 @@ void TeacherExamController::handleExamReview(int clientFd, const protocol::Messa
     
     if (exam.getExamId() == -1) {
         protocol::Message response(protocol::MsgCode::EXAM_FAILURE, "Exam not found");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
     Payloads::ExamDTO dto = exam.toDTO();
-    protocol::Message response(protocol::MsgCode::EXAM_SUCCESS, dto.serialize());
-    sendMessage(clientFd, response);
+    protocol::Message response = Payloads::encode(protocol::MsgCode::EXAM_SUCCESS, dto, msg.binary);
+    sendMessage(conn, response);
 }
 
-bool TeacherExamController::sendMessage(int clientFd, const protocol::Message& msg) {
-    std::vector<uint8_t> data = msg.serialize();
-    ssize_t sent = send(clientFd, data.data(), data.size(), 0);
+bool TeacherExamController::sendMessage(Connection& conn, const protocol::Message& msg) {
+    ssize_t sent = sendReply(conn, msg);
     
     if (sent < 0) {
         if (logger::serverLogger) {
-            logger::serverLogger->error("Failed to send message to fd=" + std::to_string(clientFd));
+            logger::serverLogger->error("Failed to send message to fd=" + std::to_string(conn.fd));
         }
         return false;
     }
@@ -1,4 +1,5 @@
 #include "server/controller/user_controller.h"
+#include "server/reply_context.h"
 #include "server/repository/user_repository.h"
 #include "server/session.h"
 #include "server/connection_manager.h"
@@ -13,30 +14,29 @@ UserController::UserController(std::shared_ptr<UserRepository> userRepo,
                                std::shared_ptr<ConnectionManager> connMgr)
     : userRepo(userRepo), sessionMgr(sessionMgr), connMgr(connMgr) {}
 
-void UserController::sendMessage(int clientFd, const protocol::Message& msg) {
-    std::vector<uint8_t> data = msg.serialize();
-    ssize_t sent = send(clientFd, data.data(), data.size(), 0);
+void UserController::sendMessage(Connection& conn, const protocol::Message& msg) {
+    ssize_t sent = sendReply(conn, msg);
     if (logger::serverLogger) {
         if (sent < 0) {
-            logger::serverLogger->error("Failed to send message to fd=" + std::to_string(clientFd) + ", error=" + std::string(strerror(errno)));
+            logger::serverLogger->error("Failed to send message to fd=" + std::to_string(conn.fd) + ", error=" + std::string(strerror(errno)));
         } else {
-            logger::serverLogger->debug("Sent " + std::to_string(sent) + " bytes to fd=" + std::to_string(clientFd));
+            logger::serverLogger->debug("Sent " + std::to_string(sent) + " bytes to fd=" + std::to_string(conn.fd));
         }
     }
 }
 
-void UserController::handleUserLoginRequest(int clientFd, const protocol::Message& msg, ClientHandler* clientHandler) {
-    if (logger::serverLogger) logger::serverLogger->debug("Handling login request for fd=" + std::to_string(clientFd));
+void UserController::handleUserLoginRequest(Connection& conn, const protocol::Message& msg) {
+    if (logger::serverLogger) logger::serverLogger->debug("Handling login request for fd=" + std::to_string(conn.fd));
     
     std::string payload = msg.toString();
     std::string username, password;
     
     if (!utils::parseLoginCredentials(payload, username, password)) {
         if (logger::serverLogger) {
-            logger::serverLogger->error("Invalid login credentials format from fd=" + std::to_string(clientFd));
+            logger::serverLogger->error("Invalid login credentials format from fd=" + std::to_string(conn.fd));
         }
         protocol::Message response(protocol::MsgCode::LOGIN_FAILURE, "Invalid credentials format");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
@@ -53,74 +53,91 @@ void UserController::handleUserLoginRequest(int clientFd, const protocol::Messag
         User user = userRepo->findById(userId);
         std::string role = user.getRole();
         
+        // A re-login replaces the previous session and identity
+        if (!conn.sessionToken.empty()) {
+            sessionMgr->remove_session(conn.sessionToken);
+        }
+        connMgr->remove_client(conn);
+
         // Create session with role
-        std::string sessionId = sessionMgr->create_session(userId, clientFd, role);
+        std::string sessionId = sessionMgr->create_session(userId, conn.fd, role);
         
-        // Register client with ConnectionManager
-        connMgr->add_client(userId, clientHandler);
+        // Bind the identity to the connection (requests are authenticated
+        // against it) and register it with ConnectionManager
+        conn.userId = userId;
+        conn.role = role;
+        conn.roleBits = roles::fromName(role);
+        conn.sessionToken = sessionId;
+        conn.sessionTouchedAt = std::chrono::steady_clock::now();
+        connMgr->add_client(conn);
+        connMgr->subscribe(conn, topics::role(role));
+        if (!user.getLevel().empty()) {
+            connMgr->subscribe(conn, topics::level(user.getLevel()));
+        }
 
         protocol::Message response(protocol::MsgCode::LOGIN_SUCCESS, "session_id=" + sessionId + ";role=" + role);
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         
         if (logger::serverLogger) {
             logger::serverLogger->info("User " + username + " logged in successfully (fd=" + 
-                                      std::to_string(clientFd) + ")");
+                                      std::to_string(conn.fd) + ")");
         }
     } else {
         if (logger::serverLogger) {
             logger::serverLogger->warn("Failed login attempt for user " + username + 
-                                      " (fd=" + std::to_string(clientFd) + ")");
+                                      " (fd=" + std::to_string(conn.fd) + ")");
         }
         protocol::Message response(protocol::MsgCode::LOGIN_FAILURE, "Invalid credentials");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
     }
 }
 
-void UserController::handleUserLogoutRequest(int clientFd, const protocol::Message& msg) {
+void UserController::handleUserLogoutRequest(Connection& conn, const protocol::Message& msg) {
     std::string sessionId = msg.toString();
     
     if (sessionId.empty()) {
         if (logger::serverLogger) {
             logger::serverLogger->error("No session token in logout request from fd=" + 
-                                       std::to_string(clientFd));
+                                       std::to_string(conn.fd));
         }
         protocol::Message response(protocol::MsgCode::GENERAL_FAILURE, "No session token");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
     // Validate session
-    if (!sessionMgr->is_session_valid(sessionId)) {
+    if (sessionMgr->authenticate(conn, sessionId) == -1) {
         if (logger::serverLogger) {
             logger::serverLogger->error("Invalid session token in logout request from fd=" + 
-                                       std::to_string(clientFd));
+                                       std::to_string(conn.fd));
         }
         protocol::Message response(protocol::MsgCode::GENERAL_FAILURE, "Invalid session");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
     // Unregister client
-    int userId = sessionMgr->get_user_id_by_session(sessionId);
-    if (userId != -1) {
-        connMgr->remove_client(userId);
-    }
+    connMgr->remove_client(conn);
+    conn.userId = -1;
+    conn.role.clear();
+    conn.roleBits = roles::NONE;
+    conn.sessionToken.clear();
 
     // Remove session
     sessionMgr->remove_session(sessionId);
     
     // Send success response
     protocol::Message response(protocol::MsgCode::LOGOUT_SUCCESS, "Logout successful");
-    sendMessage(clientFd, response);
+    sendMessage(conn, response);
     
     if (logger::serverLogger) {
         logger::serverLogger->info("User logged out successfully (fd=" + 
-                                  std::to_string(clientFd) + ")");
+                                  std::to_string(conn.fd) + ")");
     }
 }
 
-void UserController::handleUserRegisterRequest(int clientFd, const protocol::Message& msg) {
-    if (logger::serverLogger) logger::serverLogger->debug("Handling register request for fd=" + std::to_string(clientFd));
+void UserController::handleUserRegisterRequest(Connection& conn, const protocol::Message& msg) {
+    if (logger::serverLogger) logger::serverLogger->debug("Handling register request for fd=" + std::to_string(conn.fd));
     
     std::string payload = msg.toString();
     std::string username, password;
@@ -128,36 +145,36 @@ void UserController::handleUserRegisterRequest(int clientFd, const protocol::Mes
     // Parse registration data (same format as login: username;password)
     if (!utils::parseLoginCredentials(payload, username, password)) {
         if (logger::serverLogger) {
-            logger::serverLogger->error("Invalid registration format from fd=" + std::to_string(clientFd));
+            logger::serverLogger->error("Invalid registration format from fd=" + std::to_string(conn.fd));
         }
         protocol::Message response(protocol::MsgCode::REGISTER_FAILURE, "Invalid registration format");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
     // Validate username and password
     if (username.length() < 3 || password.length() < 4) {
         protocol::Message response(protocol::MsgCode::REGISTER_FAILURE, "Username must be at least 3 characters and password at least 4 characters");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         return;
     }
 
     // Create user
     if (userRepo->createUser(username, password, "student")) {
         protocol::Message response(protocol::MsgCode::REGISTER_SUCCESS, "Registration successful");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         
         if (logger::serverLogger) {
             logger::serverLogger->info("User " + username + " registered successfully (fd=" + 
-                                      std::to_string(clientFd) + ")");
+                                      std::to_string(conn.fd) + ")");
         }
     } else {
         protocol::Message response(protocol::MsgCode::REGISTER_FAILURE, "Username already exists or registration failed");
-        sendMessage(clientFd, response);
+        sendMessage(conn, response);
         
         if (logger::serverLogger) {
             logger::serverLogger->warn("Failed registration attempt for user " + username + 
-                                      " (fd=" + std::to_string(clientFd) + ")");
+                                      " (fd=" + std::to_string(conn.fd) + ")");
         }
     }
 }
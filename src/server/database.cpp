@@ -39,6 +39,12 @@ bool Database::connect() {
 }
 
 void Database::disconnect() {
+    {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        for (PGconn* streamConn : idleStreamConnections) PQfinish(streamConn);
+        idleStreamConnections.clear();
+    }
+
     std::lock_guard<std::mutex> lock(dbMutex);
     if (conn) {
         PQfinish(conn);
@@ -104,6 +110,94 @@ PGresult* Database::execParams(const std::string& sql, int nParams, const char*
     return res;
 }
 
+PGconn* Database::acquireStreamConnection() {
+    {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        while (!idleStreamConnections.empty()) {
+            PGconn* streamConn = idleStreamConnections.back();
+            idleStreamConnections.pop_back();
+            if (PQstatus(streamConn) == CONNECTION_OK) return streamConn;
+            PQfinish(streamConn);
+        }
+    }
+
+    PGconn* streamConn = PQconnectdb(connInfo.c_str());
+    if (PQstatus(streamConn) != CONNECTION_OK) {
+        if (logger::serverLogger) {
+            logger::serverLogger->error("Streaming connection to database failed: " + std::string(PQerrorMessage(streamConn)));
+        }
+        PQfinish(streamConn);
+        return nullptr;
+    }
+    return streamConn;
+}
+
+void Database::releaseStreamConnection(PGconn* streamConn) {
+    {
+        std::lock_guard<std::mutex> lock(streamMutex);
+        if (PQstatus(streamConn) == CONNECTION_OK && PQtransactionStatus(streamConn) == PQTRANS_IDLE &&
+            idleStreamConnections.size() < MAX_IDLE_STREAM_CONNECTIONS) {
+            idleStreamConnections.push_back(streamConn);
+            return;
+        }
+    }
+    PQfinish(streamConn);
+}
+
+bool Database::forEachRow(const std::string& sql, int nParams, const char* const* paramValues,
+                          const std::function<bool(PGresult* row)>& onRow) {
+    PGconn* streamConn = acquireStreamConnection();
+    if (!streamConn) return false;
+
+    if (!PQsendQueryParams(streamConn, sql.c_str(), nParams, nullptr, paramValues, nullptr, nullptr, 0) ||
+        !PQsetSingleRowMode(streamConn)) {
+        if (logger::serverLogger) {
+            logger::serverLogger->error("Streaming query failed to start: " + std::string(PQerrorMessage(streamConn)));
+        }
+        // Drain anything that was sent so the connection is usable again
+        while (PGresult* res = PQgetResult(streamConn)) PQclear(res);
+        releaseStreamConnection(streamConn);
+        return false;
+    }
+
+    bool ok = true;
+    bool wanted = true;
+    // Every result must be read before the connection takes another query,
+    // including the rows left over when the caller stops early; cancelling
+    // keeps the server from producing the rest of them
+    while (PGresult* res = PQgetResult(streamConn)) {
+        ExecStatusType status = PQresultStatus(res);
+        if (status == PGRES_SINGLE_TUPLE && wanted) {
+            bool more;
+            try {
+                more = onRow(res);
+            } catch (...) {
+                // Rows are still pending on it; not worth draining for reuse
+                PQclear(res);
+                PQfinish(streamConn);
+                throw;
+            }
+            if (!more) {
+                wanted = false;
+                if (PGcancel* cancel = PQgetCancel(streamConn)) {
+                    char errbuf[256];
+                    PQcancel(cancel, errbuf, sizeof(errbuf));
+                    PQfreeCancel(cancel);
+                }
+            }
+        } else if (status != PGRES_SINGLE_TUPLE && status != PGRES_TUPLES_OK && wanted) {
+            if (logger::serverLogger) {
+                logger::serverLogger->error("Streaming query failed: " + std::string(PQerrorMessage(streamConn)));
+            }
+            ok = false;
+        }
+        PQclear(res);
+    }
+
+    releaseStreamConnection(streamConn);
+    return ok;
+}
+
 void Database::printResult(PGresult* res) {
     if (!res) return;
     int nFields = PQnfields(res);
@@ -0,0 +1,340 @@
+#include "server/media_relay.h"
+#include "common/media_packet.h"
+#include "common/logger.h"
+#include <sys/random.h>
+#include <sys/socket.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <cerrno>
+#include <cstring>
+
+namespace server {
+
+namespace {
+
+const int POLL_INTERVAL_MS = 5;
+const size_t RECV_BATCH = 64;
+
+bool sameAddress(const sockaddr_in& a, const sockaddr_in& b) {
+    return a.sin_addr.s_addr == b.sin_addr.s_addr && a.sin_port == b.sin_port;
+}
+
+// Session ids and leg tokens authenticate datagrams, so they must not be
+// predictable from the ones other clients were handed: read them from the
+// kernel CSPRNG rather than a seeded generator
+template <typename T>
+bool secureRandom(T& value) {
+    uint8_t* out = reinterpret_cast<uint8_t*>(&value);
+    size_t filled = 0;
+    while (filled < sizeof(value)) {
+        ssize_t n = getrandom(out + filled, sizeof(value) - filled, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        filled += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+MediaRelay::MediaRelay(int port)
+    : port(port), sock(-1), running(false) {}
+
+MediaRelay::~MediaRelay() {
+    stop();
+}
+
+bool MediaRelay::start() {
+    sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) {
+        if (logger::serverLogger) logger::serverLogger->error("[MediaRelay] Failed to create UDP socket");
+        return false;
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+    if (bind(sock, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        if (logger::serverLogger) logger::serverLogger->error("[MediaRelay] Failed to bind UDP port " + std::to_string(port));
+        close(sock);
+        sock = -1;
+        return false;
+    }
+
+    int flags = fcntl(sock, F_GETFL, 0);
+    fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+
+    running = true;
+    worker = std::thread(&MediaRelay::run, this);
+
+    if (logger::serverLogger) logger::serverLogger->info("[MediaRelay] Listening on UDP port " + std::to_string(port));
+    return true;
+}
+
+void MediaRelay::stop() {
+    running = false;
+    if (worker.joinable()) {
+        worker.join();
+    }
+    if (sock >= 0) {
+        close(sock);
+        sock = -1;
+    }
+}
+
+MediaRelay::Allocation MediaRelay::allocate() {
+    Allocation alloc;
+    if (!running) return alloc;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    uint32_t sessionId = 0;
+    uint64_t tokens[2] = {0, 0};
+    do {
+        if (!secureRandom(sessionId) || !secureRandom(tokens)) {
+            if (logger::serverLogger) {
+                logger::serverLogger->error(std::string("[MediaRelay] getrandom failed: ") + std::strerror(errno));
+            }
+            return alloc;
+        }
+    } while (sessionId == 0 || sessions.count(sessionId) > 0 || tokens[0] == tokens[1]);
+
+    Session& session = sessions[sessionId];
+    session.legs[0].token = tokens[0];
+    session.legs[1].token = tokens[1];
+    session.lastActivity = std::chrono::steady_clock::now();
+
+    alloc.sessionId = sessionId;
+    alloc.callerToken = session.legs[0].token;
+    alloc.calleeToken = session.legs[1].token;
+    alloc.port = port;
+
+    if (logger::serverLogger) {
+        logger::serverLogger->info("[MediaRelay] Allocated session " + std::to_string(sessionId) +
+                                   " (" + std::to_string(sessions.size()) + " active)");
+    }
+    return alloc;
+}
+
+void MediaRelay::release(uint32_t sessionId) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = sessions.find(sessionId);
+    if (it == sessions.end()) return;
+
+    logSessionStats(sessionId, it->second, "released");
+    sessions.erase(it);
+}
+
+std::vector<uint32_t> MediaRelay::takeExpiredSessions() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<uint32_t> result;
+    result.swap(expired);
+    return result;
+}
+
+void MediaRelay::run() {
+    uint8_t buffer[media::MAX_DATAGRAM_SIZE + media::HEADER_SIZE];
+    auto lastIdleCheck = std::chrono::steady_clock::now();
+
+    while (running) {
+        pollfd pfd{sock, POLLIN, 0};
+        int ready = poll(&pfd, 1, POLL_INTERVAL_MS);
+        auto now = std::chrono::steady_clock::now();
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        if (ready > 0 && (pfd.revents & POLLIN)) {
+            // Drain a batch per wakeup; the lock is taken once for all of them
+            for (size_t i = 0; i < RECV_BATCH; ++i) {
+                sockaddr_in from{};
+                socklen_t fromLen = sizeof(from);
+                ssize_t n = recvfrom(sock, buffer, sizeof(buffer), 0, reinterpret_cast<sockaddr*>(&from), &fromLen);
+                if (n < 0) break;
+                handleDatagram(buffer, static_cast<size_t>(n), from, now);
+            }
+        }
+
+        flushJitterBuffers(now);
+
+        if (now - lastIdleCheck >= std::chrono::seconds(1)) {
+            expireIdleSessions(now);
+            lastIdleCheck = now;
+        }
+    }
+}
+
+void MediaRelay::handleDatagram(uint8_t* data, size_t len, const sockaddr_in& from,
+                                std::chrono::steady_clock::time_point now) {
+    media::PacketHeader header;
+    if (!media::readHeader(data, len, header)) return;
+
+    auto it = sessions.find(header.sessionId);
+    if (it == sessions.end()) return;
+
+    Session& session = it->second;
+    int legIndex = -1;
+    if (header.token == session.legs[0].token) legIndex = 0;
+    else if (header.token == session.legs[1].token) legIndex = 1;
+    if (legIndex < 0) return; // Unauthenticated
+
+    Leg& leg = session.legs[legIndex];
+    session.lastActivity = now;
+
+    // Latch (or re-latch after a NAT rebinding) the sender's address
+    if (!leg.hasAddress || !sameAddress(leg.address, from)) {
+        leg.address = from;
+        leg.hasAddress = true;
+    }
+
+    if (header.flags & media::FLAG_KEEPALIVE) return;
+
+    leg.stats.received++;
+
+    // Never hand a party's token to its peer
+    std::memset(data + 4, 0, 8);
+
+    JitterBuffer& jb = leg.jitter;
+    if (!jb.started) {
+        jb.started = true;
+        jb.expected = header.sequence;
+    }
+
+    int16_t delta = static_cast<int16_t>(header.sequence - jb.expected);
+    if (delta < 0) {
+        leg.stats.late++;
+        return;
+    }
+
+    if (delta == 0) {
+        // Fast path: in-order packets go straight out from the receive buffer
+        sendToPeer(session, legIndex, data, len);
+        jb.expected++;
+        drain(session, legIndex);
+        return;
+    }
+
+    if (static_cast<size_t>(delta) >= JITTER_SLOTS) {
+        // Jumped past the whole window: play out what we have and resync
+        while (jb.buffered > 0) skipToOldest(session, legIndex);
+        leg.stats.lost += static_cast<uint16_t>(header.sequence - jb.expected);
+        jb.expected = header.sequence + 1;
+        sendToPeer(session, legIndex, data, len);
+        return;
+    }
+
+    JitterBuffer::Slot& slot = jb.slots[header.sequence % JITTER_SLOTS];
+    if (slot.used) {
+        leg.stats.late++; // Duplicate
+        return;
+    }
+    slot.used = true;
+    slot.sequence = header.sequence;
+    slot.payload.assign(data, data + len);
+    slot.arrival = now;
+    jb.buffered++;
+
+    // Window nearly full: give up on the missing packet
+    if (jb.buffered >= JITTER_SLOTS - 1) {
+        skipToOldest(session, legIndex);
+    }
+}
+
+void MediaRelay::sendToPeer(Session& session, int fromLeg, const uint8_t* data, size_t len) {
+    Leg& from = session.legs[fromLeg];
+    const Leg& to = session.legs[1 - fromLeg];
+    if (!to.hasAddress) {
+        from.stats.noPeer++;
+        return;
+    }
+
+    ssize_t sent = sendto(sock, data, len, 0, reinterpret_cast<const sockaddr*>(&to.address), sizeof(to.address));
+    if (sent >= 0) {
+        from.stats.forwarded++;
+    }
+}
+
+void MediaRelay::drain(Session& session, int fromLeg) {
+    JitterBuffer& jb = session.legs[fromLeg].jitter;
+    while (jb.buffered > 0) {
+        JitterBuffer::Slot& slot = jb.slots[jb.expected % JITTER_SLOTS];
+        if (!slot.used || slot.sequence != jb.expected) break;
+
+        sendToPeer(session, fromLeg, slot.payload.data(), slot.payload.size());
+        slot.used = false;
+        jb.buffered--;
+        jb.expected++;
+    }
+}
+
+void MediaRelay::skipToOldest(Session& session, int fromLeg) {
+    Leg& leg = session.legs[fromLeg];
+    JitterBuffer& jb = leg.jitter;
+
+    uint16_t oldest = 0;
+    int16_t best = INT16_MAX;
+    for (const auto& slot : jb.slots) {
+        if (!slot.used) continue;
+        int16_t delta = static_cast<int16_t>(slot.sequence - jb.expected);
+        if (delta < best) {
+            best = delta;
+            oldest = slot.sequence;
+        }
+    }
+    if (best == INT16_MAX) return;
+
+    leg.stats.lost += static_cast<uint16_t>(oldest - jb.expected);
+    jb.expected = oldest;
+    drain(session, fromLeg);
+}
+
+void MediaRelay::flushJitterBuffers(std::chrono::steady_clock::time_point now) {
+    const auto hold = std::chrono::milliseconds(JITTER_HOLD_MS);
+    for (auto& entry : sessions) {
+        for (int legIndex = 0; legIndex < 2; ++legIndex) {
+            JitterBuffer& jb = entry.second.legs[legIndex].jitter;
+            while (jb.buffered > 0) {
+                // Oldest waiting packet decides whether the gap in front of it is declared lost
+                auto oldestArrival = now;
+                for (const auto& slot : jb.slots) {
+                    if (slot.used && slot.arrival < oldestArrival) oldestArrival = slot.arrival;
+                }
+                if (now - oldestArrival < hold) break;
+                skipToOldest(entry.second, legIndex);
+            }
+        }
+    }
+}
+
+void MediaRelay::expireIdleSessions(std::chrono::steady_clock::time_point now) {
+    const auto timeout = std::chrono::seconds(SESSION_IDLE_TIMEOUT_SECONDS);
+    for (auto it = sessions.begin(); it != sessions.end();) {
+        if (now - it->second.lastActivity > timeout) {
+            logSessionStats(it->first, it->second, "timed out");
+            expired.push_back(it->first);
+            it = sessions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void MediaRelay::logSessionStats(uint32_t sessionId, const Session& session, const char* reason) {
+    if (!logger::serverLogger) return;
+
+    std::string line = "[MediaRelay] Session " + std::to_string(sessionId) + " " + reason;
+    const char* names[2] = {"caller", "callee"};
+    for (int i = 0; i < 2; ++i) {
+        const LegStats& s = session.legs[i].stats;
+        line += std::string(" | ") + names[i] + ": rx=" + std::to_string(s.received) +
+                " fwd=" + std::to_string(s.forwarded) + " lost=" + std::to_string(s.lost) +
+                " late=" + std::to_string(s.late) + " noPeer=" + std::to_string(s.noPeer);
+    }
+    logger::serverLogger->info(line);
+}
+
+} // namespace server
@@ -2,5 +2,13 @@
 
 namespace server {
 
+Payloads::RecentChatDTO ChatMessage::toRecentChatDTO(int userId, const std::string& otherUsername) const {
+    Payloads::RecentChatDTO dto;
+    dto.userId = otherParticipant(userId);
+    dto.username = otherUsername;
+    dto.lastMessage = content;
+    dto.timestamp = timestamp;
+    return dto;
+}
 
 }
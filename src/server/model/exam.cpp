@@ -66,6 +66,16 @@ Payloads::ExamMetadataDTO Exam::toMetadataDTO() const {
     return dto;
 }
 
+Payloads::ExamMetadataDTO ExamMetadata::toDTO() const {
+    Payloads::ExamMetadataDTO dto;
+    dto.id = std::to_string(examId);
+    dto.lessonId = std::to_string(lessonId);
+    dto.title = title;
+    dto.type = type;
+    dto.level = level;
+    return dto;
+}
+
 // ============================================================================
 // ExamList Implementation
 // ============================================================================
@@ -81,6 +81,16 @@ Payloads::ExerciseMetadataDTO Exercise::toMetadataDTO() const {
     return dto;
 }
 
+Payloads::ExerciseMetadataDTO ExerciseMetadata::toDTO() const {
+    Payloads::ExerciseMetadataDTO dto;
+    dto.id = std::to_string(exerciseId);
+    dto.lessonId = std::to_string(lessonId);
+    dto.title = title;
+    dto.type = type;
+    dto.level = level;
+    return dto;
+}
+
 // ============================================================================
 // ExerciseList Implementation
 // ============================================================================
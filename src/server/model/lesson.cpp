@@ -82,6 +82,15 @@ Payloads::LessonMetadataDTO Lesson::toMetadataDTO() const {
     return dto;
 }
 
+Payloads::LessonMetadataDTO LessonMetadata::toDTO() const {
+    Payloads::LessonMetadataDTO dto;
+    dto.id = std::to_string(lessonId);
+    dto.title = title;
+    dto.topic = topic;
+    dto.level = level;
+    return dto;
+}
+
 // ============================================================================
 // LessonList Implementation
 // ============================================================================
@@ -0,0 +1,75 @@
+#include "server/outbox.h"
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace server {
+
+Outbox::~Outbox() {
+    Node* node = head.exchange(nullptr, std::memory_order_acquire);
+    while (node) {
+        Node* next = node->next;
+        delete node;
+        node = next;
+    }
+}
+
+bool Outbox::push(Frame frame) {
+    Node* node = new Node{std::move(frame), nullptr};
+    Node* expected = head.load(std::memory_order_relaxed);
+    // The release publishes the node to take(), which may free it at once,
+    // so only the local copy of the old head is read afterwards
+    do {
+        node->next = expected;
+    } while (!head.compare_exchange_weak(expected, node, std::memory_order_release, std::memory_order_relaxed));
+    return expected == nullptr;
+}
+
+std::vector<Outbox::Frame> Outbox::take() {
+    // Taking the whole stack at once leaves nothing for a concurrent push to
+    // race with, so nodes are never reused while a producer still reads them
+    Node* node = head.exchange(nullptr, std::memory_order_acquire);
+    std::vector<Frame> frames;
+    while (node) {
+        frames.push_back(std::move(node->frame));
+        Node* next = node->next;
+        delete node;
+        node = next;
+    }
+    std::reverse(frames.begin(), frames.end());
+    return frames;
+}
+
+Wakeup::Wakeup() : eventFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+    if (eventFd < 0) {
+        throw std::runtime_error(std::string("eventfd failed: ") + std::strerror(errno));
+    }
+}
+
+Wakeup::~Wakeup() {
+    ::close(eventFd);
+}
+
+void Wakeup::notify() {
+    if (signalled.exchange(true)) return; // Already pending; the loop has not cleared it yet
+    uint64_t one = 1;
+    // EAGAIN means the counter is saturated, so the loop is woken regardless
+    while (::write(eventFd, &one, sizeof(one)) < 0 && errno == EINTR) {
+    }
+}
+
+void Wakeup::clear() {
+    // Reset the flag before reading, so a notify() from here on writes again.
+    // One that lands before the read is consumed by it, but its frame was
+    // queued first and the loop drains every outbox after clearing.
+    signalled.store(false);
+    uint64_t count;
+    while (::read(eventFd, &count, sizeof(count)) < 0 && errno == EINTR) {
+    }
+}
+
+} // namespace server
@@ -0,0 +1,88 @@
+#include "server/reply_context.h"
+#include "common/logger.h"
+
+namespace server {
+
+namespace {
+
+thread_local Connection* currentConnection = nullptr;
+thread_local uint32_t currentId = 0;
+
+thread_local Connection* captureConnection = nullptr;
+thread_local std::vector<uint8_t>* captureFrames = nullptr;
+
+bool isRequester(const Connection& conn) {
+    return &conn == currentConnection;
+}
+
+bool isCaptured(const Connection& conn) {
+    return captureFrames && &conn == captureConnection;
+}
+
+} // namespace
+
+ReplyScope::ReplyScope(Connection& connection, uint32_t correlationId)
+    : previousConnection(currentConnection), previousId(currentId) {
+    currentConnection = &connection;
+    currentId = correlationId;
+}
+
+ReplyScope::~ReplyScope() {
+    currentConnection = previousConnection;
+    currentId = previousId;
+}
+
+ReplyCapture::ReplyCapture(Connection& conn, std::vector<uint8_t>& frames)
+    : previousConnection(captureConnection), previousFrames(captureFrames) {
+    captureConnection = &conn;
+    captureFrames = &frames;
+}
+
+ReplyCapture::~ReplyCapture() {
+    captureConnection = previousConnection;
+    captureFrames = previousFrames;
+}
+
+std::vector<uint8_t> frameReply(Connection& conn, const protocol::Message& msg) {
+    if (!isRequester(conn)) {
+        return msg.serialize();
+    }
+
+    // Captured frames are compressed together with the batch they end up in
+    uint32_t id = msg.correlationId != 0 ? msg.correlationId : currentId;
+    bool compress = msg.compress || (conn.capabilities.compression && !isCaptured(conn));
+    return msg.serialize(id, compress);
+}
+
+bool replyAcceptsChunks(Connection& conn) {
+    return isRequester(conn) && conn.capabilities.chunkedResponses && !isCaptured(conn);
+}
+
+ssize_t sendReply(Connection& conn, const protocol::Message& msg) {
+    if (!isRequester(conn)) {
+        // Not on conn's strand, so its capabilities may be changing under us
+        if (logger::serverLogger) {
+            logger::serverLogger->error("Reply to fd=" + std::to_string(conn.fd) + " outside its request; dropped");
+        }
+        return -1;
+    }
+
+    std::vector<uint8_t> data = frameReply(conn, msg);
+
+    if (isCaptured(conn)) {
+        captureFrames->insert(captureFrames->end(), data.begin(), data.end());
+        return static_cast<ssize_t>(data.size());
+    }
+
+    if (data.size() > conn.capabilities.maxFrameSize) {
+        if (logger::serverLogger) {
+            logger::serverLogger->warn("Reply of " + std::to_string(data.size()) + " bytes exceeds the frame limit of fd=" +
+                                       std::to_string(conn.fd));
+        }
+        protocol::Message failure(protocol::MsgCode::GENERAL_FAILURE, "Response exceeds the client's frame limit");
+        data = frameReply(conn, failure);
+    }
+    return conn.write(std::move(data));
+}
+
+} // namespace server
@@ -0,0 +1,57 @@
+#include "server/repository/call_log_repository.h"
+#include "common/logger.h"
+#include <string>
+
+namespace server {
+
+CallLogRepository::CallLogRepository(std::shared_ptr<Database> db) : db(db) {}
+
+bool CallLogRepository::saveCallLogs(const std::vector<CallLog>& logs) {
+    if (logs.empty()) return true;
+
+    // Multi-row VALUES list: one round trip per batch
+    std::string sql = "INSERT INTO call_logs (caller_id, receiver_id, start_time, end_time, status, duration) VALUES ";
+    std::vector<std::string> params;
+    params.reserve(logs.size() * 6);
+
+    for (size_t i = 0; i < logs.size(); ++i) {
+        const CallLog& log = logs[i];
+        size_t base = i * 6;
+        if (i > 0) sql += ", ";
+        sql += "($" + std::to_string(base + 1) + ", $" + std::to_string(base + 2) +
+               ", to_timestamp($" + std::to_string(base + 3) + "), to_timestamp($" + std::to_string(base + 4) +
+               "), $" + std::to_string(base + 5) + ", $" + std::to_string(base + 6) + ")";
+
+        params.push_back(std::to_string(log.getCallerId()));
+        params.push_back(std::to_string(log.getReceiverId()));
+        params.push_back(std::to_string(static_cast<long long>(log.getStartTime())));
+        params.push_back(std::to_string(static_cast<long long>(log.getEndTime())));
+        params.push_back(log.getStatus());
+        params.push_back(std::to_string(log.getDuration()));
+    }
+
+    std::vector<const char*> paramValues;
+    for (const auto& p : params) {
+        paramValues.push_back(p.c_str());
+    }
+
+    try {
+        PGresult* res = db->execParams(sql, params.size(), paramValues.data());
+        if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+            if (logger::serverLogger) {
+                logger::serverLogger->error("Failed to save call logs: " + std::string(PQerrorMessage(db->getConnection())));
+            }
+            PQclear(res);
+            return false;
+        }
+        PQclear(res);
+        return true;
+    } catch (const std::exception& e) {
+        if (logger::serverLogger) {
+            logger::serverLogger->error("Exception in saveCallLogs: " + std::string(e.what()));
+        }
+        return false;
+    }
+}
+
+} // namespace server
@@ -97,6 +97,56 @@ std::vector<ChatMessage> ChatRepository::getChatHistory(int userId1, int userId2
     return messages;
 }
 
+std::vector<ChatMessage> ChatRepository::getUndeliveredMessages(int receiverId, int limit) {
+    std::vector<ChatMessage> messages;
+
+    // Served by the partial index idx_chat_messages_undelivered
+    std::string sql = "SELECT id, sender_id, receiver_id, content, message_type, created_at, is_read "
+                      "FROM chat_messages "
+                      "WHERE receiver_id = $1 AND is_delivered = FALSE "
+                      "ORDER BY created_at ASC "
+                      "LIMIT $2";
+
+    std::vector<std::string> params = {
+        std::to_string(receiverId),
+        std::to_string(limit)
+    };
+
+    std::vector<const char*> paramValues;
+    for (const auto& p : params) {
+        paramValues.push_back(p.c_str());
+    }
+
+    try {
+        PGresult* res = db->execParams(sql, params.size(), paramValues.data());
+
+        if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+            logger::serverLogger->error("Failed to get undelivered messages: " + std::string(PQerrorMessage(db->getConnection())));
+            PQclear(res);
+            return messages;
+        }
+
+        int rows = PQntuples(res);
+        for (int i = 0; i < rows; ++i) {
+            int id = std::stoi(PQgetvalue(res, i, 0));
+            int senderId = std::stoi(PQgetvalue(res, i, 1));
+            int receiver = std::stoi(PQgetvalue(res, i, 2));
+            std::string content = PQgetvalue(res, i, 3);
+            std::string messageType = PQgetvalue(res, i, 4);
+            std::string timestamp = PQgetvalue(res, i, 5);
+            bool isRead = std::string(PQgetvalue(res, i, 6)) == "t";
+
+            messages.emplace_back(id, senderId, receiver, content, messageType, timestamp, isRead);
+        }
+
+        PQclear(res);
+    } catch (const std::exception& e) {
+        logger::serverLogger->error("Exception in getUndeliveredMessages: " + std::string(e.what()));
+    }
+
+    return messages;
+}
+
 std::vector<ChatMessage> ChatRepository::getRecentChats(int userId) {
     std::vector<ChatMessage> messages;
 
@@ -160,7 +210,7 @@ std::vector<ChatMessage> ChatRepository::getRecentChats(int userId) {
 }
 
 void ChatRepository::markMessagesAsRead(int senderId, int receiverId) {
-    std::string sql = "UPDATE chat_messages SET is_read = TRUE "
+    std::string sql = "UPDATE chat_messages SET is_read = TRUE, is_delivered = TRUE "
                       "WHERE sender_id = $1 AND receiver_id = $2 AND is_read = FALSE";
     
     std::vector<std::string> params = {
@@ -181,4 +231,73 @@ void ChatRepository::markMessagesAsRead(int senderId, int receiverId) {
     }
 }
 
+void ChatRepository::markMessagesAsRead(const std::vector<std::pair<int, int>>& conversations) {
+    if (conversations.empty()) return;
+
+    // Pass both columns as arrays and join against them, so any number of
+    // conversations costs a single round trip
+    std::string senders = "{";
+    std::string receivers = "{";
+    for (size_t i = 0; i < conversations.size(); ++i) {
+        if (i > 0) {
+            senders += ",";
+            receivers += ",";
+        }
+        senders += std::to_string(conversations[i].first);
+        receivers += std::to_string(conversations[i].second);
+    }
+    senders += "}";
+    receivers += "}";
+
+    std::string sql = "UPDATE chat_messages cm SET is_read = TRUE, is_delivered = TRUE "
+                      "FROM unnest($1::int[], $2::int[]) AS conv(sender_id, receiver_id) "
+                      "WHERE cm.sender_id = conv.sender_id AND cm.receiver_id = conv.receiver_id AND cm.is_read = FALSE";
+
+    const char* paramValues[] = { senders.c_str(), receivers.c_str() };
+
+    try {
+        PGresult* res = db->execParams(sql, 2, paramValues);
+        if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+            logger::serverLogger->error("Failed to mark messages as read: " + std::string(PQerrorMessage(db->getConnection())));
+        }
+        PQclear(res);
+    } catch (const std::exception& e) {
+        logger::serverLogger->error("Exception in markMessagesAsRead: " + std::string(e.what()));
+    }
+}
+
+void ChatRepository::markMessagesAsDelivered(const std::vector<std::pair<int, int>>& deliveries) {
+    if (deliveries.empty()) return;
+
+    // Same shape as the bulk read update; matching the receiver as well keeps
+    // a client from acknowledging ids that were never addressed to it
+    std::string receivers = "{";
+    std::string ids = "{";
+    for (size_t i = 0; i < deliveries.size(); ++i) {
+        if (i > 0) {
+            receivers += ",";
+            ids += ",";
+        }
+        receivers += std::to_string(deliveries[i].first);
+        ids += std::to_string(deliveries[i].second);
+    }
+    receivers += "}";
+    ids += "}";
+
+    std::string sql = "UPDATE chat_messages cm SET is_delivered = TRUE "
+                      "FROM unnest($1::int[], $2::int[]) AS ack(receiver_id, id) "
+                      "WHERE cm.id = ack.id AND cm.receiver_id = ack.receiver_id AND cm.is_delivered = FALSE";
+    const char* paramValues[] = { receivers.c_str(), ids.c_str() };
+
+    try {
+        PGresult* res = db->execParams(sql, 2, paramValues);
+        if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+            logger::serverLogger->error("Failed to mark messages as delivered: " + std::string(PQerrorMessage(db->getConnection())));
+        }
+        PQclear(res);
+    } catch (const std::exception& e) {
+        logger::serverLogger->error("Exception in markMessagesAsDelivered: " + std::string(e.what()));
+    }
+}
+
 } // namespace server
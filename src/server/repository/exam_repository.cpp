@@ -1,4 +1,5 @@
 #include "server/repository/exam_repository.h"
+#include "server/repository/query_filter.h"
 #include "common/logger.h"
 #include <sstream>
 #include <algorithm>
@@ -10,7 +11,7 @@ namespace server {
 // ExamLoader Implementation
 // ============================================================================
 
-ExamRepository::ExamRepository(std::shared_ptr<Database> database) : db(database) {
+ExamRepository::ExamRepository(std::shared_ptr<Database> database) : db(database), byIdLoads("exam") {
 }
 
 std::vector<Question> ExamRepository::parseQuestions(const std::string& jsonStr) const {
@@ -78,86 +79,11 @@ bool ExamRepository::parseExamFromRow(PGresult* result, int row, Exam& exam) con
     }
 }
 
-ExamList ExamRepository::loadAllExams() {
-    ExamList examList;
-    
-    if (!db) {
-        if (logger::serverLogger) {
-            logger::serverLogger->error("[ERROR] Database connection is null in loadAllExams");
-        }
-        return examList;
-    }
-    
-    if (!db->isConnected()) {
-        if (logger::serverLogger) {
-            logger::serverLogger->error("[ERROR] Database not connected in loadAllExams");
-        }
-        return examList;
-    }
-    
-    std::string query = "SELECT * FROM exams ORDER BY lesson_id, type, level, title";
-    
-    if (logger::serverLogger) {
-        logger::serverLogger->debug("[DEBUG] Executing query in loadAllExams: " + query);
-    }
-    
-    try {
-        auto startTime = std::chrono::steady_clock::now();
-        PGresult* result = db->query(query);
-        auto endTime = std::chrono::steady_clock::now();
-        
-        if (logger::serverLogger) {
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
-            logger::serverLogger->debug("[DEBUG] Query executed in " + std::to_string(duration) + "ms");
-        }
-        
-        if (!result) {
-            if (logger::serverLogger) {
-                logger::serverLogger->error("[ERROR] Query returned null result in loadAllExams");
-            }
-            return examList;
-        }
-        
-        int rowCount = PQntuples(result);
-        
-        if (logger::serverLogger) {
-            logger::serverLogger->debug("[DEBUG] Found " + std::to_string(rowCount) + " exams in database");
-        }
-        
-        int successCount = 0;
-        for (int i = 0; i < rowCount; i++) {
-            try {
-                Exam exam;
-                if (parseExamFromRow(result, i, exam)) {
-                    examList.addExam(exam);
-                    successCount++;
-                }
-            } catch (const std::exception& e) {
-                if (logger::serverLogger) {
-                    logger::serverLogger->error("[ERROR] Error parsing exam at row " + std::to_string(i) +
-                                              ": " + e.what());
-                }
-            }
-        }
-        
-        if (logger::serverLogger) {
-            logger::serverLogger->info("[INFO] Successfully loaded " + std::to_string(successCount) +
-                                     " out of " + std::to_string(rowCount) + " exams");
-        }
-        
-        PQclear(result);
-        
-    } catch (const std::exception& e) {
-        if (logger::serverLogger) {
-            logger::serverLogger->error("[ERROR] Exception in loadAllExams: " + std::string(e.what()));
-        }
-        throw;
-    }
-    
-    return examList;
+Exam ExamRepository::loadExamById(int examId) {
+    return byIdLoads.run(examId, [&] { return fetchExamById(examId); });
 }
 
-Exam ExamRepository::loadExamById(int examId) {
+Exam ExamRepository::fetchExamById(int examId) {
     Exam exam;
     
     if (!db) {
@@ -240,111 +166,49 @@ Exam ExamRepository::loadExamById(int examId) {
     return exam;
 }
 
-ExamList ExamRepository::loadExamsByFilter(int lessonId, const std::string& type, const std::string& level) {
-    ExamList examList;
-    
-    if (logger::serverLogger) {
-        logger::serverLogger->debug("[DEBUG] loadExamsByFilter called with type='" + type +
-                                    "', level='" + level + "', lessonId='" + std::to_string(lessonId) + "'");
-    }
-    
-    if (!db) {
-        if (logger::serverLogger) {
-            logger::serverLogger->error("[ERROR] Database connection is null in loadExamsByFilter");
-        }
-        return examList;
-    }
-    
-    if (!db->isConnected()) {
+std::vector<ExamMetadata> ExamRepository::loadExamMetadata(int lessonId, const std::string& type, const std::string& level) {
+    std::vector<ExamMetadata> exams;
+
+    if (!db || !db->isConnected()) {
         if (logger::serverLogger) {
-            logger::serverLogger->error("[ERROR] Database not connected in loadExamsByFilter");
+            logger::serverLogger->error("[ERROR] Database not connected in loadExamMetadata");
         }
-        return examList;
+        return exams;
     }
-    
-    // If no filters, delegate to loadAllExams
-    if (type.empty() && level.empty() && lessonId == -1) {
+
+    // Only the listed columns: the question JSONB arrays never leave the database
+    std::string query = "SELECT exam_id, lesson_id, title, type, level FROM exams";
+    QueryFilter filter;
+    filter.equals("lesson_id", lessonId).equals("type", type).equals("level", level);
+    PGresult* result = filter.exec(*db, query, " ORDER BY lesson_id, type, level, title");
+    if (!result || PQresultStatus(result) != PGRES_TUPLES_OK) {
         if (logger::serverLogger) {
-            logger::serverLogger->debug("[DEBUG] No filters provided, delegating to loadAllExams");
+            logger::serverLogger->error("[ERROR] Query failed in loadExamMetadata: " +
+                                        std::string(PQerrorMessage(db->getConnection())));
         }
-        return loadAllExams();
-    }
-    
-    std::string query = "SELECT * FROM exams";
-    std::vector<std::string> conditions;
-    
-    if (!type.empty()) {
-        conditions.push_back("type = '" + type + "'");
-    }
-    
-    if (!level.empty()) {
-        conditions.push_back("level = '" + level + "'");
+        if (result) PQclear(result);
+        return exams;
     }
 
-    if (lessonId != -1) {
-        conditions.push_back("lesson_id = " + std::to_string(lessonId));
-    }
-    
-    if (!conditions.empty()) {
-        query += " WHERE " + conditions[0];
-        for (size_t i = 1; i < conditions.size(); ++i) {
-            query += " AND " + conditions[i];
-        }
-    }
-    
-    query += " ORDER BY lesson_id, type, level, title";
-    
+    int rowCount = PQntuples(result);
+    exams.reserve(rowCount);
+    for (int i = 0; i < rowCount; ++i) {
+        ExamMetadata exam;
+        std::string examIdStr = PQgetvalue(result, i, 0);
+        exam.examId = examIdStr.empty() ? 0 : std::stoi(examIdStr);
+        std::string lessonIdStr = PQgetvalue(result, i, 1);
+        exam.lessonId = lessonIdStr.empty() ? 0 : std::stoi(lessonIdStr);
+        exam.title = PQgetvalue(result, i, 2);
+        exam.type = PQgetvalue(result, i, 3);
+        exam.level = PQgetvalue(result, i, 4);
+        exams.push_back(std::move(exam));
+    }
+    PQclear(result);
+
     if (logger::serverLogger) {
-        logger::serverLogger->debug("[DEBUG] Executing query in loadExamsByFilter: " + query);
-    }
-    
-    try {
-        auto startTime = std::chrono::steady_clock::now();
-        PGresult* result = db->query(query);
-        auto endTime = std::chrono::steady_clock::now();
-        
-        if (logger::serverLogger) {
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
-            logger::serverLogger->debug("[DEBUG] Query executed in " + std::to_string(duration) + "ms");
-        }
-        
-        if (!result) {
-            if (logger::serverLogger) {
-                logger::serverLogger->error("[ERROR] Query returned null result in loadExamsByFilter");
-            }
-            return examList;
-        }
-        
-        int rowCount = PQntuples(result);
-        
-        if (logger::serverLogger) {
-            logger::serverLogger->debug("[DEBUG] Found " + std::to_string(rowCount) + " exams in database");
-        }
-        
-        for (int i = 0; i < rowCount; ++i) {
-            try {
-                Exam exam;
-                if (parseExamFromRow(result, i, exam)) {
-                    examList.addExam(exam);
-                }
-            } catch (const std::exception& e) {
-                if (logger::serverLogger) {
-                    logger::serverLogger->error("[ERROR] Error parsing exam at row " + std::to_string(i) +
-                                                ": " + e.what());
-                }
-            }
-        }
-        
-        PQclear(result);
-        
-    } catch (const std::exception& e) {
-        if (logger::serverLogger) {
-            logger::serverLogger->error("[ERROR] Exception in loadExamsByFilter: " + std::string(e.what()));
-        }
-        throw;
+        logger::serverLogger->debug("[DEBUG] loadExamMetadata returned " + std::to_string(rowCount) + " exams");
     }
-    
-    return examList;
+    return exams;
 }
 
 } // namespace server
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "server/repository/exercise_repository.h"
+#include "server/repository/query_filter.h"
 #include "common/logger.h"
 #include <sstream>
 #include <algorithm>
@@ -10,7 +11,7 @@ namespace server {
 // ExerciseRepository Implementation
 // ============================================================================
 
-ExerciseRepository::ExerciseRepository(std::shared_ptr<Database> database) : db(database) {
+ExerciseRepository::ExerciseRepository(std::shared_ptr<Database> database) : db(database), byIdLoads("exercise") {
 }
 
 std::vector<Question> ExerciseRepository::parseQuestions(const std::string& jsonStr) const {
@@ -89,89 +90,11 @@ bool ExerciseRepository::parseExerciseFromRow(PGresult* result, int row, Exercis
     }
 }
 
-ExerciseList ExerciseRepository::loadAllExercises() {
-    ExerciseList exerciseList;
-    
-    if (!db) {
-        if (logger::serverLogger) {
-            logger::serverLogger->error("[ERROR] Database connection is null in loadAllExercises");
-        }
-        return exerciseList;
-    }
-    
-    if (!db->isConnected()) {
-        if (logger::serverLogger) {
-            logger::serverLogger->error("[ERROR] Database not connected in loadAllExercises");
-        }
-        return exerciseList;
-    }
-    
-    std::string query = "SELECT * FROM exercises ORDER BY lesson_id, type, level, title";
-    
-    if (logger::serverLogger) {
-        logger::serverLogger->debug("[DEBUG] Executing query in loadAllExercises: " + query);
-    }
-    
-    try {
-        auto startTime = std::chrono::steady_clock::now();
-        PGresult* result = db->query(query);
-        auto endTime = std::chrono::steady_clock::now();
-        
-        if (logger::serverLogger) {
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
-            logger::serverLogger->debug("[DEBUG] Query executed in " + std::to_string(duration) + "ms");
-        }
-        
-        if (!result) {
-            if (logger::serverLogger) {
-                logger::serverLogger->error("[ERROR] Query returned null result in loadAllExercises");
-            }
-            return exerciseList;
-        }
-        
-        int rowCount = PQntuples(result);
-        
-        if (logger::serverLogger) {
-            logger::serverLogger->debug("[DEBUG] Found " + std::to_string(rowCount) + " exercises in database");
-        }
-        
-        int successCount = 0;
-        for (int i = 0; i < rowCount; i++) {
-            try {
-                Exercise exercise;
-                if (parseExerciseFromRow(result, i, exercise)) {
-                    exerciseList.addExercise(exercise);
-                    successCount++;
-                    if (logger::serverLogger) {
-                        logger::serverLogger->debug("[DEBUG] Successfully loaded exercise: " + exercise.getTitle() + " (ID: " + std::to_string(exercise.getExerciseId()) + ")");
-                    }
-                }
-            } catch (const std::exception& e) {
-                if (logger::serverLogger) {
-                    logger::serverLogger->error("[ERROR] Error parsing exercise at row " + std::to_string(i) +
-                                              ": " + e.what());
-                }
-            }
-        }
-        
-        if (logger::serverLogger) {
-            logger::serverLogger->info("[INFO] Successfully loaded " + std::to_string(successCount) +
-                                     " out of " + std::to_string(rowCount) + " exercises");
-        }
-        
-        PQclear(result);
-        
-    } catch (const std::exception& e) {
-        if (logger::serverLogger) {
-            logger::serverLogger->error("[ERROR] Exception in loadAllExercises: " + std::string(e.what()));
-        }
-        throw;
-    }
-    
-    return exerciseList;
+Exercise ExerciseRepository::loadExerciseById(int exerciseId) {
+    return byIdLoads.run(exerciseId, [&] { return fetchExerciseById(exerciseId); });
 }
 
-Exercise ExerciseRepository::loadExerciseById(int exerciseId) {
+Exercise ExerciseRepository::fetchExerciseById(int exerciseId) {
     Exercise exercise;
     
     if (!db) {
@@ -254,111 +177,49 @@ Exercise ExerciseRepository::loadExerciseById(int exerciseId) {
     return exercise;
 }
 
-ExerciseList ExerciseRepository::loadExercisesByFilter(int lessonId, const std::string& type, const std::string& level) {
-    ExerciseList exerciseList;
-    
-    if (logger::serverLogger) {
-        logger::serverLogger->debug("[DEBUG] loadExercisesByFilter called with type='" + type +
-                                    "', level='" + level + "', lessonId='" + std::to_string(lessonId) + "'");
-    }
-    
-    if (!db) {
-        if (logger::serverLogger) {
-            logger::serverLogger->error("[ERROR] Database connection is null in loadExercisesByFilter");
-        }
-        return exerciseList;
-    }
-    
-    if (!db->isConnected()) {
+std::vector<ExerciseMetadata> ExerciseRepository::loadExerciseMetadata(int lessonId, const std::string& type, const std::string& level) {
+    std::vector<ExerciseMetadata> exercises;
+
+    if (!db || !db->isConnected()) {
         if (logger::serverLogger) {
-            logger::serverLogger->error("[ERROR] Database not connected in loadExercisesByFilter");
+            logger::serverLogger->error("[ERROR] Database not connected in loadExerciseMetadata");
         }
-        return exerciseList;
+        return exercises;
     }
-    
-    // If no filters, delegate to loadAllExercises
-    if (type.empty() && level.empty() && lessonId == -1) {
+
+    // Only the listed columns: the questions and options JSONB never leave the database
+    std::string query = "SELECT exercise_id, lesson_id, title, type, level FROM exercises";
+    QueryFilter filter;
+    filter.equals("lesson_id", lessonId).equals("type", type).equals("level", level);
+    PGresult* result = filter.exec(*db, query, " ORDER BY lesson_id, type, level, title");
+    if (!result || PQresultStatus(result) != PGRES_TUPLES_OK) {
         if (logger::serverLogger) {
-            logger::serverLogger->debug("[DEBUG] No filters provided, delegating to loadAllExercises");
+            logger::serverLogger->error("[ERROR] Query failed in loadExerciseMetadata: " +
+                                        std::string(PQerrorMessage(db->getConnection())));
         }
-        return loadAllExercises();
-    }
-    
-    std::string query = "SELECT * FROM exercises";
-    std::vector<std::string> conditions;
-    
-    if (!type.empty()) {
-        conditions.push_back("type = '" + type + "'");
-    }
-    
-    if (!level.empty()) {
-        conditions.push_back("level = '" + level + "'");
+        if (result) PQclear(result);
+        return exercises;
     }
 
-    if (lessonId != -1) {
-        conditions.push_back("lesson_id = " + std::to_string(lessonId));
-    }
-    
-    if (!conditions.empty()) {
-        query += " WHERE " + conditions[0];
-        for (size_t i = 1; i < conditions.size(); ++i) {
-            query += " AND " + conditions[i];
-        }
-    }
-    
-    query += " ORDER BY lesson_id, type, level, title";
-    
+    int rowCount = PQntuples(result);
+    exercises.reserve(rowCount);
+    for (int i = 0; i < rowCount; ++i) {
+        ExerciseMetadata exercise;
+        std::string exerciseIdStr = PQgetvalue(result, i, 0);
+        exercise.exerciseId = exerciseIdStr.empty() ? 0 : std::stoi(exerciseIdStr);
+        std::string lessonIdStr = PQgetvalue(result, i, 1);
+        exercise.lessonId = lessonIdStr.empty() ? 0 : std::stoi(lessonIdStr);
+        exercise.title = PQgetvalue(result, i, 2);
+        exercise.type = PQgetvalue(result, i, 3);
+        exercise.level = PQgetvalue(result, i, 4);
+        exercises.push_back(std::move(exercise));
+    }
+    PQclear(result);
+
     if (logger::serverLogger) {
-        logger::serverLogger->debug("[DEBUG] Executing query in loadExercisesByFilter: " + query);
-    }
-    
-    try {
-        auto startTime = std::chrono::steady_clock::now();
-        PGresult* result = db->query(query);
-        auto endTime = std::chrono::steady_clock::now();
-        
-        if (logger::serverLogger) {
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
-            logger::serverLogger->debug("[DEBUG] Query executed in " + std::to_string(duration) + "ms");
-        }
-        
-        if (!result) {
-            if (logger::serverLogger) {
-                logger::serverLogger->error("[ERROR] Query returned null result in loadExercisesByFilter");
-            }
-            return exerciseList;
-        }
-        
-        int rowCount = PQntuples(result);
-        
-        if (logger::serverLogger) {
-            logger::serverLogger->debug("[DEBUG] Found " + std::to_string(rowCount) + " exercises in database");
-        }
-        
-        for (int i = 0; i < rowCount; ++i) {
-            try {
-                Exercise exercise;
-                if (parseExerciseFromRow(result, i, exercise)) {
-                    exerciseList.addExercise(exercise);
-                }
-            } catch (const std::exception& e) {
-                if (logger::serverLogger) {
-                    logger::serverLogger->error("[ERROR] Error parsing exercise at row " + std::to_string(i) +
-                                                ": " + e.what());
-                }
-            }
-        }
-        
-        PQclear(result);
-        
-    } catch (const std::exception& e) {
-        if (logger::serverLogger) {
-            logger::serverLogger->error("[ERROR] Exception in loadExercisesByFilter: " + std::string(e.what()));
-        }
-        throw;
+        logger::serverLogger->debug("[DEBUG] loadExerciseMetadata returned " + std::to_string(rowCount) + " exercises");
     }
-    
-    return exerciseList;
+    return exercises;
 }
 
 } // namespace server
\ No newline at end of file
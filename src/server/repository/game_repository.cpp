@@ -4,7 +4,7 @@
 
 namespace server {
 
-GameRepository::GameRepository(std::shared_ptr<Database> database) : db(database) {
+GameRepository::GameRepository(std::shared_ptr<Database> database) : db(database), byIdLoads("game") {
 }
 
 bool GameRepository::parseGameFromRow(PGresult* result, int row, Game& game) const {
@@ -76,6 +76,10 @@ std::vector<Game> GameRepository::getLevelsByType(const std::string& type) {
 }
 
 Game GameRepository::getGameById(int id) {
+    return byIdLoads.run(id, [&] { return fetchGameById(id); });
+}
+
+Game GameRepository::fetchGameById(int id) {
     Game game;
     if (!db || !db->isConnected()) return game;
 
@@ -129,6 +133,7 @@ bool GameRepository::updateGame(const Game& game) {
     PGresult* res = db->execParams(sql, 4, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     PQclear(res);
+    byIdLoads.forget(game.getId()); // A load already running may have read the old row
     return success;
 }
 
@@ -141,6 +146,7 @@ bool GameRepository::deleteGame(int id) {
     PGresult* res = db->execParams(sql, 1, params);
     bool success = (PQresultStatus(res) == PGRES_COMMAND_OK);
     PQclear(res);
+    byIdLoads.forget(id);
     return success;
 }
 
@@ -1,4 +1,5 @@
 #include "server/repository/lesson_repository.h"
+#include "server/repository/query_filter.h"
 #include "common/logger.h"
 #include <sstream>
 #include <algorithm>
@@ -10,7 +11,7 @@ namespace server {
 // LessonRepository Implementation
 // ============================================================================
 
-LessonRepository::LessonRepository(std::shared_ptr<Database> database) : db(database) {
+LessonRepository::LessonRepository(std::shared_ptr<Database> database) : db(database), byIdLoads("lesson") {
 }
 
 std::vector<std::string> LessonRepository::parseJsonArray(const std::string& jsonStr) const {
@@ -65,86 +66,11 @@ bool LessonRepository::parseLessonFromRow(PGresult* result, int row, Lesson& les
     }
 }
 
-LessonList LessonRepository::loadAllLessons() {
-    LessonList lessonList;
-    
-    if (!db) {
-        if (logger::serverLogger) {
-            logger::serverLogger->error("[ERROR] Database connection is null in loadAllLessons");
-        }
-        return lessonList;
-    }
-    
-    if (!db->isConnected()) {
-        if (logger::serverLogger) {
-            logger::serverLogger->error("[ERROR] Database not connected in loadAllLessons");
-        }
-        return lessonList;
-    }
-    
-    std::string query = "SELECT * FROM lessons ORDER BY topic, level, title";
-    
-    if (logger::serverLogger) {
-        logger::serverLogger->debug("[DEBUG] Executing query in loadAllLessons: " + query);
-    }
-    
-    try {
-        auto startTime = std::chrono::steady_clock::now();
-        PGresult* result = db->query(query);  // Changed to raw pointer
-        auto endTime = std::chrono::steady_clock::now();
-        
-        if (logger::serverLogger) {
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
-            logger::serverLogger->debug("[DEBUG] Query executed in " + std::to_string(duration) + "ms");
-        }
-        
-        if (!result) {
-            if (logger::serverLogger) {
-                logger::serverLogger->error("[ERROR] Query returned null result in loadAllLessons");
-            }
-            return lessonList;
-        }
-        
-        int rowCount = PQntuples(result);  // Removed ->get()
-        
-        if (logger::serverLogger) {
-            logger::serverLogger->debug("[DEBUG] Found " + std::to_string(rowCount) + " lessons in database");
-        }
-        
-        int successCount = 0;
-        for (int i = 0; i < rowCount; i++) {
-            try {
-                Lesson lesson;
-                if (parseLessonFromRow(result, i, lesson)) {  // Removed ->get()
-                    lessonList.addLesson(lesson);
-                    successCount++;
-                }
-            } catch (const std::exception& e) {
-                if (logger::serverLogger) {
-                    logger::serverLogger->error("[ERROR] Error parsing lesson at row " + std::to_string(i) + 
-                                              ": " + e.what());
-                }
-            }
-        }
-        
-        if (logger::serverLogger) {
-            logger::serverLogger->info("[INFO] Successfully loaded " + std::to_string(successCount) + 
-                                     " out of " + std::to_string(rowCount) + " lessons");
-        }
-        
-        PQclear(result);  // Clean up result
-        
-    } catch (const std::exception& e) {
-        if (logger::serverLogger) {
-            logger::serverLogger->error("[ERROR] Exception in loadAllLessons: " + std::string(e.what()));
-        }
-        throw;
-    }
-    
-    return lessonList;
+Lesson LessonRepository::loadLessonById(int lessonId) {
+    return byIdLoads.run(lessonId, [&] { return fetchLessonById(lessonId); });
 }
 
-Lesson LessonRepository::loadLessonById(int lessonId) {
+Lesson LessonRepository::fetchLessonById(int lessonId) {
     Lesson lesson;
     
     if (!db) {
@@ -227,107 +153,47 @@ Lesson LessonRepository::loadLessonById(int lessonId) {
     return lesson;
 }
 
-LessonList LessonRepository::loadLessonsByFilter(const std::string& topic, const std::string& level) {
-    LessonList lessonList;
-    
-    if (logger::serverLogger) {
-        logger::serverLogger->debug("[DEBUG] loadLessonsByFilter called with topic='" + topic +
-                                    "', level='" + level + "'");
-    }
-    
-    if (!db) {
-        if (logger::serverLogger) {
-            logger::serverLogger->error("[ERROR] Database connection is null in loadLessonsByFilter");
-        }
-        return lessonList;
-    }
-    
-    if (!db->isConnected()) {
+std::vector<LessonMetadata> LessonRepository::loadLessonMetadata(const std::string& topic, const std::string& level) {
+    std::vector<LessonMetadata> lessons;
+
+    if (!db || !db->isConnected()) {
         if (logger::serverLogger) {
-            logger::serverLogger->error("[ERROR] Database not connected in loadLessonsByFilter");
+            logger::serverLogger->error("[ERROR] Database not connected in loadLessonMetadata");
         }
-        return lessonList;
+        return lessons;
     }
-    
-    // If no filters, delegate to loadAllLessons
-    if (topic.empty() && level.empty()) {
+
+    // Only the listed columns: the text, vocabulary and grammar never leave the database
+    std::string query = "SELECT lesson_id, title, topic, level FROM lessons";
+    QueryFilter filter;
+    filter.equals("topic", topic).equals("level", level);
+    PGresult* result = filter.exec(*db, query, " ORDER BY topic, level, title");
+    if (!result || PQresultStatus(result) != PGRES_TUPLES_OK) {
         if (logger::serverLogger) {
-            logger::serverLogger->debug("[DEBUG] No filters provided, delegating to loadAllLessons");
-        }
-        return loadAllLessons();
-    }
-    
-    std::string query = "SELECT * FROM lessons";
-    std::vector<std::string> conditions;
-    
-    if (!topic.empty()) {
-        conditions.push_back("topic = '" + topic + "'");
-    }
-    
-    if (!level.empty()) {
-        conditions.push_back("level = '" + level + "'");
-    }
-    
-    if (!conditions.empty()) {
-        query += " WHERE " + conditions[0];
-        for (size_t i = 1; i < conditions.size(); ++i) {
-            query += " AND " + conditions[i];
+            logger::serverLogger->error("[ERROR] Query failed in loadLessonMetadata: " +
+                                        std::string(PQerrorMessage(db->getConnection())));
         }
+        if (result) PQclear(result);
+        return lessons;
     }
-    
-    query += " ORDER BY topic, level, title";
-    
+
+    int rowCount = PQntuples(result);
+    lessons.reserve(rowCount);
+    for (int i = 0; i < rowCount; ++i) {
+        LessonMetadata lesson;
+        std::string lessonIdStr = PQgetvalue(result, i, 0);
+        lesson.lessonId = lessonIdStr.empty() ? 0 : std::stoi(lessonIdStr);
+        lesson.title = PQgetvalue(result, i, 1);
+        lesson.topic = PQgetvalue(result, i, 2);
+        lesson.level = PQgetvalue(result, i, 3);
+        lessons.push_back(std::move(lesson));
+    }
+    PQclear(result);
+
     if (logger::serverLogger) {
-        logger::serverLogger->debug("[DEBUG] Executing query in loadLessonsByFilter: " + query);
-    }
-    
-    try {
-        auto startTime = std::chrono::steady_clock::now();
-        PGresult* result = db->query(query);
-        auto endTime = std::chrono::steady_clock::now();
-        
-        if (logger::serverLogger) {
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
-            logger::serverLogger->debug("[DEBUG] Query executed in " + std::to_string(duration) + "ms");
-        }
-        
-        if (!result) {
-            if (logger::serverLogger) {
-                logger::serverLogger->error("[ERROR] Query returned null result in loadLessonsByFilter");
-            }
-            return lessonList;
-        }
-        
-        int rowCount = PQntuples(result);
-        
-        if (logger::serverLogger) {
-            logger::serverLogger->debug("[DEBUG] Found " + std::to_string(rowCount) + " lessons in database");
-        }
-        
-        for (int i = 0; i < rowCount; ++i) {
-            try {
-                Lesson lesson;
-                if (parseLessonFromRow(result, i, lesson)) {
-                    lessonList.addLesson(lesson);
-                }
-            } catch (const std::exception& e) {
-                if (logger::serverLogger) {
-                    logger::serverLogger->error("[ERROR] Error parsing lesson at row " + std::to_string(i) +
-                                                ": " + e.what());
-                }
-            }
-        }
-        
-        PQclear(result);
-        
-    } catch (const std::exception& e) {
-        if (logger::serverLogger) {
-            logger::serverLogger->error("[ERROR] Exception in loadLessonsByFilter: " + std::string(e.what()));
-        }
-        throw;
+        logger::serverLogger->debug("[DEBUG] loadLessonMetadata returned " + std::to_string(rowCount) + " lessons");
     }
-    
-    return lessonList;
+    return lessons;
 }
 
 }  // namespace server
\ No newline at end of file
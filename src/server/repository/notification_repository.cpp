@@ -0,0 +1,101 @@
+#include "server/repository/notification_repository.h"
+#include "common/logger.h"
+
+namespace server {
+
+NotificationRepository::NotificationRepository(std::shared_ptr<Database> db) : db(db) {}
+
+int NotificationRepository::save(int userId, const std::string& content) {
+    // Insert and trim to MAX_PER_USER in one round trip
+    std::string sql = "WITH added AS ("
+                      "  INSERT INTO offline_notifications (user_id, content) VALUES ($1, $2) RETURNING id"
+                      "), trimmed AS ("
+                      "  DELETE FROM offline_notifications WHERE user_id = $1 AND id IN ("
+                      "    SELECT id FROM offline_notifications WHERE user_id = $1 "
+                      "    ORDER BY id DESC OFFSET $3)"
+                      ") SELECT id FROM added";
+
+    std::string user = std::to_string(userId);
+    std::string keep = std::to_string(MAX_PER_USER - 1); // The snapshot does not include the new row
+    const char* paramValues[] = { user.c_str(), content.c_str(), keep.c_str() };
+
+    try {
+        PGresult* res = db->execParams(sql, 3, paramValues);
+        if (PQresultStatus(res) != PGRES_TUPLES_OK || PQntuples(res) != 1) {
+            logger::serverLogger->error("Failed to save notification: " + std::string(PQerrorMessage(db->getConnection())));
+            PQclear(res);
+            return -1;
+        }
+
+        int id = std::stoi(PQgetvalue(res, 0, 0));
+        PQclear(res);
+        return id;
+    } catch (const std::exception& e) {
+        logger::serverLogger->error("Exception in save notification: " + std::string(e.what()));
+        return -1;
+    }
+}
+
+std::vector<NotificationRepository::Notification> NotificationRepository::getPending(int userId) {
+    std::vector<Notification> notifications;
+
+    std::string sql = "SELECT id, content, to_char(created_at, 'YYYY-MM-DD HH24:MI:SS') "
+                      "FROM offline_notifications WHERE user_id = $1 ORDER BY id ASC";
+    std::string user = std::to_string(userId);
+    const char* paramValues[] = { user.c_str() };
+
+    try {
+        PGresult* res = db->execParams(sql, 1, paramValues);
+        if (PQresultStatus(res) != PGRES_TUPLES_OK) {
+            logger::serverLogger->error("Failed to get notifications: " + std::string(PQerrorMessage(db->getConnection())));
+            PQclear(res);
+            return notifications;
+        }
+
+        int rows = PQntuples(res);
+        notifications.reserve(rows);
+        for (int i = 0; i < rows; ++i) {
+            notifications.push_back({std::stoi(PQgetvalue(res, i, 0)), PQgetvalue(res, i, 1), PQgetvalue(res, i, 2)});
+        }
+        PQclear(res);
+    } catch (const std::exception& e) {
+        logger::serverLogger->error("Exception in getPending notifications: " + std::string(e.what()));
+    }
+
+    return notifications;
+}
+
+void NotificationRepository::remove(const std::vector<std::pair<int, int>>& notifications) {
+    if (notifications.empty()) return;
+
+    // Same shape as ChatRepository::markMessagesAsDelivered
+    std::string users = "{";
+    std::string ids = "{";
+    for (size_t i = 0; i < notifications.size(); ++i) {
+        if (i > 0) {
+            users += ",";
+            ids += ",";
+        }
+        users += std::to_string(notifications[i].first);
+        ids += std::to_string(notifications[i].second);
+    }
+    users += "}";
+    ids += "}";
+
+    std::string sql = "DELETE FROM offline_notifications n "
+                      "USING unnest($1::int[], $2::int[]) AS ack(user_id, id) "
+                      "WHERE n.id = ack.id AND n.user_id = ack.user_id";
+    const char* paramValues[] = { users.c_str(), ids.c_str() };
+
+    try {
+        PGresult* res = db->execParams(sql, 2, paramValues);
+        if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+            logger::serverLogger->error("Failed to remove notifications: " + std::string(PQerrorMessage(db->getConnection())));
+        }
+        PQclear(res);
+    } catch (const std::exception& e) {
+        logger::serverLogger->error("Exception in remove notifications: " + std::string(e.what()));
+    }
+}
+
+} // namespace server
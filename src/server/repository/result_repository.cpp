@@ -1,4 +1,5 @@
 #include "server/repository/result_repository.h"
+#include <cstdlib>
 #include "common/logger.h"
 #include "common/utils.h"
 #include <json/json.h>
@@ -29,12 +30,17 @@ bool ResultRepository::saveResult(int userId, const std::string& targetType, int
     PGresult* res = db->execParams(query, 7, params);
     bool success = (res && PQresultStatus(res) == PGRES_COMMAND_OK);
     if (res) PQclear(res);
+    if (success && targetType == "exam") {
+        examAttempts.record(targetId, userId);
+    }
     return success;
 }
 
-bool ResultRepository::updateResult(int resultId, double score, const std::string& feedback, const std::string& status, const std::string& gradingDetails) {
+bool ResultRepository::updateResult(int resultId, double score, const std::string& feedback, const std::string& status,
+                                    const std::string& gradingDetails, int* studentId) {
     std::string details = gradingDetails.empty() ? "{}" : gradingDetails;
-    const char* query = "UPDATE results SET score = $1, feedback = $2, status = $3, grading_details = $4, graded_at = CURRENT_TIMESTAMP WHERE result_id = $5";
+    const char* query = "UPDATE results SET score = $1, feedback = $2, status = $3, grading_details = $4, graded_at = CURRENT_TIMESTAMP "
+                        "WHERE result_id = $5 RETURNING user_id";
     
     std::string s_score = std::to_string(score);
     std::string s_resultId = std::to_string(resultId);
@@ -47,7 +53,10 @@ bool ResultRepository::updateResult(int resultId, double score, const std::strin
     params[4] = s_resultId.c_str();
     
     PGresult* res = db->execParams(query, 5, params);
-    bool success = (res && PQresultStatus(res) == PGRES_COMMAND_OK);
+    bool success = (res && PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0);
+    if (success && studentId) {
+        *studentId = PQgetisnull(res, 0, 0) ? -1 : std::atoi(PQgetvalue(res, 0, 0));
+    }
     if (res) PQclear(res);
     return success;
 }
@@ -130,40 +139,6 @@ std::vector<Payloads::ResultSummaryDTO> ResultRepository::getResultsByUser(int u
     return results;
 }
 
-std::vector<Payloads::PendingSubmissionDTO> ResultRepository::getPendingSubmissions() {
-    std::vector<Payloads::PendingSubmissionDTO> submissions;
-    
-    // Join with users and exercises/exams tables to get titles and status
-    std::string query = "SELECT r.result_id, u.username, r.target_type, r.target_id, r.submitted_at, "
-                        "r.user_answer, r.status, "
-                        "COALESCE(ex.title, e.title, 'Unknown') as title "
-                        "FROM results r "
-                        "JOIN users u ON r.user_id = u.user_id "
-                        "LEFT JOIN exercises ex ON r.target_type = 'exercise' AND r.target_id = ex.exercise_id "
-                        "LEFT JOIN exams e ON r.target_type = 'exam' AND r.target_id = e.exam_id "
-                        "ORDER BY r.status DESC, r.submitted_at ASC"; // pending first, then graded
-
-    PGresult* result = db->query(query);
-    
-    if (result) {
-        for (int i = 0; i < PQntuples(result); ++i) {
-            Payloads::PendingSubmissionDTO dto;
-            dto.resultId = PQgetvalue(result, i, 0);
-            dto.userName = PQgetvalue(result, i, 1);
-            dto.targetType = PQgetvalue(result, i, 2);
-            dto.targetId = PQgetvalue(result, i, 3);
-            dto.submittedAt = PQgetvalue(result, i, 4);
-            dto.userAnswer = PQgetvalue(result, i, 5);
-            dto.status = PQgetvalue(result, i, 6);
-            dto.targetTitle = PQgetvalue(result, i, 7);
-            submissions.push_back(dto);
-        }
-        PQclear(result);
-    }
-    
-    return submissions;
-}
-
 bool ResultRepository::getResultDetail(int userId, const std::string& targetType, int targetId, Payloads::ResultDetailDTO& detail) {
     // 1. Fetch result data
     std::string query = "SELECT score, feedback, user_answer, grading_details FROM results WHERE user_id = " + std::to_string(userId) +
@@ -267,48 +242,147 @@ bool ResultRepository::getResultDetail(int userId, const std::string& targetType
 }
 
 bool ResultRepository::hasResult(int userId, const std::string& targetType, int targetId) {
-    std::string query = "SELECT 1 FROM results WHERE user_id = " + std::to_string(userId) +
-                        " AND target_type = '" + targetType + "' AND target_id = " + std::to_string(targetId) + " LIMIT 1";
-    
-    PGresult* res = db->query(query);
-    bool exists = (res && PQntuples(res) > 0);
+    if (targetType == "exam") {
+        AttemptIndex::Answer answer = examAttempts.check(targetId, userId);
+        if (answer == AttemptIndex::Answer::UNKNOWN) {
+            loadExamAttempts(targetId);
+            answer = examAttempts.check(targetId, userId);
+        }
+        if (answer == AttemptIndex::Answer::NOT_TAKEN) {
+            return false;
+        }
+        // Possibly taken (or the load failed): the database has the final say
+    }
+
+    const char* query = "SELECT 1 FROM results WHERE user_id = $1 AND target_type = $2 AND target_id = $3 LIMIT 1";
+    std::string s_userId = std::to_string(userId);
+    std::string s_targetId = std::to_string(targetId);
+    const char* params[3] = {s_userId.c_str(), targetType.c_str(), s_targetId.c_str()};
+
+    PGresult* res = db->execParams(query, 3, params);
+    bool exists = (res && PQresultStatus(res) == PGRES_TUPLES_OK && PQntuples(res) > 0);
     if (res) PQclear(res);
     return exists;
 }
 
-std::vector<Payloads::SubmissionDTO> ResultRepository::getSubmissions() {
-    std::vector<Payloads::SubmissionDTO> submissions;
-    
-    // Get all submissions with proper joins for titles and scores
-    std::string query = "SELECT r.result_id, u.username, r.target_type, r.target_id, r.submitted_at, "
-                        "r.user_answer, r.status, r.score, "
-                        "COALESCE(ex.title, e.title, 'Unknown') as title "
-                        "FROM results r "
-                        "JOIN users u ON r.user_id = u.user_id "
-                        "LEFT JOIN exercises ex ON r.target_type = 'exercise' AND r.target_id = ex.exercise_id "
-                        "LEFT JOIN exams e ON r.target_type = 'exam' AND r.target_id = e.exam_id "
-                        "ORDER BY CASE WHEN r.status = 'pending' THEN 0 ELSE 1 END, r.submitted_at DESC";
+void ResultRepository::loadExamAttempts(int examId) {
+    if (!examAttempts.beginLoad(examId)) {
+        return; // Loaded meanwhile, or another request is loading it
+    }
 
-    PGresult* result = db->query(query);
-    
-    if (result) {
-        for (int i = 0; i < PQntuples(result); ++i) {
-            Payloads::SubmissionDTO dto;
-            dto.resultId = PQgetvalue(result, i, 0);
-            dto.studentName = PQgetvalue(result, i, 1);
-            dto.targetType = PQgetvalue(result, i, 2);
-            dto.targetId = PQgetvalue(result, i, 3);
-            dto.submittedAt = PQgetvalue(result, i, 4);
-            dto.userAnswer = PQgetvalue(result, i, 5);
-            dto.status = PQgetvalue(result, i, 6);
-            dto.score = PQgetvalue(result, i, 7) ? PQgetvalue(result, i, 7) : "0";
-            dto.targetTitle = PQgetvalue(result, i, 8);
-            submissions.push_back(dto);
+    const char* query = "SELECT DISTINCT user_id FROM results WHERE target_type = 'exam' AND target_id = $1 AND user_id IS NOT NULL";
+    std::string s_examId = std::to_string(examId);
+    const char* params[1] = {s_examId.c_str()};
+
+    PGresult* res = db->execParams(query, 1, params);
+    if (!res || PQresultStatus(res) != PGRES_TUPLES_OK) {
+        if (res) PQclear(res);
+        examAttempts.abortLoad(examId);
+        return;
+    }
+
+    std::vector<int> userIds;
+    int rows = PQntuples(res);
+    userIds.reserve(rows);
+    for (int i = 0; i < rows; ++i) {
+        userIds.push_back(std::atoi(PQgetvalue(res, i, 0)));
+    }
+    PQclear(res);
+    examAttempts.finishLoad(examId, userIds);
+}
+
+bool SubmissionFilter::setCursor(const std::string& cursor) {
+    std::vector<std::string> parts = utils::split(cursor, ',');
+    if (parts.size() != 3 || parts[0].empty() || parts[1].empty()) {
+        return false;
+    }
+    try {
+        afterResultId = std::stoi(parts[2]);
+    } catch (...) {
+        return false;
+    }
+    afterStatus = parts[0];
+    afterSubmittedAt = parts[1];
+    hasCursor = true;
+    return true;
+}
+
+long ResultRepository::forEachSubmission(const SubmissionFilter& filter,
+                                         const std::function<bool(size_t total, const Payloads::SubmissionDTO&)>& onRow) {
+    std::vector<std::string> values;
+    auto param = [&values](const std::string& value) {
+        values.push_back(value);
+        return "$" + std::to_string(values.size());
+    };
+
+    std::vector<std::string> conditions;
+    if (!filter.status.empty()) conditions.push_back("r.status = " + param(filter.status));
+    if (!filter.targetType.empty()) conditions.push_back("r.target_type = " + param(filter.targetType));
+    if (filter.targetId != -1) conditions.push_back("r.target_id = " + param(std::to_string(filter.targetId)) + "::int");
+    if (!filter.student.empty()) conditions.push_back("u.username = " + param(filter.student));
+    if (!filter.from.empty()) conditions.push_back("r.submitted_at >= " + param(filter.from) + "::timestamp");
+    if (!filter.to.empty()) conditions.push_back("r.submitted_at < " + param(filter.to) + "::timestamp");
+
+    // Sort key: pending first (unless the filter fixes the status, which lets
+    // the pending queue walk idx_results_pending), then newest first, with
+    // result_id making it unique so the cursor resumes exactly
+    bool rankByStatus = filter.status.empty();
+    if (filter.hasCursor) {
+        std::string key = "(r.submitted_at, r.result_id) < (" + param(filter.afterSubmittedAt) + "::timestamp, " +
+                          param(std::to_string(filter.afterResultId)) + "::int)";
+        if (rankByStatus) {
+            std::string rank = param(filter.afterStatus == "pending" ? "false" : "true") + "::boolean";
+            key = "((r.status <> 'pending') > " + rank + " OR ((r.status <> 'pending') = " + rank + " AND " + key + "))";
         }
-        PQclear(result);
+        conditions.push_back(key);
     }
-    
-    return submissions;
+
+    auto orderBy = [rankByStatus](const std::string& alias) {
+        return std::string(" ORDER BY ") + (rankByStatus ? "(" + alias + "status <> 'pending'), " : "") +
+               alias + "submitted_at DESC, " + alias + "result_id DESC";
+    };
+
+    std::string page = "SELECT r.result_id, u.username, r.target_type, r.target_id, r.submitted_at, "
+                       "r.user_answer, r.status, r.score, "
+                       "COALESCE(ex.title, e.title, 'Unknown') AS title "
+                       "FROM results r "
+                       "JOIN users u ON r.user_id = u.user_id "
+                       "LEFT JOIN exercises ex ON r.target_type = 'exercise' AND r.target_id = ex.exercise_id "
+                       "LEFT JOIN exams e ON r.target_type = 'exam' AND r.target_id = e.exam_id";
+    for (size_t i = 0; i < conditions.size(); ++i) {
+        page += (i == 0 ? " WHERE " : " AND ") + conditions[i];
+    }
+    page += orderBy("r.") + " LIMIT " + param(std::to_string(filter.limit));
+
+    // count(*) OVER () carries the page's row count on every row, so a list
+    // header can be written before the first row without a second query. It
+    // is taken outside the LIMIT, which therefore still stops the scan early.
+    std::string query = "SELECT page.*, count(*) OVER () AS total FROM (" + page + ") page" + orderBy("page.");
+
+    std::vector<const char*> params;
+    params.reserve(values.size());
+    for (const auto& value : values) {
+        params.push_back(value.c_str());
+    }
+
+    long visited = 0;
+    bool ok = db->forEachRow(query, static_cast<int>(params.size()), params.data(), [&](PGresult* row) {
+        Payloads::SubmissionDTO dto;
+        dto.resultId = PQgetvalue(row, 0, 0);
+        dto.studentName = PQgetvalue(row, 0, 1);
+        dto.targetType = PQgetvalue(row, 0, 2);
+        dto.targetId = PQgetvalue(row, 0, 3);
+        dto.submittedAt = PQgetvalue(row, 0, 4);
+        dto.userAnswer = PQgetvalue(row, 0, 5);
+        dto.status = PQgetvalue(row, 0, 6);
+        dto.score = PQgetisnull(row, 0, 7) ? "0" : PQgetvalue(row, 0, 7);
+        dto.targetTitle = PQgetvalue(row, 0, 8);
+        size_t total = std::strtoul(PQgetvalue(row, 0, 9), nullptr, 10);
+        ++visited;
+        return onRow(total, dto);
+    });
+
+    return ok ? visited : -1;
 }
 
 bool ResultRepository::addFeedback(int resultId, const std::string& feedbackContent, const std::string& feedbackType) {
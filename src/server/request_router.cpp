@@ -1,4 +1,5 @@
 #include "server/request_router.h"
+#include "server/reply_context.h"
 #include "server/controller/user_controller.h"
 #include "server/controller/chat_controller.h"
 #include "server/controller/lesson_controller.h"
@@ -16,16 +17,26 @@
 #include "server/repository/game_repository.h"
 #include "server/controller/game_controller.h"
 #include "server/controller/admin_game_controller.h"
+#include "server/controller/blob_controller.h"
+#include "server/blob_store.h"
+#include "server/audio_transcoder.h"
+#include "server/call_log_writer.h"
+#include "server/catalog_versions.h"
+#include "server/repository/call_log_repository.h"
 #include "common/logger.h"
 #include "common/payloads.h"
+#include "common/utils.h"
 #include <sys/socket.h>
+#include <algorithm>
+#include <array>
 
 namespace server {
 
 RequestRouter::RequestRouter(std::shared_ptr<SessionManager> sessionMgr,
                              std::shared_ptr<ConnectionManager> connMgr,
                              std::shared_ptr<Database> database,
-                             std::shared_ptr<ResultRepository> resultRepo)
+                             std::shared_ptr<ResultRepository> resultRepo,
+                             std::shared_ptr<MediaRelay> mediaRelay)
     : sessionManager(sessionMgr), connectionManager(connMgr), db(database), resultRepo(resultRepo) {
     
     // Initialize Repositories
@@ -34,203 +45,400 @@ RequestRouter::RequestRouter(std::shared_ptr<SessionManager> sessionMgr,
     auto exerciseRepo = std::make_shared<ExerciseRepository>(db);
     auto examRepo = std::make_shared<ExamRepository>(db);
     auto chatRepo = std::make_shared<ChatRepository>(db);
+    auto notificationRepo = std::make_shared<NotificationRepository>(db);
     auto gameRepo = std::make_shared<GameRepository>(db);
+    auto blobStore = std::make_shared<BlobStore>("data/blobs");
+    auto audioTranscoder = std::make_shared<AudioTranscoder>(blobStore);
+    auto callLogWriter = std::make_shared<CallLogWriter>(std::make_shared<CallLogRepository>(db));
+    auto catalogVersions = std::make_shared<CatalogVersions>();
 
     // Initialize Controllers
     userController = std::make_shared<UserController>(userRepo, sessionManager, connectionManager);
-    chatController = std::make_shared<ChatController>(chatRepo, userRepo, connectionManager, sessionManager);
-    lessonController = std::make_shared<LessonController>(sessionManager, lessonRepo);
-    exerciseController = std::make_shared<ExerciseController>(sessionManager, exerciseRepo);
+    chatController = std::make_shared<ChatController>(chatRepo, notificationRepo, userRepo, connectionManager, sessionManager, blobStore, audioTranscoder, mediaRelay, callLogWriter);
+    lessonController = std::make_shared<LessonController>(sessionManager, lessonRepo, catalogVersions, connectionManager);
+    exerciseController = std::make_shared<ExerciseController>(sessionManager, exerciseRepo, catalogVersions);
     submissionController = std::make_shared<SubmissionController>(sessionManager, resultRepo, exerciseRepo, examRepo);
     resultController = std::make_shared<ResultController>(sessionManager, resultRepo);
-    studentExamController = std::make_shared<StudentExamController>(sessionManager, examRepo, resultRepo);
+    studentExamController = std::make_shared<StudentExamController>(sessionManager, examRepo, resultRepo, catalogVersions);
     teacherExamController = std::make_shared<TeacherExamController>(sessionManager, examRepo);
-    feedbackController = std::make_shared<FeedbackController>(sessionManager, resultRepo, exerciseRepo, examRepo);
-    gameController = std::make_shared<GameController>(sessionManager, gameRepo, resultRepo);
-    adminGameController = std::make_shared<AdminGameController>(sessionManager, gameRepo);
-
-    // Register Default Middlewares
-    registerMiddleware(std::make_shared<LoggingMiddleware>());
-    registerMiddleware(std::make_shared<AuthMiddleware>(sessionManager));
-    registerMiddleware(std::make_shared<RBACMiddleware>(sessionManager));
-}
+    feedbackController = std::make_shared<FeedbackController>(sessionManager, resultRepo, exerciseRepo, examRepo, connectionManager);
+    gameController = std::make_shared<GameController>(sessionManager, gameRepo, resultRepo, catalogVersions);
+    adminGameController = std::make_shared<AdminGameController>(sessionManager, gameRepo, catalogVersions, connectionManager);
+    blobController = std::make_shared<BlobController>(sessionManager, blobStore);
 
-void RequestRouter::registerMiddleware(std::shared_ptr<Middleware> middleware) {
-    middlewares.push_back(middleware);
 }
 
-void RequestRouter::sendErrorResponse(int clientFd, protocol::MsgCode code, const std::string& message) {
+void RequestRouter::sendErrorResponse(Connection& conn, protocol::MsgCode code, const std::string& message, bool binary) {
     Payloads::GenericResponse resp;
     resp.success = false;
     resp.message = message;
     
-    // Use the provided error code
-    protocol::Message error_msg(code, resp.serialize());
+    // Use the provided error code, answering in the codec the request used
+    protocol::Message error_msg = Payloads::encode(code, resp, binary);
     
-    std::vector<uint8_t> data = error_msg.serialize();
-    send(clientFd, data.data(), data.size(), 0);
+    sendReply(conn, error_msg);
+}
+
+namespace {
+
+using protocol::MsgCode;
+
+// Reason given when a request's role check fails, by the route's allowed roles
+const char* deniedMessage(uint8_t allowedRoles) {
+    switch (allowedRoles) {
+        case roles::TEACHER | roles::ADMIN:
+            return "Unauthorized: Teacher or Admin role required";
+        case roles::STUDENT | roles::ADMIN:
+            return "Unauthorized: Teachers cannot perform student actions";
+        case roles::ADMIN:
+            return "Unauthorized: Admin role required";
+        default:
+            return "Unauthorized: Role not permitted";
+    }
+}
+
+} // namespace
+
+template <auto Controller, auto Method>
+void RequestRouter::invoke(Connection& conn, const protocol::Message& msg) {
+    ((*(this->*Controller)).*Method)(conn, msg);
+}
+
+// Every request the router serves. HEARTBEAT and DISCONNECT_REQUEST never get
+// here (ClientHandler answers them); anything else not listed is unknown.
+constexpr RequestRouter::Route RequestRouter::routes[] = {
+    // Connection setup (no login needed)
+    {MsgCode::HELLO, &RequestRouter::handleHello, false, roles::ANY, false},
+    {MsgCode::CODEC_SELECT_REQUEST, &RequestRouter::handleCodecSelect, false, roles::ANY, false},
+    {MsgCode::BATCH_REQUEST, &RequestRouter::handleBatch, true, roles::ANY, false},
+
+    // User / Auth
+    {MsgCode::LOGIN_REQUEST, &RequestRouter::handleLogin, false, roles::ANY, false},
+    {MsgCode::REGISTER_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::userController, &UserController::handleUserRegisterRequest>, false, roles::ANY, false},
+    {MsgCode::LOGOUT_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::userController, &UserController::handleUserLogoutRequest>, true, roles::ANY, false},
+
+    // Chat
+    {MsgCode::SEND_CHAT_PRIVATE_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::chatController, &ChatController::handleUserSendPrivateMessage>, true, roles::ANY, true},
+    {MsgCode::CHAT_HISTORY_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::chatController, &ChatController::handleUserGetChatHistory>, true, roles::ANY, true},
+    {MsgCode::RECENT_CHATS_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::chatController, &ChatController::handleUserGetRecentChats>, true, roles::ANY, true},
+    {MsgCode::CHAT_READ_ACK,
+     &RequestRouter::invoke<&RequestRouter::chatController, &ChatController::handleChatReadAck>, true, roles::ANY, true},
+    {MsgCode::UNREAD_DIGEST_ACK,
+     &RequestRouter::invoke<&RequestRouter::chatController, &ChatController::handleDeliveryAck>, true, roles::ANY, true},
+    {MsgCode::CHAT_RECEIVE_ACK,
+     &RequestRouter::invoke<&RequestRouter::chatController, &ChatController::handleDeliveryAck>, true, roles::ANY, true},
+
+    // Voice Calls
+    {MsgCode::CALL_INITIATE_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::chatController, &ChatController::handleCallInitiate>, true, roles::ANY, true},
+    {MsgCode::CALL_ANSWER_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::chatController, &ChatController::handleCallAnswer>, true, roles::ANY, true},
+    {MsgCode::CALL_DECLINE_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::chatController, &ChatController::handleCallDecline>, true, roles::ANY, true},
+    {MsgCode::CALL_END_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::chatController, &ChatController::handleCallEnd>, true, roles::ANY, true},
+
+    // Blob Transfer
+    {MsgCode::BLOB_UPLOAD_CHUNK,
+     &RequestRouter::invoke<&RequestRouter::blobController, &BlobController::handleBlobUploadChunk>, true, roles::ANY, true},
+    {MsgCode::BLOB_DOWNLOAD_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::blobController, &BlobController::handleBlobDownloadRequest>, true, roles::ANY, true},
+
+    // Lesson
+    {MsgCode::LESSON_LIST_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::lessonController, &LessonController::handleUserLessonListRequest>, true, roles::ANY, true},
+    {MsgCode::STUDY_LESSON_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::lessonController, &LessonController::handleUserStudyLessonRequest>, true, roles::ANY, true},
+
+    // Exercise (teachers cannot perform student actions)
+    {MsgCode::EXERCISE_LIST_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::exerciseController, &ExerciseController::handleStudentExerciseListRequest>,
+     true, roles::STUDENT | roles::ADMIN, true},
+    {MsgCode::MULTIPLE_CHOICE_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::exerciseController, &ExerciseController::handleStudentSpecificExerciseRequest>,
+     true, roles::STUDENT | roles::ADMIN, true},
+    {MsgCode::FILL_IN_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::exerciseController, &ExerciseController::handleStudentSpecificExerciseRequest>,
+     true, roles::STUDENT | roles::ADMIN, true},
+    {MsgCode::SENTENCE_ORDER_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::exerciseController, &ExerciseController::handleStudentSpecificExerciseRequest>,
+     true, roles::STUDENT | roles::ADMIN, true},
+    {MsgCode::REWRITE_SENTENCE_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::exerciseController, &ExerciseController::handleStudentSpecificExerciseRequest>,
+     true, roles::STUDENT | roles::ADMIN, true},
+    {MsgCode::WRITE_PARAGRAPH_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::exerciseController, &ExerciseController::handleStudentSpecificExerciseRequest>,
+     true, roles::STUDENT | roles::ADMIN, true},
+    {MsgCode::SPEAKING_TOPIC_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::exerciseController, &ExerciseController::handleStudentSpecificExerciseRequest>,
+     true, roles::STUDENT | roles::ADMIN, true},
+    {MsgCode::STUDY_EXERCISE_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::exerciseController, &ExerciseController::handleStudentStudyExerciseRequest>,
+     true, roles::ANY, true},
+
+    // Submission
+    {MsgCode::SUBMIT_ANSWER_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::submissionController, &SubmissionController::handleStudentSubmission>,
+     true, roles::STUDENT | roles::ADMIN, true},
+    {MsgCode::GRADE_SUBMISSION_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::feedbackController, &FeedbackController::handleGradeSubmission>,
+     true, roles::TEACHER | roles::ADMIN, true},
+
+    // Result
+    {MsgCode::RESULT_LIST_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::resultController, &ResultController::handleStudentResultListRequest>,
+     true, roles::STUDENT | roles::ADMIN, true},
+    {MsgCode::RESULT_DETAIL_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::resultController, &ResultController::handleStudentResultDetailRequest>,
+     true, roles::STUDENT | roles::ADMIN, true},
+    {MsgCode::RESULT_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::resultController, &ResultController::handleStudentResultRequest>,
+     true, roles::STUDENT | roles::ADMIN, true},
+    {MsgCode::PENDING_SUBMISSIONS_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::feedbackController, &FeedbackController::handleGetSubmissions>,
+     true, roles::TEACHER | roles::ADMIN, true},
+
+    // Exam (Student)
+    {MsgCode::EXAM_LIST_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::studentExamController, &StudentExamController::handleGetExams>,
+     true, roles::STUDENT | roles::ADMIN, true},
+    {MsgCode::EXAM_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::studentExamController, &StudentExamController::handleExamRequest>,
+     true, roles::STUDENT | roles::ADMIN, true},
+
+    // Exam (Teacher)
+    {MsgCode::EXAM_REVIEW_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::teacherExamController, &TeacherExamController::handleExamReview>,
+     true, roles::TEACHER | roles::ADMIN, true},
+
+    // Games
+    {MsgCode::GAME_LIST_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::gameController, &GameController::handleGameListRequest>, true, roles::ANY, true},
+    {MsgCode::GAME_LEVEL_LIST_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::gameController, &GameController::handleGameLevelListRequest>, true, roles::ANY, true},
+    {MsgCode::GAME_DATA_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::gameController, &GameController::handleGameDataRequest>, true, roles::ANY, true},
+    {MsgCode::GAME_SUBMIT_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::gameController, &GameController::handleGameSubmitRequest>, true, roles::ANY, true},
+
+    // Admin Game Management
+    {MsgCode::GAME_CREATE_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::adminGameController, &AdminGameController::handleGameCreateRequest>,
+     true, roles::ADMIN, true},
+    {MsgCode::GAME_UPDATE_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::adminGameController, &AdminGameController::handleGameUpdateRequest>,
+     true, roles::ADMIN, true},
+    {MsgCode::GAME_DELETE_REQUEST,
+     &RequestRouter::invoke<&RequestRouter::adminGameController, &AdminGameController::handleGameDeleteRequest>,
+     true, roles::ADMIN, true},
+};
+
+namespace {
+
+// Request codes are below 1000; the index maps each to its slot in
+// RequestRouter::routes, or NO_ROUTE
+constexpr size_t CODE_SLOTS = 1000;
+constexpr uint8_t NO_ROUTE = 0xFF;
+
+template <typename Route, size_t N>
+constexpr std::array<uint8_t, CODE_SLOTS> buildRouteIndex(const Route (&table)[N]) {
+    static_assert(N < NO_ROUTE, "Route table too large for a uint8_t index");
+    std::array<uint8_t, CODE_SLOTS> index{};
+    for (auto& slot : index) slot = NO_ROUTE;
+    for (size_t i = 0; i < N; ++i) {
+        size_t code = static_cast<size_t>(table[i].code);
+        // Not a constant expression (so a compile error) for a code out of
+        // range or listed twice
+        if (code >= CODE_SLOTS || index[code] != NO_ROUTE) throw "invalid route table";
+        index[code] = static_cast<uint8_t>(i);
+    }
+    return index;
+}
+
+} // namespace
+
+const RequestRouter::Route* RequestRouter::findRoute(protocol::MsgCode code) {
+    static constexpr auto index = buildRouteIndex(routes);
+    size_t slot = static_cast<size_t>(code);
+    if (slot >= CODE_SLOTS || index[slot] == NO_ROUTE) {
+        return nullptr;
+    }
+    return &routes[index[slot]];
 }
 
-void RequestRouter::handleMessage(int clientFd, const protocol::Message& msg, ClientHandler* clientHandler) {
+void RequestRouter::handleMessage(Connection& conn, const protocol::Message& msg) {
     if (logger::serverLogger) {
-        logger::serverLogger->debug("RequestRouter handling message code: " + std::to_string(static_cast<int>(msg.code)));
-    }
-
-    // Execute Middlewares
-    std::string errorMsg;
-    for (const auto& middleware : middlewares) {
-        if (!middleware->handle(clientFd, msg, errorMsg)) {
-            if (logger::serverLogger) {
-                logger::serverLogger->warn("Middleware rejected request from fd=" + std::to_string(clientFd) + ": " + errorMsg);
-            }
-            sendErrorResponse(clientFd, protocol::MsgCode::GENERAL_FAILURE, errorMsg);
-            return;
+        logger::serverLogger->info("Request: Code=" + std::to_string(static_cast<int>(msg.code)) +
+                                   ", Size=" + std::to_string(msg.payloadSize()) +
+                                   ", Fd=" + std::to_string(conn.fd));
+    }
+
+    const Route* route = findRoute(msg.code);
+    if (!route) {
+        if (logger::serverLogger) {
+            logger::serverLogger->warn("Unknown message code: " + std::to_string(static_cast<int>(msg.code)));
         }
+        return;
+    }
+
+    if (!authorize(conn, *route, msg)) {
+        return;
+    }
+    (this->*(route->handler))(conn, msg);
+}
+
+bool RequestRouter::authorize(Connection& conn, const Route& route, const protocol::Message& msg) {
+    const char* errorMsg = nullptr;
+    if (route.requiresAuth && !conn.isAuthenticated()) {
+        errorMsg = "Unauthorized: Login required";
+    } else if (route.requiresAuth && route.allowedRoles != roles::ANY && !(route.allowedRoles & conn.roleBits)) {
+        errorMsg = deniedMessage(route.allowedRoles);
     }
 
+    if (!errorMsg) {
+        return true;
+    }
     if (logger::serverLogger) {
-        logger::serverLogger->debug("Middleware passed, routing to controller");
-    }
-
-    switch (msg.code) {
-        // User / Auth
-        case protocol::MsgCode::LOGIN_REQUEST:
-            if (clientHandler) {
-                if (logger::serverLogger) logger::serverLogger->debug("Routing to UserController::handleUserLoginRequest");
-                userController->handleUserLoginRequest(clientFd, msg, clientHandler);
-            } else {
-                if (logger::serverLogger) logger::serverLogger->error("ClientHandler is null for LOGIN_REQUEST");
-            }
-            break;
-        case protocol::MsgCode::LOGOUT_REQUEST:
-            if (logger::serverLogger) logger::serverLogger->debug("Routing to UserController::handleUserLogoutRequest");
-            userController->handleUserLogoutRequest(clientFd, msg);
-            break;
-        case protocol::MsgCode::REGISTER_REQUEST:
-            if (logger::serverLogger) logger::serverLogger->debug("Routing to UserController::handleUserRegisterRequest");
-            userController->handleUserRegisterRequest(clientFd, msg);
-            break;
+        logger::serverLogger->warn("Rejected request from fd=" + std::to_string(conn.fd) + ": " + errorMsg);
+    }
+    sendErrorResponse(conn, protocol::MsgCode::GENERAL_FAILURE, errorMsg, msg.binary);
+    return false;
+}
 
-        // Chat
-        case protocol::MsgCode::SEND_CHAT_PRIVATE_REQUEST:
-            chatController->handleUserSendPrivateMessage(clientFd, msg);
-            break;
-        case protocol::MsgCode::CHAT_HISTORY_REQUEST:
-            chatController->handleUserGetChatHistory(clientFd, msg);
-            break;
-        case protocol::MsgCode::RECENT_CHATS_REQUEST:
-            chatController->handleUserGetRecentChats(clientFd, msg);
-            break;
+void RequestRouter::handleLogin(Connection& conn, const protocol::Message& msg) {
+    userController->handleUserLoginRequest(conn, msg);
+    // Store-and-forward: deliver what arrived while the user was offline
+    if (conn.isAuthenticated()) chatController->sendUnreadDigest(conn, conn.userId);
+}
 
-        // Voice Calls
-        case protocol::MsgCode::CALL_INITIATE_REQUEST:
-            chatController->handleCallInitiate(clientFd, msg);
-            break;
-        case protocol::MsgCode::CALL_ANSWER_REQUEST:
-            chatController->handleCallAnswer(clientFd, msg);
-            break;
-        case protocol::MsgCode::CALL_DECLINE_REQUEST:
-            chatController->handleCallDecline(clientFd, msg);
-            break;
-        case protocol::MsgCode::CALL_END_REQUEST:
-            chatController->handleCallEnd(clientFd, msg);
-            break;
+void RequestRouter::handleCodecSelect(Connection& conn, const protocol::Message& msg) {
+    // Payload is "<codec>[,deflate][,chunked]": the codec for server pushes
+    // (anything unknown falls back to text), optionally followed by compression
+    // and by consent to receive large responses as STREAM_* frames.
+    // The reply itself is always uncompressed text so any client can read it.
+    auto options = utils::splitView(msg.view(), ',');
+    bool binary = !options.empty() && options[0] == "binary";
+    bool deflate = false;
+    bool chunked = false;
+    for (size_t i = 1; i < options.size(); ++i) {
+        if (options[i] == "deflate") deflate = true;
+        if (options[i] == "chunked") chunked = true;
+    }
+    // Anything else negotiated by an earlier HELLO stays as it was
+    protocol::Capabilities capabilities = conn.capabilities;
+    capabilities.binaryPayloads = binary;
+    capabilities.compression = deflate;
+    capabilities.chunkedResponses = chunked;
+    conn.setCapabilities(capabilities);
 
-        // Lesson
-        case protocol::MsgCode::LESSON_LIST_REQUEST:
-            lessonController->handleUserLessonListRequest(clientFd, msg);
-            break;
-        case protocol::MsgCode::STUDY_LESSON_REQUEST:
-            lessonController->handleUserStudyLessonRequest(clientFd, msg);
-            break;
+    std::string selected = std::string(binary ? "binary" : "text") + (deflate ? ",deflate" : "") +
+                           (chunked ? ",chunked" : "");
+    protocol::Message response(protocol::MsgCode::CODEC_SELECT_SUCCESS, selected);
+    sendReply(conn, response);
 
-        // Exercise
-        case protocol::MsgCode::EXERCISE_LIST_REQUEST:
-            exerciseController->handleStudentExerciseListRequest(clientFd, msg);
-            break;
-        case protocol::MsgCode::MULTIPLE_CHOICE_REQUEST:
-        case protocol::MsgCode::FILL_IN_REQUEST:
-        case protocol::MsgCode::SENTENCE_ORDER_REQUEST:
-        case protocol::MsgCode::REWRITE_SENTENCE_REQUEST:
-        case protocol::MsgCode::WRITE_PARAGRAPH_REQUEST:
-        case protocol::MsgCode::SPEAKING_TOPIC_REQUEST:
-            exerciseController->handleStudentSpecificExerciseRequest(clientFd, msg);
-            break;
-        case protocol::MsgCode::STUDY_EXERCISE_REQUEST:
-            exerciseController->handleStudentStudyExerciseRequest(clientFd, msg);
-            break;
+    if (logger::serverLogger) {
+        logger::serverLogger->info("fd=" + std::to_string(conn.fd) + " selected " + selected + " payloads");
+    }
+}
 
-        // Submission
-        case protocol::MsgCode::SUBMIT_ANSWER_REQUEST:
-            submissionController->handleStudentSubmission(clientFd, msg);
-            break;
-        case protocol::MsgCode::GRADE_SUBMISSION_REQUEST:
-            feedbackController->handleGradeSubmission(clientFd, msg);
-            break;
+void RequestRouter::handleHello(Connection& conn, const protocol::Message& msg) {
+    Payloads::HelloDTO hello;
+    Payloads::decode(msg, hello);
 
-        // Result
-        case protocol::MsgCode::RESULT_LIST_REQUEST:
-            resultController->handleStudentResultListRequest(clientFd, msg);
-            break;
-        case protocol::MsgCode::RESULT_DETAIL_REQUEST:
-            resultController->handleStudentResultDetailRequest(clientFd, msg);
-            break;
-        case protocol::MsgCode::RESULT_REQUEST: // This case is kept for handleResultRequest
-            resultController->handleStudentResultRequest(clientFd, msg);
-            break;
-        case protocol::MsgCode::PENDING_SUBMISSIONS_REQUEST:
-            feedbackController->handleGetSubmissions(clientFd, msg);
+    // Take the client's first codec we support; options it did not offer stay off
+    protocol::Capabilities capabilities;
+    capabilities.version = std::min(hello.version, protocol::PROTOCOL_VERSION);
+    if (hello.maxFrameSize > 0) {
+        capabilities.maxFrameSize = std::max(static_cast<uint32_t>(hello.maxFrameSize), protocol::MIN_FRAME_SIZE);
+    }
+    for (const auto& codec : hello.codecs) {
+        if (codec == "binary" || codec == "text") {
+            capabilities.binaryPayloads = codec == "binary";
             break;
+        }
+    }
+    capabilities.compression = Payloads::HelloDTO::contains(hello.compression, "deflate");
+    capabilities.correlationIds = Payloads::HelloDTO::contains(hello.features, protocol::feature::CORRELATION_ID);
+    capabilities.contentVersions = Payloads::HelloDTO::contains(hello.features, protocol::feature::CONTENT_VERSION);
+    capabilities.batch = Payloads::HelloDTO::contains(hello.features, protocol::feature::BATCH);
+    capabilities.chunkedResponses = Payloads::HelloDTO::contains(hello.features, protocol::feature::CHUNKED);
+    conn.setCapabilities(capabilities);
 
-        // Exam (Student)
-        case protocol::MsgCode::EXAM_LIST_REQUEST:
-            studentExamController->handleGetExams(clientFd, msg);
-            break;
-        case protocol::MsgCode::EXAM_REQUEST:
-            studentExamController->handleExamRequest(clientFd, msg);
-            break;
+    Payloads::HelloDTO ack;
+    ack.version = capabilities.version;
+    ack.maxFrameSize = static_cast<int>(protocol::MAX_FRAME_SIZE);
+    ack.codecs.push_back(capabilities.binaryPayloads ? "binary" : "text");
+    if (capabilities.compression) ack.compression.push_back("deflate");
+    if (capabilities.correlationIds) ack.features.emplace_back(protocol::feature::CORRELATION_ID);
+    if (capabilities.contentVersions) ack.features.emplace_back(protocol::feature::CONTENT_VERSION);
+    if (capabilities.batch) ack.features.emplace_back(protocol::feature::BATCH);
+    if (capabilities.chunkedResponses) ack.features.emplace_back(protocol::feature::CHUNKED);
+    ack.maxBlobSize = static_cast<int>(BlobController::MAX_BLOB_SIZE);
 
-        // Exam (Teacher)
-        case protocol::MsgCode::EXAM_REVIEW_REQUEST:
-            teacherExamController->handleExamReview(clientFd, msg);
-            break;
+    // Answered in the codec the HELLO used, which the client can always read
+    sendReply(conn, Payloads::encode(protocol::MsgCode::HELLO_ACK, ack, msg.binary));
 
-        // Games
-        case protocol::MsgCode::GAME_LIST_REQUEST:
-            gameController->handleGameListRequest(clientFd, msg);
-            break;
-        case protocol::MsgCode::GAME_LEVEL_LIST_REQUEST:
-            gameController->handleGameLevelListRequest(clientFd, msg);
-            break;
-        case protocol::MsgCode::GAME_DATA_REQUEST:
-            gameController->handleGameDataRequest(clientFd, msg);
-            break;
-        case protocol::MsgCode::GAME_SUBMIT_REQUEST:
-            gameController->handleGameSubmitRequest(clientFd, msg);
-            break;
+    if (logger::serverLogger) {
+        logger::serverLogger->info("fd=" + std::to_string(conn.fd) + " said HELLO v" + std::to_string(hello.version) +
+                                   ", agreed " + ack.serialize());
+    }
+}
 
-        // Admin Game Management
-        case protocol::MsgCode::GAME_CREATE_REQUEST:
-            adminGameController->handleGameCreateRequest(clientFd, msg);
-            break;
-        case protocol::MsgCode::GAME_UPDATE_REQUEST:
-            adminGameController->handleGameUpdateRequest(clientFd, msg);
-            break;
-        case protocol::MsgCode::GAME_DELETE_REQUEST:
-            adminGameController->handleGameDeleteRequest(clientFd, msg);
-            break;
+void RequestRouter::handleBatch(Connection& conn, const protocol::Message& msg) {
+    std::vector<protocol::Message> requests;
+    try {
+        requests = protocol::unpackFrameViews(msg, conn.capabilities.compression);
+    } catch (const std::exception& e) {
+        sendErrorResponse(conn, protocol::MsgCode::GENERAL_FAILURE, std::string("Invalid batch: ") + e.what(),
+                          msg.binary);
+        return;
+    }
 
-        default:
-            if (logger::serverLogger) {
-                logger::serverLogger->warn("Unknown message code: " + std::to_string(static_cast<int>(msg.code)));
-            }
-            break;
+    // Each sub-request is checked against its route (the login behind the
+    // batch frame already is) and run by its handler. Replies are captured
+    // with their own correlation ids and returned in one frame.
+    std::vector<uint8_t> frames;
+    for (const auto& request : requests) {
+        ReplyScope replyScope(conn, request.correlationId);
+        ReplyCapture capture(conn, frames);
+
+        // Connection and session state changes are not batchable (nor is
+        // anything unknown, which would otherwise leave its reply missing)
+        const Route* route = findRoute(request.code);
+        if (!route || !route->batchable) {
+            sendErrorResponse(conn, protocol::MsgCode::GENERAL_FAILURE,
+                              "Request code " + std::to_string(static_cast<int>(request.code)) + " cannot be batched",
+                              request.binary);
+            continue;
+        }
+
+        if (!authorize(conn, *route, request)) {
+            continue;
+        }
+        (this->*(route->handler))(conn, request);
     }
+
+    if (logger::serverLogger) {
+        logger::serverLogger->debug("Batch of " + std::to_string(requests.size()) + " requests from fd=" +
+                                    std::to_string(conn.fd) + " answered in " + std::to_string(frames.size()) + " bytes");
+    }
+
+    protocol::Message response(protocol::MsgCode::BATCH_RESPONSE, frames);
+    sendReply(conn, response);
 }
 
 void RequestRouter::processTimeouts() {
     if (chatController) {
         chatController->processCallTimeouts();
+        chatController->flushAcknowledgements();
+    }
+    if (blobController) {
+        blobController->processUploadTimeouts();
     }
 }
 
@@ -0,0 +1,104 @@
+#include "server/response_stream.h"
+#include "server/reply_context.h"
+#include "common/logger.h"
+#include <atomic>
+
+namespace server {
+
+namespace {
+
+std::atomic<uint32_t> nextStreamId{1};
+
+void appendU32(std::string& out, uint32_t value) {
+    out.push_back(static_cast<char>(value >> 24));
+    out.push_back(static_cast<char>(value >> 16));
+    out.push_back(static_cast<char>(value >> 8));
+    out.push_back(static_cast<char>(value));
+}
+
+} // namespace
+
+ResponseStream::ResponseStream(Connection& conn, protocol::MsgCode code, bool binary)
+    : conn(conn), code(code), binary(binary), chunked(replyAcceptsChunks(conn)) {}
+
+ResponseStream::~ResponseStream() {
+    if (!finished && started) {
+        end(1);
+    }
+}
+
+bool ResponseStream::sendFrame(const protocol::Message& frame) {
+    if (sendReply(conn, frame) < 0) {
+        if (logger::serverLogger) {
+            logger::serverLogger->error("Failed to send stream frame to fd=" + std::to_string(conn.fd));
+        }
+        failed = true;
+    }
+    return !failed;
+}
+
+bool ResponseStream::flushChunk() {
+    if (!started) {
+        streamId = nextStreamId.fetch_add(1);
+        if (streamId == 0) streamId = nextStreamId.fetch_add(1); // 0 is never a valid id
+
+        std::string header;
+        appendU32(header, streamId);
+        uint16_t rawCode = static_cast<uint16_t>(code);
+        if (binary) rawCode |= protocol::BINARY_PAYLOAD_FLAG;
+        header.push_back(static_cast<char>(rawCode >> 8));
+        header.push_back(static_cast<char>(rawCode));
+        started = true;
+        if (!sendFrame(protocol::Message(protocol::MsgCode::STREAM_START, header))) return false;
+    }
+
+    if (buffer.empty()) return true;
+
+    std::string chunk;
+    chunk.reserve(4 + buffer.size());
+    appendU32(chunk, streamId);
+    chunk.append(buffer);
+    buffer.clear();
+    return sendFrame(protocol::Message(protocol::MsgCode::STREAM_CHUNK, chunk));
+}
+
+void ResponseStream::end(uint8_t status) {
+    finished = true;
+    if (failed) return;
+
+    std::string payload;
+    appendU32(payload, streamId);
+    payload.push_back(static_cast<char>(status));
+    sendFrame(protocol::Message(protocol::MsgCode::STREAM_END, payload));
+}
+
+bool ResponseStream::write(std::string_view bytes) {
+    if (failed || finished) return false;
+
+    buffer.append(bytes);
+    // Flush only between writes, so chunks end on the boundaries the
+    // handler wrote (whole list items)
+    if (chunked && buffer.size() >= CHUNK_SIZE) {
+        return flushChunk();
+    }
+    return true;
+}
+
+bool ResponseStream::finish() {
+    if (finished) return !failed;
+
+    if (!chunked) {
+        finished = true;
+        protocol::Message response(code, std::vector<uint8_t>(buffer.begin(), buffer.end()));
+        response.binary = binary;
+        std::string().swap(buffer);
+        return sendFrame(response);
+    }
+
+    if (flushChunk()) {
+        end(0);
+    }
+    return !failed;
+}
+
+} // namespace server
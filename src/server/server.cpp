@@ -3,14 +3,17 @@
 #include "common/logger.h"
 #include <sys/socket.h>
 #include <arpa/inet.h>
+#include <netinet/tcp.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <algorithm>
 #include <cstring>
+#include <cerrno>
 #include <csignal>
 #include <iostream>
 
-Server::Server(int port, const std::string& dbConn)
-    : serverSocket(-1), port(port), running(false), dbConnInfo(dbConn) {
+Server::Server(int port, const std::string& dbConn, size_t workers)
+    : serverSocket(-1), port(port), running(true), dbConnInfo(dbConn) {
     
     // Initialize database connection
     database = std::make_shared<server::Database>(dbConnInfo);
@@ -24,25 +27,33 @@ Server::Server(int port, const std::string& dbConn)
     // Initialize managers
     // Initialize managers
     sessionManager = std::make_shared<server::SessionManager>(database);
-    connectionManager = std::make_shared<server::ConnectionManager>(sessionManager);
+    connectionManager = std::make_shared<server::ConnectionManager>(
+        sessionManager, std::make_shared<server::NotificationRepository>(database));
 
     // Initialize Repositories
     resultRepository = std::make_shared<server::ResultRepository>(database);
 
-    requestRouter = std::make_shared<server::RequestRouter>(sessionManager, connectionManager, database, resultRepository);
+    mediaRelay = std::make_shared<server::MediaRelay>(port + 1);
+
+    requestRouter = std::make_shared<server::RequestRouter>(sessionManager, connectionManager, database, resultRepository, mediaRelay);
 
     this->clientHandler = std::make_shared<server::ClientHandler>(
         sessionManager,
         connectionManager,
         requestRouter);
+
+    executor = std::make_unique<server::StrandExecutor>(workers);
+    wakeup = std::make_shared<server::Wakeup>();
         
     if (logger::serverLogger) {
-        logger::serverLogger->info("Server components initialized successfully");
+        logger::serverLogger->info("Server components initialized successfully (" +
+                                   (workers ? std::to_string(workers) + " worker threads" : std::string("single-threaded")) +
+                                   ")");
     }
 }
 
 Server::~Server() {
-    stop();
+    shutdown();
 }
 
 bool Server::initSocket() {
@@ -62,6 +73,7 @@ bool Server::initSocket() {
             logger::serverLogger->error("Failed to set socket options");
         }
         close(serverSocket);
+        serverSocket = -1;
         return false;
     }
 
@@ -81,6 +93,7 @@ bool Server::initSocket() {
             logger::serverLogger->error("Failed to bind socket to port " + std::to_string(port));
         }
         close(serverSocket);
+        serverSocket = -1;
         return false;
     }
 
@@ -90,6 +103,7 @@ bool Server::initSocket() {
             logger::serverLogger->error("Failed to listen on socket");
         }
         close(serverSocket);
+        serverSocket = -1;
         return false;
     }
 
@@ -119,7 +133,15 @@ int Server::acceptClient() {
     int flags = fcntl(clientFd, F_GETFL, 0);
     fcntl(clientFd, F_SETFL, flags | O_NONBLOCK);
 
-    clientSockets.insert(clientFd);
+    // Output is already coalesced per loop pass, so Nagle would only add delay
+    int noDelay = 1;
+    setsockopt(clientFd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+    auto conn = std::make_shared<server::Connection>(clientFd);
+    conn->strandKey = server::StrandExecutor::connectionKey(clientFd);
+    conn->wakeup = wakeup;
+    connectionManager->attach(*conn);
+    connections.emplace(clientFd, std::move(conn));
 
     char clientIp[INET_ADDRSTRLEN];
     inet_ntop(AF_INET, &clientAddr.sin_addr, clientIp, INET_ADDRSTRLEN);
@@ -132,52 +154,95 @@ int Server::acceptClient() {
     return clientFd;
 }
 
-void Server::handleClientData(int clientFd) {
-    std::vector<uint8_t> tempBuffer(4096);
-    
-    ssize_t received = recv(clientFd, tempBuffer.data(), tempBuffer.size(), 0);
-    
+void Server::handleClientData(const std::shared_ptr<server::Connection>& conn) {
+    // Receive straight into the connection's buffer, after any partial frame
+    std::vector<uint8_t>& buffer = conn->input;
+    size_t previous = buffer.size();
+    buffer.resize(previous + RECV_CHUNK);
+
+    ssize_t received = recv(conn->fd, buffer.data() + previous, RECV_CHUNK, 0);
+    buffer.resize(previous + std::max<ssize_t>(received, 0));
+
     if (received <= 0) {
         if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
             // Client disconnected
-            removeClient(clientFd);
+            removeClient(conn);
         }
         return;
     }
 
-    tempBuffer.resize(received);
-    
-    // Append to client buffer
-    std::vector<uint8_t>& buffer = clientBuffers[clientFd];
-    buffer.insert(buffer.end(), tempBuffer.begin(), tempBuffer.end());
-    
-    // Process all complete messages
+    // Find the complete frames
+    size_t consumed = 0;
+    std::vector<std::pair<size_t, uint32_t>> frames; // (offset, length)
     while (true) {
-        uint32_t msgLen = protocol::Message::getFullLength(buffer);
+        // Refuse frames over the limit advertised in HELLO_ACK before
+        // buffering them; the length prefix is all we need to tell
+        uint32_t declaredLen = protocol::Message::peekLength(buffer, consumed);
+        if (declaredLen > protocol::MAX_FRAME_SIZE || (declaredLen != 0 && declaredLen < 6)) {
+            if (logger::serverLogger) {
+                logger::serverLogger->warn("Frame of " + std::to_string(declaredLen) + " bytes from fd=" +
+                                           std::to_string(conn->fd) + " is outside the frame limit; closing");
+            }
+            removeClient(conn);
+            return;
+        }
+
+        uint32_t msgLen = protocol::Message::getFullLength(buffer, consumed);
         
         if (msgLen == 0) {
             // Not enough data for a full message yet
             break;
         }
-        
-        // Extract message data
-        std::vector<uint8_t> msgData(buffer.begin(), buffer.begin() + msgLen);
-        
-        // Remove from buffer
-        buffer.erase(buffer.begin(), buffer.begin() + msgLen);
-        
-        // Process the message
-        // Note: processMessage now expects the full serialized message including length prefix
-        // because we modified deserialize to handle it.
-        clientHandler->processMessage(clientFd, msgData);
+        frames.emplace_back(consumed, msgLen);
+        consumed += msgLen;
+    }
+    if (frames.empty()) return;
+
+    // Note: processMessage expects the full serialized message including length prefix
+    if (executor->isInline()) {
+        // Parsed in place, then dropped from the buffer in one erase
+        for (const auto& frame : frames) {
+            clientHandler->processMessage(*conn, buffer.data() + frame.first, frame.second);
+        }
+        buffer.erase(buffer.begin(), buffer.begin() + consumed);
+        return;
+    }
+
+    // The queued frames share this read's buffer, each parsed in place by its
+    // task; only the partial frame after them is copied back into input
+    auto block = std::make_shared<const std::vector<uint8_t>>(std::move(buffer));
+    buffer.assign(block->begin() + consumed, block->end());
+    for (const auto& frame : frames) {
+        postToStrand(conn, [this, conn, block, frame] {
+            clientHandler->processMessage(*conn, block->data() + frame.first, frame.second);
+        });
+    }
+}
+
+void Server::postToStrand(const std::shared_ptr<server::Connection>& conn, server::StrandExecutor::Task task) {
+    // Switch strands (after login or logout) only once the previous one has
+    // run everything for this connection, or requests could overtake each other.
+    // The acquire pairs with the release below, making the worker's writes to
+    // conn->userId visible here.
+    if (conn->inFlight.load(std::memory_order_acquire) == 0) {
+        conn->strandKey = conn->isAuthenticated() ? server::StrandExecutor::userKey(conn->userId)
+                                                  : server::StrandExecutor::connectionKey(conn->fd);
     }
+    conn->inFlight.fetch_add(1, std::memory_order_relaxed);
+    executor->post(conn->strandKey, [conn, task = std::move(task)] {
+        task();
+        conn->inFlight.fetch_sub(1, std::memory_order_release);
+    });
 }
 
-void Server::removeClient(int clientFd) {
-    clientHandler->handleClientDisconnect(clientFd);
-    clientSockets.erase(clientFd);
-    clientBuffers.erase(clientFd);
-    close(clientFd);
+void Server::removeClient(std::shared_ptr<server::Connection> conn) {
+    // Stop watching the socket now; unregister and close it behind the
+    // requests already queued, so none of them sees a reused fd
+    connections.erase(conn->fd);
+    postToStrand(conn, [this, conn] {
+        clientHandler->handleClientDisconnect(*conn);
+        conn->close();
+    });
 }
 
 bool Server::start() {
@@ -185,8 +250,11 @@ bool Server::start() {
         return false;
     }
 
-    running = true;
-    
+    // Calls still work for signaling if the relay cannot bind
+    if (!mediaRelay->start() && logger::serverLogger) {
+        logger::serverLogger->warn("Media relay unavailable; voice calls will have no audio path");
+    }
+
     if (logger::serverLogger) {
         logger::serverLogger->info("Server started on port " + std::to_string(port));
     }
@@ -195,7 +263,7 @@ bool Server::start() {
 }
 
 void Server::run() {
-    if (!running) {
+    if (serverSocket < 0) {
         if (logger::serverLogger) {
             logger::serverLogger->error("Server not started");
         }
@@ -214,15 +282,21 @@ void Server::run() {
 
     while (running) {
         fd_set readfds;
+        fd_set writefds;
         FD_ZERO(&readfds);
+        FD_ZERO(&writefds);
         
-        // Add server socket
+        // Add server socket and the outbox wakeup
         FD_SET(serverSocket, &readfds);
-        int maxFd = serverSocket;
+        FD_SET(wakeup->fd(), &readfds);
+        int maxFd = std::max(serverSocket, wakeup->fd());
         
-        // Add all client sockets
-        for (int clientFd : clientSockets) {
+        // Add all client sockets; wait for writability only where output is queued
+        for (const auto& [clientFd, conn] : connections) {
             FD_SET(clientFd, &readfds);
+            if (conn->hasPendingOutput()) {
+                FD_SET(clientFd, &writefds);
+            }
             if (clientFd > maxFd) {
                 maxFd = clientFd;
             }
@@ -233,7 +307,7 @@ void Server::run() {
         timeout.tv_sec = 1;
         timeout.tv_usec = 0;
 
-        int activity = select(maxFd + 1, &readfds, nullptr, nullptr, &timeout);
+        int activity = select(maxFd + 1, &readfds, &writefds, nullptr, &timeout);
 
         if (activity < 0) {
             if (errno == EINTR) {
@@ -245,6 +319,11 @@ void Server::run() {
             break;
         }
 
+        // Reset before draining, so a push that lands after the drain wakes the next select()
+        if (FD_ISSET(wakeup->fd(), &readfds)) {
+            wakeup->clear();
+        }
+
         // Check for new connections
         if (FD_ISSET(serverSocket, &readfds)) {
             int newClient = acceptClient();
@@ -253,11 +332,38 @@ void Server::run() {
             }
         }
 
-        // Check for client data
-        std::vector<int> clientsToCheck(clientSockets.begin(), clientSockets.end());
+        // Check for client data. A handler can remove its own connection, so
+        // look each fd up again rather than iterating
+        std::vector<int> clientsToCheck;
+        clientsToCheck.reserve(connections.size());
+        for (const auto& entry : connections) {
+            clientsToCheck.push_back(entry.first);
+        }
         for (int clientFd : clientsToCheck) {
+            auto it = connections.find(clientFd);
+            if (it == connections.end()) {
+                continue;
+            }
             if (FD_ISSET(clientFd, &readfds)) {
-                handleClientData(clientFd);
+                std::shared_ptr<server::Connection> conn = it->second; // May be removed meanwhile
+                handleClientData(conn);
+            }
+        }
+
+        // Send what this pass queued (replies, pushes from any thread) plus
+        // whatever the socket refused before: one vectored write per connection
+        for (const auto& [clientFd, conn] : connections) {
+            if (conn->hasQueuedFrames() || FD_ISSET(clientFd, &writefds)) {
+                conn->flush();
+            }
+        }
+
+        // Writes to any connection (replies, pushes to other users) may have
+        // found it dead or not reading; close those now that no handler runs
+        for (int clientFd : clientsToCheck) {
+            auto it = connections.find(clientFd);
+            if (it != connections.end() && it->second->isBroken()) {
+                removeClient(it->second);
             }
         }
 
@@ -273,7 +379,13 @@ void Server::run() {
         // Periodically check for call timeouts
         auto elapsedTimeout = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastTimeoutCheck).count();
         if (elapsedTimeout >= timeoutCheckInterval) {
-            requestRouter->processTimeouts();
+            // Flushing acknowledgements talks to the database: off the loop
+            if (!timeoutsPending.exchange(true)) {
+                executor->post(server::StrandExecutor::maintenanceKey(), [this] {
+                    requestRouter->processTimeouts();
+                    timeoutsPending = false;
+                });
+            }
             lastTimeoutCheck = now;
         }
     }
@@ -281,16 +393,34 @@ void Server::run() {
     if (logger::serverLogger) {
         logger::serverLogger->info("Server event loop terminated");
     }
+    shutdown();
 }
 
 void Server::stop() {
     running = false;
+    wakeup->notify();
+}
+
+void Server::shutdown() {
+    if (shutDown) return;
+    shutDown = true;
+    running = false;
+
+    if (mediaRelay) {
+        mediaRelay->stop();
+    }
+
+    // Let queued requests finish before their connections go away
+    if (executor) {
+        executor->stop();
+    }
 
     // Close all client connections
-    for (int clientFd : clientSockets) {
-        close(clientFd);
+    for (const auto& entry : connections) {
+        connectionManager->detach(*entry.second);
+        entry.second->close();
     }
-    clientSockets.clear();
+    connections.clear();
 
     // Close server socket
     if (serverSocket >= 0) {
@@ -305,19 +435,16 @@ void Server::stop() {
 
 // Global server pointer for signal handling
 Server* g_server = nullptr;
+static_assert(std::atomic<bool>::is_always_lock_free, "Server::stop() is called from a signal handler");
 
-void signalHandler(int signum) {
-    std::cout << "\nSignal (" << signum << ") received. Shutting down server..." << std::endl;
+// Only async-signal-safe work here: stop() sets a flag and wakes select(),
+// and run() does the shutdown once the loop sees it
+void signalHandler(int) {
+    int savedErrno = errno;
     if (g_server) {
         g_server->stop();
     }
-    // Allow some time for cleanup if needed, or just exit
-    // exit(signum); 
-    // Better to let the main loop exit if possible, but stop() sets running=false.
-    // However, we are in a signal handler.
-    // If we exit here, destructors of main() variables won't run.
-    // But stop() has been called.
-    exit(signum);
+    errno = savedErrno;
 }
 
 // Main entry point
@@ -331,8 +458,12 @@ int main(int argc, char* argv[]) {
     if (argc > 1) {
         port = std::atoi(argv[1]);
     }
+    size_t workers = 0;
+    if (argc > 2) {
+        workers = static_cast<size_t>(std::max(0, std::atoi(argv[2])));
+    }
 
-    Server srv(port);
+    Server srv(port, Server::DEFAULT_DB_CONN, workers);
     g_server = &srv;
 
     // Handle signals gracefully
@@ -1,4 +1,5 @@
 #include "server/session.h"
+#include "server/connection.h"
 #include "common/utils.h"
 #include <chrono>
 #include <random>
@@ -24,6 +25,10 @@ std::string SessionManager::create_session(int user_id, int client_fd, const std
 
 void SessionManager::remove_session(const std::string& session_id) {
     std::lock_guard<std::mutex> lock(mutex_);
+    erase_session(session_id);
+}
+
+void SessionManager::erase_session(const std::string& session_id) {
     if (sessions_.count(session_id)) {
         for (auto it = fd_to_session_id_.begin(); it != fd_to_session_id_.end(); ++it) {
             if (it->second == session_id) {
@@ -50,6 +55,19 @@ int SessionManager::get_user_id_by_session(const std::string& session_id) {
     return -1;
 }
 
+int SessionManager::authenticate(Connection& conn, const std::string& session_id) {
+    if (!conn.isAuthenticated() || session_id.empty() || session_id != conn.sessionToken) {
+        return -1;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    if (now - conn.sessionTouchedAt >= TOUCH_INTERVAL) {
+        conn.sessionTouchedAt = now;
+        update_session(session_id);
+    }
+    return conn.userId;
+}
+
 int SessionManager::get_user_id_by_fd(int client_fd) {
     std::lock_guard<std::mutex> lock(mutex_);
     if (fd_to_session_id_.count(client_fd)) {
@@ -75,7 +93,8 @@ std::string SessionManager::get_user_role_by_fd(int client_fd) {
 void SessionManager::remove_session_by_fd(int client_fd) {
     std::lock_guard<std::mutex> lock(mutex_);
     if (fd_to_session_id_.count(client_fd)) {
-        remove_session(fd_to_session_id_[client_fd]);
+        std::string session_id = fd_to_session_id_[client_fd]; // erase_session drops the entry
+        erase_session(session_id);
     }
 }
 
@@ -0,0 +1,158 @@
+#include "server/strand_executor.h"
+#include "common/logger.h"
+#include <exception>
+
+namespace server {
+
+StrandExecutor::StrandExecutor(size_t workerCount) {
+    workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    // Start only once every queue exists, since workers steal from each other
+    for (size_t i = 0; i < workerCount; ++i) {
+        workers[i]->thread = std::thread(&StrandExecutor::workerLoop, this, i);
+    }
+}
+
+StrandExecutor::~StrandExecutor() {
+    stop();
+}
+
+void StrandExecutor::post(uint64_t key, Task task) {
+    if (isInline()) {
+        task();
+        executed.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    std::shared_ptr<Strand> strand;
+    {
+        Shard& shard = shardFor(key);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto& entry = shard.strands[key];
+        if (!entry) entry = std::make_shared<Strand>(key);
+        entry->tasks.push_back(std::move(task));
+        if (entry->scheduled) {
+            return; // Runs after the tasks ahead of it
+        }
+        entry->scheduled = true;
+        strand = entry;
+    }
+    schedule(std::move(strand), key % workers.size());
+}
+
+void StrandExecutor::schedule(std::shared_ptr<Strand> strand, size_t worker) {
+    {
+        std::lock_guard<std::mutex> lock(workers[worker]->mutex);
+        workers[worker]->ready.push_back(std::move(strand));
+    }
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        ++readyCount;
+    }
+    idle.notify_one();
+}
+
+std::shared_ptr<StrandExecutor::Strand> StrandExecutor::take(size_t self) {
+    std::shared_ptr<Strand> strand;
+    {
+        Worker& own = *workers[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.ready.empty()) {
+            strand = std::move(own.ready.front());
+            own.ready.pop_front();
+        }
+    }
+
+    // Steal from the back: the strands the victim would reach last
+    for (size_t i = 1; !strand && i < workers.size(); ++i) {
+        Worker& victim = *workers[(self + i) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.ready.empty()) {
+            strand = std::move(victim.ready.back());
+            victim.ready.pop_back();
+            stolen.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    if (strand) {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        --readyCount;
+    }
+    return strand;
+}
+
+void StrandExecutor::runStrand(std::shared_ptr<Strand> strand, size_t self) {
+    Shard& shard = shardFor(strand->key);
+    for (size_t n = 0; n < STRAND_BATCH; ++n) {
+        Task task;
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (strand->tasks.empty()) {
+                // Drained: the next post for this key starts a new strand
+                strand->scheduled = false;
+                shard.strands.erase(strand->key);
+                return;
+            }
+            task = std::move(strand->tasks.front());
+            strand->tasks.pop_front();
+        }
+
+        try {
+            task();
+        } catch (const std::exception& e) {
+            if (logger::serverLogger) {
+                logger::serverLogger->error(std::string("Unhandled exception in strand task: ") + e.what());
+            }
+        }
+        executed.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Still scheduled, so nothing else runs it meanwhile; requeue behind the others
+    schedule(std::move(strand), self);
+}
+
+void StrandExecutor::workerLoop(size_t self) {
+    while (true) {
+        std::shared_ptr<Strand> strand = take(self);
+        if (strand) {
+            runStrand(std::move(strand), self);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(idleMutex);
+        if (readyCount > 0) continue;
+        if (stopping) return;
+        idle.wait(lock, [this] { return readyCount > 0 || stopping; });
+    }
+}
+
+void StrandExecutor::stop() {
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        if (stopping) return;
+        stopping = true;
+    }
+    idle.notify_all();
+
+    for (auto& worker : workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+
+    if (logger::serverLogger && !workers.empty()) {
+        Stats s = stats();
+        logger::serverLogger->info("Strand executor stopped: " + std::to_string(s.executed) + " tasks, " +
+                                   std::to_string(s.stolen) + " strands stolen");
+    }
+    workers.clear();
+}
+
+StrandExecutor::Stats StrandExecutor::stats() const {
+    Stats s;
+    s.executed = executed.load(std::memory_order_relaxed);
+    s.stolen = stolen.load(std::memory_order_relaxed);
+    return s;
+}
+
+} // namespace server
@@ -0,0 +1,116 @@
+// Encode + decode of a 200-message chat history: the hand-written split/join
+// codec Payloads used before the descriptors, against the generated text
+// codec and the binary codec.
+
+#include "test_support.h"
+#include "common/payloads.h"
+#include "common/utils.h"
+#include <cstdio>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+// The pre-descriptor ChatMessageDTO/ChatHistoryDTO, verbatim apart from names
+namespace legacy {
+
+struct ChatMessageDTO {
+    std::string sender;
+    std::string messageType;
+    std::string content;
+    std::string timestamp;
+
+    std::string serialize() const {
+        std::vector<std::string> parts = {sender, messageType, content, timestamp};
+        return utils::join(parts, ';');
+    }
+
+    void deserialize(const std::string& raw) {
+        auto parts = utils::split(raw, ';');
+        if (parts.size() >= 1) sender = parts[0];
+        if (parts.size() >= 2) messageType = parts[1];
+        if (parts.size() >= 3) content = parts[2];
+        if (parts.size() >= 4) timestamp = parts[3];
+    }
+};
+
+struct ChatHistoryDTO {
+    std::vector<ChatMessageDTO> messages;
+
+    std::string serialize() const {
+        std::string result;
+        for (size_t i = 0; i < messages.size(); ++i) {
+            result += messages[i].serialize();
+            if (i < messages.size() - 1) result += "|";
+        }
+        return result;
+    }
+
+    void deserialize(const std::string& data) {
+        messages.clear();
+        std::stringstream ss(data);
+        std::string segment;
+        while (std::getline(ss, segment, '|')) {
+            ChatMessageDTO msg;
+            msg.deserialize(segment);
+            messages.push_back(msg);
+        }
+    }
+};
+
+} // namespace legacy
+
+constexpr int MESSAGES = 200;
+constexpr int ITERATIONS = 2000;
+
+std::string content(int i) {
+    return "Message " + std::to_string(i) + ": see you after class, bring the workbook and the audio notes";
+}
+
+} // namespace
+
+int main() {
+    legacy::ChatHistoryDTO oldHistory;
+    Payloads::ChatHistoryDTO history;
+    for (int i = 0; i < MESSAGES; ++i) {
+        oldHistory.messages.push_back({"user" + std::to_string(i % 7), "TEXT", content(i), "2026-10-19 08:15:00"});
+        Payloads::ChatMessageDTO dto;
+        dto.sender = oldHistory.messages.back().sender;
+        dto.messageType = "TEXT";
+        dto.content = content(i);
+        dto.timestamp = "2026-10-19 08:15:00";
+        history.messages.push_back(dto);
+    }
+
+    // The generated text codec must stay byte-identical to the old one
+    std::string oldText = oldHistory.serialize();
+    CHECK(history.serialize() == oldText);
+
+    size_t binarySize = 0;
+    double splitJoin = testing::timeMicros(ITERATIONS, [&] {
+        legacy::ChatHistoryDTO decoded;
+        decoded.deserialize(oldHistory.serialize());
+        CHECK(decoded.messages.size() == MESSAGES);
+    });
+    double text = testing::timeMicros(ITERATIONS, [&] {
+        Payloads::ChatHistoryDTO decoded;
+        decoded.deserialize(history.serialize());
+        CHECK(decoded.messages.size() == MESSAGES);
+    });
+    double binary = testing::timeMicros(ITERATIONS, [&] {
+        codec::BinaryWriter w;
+        history.encode(w);
+        binarySize = w.data().size();
+        codec::BinaryReader r(w.data());
+        Payloads::ChatHistoryDTO decoded;
+        decoded.decode(r);
+        CHECK(decoded.messages.size() == MESSAGES);
+    });
+
+    std::printf("%d-message history, encode + decode, mean of %d runs\n", MESSAGES, ITERATIONS);
+    std::printf("  %-22s %8.1f us  %6zu bytes\n", "split/join (old)", splitJoin, oldText.size());
+    std::printf("  %-22s %8.1f us  %6zu bytes\n", "generated text", text, oldText.size());
+    std::printf("  %-22s %8.1f us  %6zu bytes\n", "binary", binary, binarySize);
+    return testing::testResult("codec_bench");
+}
@@ -0,0 +1,236 @@
+// Round trips between the text and binary payload codecs
+// (common/payload_fields.h, common/binary_codec.h) and through a full frame.
+
+#include "test_support.h"
+#include "common/payloads.h"
+#include "common/protocol.h"
+#include <stdexcept>
+#include <string>
+
+namespace {
+
+// Every separator the text formats use, in user content
+const std::string DELIMITERS = "a;b|c^d~e,f";
+
+bool sameMessage(const Payloads::ChatMessageDTO& a, const Payloads::ChatMessageDTO& b) {
+    return a.sender == b.sender && a.messageType == b.messageType && a.content == b.content &&
+           a.timestamp == b.timestamp;
+}
+
+Payloads::ChatMessageDTO message(const std::string& content) {
+    Payloads::ChatMessageDTO dto;
+    dto.sender = "alice";
+    dto.messageType = "TEXT";
+    dto.content = content;
+    dto.timestamp = "2026-10-19 08:15:00";
+    return dto;
+}
+
+template <typename T>
+T binaryRoundTrip(const T& dto) {
+    codec::BinaryWriter w;
+    dto.encode(w);
+    std::string bytes = w.release();
+    codec::BinaryReader r(bytes);
+    T decoded;
+    decoded.decode(r);
+    return decoded;
+}
+
+void binaryKeepsDelimitersInContent() {
+    auto original = message(DELIMITERS);
+    original.sender = "bob;|^~,";
+    auto decoded = binaryRoundTrip(original);
+    CHECK(sameMessage(decoded, original));
+
+    // Every byte value, including NUL and the separators
+    std::string allBytes;
+    for (int c = 0; c < 256; ++c) allBytes.push_back(static_cast<char>(c));
+    CHECK(binaryRoundTrip(message(allBytes)).content == allBytes);
+}
+
+void textToBinaryAndBack() {
+    // A legacy text payload converts to binary and back byte for byte
+    const std::string text = "alice;TEXT;see you at 5, ok? ^_^ ~bye;2026-10-19 08:15:00";
+    Payloads::ChatMessageDTO fromText;
+    fromText.deserialize(text);
+    CHECK(fromText.content == "see you at 5, ok? ^_^ ~bye");
+
+    auto viaBinary = binaryRoundTrip(fromText);
+    CHECK(sameMessage(viaBinary, fromText));
+    CHECK(viaBinary.serialize() == text);
+}
+
+void binaryToTextForNestedSeparators() {
+    // ',' '^' '~' are not ChatMessageDTO separators, so they survive text too;
+    // ';' and '|' only survive the binary codec
+    auto original = message("x,y^z~w");
+    Payloads::ChatMessageDTO viaText;
+    viaText.deserialize(binaryRoundTrip(original).serialize());
+    CHECK(sameMessage(viaText, original));
+
+    Payloads::ChatMessageDTO lossy;
+    lossy.deserialize(message(DELIMITERS).serialize());
+    CHECK(lossy.content != DELIMITERS);
+}
+
+void listsRoundTrip() {
+    Payloads::ChatHistoryDTO history;
+    for (int i = 0; i < 200; ++i) history.messages.push_back(message(DELIMITERS + std::to_string(i)));
+    auto decoded = binaryRoundTrip(history);
+    CHECK(decoded.messages.size() == history.messages.size());
+    bool allSame = decoded.messages.size() == history.messages.size();
+    for (size_t i = 0; allSame && i < decoded.messages.size(); ++i) {
+        allSame = sameMessage(decoded.messages[i], history.messages[i]);
+    }
+    CHECK(allSame);
+
+    // ListDTO and its incremental writer produce the same bytes in both codecs
+    Payloads::ListDTO<Payloads::ChatMessageDTO> list;
+    list.items = history.messages;
+    for (bool binary : {false, true}) {
+        Payloads::ListDTOWriter<Payloads::ChatMessageDTO> writer(binary);
+        std::string streamed = writer.header(list.items.size());
+        for (const auto& item : list.items) streamed += writer.item(item);
+        CHECK(Payloads::encode(protocol::MsgCode::CHAT_HISTORY_SUCCESS, list, binary).toString() == streamed);
+    }
+
+    Payloads::ChatHistoryDTO empty;
+    CHECK(binaryRoundTrip(empty).messages.empty());
+}
+
+void throughAFrame() {
+    for (bool binary : {false, true}) {
+        // Only the binary codec carries the text formats' own separators
+        Payloads::ChatHistoryDTO history;
+        history.messages.push_back(message(binary ? DELIMITERS : "x,y^z~w"));
+        protocol::Message msg = Payloads::encode(protocol::MsgCode::CHAT_HISTORY_SUCCESS, history, binary);
+        protocol::Message received = protocol::Message::deserialize(msg.serialize(42, false));
+        CHECK(received.binary == binary);
+        CHECK(received.correlationId == 42u);
+
+        Payloads::ChatHistoryDTO decoded;
+        Payloads::decode(received, decoded);
+        CHECK(decoded.messages.size() == 1);
+        if (decoded.messages.size() == 1) CHECK(sameMessage(decoded.messages[0], history.messages[0]));
+    }
+}
+
+void inPlaceViews() {
+    // A view borrows the payload from the frame; decoding it matches a copy
+    for (bool binary : {false, true}) {
+        auto original = message(binary ? DELIMITERS : "x,y^z~w");
+        std::vector<uint8_t> frame =
+            Payloads::encode(protocol::MsgCode::CHAT_PRIVATE_RECEIVE, original, binary).serialize(7, false);
+        protocol::Message view = protocol::Message::deserializeView(frame.data(), frame.size());
+        CHECK(view.data.empty());
+        CHECK(view.payload() == frame.data() + 10);
+        CHECK(view.payloadSize() == frame.size() - 10);
+
+        Payloads::ChatMessageDTO decoded;
+        Payloads::decode(view, decoded);
+        CHECK(sameMessage(decoded, original));
+        CHECK(view.serialize(7, false) == frame);
+    }
+
+    // Batched frames borrow from the batch, which borrows from the frame
+    std::vector<uint8_t> frames;
+    for (const char* content : {"one", "two"}) {
+        auto part = Payloads::encode(protocol::MsgCode::CHAT_PRIVATE_RECEIVE, message(content), true).serialize();
+        frames.insert(frames.end(), part.begin(), part.end());
+    }
+    std::vector<uint8_t> batch = protocol::Message(protocol::MsgCode::BATCH_REQUEST, frames).serialize();
+    protocol::Message outer = protocol::Message::deserializeView(batch.data(), batch.size());
+    auto inner = protocol::unpackFrameViews(outer);
+    CHECK(inner.size() == 2);
+    if (inner.size() == 2) {
+        CHECK(inner[1].payload() > batch.data() && inner[1].payload() < batch.data() + batch.size());
+        Payloads::ChatMessageDTO second;
+        Payloads::decode(inner[1], second);
+        CHECK(second.content == "two");
+    }
+
+    // A frame running past the batch is rejected, not read beyond it
+    frames.pop_back();
+    protocol::Message cut(protocol::MsgCode::BATCH_REQUEST, frames);
+    CHECK(testing::throws<std::runtime_error>([&] { protocol::unpackFrameViews(cut); }));
+}
+
+void olderWritersAndTruncation() {
+    // Fields an older writer never sent keep their defaults
+    codec::BinaryWriter w;
+    w.writeString("alice");
+    w.writeString("TEXT");
+    codec::BinaryReader r(w.data());
+    Payloads::ChatMessageDTO partial;
+    partial.content = "unchanged";
+    partial.decode(r);
+    CHECK(partial.sender == "alice");
+    CHECK(partial.content == "unchanged");
+
+    // A field cut short is an error, not a silently shortened value
+    codec::BinaryWriter full;
+    message(DELIMITERS).encode(full);
+    std::string cut = full.data().substr(0, full.data().size() - 3);
+    CHECK(testing::throws<std::runtime_error>([&] {
+        codec::BinaryReader reader(cut);
+        Payloads::ChatMessageDTO dto;
+        dto.decode(reader);
+    }));
+
+    // A wrong wire type is rejected
+    codec::BinaryWriter ints;
+    ints.writeInt(7);
+    CHECK(testing::throws<std::runtime_error>([&] {
+        codec::BinaryReader reader(ints.data());
+        Payloads::ChatMessageDTO dto;
+        dto.decode(reader);
+    }));
+}
+
+void integersAndBooleans() {
+    Payloads::RecentChatDTO chat;
+    for (int id : {0, 1, -1, 63, -64, 64, 1 << 20, -(1 << 30)}) {
+        chat.userId = id;
+        CHECK(binaryRoundTrip(chat).userId == id);
+        Payloads::RecentChatDTO viaText;
+        viaText.deserialize(chat.serialize());
+        CHECK(viaText.userId == id);
+    }
+
+    Payloads::GenericResponse response;
+    response.success = true;
+    response.message = DELIMITERS;
+    auto decoded = binaryRoundTrip(response);
+    CHECK(decoded.success);
+    CHECK(decoded.message == DELIMITERS);
+}
+
+void trailingMessageId() {
+    // Pushes carry the id; everything else stays in the four-field form
+    auto plain = message("hi");
+    CHECK(plain.serialize() == "alice;TEXT;hi;2026-10-19 08:15:00");
+
+    auto pushed = message(DELIMITERS);
+    pushed.messageId = "42";
+    Payloads::ChatMessageDTO viaText;
+    viaText.deserialize(message("hi").serialize() + ";42");
+    CHECK(viaText.messageId == "42");
+    CHECK(binaryRoundTrip(pushed).messageId == "42");
+    CHECK(binaryRoundTrip(plain).messageId.empty());
+}
+
+} // namespace
+
+int main() {
+    binaryKeepsDelimitersInContent();
+    textToBinaryAndBack();
+    binaryToTextForNestedSeparators();
+    listsRoundTrip();
+    throughAFrame();
+    inPlaceViews();
+    olderWritersAndTruncation();
+    integersAndBooleans();
+    trailingMessageId();
+    return testing::testResult("codec_roundtrip_test");
+}
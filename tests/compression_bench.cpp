@@ -0,0 +1,65 @@
+// Size and speed of payload compression (common/compression.h) on the traffic
+// fixture: with the preset dictionary against the same deflate without it.
+
+#include "test_support.h"
+#include "traffic_fixture.h"
+#include "common/compression.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+namespace {
+
+constexpr int ITERATIONS = 2000;
+
+size_t plainDeflateSize(const std::vector<uint8_t>& data) {
+    z_stream zs{};
+    deflateInit2(&zs, 6, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    std::vector<uint8_t> out(deflateBound(&zs, static_cast<uLong>(data.size())));
+    zs.next_in = const_cast<Bytef*>(data.data());
+    zs.avail_in = static_cast<uInt>(data.size());
+    zs.next_out = out.data();
+    zs.avail_out = static_cast<uInt>(out.size());
+    deflate(&zs, Z_FINISH);
+    size_t size = zs.total_out;
+    deflateEnd(&zs);
+    return 4 + size;
+}
+
+} // namespace
+
+int main() {
+    auto traffic = testing::loadTraffic();
+    CHECK(!traffic.empty());
+
+    std::printf("Payload compression, mean of %d runs (bytes include the 4B length)\n", ITERATIONS);
+    std::printf("  %-20s %7s %9s %9s %10s %10s\n", "record", "raw", "no dict", "dict", "deflate", "inflate");
+
+    size_t totalRaw = 0, totalPlain = 0, totalDict = 0;
+    for (const auto& record : traffic) {
+        std::vector<uint8_t> original(record.payload.begin(), record.payload.end());
+        std::vector<uint8_t> deflated;
+        bool compressed = compression::deflatePayload(original.data(), original.size(), deflated);
+        size_t plain = plainDeflateSize(original);
+        totalRaw += original.size();
+        totalPlain += std::min(plain, original.size());
+        totalDict += compressed ? deflated.size() : original.size();
+
+        if (!compressed) {
+            std::printf("  %-20s %7zu %9zu %9s\n", record.name.c_str(), original.size(), plain, "as is");
+            continue;
+        }
+
+        double deflateTime = testing::timeMicros(ITERATIONS, [&] {
+            compression::deflatePayload(original.data(), original.size(), deflated);
+        });
+        double inflateTime = testing::timeMicros(ITERATIONS, [&] {
+            CHECK(compression::inflatePayload(deflated.data(), deflated.size()).size() == original.size());
+        });
+        std::printf("  %-20s %7zu %9zu %9zu %7.1f us %7.1f us\n", record.name.c_str(), original.size(), plain,
+                    deflated.size(), deflateTime, inflateTime);
+    }
+    std::printf("  %-20s %7zu %9zu %9zu\n", "total", totalRaw, totalPlain, totalDict);
+    return testing::testResult("compression_bench");
+}
@@ -0,0 +1,193 @@
+// deflatePayload/inflatePayload (common/compression.h) over the traffic
+// fixture, with the preset dictionary, and through a compressed frame.
+
+#include "test_support.h"
+#include "traffic_fixture.h"
+#include "common/compression.h"
+#include "common/protocol.h"
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+namespace {
+
+std::vector<uint8_t> bytes(const std::string& s) { return std::vector<uint8_t>(s.begin(), s.end()); }
+
+// The same raw deflate stream without the preset dictionary, for comparison
+size_t plainDeflateSize(const std::vector<uint8_t>& data) {
+    z_stream zs{};
+    deflateInit2(&zs, 6, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    std::vector<uint8_t> out(deflateBound(&zs, static_cast<uLong>(data.size())));
+    zs.next_in = const_cast<Bytef*>(data.data());
+    zs.avail_in = static_cast<uInt>(data.size());
+    zs.next_out = out.data();
+    zs.avail_out = static_cast<uInt>(out.size());
+    deflate(&zs, Z_FINISH);
+    size_t size = zs.total_out;
+    deflateEnd(&zs);
+    return 4 + size;
+}
+
+// Inflate a deflatePayload() stream without priming the dictionary
+bool inflatesWithoutDictionary(const std::vector<uint8_t>& deflated, const std::vector<uint8_t>& original) {
+    z_stream zs{};
+    inflateInit2(&zs, -15);
+    std::vector<uint8_t> out(original.size());
+    zs.next_in = const_cast<Bytef*>(deflated.data() + 4);
+    zs.avail_in = static_cast<uInt>(deflated.size() - 4);
+    zs.next_out = out.data();
+    zs.avail_out = static_cast<uInt>(out.size());
+    int rc = inflate(&zs, Z_FINISH);
+    inflateEnd(&zs);
+    return rc == Z_STREAM_END && out == original;
+}
+
+void fixtureRoundTrips() {
+    auto traffic = testing::loadTraffic();
+    CHECK(traffic.size() >= 8);
+
+    for (const auto& record : traffic) {
+        auto original = bytes(record.payload);
+        std::vector<uint8_t> deflated;
+        bool compressed = compression::deflatePayload(original.data(), original.size(), deflated);
+        if (original.size() < compression::MIN_COMPRESS_SIZE) continue;
+
+        CHECK_CASE(compressed, record.name);
+        if (!compressed) continue;
+        CHECK_CASE(deflated.size() < original.size(), record.name);
+        CHECK_CASE(compression::inflatePayload(deflated.data(), deflated.size()) == original, record.name);
+
+        // Protocol text draws on the dictionary and compresses better for it;
+        // the Base64 chunk shares nothing with it
+        if (record.name == "blob_chunk") continue;
+        CHECK_CASE(!inflatesWithoutDictionary(deflated, original), record.name);
+        CHECK_CASE(deflated.size() < plainDeflateSize(original), record.name);
+    }
+}
+
+void notWorthCompressing() {
+    std::vector<uint8_t> out{1, 2, 3};
+    CHECK(!compression::deflatePayload(nullptr, 0, out));
+    CHECK(out.empty());
+
+    // Random bytes do not shrink, so they are sent as is
+    std::mt19937 rng(36);
+    std::vector<uint8_t> noise(4096);
+    for (auto& b : noise) b = static_cast<uint8_t>(rng());
+    CHECK(!compression::deflatePayload(noise.data(), noise.size(), out));
+    CHECK(out.empty());
+}
+
+void corruptInputThrows() {
+    auto original = bytes(testing::loadTraffic().at(2).payload);
+    std::vector<uint8_t> deflated;
+    CHECK(compression::deflatePayload(original.data(), original.size(), deflated));
+
+    auto inflate = [](std::vector<uint8_t> data) {
+        return testing::throws<std::runtime_error>([&] { compression::inflatePayload(data.data(), data.size()); });
+    };
+
+    // Shorter than the length prefix
+    CHECK(inflate({0, 0, 1}));
+
+    // Stream cut short
+    CHECK(inflate(std::vector<uint8_t>(deflated.begin(), deflated.end() - 8)));
+
+    // Declared length longer or shorter than what the stream holds
+    auto longer = deflated;
+    longer[3] ^= 0x01;
+    CHECK(inflate(longer));
+
+    // A length prefix beyond MAX_INFLATED_SIZE is refused before allocating
+    auto huge = deflated;
+    huge[0] = 0xFF;
+    CHECK(inflate(huge));
+
+    // Garbage in the stream
+    auto garbage = deflated;
+    for (size_t i = 4; i < garbage.size(); i += 3) garbage[i] ^= 0x5A;
+    CHECK(inflate(garbage));
+}
+
+void tinyFrameHugePrefix() {
+    // A few bytes of stream claiming the whole frame limit: more than deflate
+    // could ever expand them to, so refused without inflating
+    std::vector<uint8_t> tiny = {0x01, 0x00, 0x00, 0x00, 0x63, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+    CHECK(testing::throws<std::runtime_error>([&] { compression::inflatePayload(tiny.data(), tiny.size()); }));
+
+    // Same inside a frame, and past MAX_FRAME_SIZE however long the stream
+    std::vector<uint8_t> padding(20, 0);
+    protocol::Message msg(protocol::MsgCode::HEARTBEAT, padding);
+    std::vector<uint8_t> frame = msg.serialize(0, false);
+    frame[4] |= protocol::COMPRESSED_PAYLOAD_FLAG >> 8;
+    frame[6] = 0x00;
+    frame[7] = 0xFF;
+    frame[8] = 0xFF;
+    frame[9] = 0xFF;
+    CHECK(testing::throws<std::runtime_error>([&] { protocol::Message::deserialize(frame); }));
+    frame[6] = 0x01;
+    frame[7] = 0x00;
+    frame[8] = 0x00;
+    frame[9] = 0x01;
+    CHECK(testing::throws<std::runtime_error>([&] { protocol::Message::deserialize(frame); }));
+
+    // A well-formed stream that really is large still inflates: the output
+    // grows past the first buffer up to the declared size
+    std::string large;
+    while (large.size() < 4 * 1024 * 1024) large += "{\"text\": \"Fill in the blank\", \"answer\": \"" +
+                                                    std::to_string(large.size()) + "\"}, ";
+    std::vector<uint8_t> original = bytes(large);
+    std::vector<uint8_t> deflated;
+    CHECK(compression::deflatePayload(original.data(), original.size(), deflated));
+    CHECK(compression::inflatePayload(deflated.data(), deflated.size()) == original);
+
+    // The declared size must be exact: one less stops short of the stream end
+    deflated[3] -= 1;
+    CHECK(testing::throws<std::runtime_error>([&] { compression::inflatePayload(deflated.data(), deflated.size()); }));
+}
+
+void onlyWhenNegotiated() {
+    auto payload = testing::loadTraffic().at(2).payload;
+    protocol::Message msg(protocol::MsgCode::HEARTBEAT, payload);
+    std::vector<uint8_t> frame = msg.serialize(0, true);
+    CHECK(protocol::Message::deserialize(frame.data(), frame.size(), true).toString() == payload);
+    CHECK(testing::throws<std::runtime_error>(
+        [&] { protocol::Message::deserialize(frame.data(), frame.size(), false); }));
+
+    // Uncompressed frames are fine either way, and so is a batch of them
+    std::vector<uint8_t> plain = msg.serialize(0, false);
+    CHECK(protocol::Message::deserialize(plain.data(), plain.size(), false).toString() == payload);
+    CHECK(testing::throws<std::runtime_error>([&] { protocol::unpackFrames(frame, false); }));
+    CHECK(protocol::unpackFrames(plain, false).size() == 1);
+}
+
+void throughAFrame() {
+    for (const auto& record : testing::loadTraffic()) {
+        protocol::Message msg(protocol::MsgCode::HEARTBEAT, record.payload);
+        std::vector<uint8_t> frame = msg.serialize(9, true);
+
+        uint16_t rawCode = static_cast<uint16_t>((frame[4] << 8) | frame[5]);
+        bool flagged = (rawCode & protocol::COMPRESSED_PAYLOAD_FLAG) != 0;
+        bool shouldCompress = record.payload.size() >= compression::MIN_COMPRESS_SIZE;
+        CHECK_CASE(flagged == shouldCompress, record.name);
+        if (flagged) CHECK_CASE(frame.size() < msg.serialize(9, false).size(), record.name);
+
+        protocol::Message received = protocol::Message::deserialize(frame);
+        CHECK_CASE(received.toString() == record.payload, record.name);
+        CHECK_CASE(received.correlationId == 9u, record.name);
+    }
+}
+
+} // namespace
+
+int main() {
+    fixtureRoundTrips();
+    notWorthCompressing();
+    corruptInputThrows();
+    tinyFrameHugePrefix();
+    onlyWhenNegotiated();
+    throughAFrame();
+    return testing::testResult("compression_test");
+}
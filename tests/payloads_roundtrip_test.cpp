@@ -0,0 +1,218 @@
+// Every Payloads DTO through both codecs. Values are generated from each
+// type's fields() descriptor, so a field added to a DTO is covered without
+// touching this file; a new DTO must be added to roundTripAll(), which
+// everySerializableIsCovered() enforces against common/payloads.h.
+
+#include "test_support.h"
+#include "common/payloads.h"
+#include "common/protocol.h"
+#include <fstream>
+#include <regex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+// Distinct, non-default values for every field. With delimiters set, strings
+// carry every separator the text formats use (binary only).
+struct Sampler {
+    bool delimiters;
+    int next = 0;
+};
+
+void fillValue(std::string& value, Sampler& s) {
+    value = "v" + std::to_string(++s.next) + (s.delimiters ? " a;b|c^d~e,f" : "");
+}
+
+void fillValue(int& value, Sampler& s) {
+    ++s.next;
+    value = (s.next % 2 ? -1 : 1) * s.next * 37;
+}
+
+void fillValue(bool& value, Sampler&) { value = true; }
+
+template <typename T>
+void fillValue(T& dto, Sampler& s);
+
+template <typename T>
+void fillValue(std::vector<T>& items, Sampler& s) {
+    items.resize(2);
+    for (auto& item : items) fillValue(item, s);
+}
+
+template <typename T>
+void fillValue(T& dto, Sampler& s) {
+    std::apply([&](const auto&... field) { (fillValue(dto.*field.member, s), ...); }, T::fields().fields);
+}
+
+inline bool sameValue(const std::string& a, const std::string& b) { return a == b; }
+inline bool sameValue(int a, int b) { return a == b; }
+inline bool sameValue(bool a, bool b) { return a == b; }
+
+template <typename T>
+bool sameValue(const T& a, const T& b);
+
+template <typename T>
+bool sameValue(const std::vector<T>& a, const std::vector<T>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (!sameValue(a[i], b[i])) return false;
+    }
+    return true;
+}
+
+template <typename T>
+bool sameValue(const T& a, const T& b) {
+    return std::apply([&](const auto&... field) { return (sameValue(a.*field.member, b.*field.member) && ...); },
+                      T::fields().fields);
+}
+
+template <typename T>
+T sample(bool delimiters) {
+    Sampler s{delimiters};
+    T dto{};
+    fillValue(dto, s);
+    return dto;
+}
+
+template <typename T>
+T viaFrame(const T& dto, bool binary) {
+    protocol::Message sent = Payloads::encode(protocol::MsgCode::HEARTBEAT, dto, binary);
+    protocol::Message received = protocol::Message::deserialize(sent.serialize(7, false));
+    T decoded{};
+    Payloads::decode(received, decoded);
+    return decoded;
+}
+
+std::set<std::string> covered;
+
+template <typename T>
+void roundTrip(const char* name) {
+    covered.insert(name);
+
+    // Binary keeps any content
+    T binary = sample<T>(true);
+    CHECK_CASE(sameValue(viaFrame(binary, true), binary), name);
+
+    // Text keeps content free of its separators, and converts to binary and
+    // back without changing a byte
+    T text = sample<T>(false);
+    T fromText = viaFrame(text, false);
+    CHECK_CASE(sameValue(fromText, text), name);
+    CHECK_CASE(viaFrame(fromText, true).serialize() == text.serialize(), name);
+
+    // Defaults survive too (empty strings, zero, false, empty lists)
+    T empty{};
+    CHECK_CASE(sameValue(viaFrame(empty, true), empty), name);
+}
+
+// List responses: ListDTO in both codecs, with and without the count
+template <typename T, bool WithCount>
+void listRoundTrip(const char* name) {
+    Payloads::ListDTO<T, WithCount> list;
+    Sampler s{false};
+    list.items.resize(3);
+    for (auto& item : list.items) fillValue(item, s);
+
+    for (bool binary : {false, true}) {
+        Payloads::ListDTO<T, WithCount> decoded = viaFrame(list, binary);
+        CHECK_CASE(sameValue(decoded.items, list.items), name);
+    }
+}
+
+void roundTripAll() {
+    using namespace Payloads;
+    // The comparison itself must see a difference, or every check below is vacuous
+    CHECK(!sameValue(sample<ResultDetailDTO>(true), sample<ResultDetailDTO>(false)));
+
+    roundTrip<LoginRequest>("LoginRequest");
+    roundTrip<LessonListRequest>("LessonListRequest");
+    roundTrip<SubmitAnswerRequest>("SubmitAnswerRequest");
+    roundTrip<StudyLessonRequest>("StudyLessonRequest");
+    roundTrip<PrivateMessageRequest>("PrivateMessageRequest");
+    roundTrip<ChatHistoryRequest>("ChatHistoryRequest");
+    roundTrip<ExerciseListRequest>("ExerciseListRequest");
+    roundTrip<StudyExerciseRequest>("StudyExerciseRequest");
+    roundTrip<SpecificExerciseRequest>("SpecificExerciseRequest");
+    roundTrip<ResultRequest>("ResultRequest");
+    roundTrip<ResultListRequest>("ResultListRequest");
+    roundTrip<ExamListRequest>("ExamListRequest");
+    roundTrip<ExamRequest>("ExamRequest");
+    roundTrip<GenericResponse>("GenericResponse");
+    roundTrip<LessonMetadataDTO>("LessonMetadataDTO");
+    roundTrip<LessonDTO>("LessonDTO");
+    roundTrip<ExerciseMetadataDTO>("ExerciseMetadataDTO");
+    roundTrip<ExerciseDTO>("ExerciseDTO");
+    roundTrip<ExamMetadataDTO>("ExamMetadataDTO");
+    roundTrip<ExamDTO>("ExamDTO");
+    roundTrip<ResultDTO>("ResultDTO");
+    roundTrip<ResultSummaryDTO>("ResultSummaryDTO");
+    roundTrip<PendingSubmissionsRequest>("PendingSubmissionsRequest");
+    roundTrip<GradeSubmissionRequest>("GradeSubmissionRequest");
+    roundTrip<SubmissionDTO>("SubmissionDTO");
+    roundTrip<FeedbackDTO>("FeedbackDTO");
+    roundTrip<AddFeedbackRequest>("AddFeedbackRequest");
+    roundTrip<ResultDetailRequest>("ResultDetailRequest");
+    roundTrip<QuestionResultDTO>("QuestionResultDTO");
+    roundTrip<ResultDetailDTO>("ResultDetailDTO");
+    roundTrip<ChatMessageDTO>("ChatMessageDTO");
+    roundTrip<ChatHistoryDTO>("ChatHistoryDTO");
+    roundTrip<RecentChatsRequest>("RecentChatsRequest");
+    roundTrip<RecentChatDTO>("RecentChatDTO");
+    roundTrip<RecentChatsDTO>("RecentChatsDTO");
+    roundTrip<GameListRequest>("GameListRequest");
+    roundTrip<GameMetadataDTO>("GameMetadataDTO");
+    roundTrip<GameLevelListRequest>("GameLevelListRequest");
+    roundTrip<GameLevelDTO>("GameLevelDTO");
+    roundTrip<GameDataRequest>("GameDataRequest");
+    roundTrip<GameDataDTO>("GameDataDTO");
+    roundTrip<GameSubmitRequest>("GameSubmitRequest");
+    roundTrip<GameCreateRequest>("GameCreateRequest");
+    roundTrip<GameDeleteRequest>("GameDeleteRequest");
+    roundTrip<GameUpdateRequest>("GameUpdateRequest");
+    roundTrip<VoiceCallRequest>("VoiceCallRequest");
+    roundTrip<VoiceCallNotification>("VoiceCallNotification");
+    roundTrip<ChatReadAck>("ChatReadAck");
+    roundTrip<UnreadItemDTO>("UnreadItemDTO");
+    roundTrip<UnreadDigestDTO>("UnreadDigestDTO");
+    roundTrip<DeliveryAck>("DeliveryAck");
+    roundTrip<CallMediaInfo>("CallMediaInfo");
+    roundTrip<BlobUploadChunk>("BlobUploadChunk");
+    roundTrip<BlobUploadResult>("BlobUploadResult");
+    roundTrip<BlobDownloadRequest>("BlobDownloadRequest");
+    roundTrip<BlobDownloadFailure>("BlobDownloadFailure");
+    roundTrip<BlobChunkDTO>("BlobChunkDTO");
+    roundTrip<HelloDTO>("HelloDTO");
+
+    listRoundTrip<LessonMetadataDTO, true>("ListDTO<LessonMetadataDTO>");
+    listRoundTrip<SubmissionDTO, true>("ListDTO<SubmissionDTO>");
+    listRoundTrip<ResultSummaryDTO, false>("ListDTO<ResultSummaryDTO, false>");
+}
+
+void everySerializableIsCovered() {
+    std::ifstream header("include/common/payloads.h");
+    CHECK(header.good());
+    std::stringstream text;
+    text << header.rdbuf();
+    std::string source = text.str();
+
+    std::regex dto(R"(struct\s+(\w+)\s*:\s*public\s+Serializable<)");
+    size_t found = 0;
+    for (std::sregex_iterator it(source.begin(), source.end(), dto), end; it != end; ++it) {
+        ++found;
+        std::string name = (*it)[1];
+        CHECK_CASE(covered.count(name) == 1, name + " is missing from roundTripAll()");
+    }
+    CHECK(found > 0);
+}
+
+} // namespace
+
+int main() {
+    roundTripAll();
+    everySerializableIsCovered();
+    return testing::testResult("payloads_roundtrip_test");
+}
@@ -0,0 +1,122 @@
+// The responses ChatController, LessonController and ExerciseController build
+// from their models (RECENT_CHATS_SUCCESS, STUDY_LESSON_SUCCESS,
+// STUDY_EXERCISE_SUCCESS), round-tripped through a frame in the request's codec.
+
+#include "test_support.h"
+#include "common/payloads.h"
+#include "common/protocol.h"
+#include "server/model/chat_message.h"
+#include "server/model/exercise.h"
+#include "server/model/lesson.h"
+#include <string>
+#include <vector>
+
+namespace {
+
+// Real content carries the text formats' separators: JSON has ',' and ':',
+// chat messages anything
+const std::string DELIMITERS = "a;b|c^d~e,f";
+
+template <typename T>
+T viaFrame(protocol::MsgCode code, const T& dto, bool binary) {
+    protocol::Message sent = Payloads::encode(code, dto, binary);
+    protocol::Message received = protocol::Message::deserialize(sent.serialize(3, false));
+    CHECK(received.code == code);
+    CHECK(received.binary == binary);
+    T decoded;
+    Payloads::decode(received, decoded);
+    return decoded;
+}
+
+server::Lesson lesson(const std::string& text, const std::vector<std::string>& vocabulary) {
+    server::Lesson l(7, "Lesson 7", "Topic 8", "intermediate");
+    l.setVideoUrl("https://example.com/videos/lesson7.mp4");
+    l.setAudioUrl("https://example.com/audio/lesson7.mp3");
+    l.setTextContent(text);
+    l.setVocabulary(vocabulary);
+    l.setGrammar({"have/has + past participle"});
+    return l;
+}
+
+void studyLesson() {
+    // Binary keeps the JSON vocabulary and any text content intact
+    auto rich = lesson("Anna: Have you ever been to London? Ben: Yes; twice | " + DELIMITERS,
+                       {"{\"word\": \"already\", \"meaning\": \"before now\"}", "{\"word\": \"yet\"}"});
+    Payloads::LessonDTO decoded = viaFrame(protocol::MsgCode::STUDY_LESSON_SUCCESS, rich.toDTO(), true);
+    CHECK(decoded.textContent == rich.getTextContent());
+    CHECK(decoded.vocabulary == rich.getVocabulary());
+    CHECK(decoded.grammar == rich.getGrammar());
+    CHECK(decoded.videoUrl == rich.getVideoUrl());
+
+    // Text clients get the same bytes as before
+    auto plain = lesson("Read the dialogue, then answer the questions.", {"already", "yet"});
+    protocol::Message text = Payloads::encode(protocol::MsgCode::STUDY_LESSON_SUCCESS, plain.toDTO(), false);
+    CHECK(text.toString() == plain.toDTO().serialize());
+    decoded = viaFrame(protocol::MsgCode::STUDY_LESSON_SUCCESS, plain.toDTO(), false);
+    CHECK(decoded.textContent == plain.getTextContent());
+    CHECK(decoded.vocabulary == plain.getVocabulary());
+}
+
+void studyExercise() {
+    server::Exercise exercise(12, 7, "Present perfect practice", "multiple_choice", "intermediate");
+    exercise.setQuestions({
+        server::Question("I have ___ finished. (a|b^c)", {"already", "yet", "ever"}, "already",
+                         "Use already in positive sentences; not yet.", "multiple_choice"),
+        server::Question("Have you ___ been to London?", {"ever", "never"}, "ever", "", "multiple_choice"),
+    });
+
+    Payloads::ExerciseDTO dto = exercise.toDTO();
+    Payloads::ExerciseDTO decoded = viaFrame(protocol::MsgCode::STUDY_EXERCISE_SUCCESS, dto, true);
+    CHECK(decoded.id == "12");
+    CHECK(decoded.lessonId == "7");
+    CHECK(decoded.type == "multiple_choice");
+    CHECK(decoded.questions == dto.questions);
+    CHECK(decoded.questions.size() == 2);
+
+    // The question JSON has no '|' or '^' here, so text keeps it too
+    exercise.setQuestions({server::Question("Pick one", {"3", "4"}, "4", "Math", "multiple_choice")});
+    dto = exercise.toDTO();
+    decoded = viaFrame(protocol::MsgCode::STUDY_EXERCISE_SUCCESS, dto, false);
+    CHECK(decoded.questions == dto.questions);
+}
+
+void recentChats() {
+    const int me = 4;
+    std::vector<server::ChatMessage> messages = {
+        server::ChatMessage(90, me, 9, "see you; bring the book | " + DELIMITERS, "TEXT", "2026-10-18 21:00:00", true),
+        server::ChatMessage(91, 12, me, "ok, thanks", "TEXT", "2026-10-18 21:05:00", false),
+    };
+    CHECK(messages[0].otherParticipant(me) == 9);
+    CHECK(messages[1].otherParticipant(me) == 12);
+
+    Payloads::RecentChatsDTO dto;
+    dto.chats.push_back(messages[0].toRecentChatDTO(me, "teacher"));
+    dto.chats.push_back(messages[1].toRecentChatDTO(me, "student3"));
+
+    Payloads::RecentChatsDTO decoded = viaFrame(protocol::MsgCode::RECENT_CHATS_SUCCESS, dto, true);
+    CHECK(decoded.chats.size() == 2);
+    if (decoded.chats.size() == 2) {
+        CHECK(decoded.chats[0].userId == 9);
+        CHECK(decoded.chats[0].username == "teacher");
+        CHECK(decoded.chats[0].lastMessage == messages[0].getContent());
+        CHECK(decoded.chats[1].userId == 12);
+        CHECK(decoded.chats[1].timestamp == "2026-10-18 21:05:00");
+    }
+
+    // Text keeps the old "userId;username;lastMessage;timestamp" entries
+    dto.chats[0].lastMessage = "see you, bring the book";
+    protocol::Message text = Payloads::encode(protocol::MsgCode::RECENT_CHATS_SUCCESS, dto, false);
+    CHECK(text.toString() ==
+          "9;teacher;see you, bring the book;2026-10-18 21:00:00|12;student3;ok, thanks;2026-10-18 21:05:00");
+    decoded = viaFrame(protocol::MsgCode::RECENT_CHATS_SUCCESS, dto, false);
+    CHECK(decoded.chats.size() == 2);
+}
+
+} // namespace
+
+int main() {
+    studyLesson();
+    studyExercise();
+    recentChats();
+    return testing::testResult("study_responses_test");
+}
@@ -0,0 +1,56 @@
+#ifndef TESTS_TEST_SUPPORT_H
+#define TESTS_TEST_SUPPORT_H
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <string>
+
+// Minimal harness for the tests/ binaries (make tests / make bench): CHECK
+// records a failure and carries on, and main() returns testResult().
+namespace testing {
+
+inline int failures = 0;
+inline int checks = 0;
+
+inline void check(bool ok, const char* expr, const char* file, int line) {
+    ++checks;
+    if (ok) return;
+    ++failures;
+    std::cerr << file << ":" << line << ": CHECK failed: " << expr << "\n";
+}
+
+// Runs fn and reports whether it threw an exception of type E
+template <typename E>
+bool throws(const std::function<void()>& fn) {
+    try {
+        fn();
+    } catch (const E&) {
+        return true;
+    }
+    return false;
+}
+
+inline int testResult(const char* name) {
+    std::cout << name << ": " << (checks - failures) << "/" << checks << " checks passed\n";
+    return failures == 0 ? 0 : 1;
+}
+
+// Mean microseconds per call of fn over iterations calls, after one warm-up
+inline double timeMicros(int iterations, const std::function<void()>& fn) {
+    fn();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) fn();
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / iterations;
+}
+
+} // namespace testing
+
+#define CHECK(expr) ::testing::check(static_cast<bool>(expr), #expr, __FILE__, __LINE__)
+
+// CHECK for checks run once per case (e.g. per DTO type); label names the case
+#define CHECK_CASE(expr, label) \
+    ::testing::check(static_cast<bool>(expr), (std::string(label) + ": " #expr).c_str(), __FILE__, __LINE__)
+
+#endif // TESTS_TEST_SUPPORT_H
@@ -0,0 +1,34 @@
+#ifndef TESTS_TRAFFIC_FIXTURE_H
+#define TESTS_TRAFFIC_FIXTURE_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+// tests/fixtures/traffic.txt: representative server payloads, one record per
+// "## name" line followed by the payload on the next line. Other '#' lines are
+// comments. Paths are relative to the repository root (make tests / make bench).
+namespace testing {
+
+struct TrafficRecord {
+    std::string name;
+    std::string payload;
+};
+
+inline std::vector<TrafficRecord> loadTraffic(const char* path = "tests/fixtures/traffic.txt") {
+    std::vector<TrafficRecord> records;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.rfind("## ", 0) == 0) {
+            records.push_back({line.substr(3), ""});
+        } else if (!line.empty() && line[0] != '#' && !records.empty()) {
+            records.back().payload = line;
+        }
+    }
+    return records;
+}
+
+} // namespace testing
+
+#endif // TESTS_TRAFFIC_FIXTURE_H